@@ -31,6 +31,7 @@
 #include "../../engine/Creature/Creature.h"
 #include "../../engine/Creature/ReproductiveFaculty.h"
 #include "../../engine/Display/DisplayEngine.h"
+#include "../../engine/DirectoryIndex.h"
 #include "../BasicException.h"
 
 #ifndef _WIN32
@@ -445,6 +446,7 @@ bool PrayHandlers::InstallFile(std::string& filename, int category, bool doInsta
 
 	// Okay, we wrote the file out, close it
 	fclose(f);
+	DirectoryIndex::theDirectoryIndex().FileCreated(mainified);
 
 	// If we are installing a catalogue, then reset the catalogue entries
 
@@ -479,6 +481,8 @@ bool PrayHandlers::InstallFile(std::string& filename, int category, bool doInsta
 				DisplayEngine::theRenderer().GetMyPixelFormat(),
 				tempFileName);
 			::DeleteFile(tempFileName.c_str());
+			// (the conversion writes files of its own)
+			DirectoryIndex::theDirectoryIndex().Refresh(category);
 		}
 	}
 	// And say "Wahey :)"
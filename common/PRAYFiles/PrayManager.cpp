@@ -26,7 +26,27 @@
 #include <zlib.h>
 #endif
 
+#include "../../engine/Display/MemoryMappedFile.h"
+
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// The index file starts with these, so we can tell if it's one we understand
+static const char theIndexMagic[4] = { 'P','I','D','X' };
+static const int theIndexVersion = 1;
+
+
+PrayManager::~PrayManager()
+{
+	dirnames.clear();
+	myChunkList.clear();
+	myFileToChunkMap.clear();
+	myChunkFlags.clear();
+	myChunkSizes.clear();
+}
 
 void PrayManager::GarbageCollect(bool force)
 {
@@ -55,7 +75,19 @@ void PrayManager::RescanFolders()
 {
 	myFileToChunkMap.clear();
 	myChunkFlags.clear();
+	myChunkSizes.clear();
 	GarbageCollect(true);
+
+	if (!myIndexLoaded)
+	{
+		LoadIndex();
+		myIndexLoaded = true;
+	}
+	bool indexChanged = false;
+	std::map<std::string, IndexedFile>::iterator iit;
+	for(iit = myFileIndex.begin(); iit != myFileIndex.end(); iit++)
+		(*iit).second.seen = false;
+
 	// Next we scan each file in turn, adding it to the lists :)
 	FileLocaliser f;
 	std::vector<std::string>::iterator it;
@@ -69,74 +101,237 @@ void PrayManager::RescanFolders()
 		std::vector<std::string>::iterator fit;
 		for(fit = files.begin(); fit != files.end(); fit++)
 		{
-			AddFile(*fit);
+			if (AddFile(*fit))
+				indexChanged = true;
 		}
 	}
+
+	// Forget about the files which have gone away
+	iit = myFileIndex.begin();
+	while (iit != myFileIndex.end())
+	{
+		if ((*iit).second.seen)
+			iit++;
+		else
+		{
+			myFileIndex.erase(iit++);
+			indexChanged = true;
+		}
+	}
+
+	if (indexChanged)
+		SaveIndex();
 }
 
-void PrayManager::AddFile(std::string filename)
+bool PrayManager::AddFile(std::string filename)
 {
-	std::map<std::string,FileOffset> localmap;
-	std::map<std::string, FlagsType> localflags;
-	FILE* f;
-	if ((f = fopen(filename.c_str(),"rb")) == NULL)
+	struct stat info;
+	if (stat(filename.c_str(),&info) != 0)
+		return false;
+
+	bool changed = false;
+	std::map<std::string, IndexedFile>::iterator it = myFileIndex.find(filename);
+	if ((it == myFileIndex.end()) ||
+		((*it).second.size != (uint32)info.st_size) ||
+		((*it).second.modified != (uint32)info.st_mtime))
 	{
-		return;
+		// New, or changed since we last looked - read its chunk headers
+		changed = true;
+		IndexedFile file;
+		file.size = (uint32)info.st_size;
+		file.modified = (uint32)info.st_mtime;
+		if (!ReadChunkHeaders(filename,file))
+		{
+			// Couldn't read it at all, so try again next time
+			if (it != myFileIndex.end())
+				myFileIndex.erase(it);
+			return changed;
+		}
+		myFileIndex[filename] = file;
+		it = myFileIndex.find(filename);
 	}
-	PrayFileHeader p;
-	if (fread(&p,1,sizeof(p),f) != sizeof(p))
+	(*it).second.seen = true;
+
+	// Okay - promote the file's chunks to the supermap :)
+
+	std::vector<IndexedChunk>::const_iterator cit;
+	for(cit = (*it).second.chunks.begin(); cit != (*it).second.chunks.end(); cit++)
 	{
-		fclose(f);
-		return;
+		myFileToChunkMap[(*cit).name] = FileOffset(filename,(*cit).offset);
+		myChunkFlags[(*cit).name] = std::make_pair((*cit).flags,(*cit).type);
+		myChunkSizes[(*cit).name] = std::make_pair((*cit).size,(*cit).usize);
 	}
+	return changed;
+}
+
+// Fills in file.chunks from the chunk headers in the file. Returns false if
+// the file couldn't be read - if it just isn't a pray file it has no chunks.
+bool PrayManager::ReadChunkHeaders(std::string filename, IndexedFile& file)
+{
+	file.chunks.clear();
+
+	if (file.size < sizeof(PrayFileHeader))
+		return true;
+
+	MemoryMappedFile mappedFile;
+	try
+	{
+		mappedFile.Open(filename,GENERIC_READ,FILE_SHARE_READ);
+	}
+	catch (MemoryMappedFile::MemoryMappedFileException&)
+	{
+		return false;
+	}
+	const uint8* data = mappedFile.GetFileStart();
+	uint32 length = mappedFile.GetLength();
 
 	// Check that it is a pray file
 
-	if ((p.majik[0] != 'P') ||
-		(p.majik[1] != 'R') ||
-		(p.majik[2] != 'A') ||
-		(p.majik[3] != 'Y'))
+	if ((length < sizeof(PrayFileHeader)) ||
+		(data[0] != 'P') ||
+		(data[1] != 'R') ||
+		(data[2] != 'A') ||
+		(data[3] != 'Y'))
 	{
-		fclose(f);
-		return;
+		return true;
 	}
 
-	// Read all the chunks one by one and index them in the maps
+	// Walk the chunk headers, hopping over the data in between
 
-	while (!feof(f))
+	uint32 ofs = sizeof(PrayFileHeader);
+	while (length - ofs >= sizeof(PrayChunkHeader))
 	{
-		int ofs = ftell(f);
 		PrayChunkHeader ch;
-		if (fread(&ch,1,sizeof(ch),f) != sizeof(ch))
+		memcpy(&ch,data + ofs,sizeof(ch));
+		if (ch.size < 0)
 		{
-			break;		
+			// Rubbish - don't trust anything in this file
+			file.chunks.clear();
+			return true;
 		}
-		FileOffset fo(filename,ofs);
-		localmap[ch.name] = fo;
-		std::string type;
-		type = "    ";
-		type.at(0) = ch.type[0];
-		type.at(1) = ch.type[1];
-		type.at(2) = ch.type[2];
-		type.at(3) = ch.type[3];
-		localflags[ch.name] = std::make_pair(ch.flags,type);
-		if (fseek(f,ch.size,SEEK_CUR))
+
+		IndexedChunk chunk;
+		chunk.name = std::string(ch.name,std::find(ch.name,ch.name + sizeof(ch.name),0));
+		chunk.type = std::string(ch.type,4);
+		chunk.offset = ofs;
+		chunk.flags = ch.flags;
+		chunk.size = ch.size;
+		chunk.usize = ch.usize;
+		file.chunks.push_back(chunk);
+
+		// (A chunk running off the end is still listed - GetChunk will complain)
+		if ((uint32)ch.size > length - ofs - sizeof(ch))
+			break;
+		ofs += sizeof(ch) + ch.size;
+	}
+	return true;
+}
+
+static bool WriteIndexInt(FILE* f, int value)
+{
+	return fwrite(&value,sizeof(value),1,f) == 1;
+}
+
+static bool WriteIndexString(FILE* f, const std::string& value)
+{
+	return WriteIndexInt(f,value.size()) &&
+		(value.empty() || fwrite(value.data(),value.size(),1,f) == 1);
+}
+
+static bool ReadIndexInt(FILE* f, int& value)
+{
+	return fread(&value,sizeof(value),1,f) == 1;
+}
+
+static bool ReadIndexString(FILE* f, std::string& value)
+{
+	int length;
+	if (!ReadIndexInt(f,length) || length < 0 || length > 4096)
+		return false;
+	value.resize(length);
+	return length == 0 || fread(&value[0],length,1,f) == 1;
+}
+
+void PrayManager::LoadIndex()
+{
+	myFileIndex.clear();
+	if (myIndexFilename.empty())
+		return;
+
+	FILE* f;
+	if ((f = fopen(myIndexFilename.c_str(),"rb")) == NULL)
+		return;
+
+	char magic[4];
+	int version, fileCount;
+	bool ok = (fread(magic,sizeof(magic),1,f) == 1) &&
+		(memcmp(magic,theIndexMagic,sizeof(magic)) == 0) &&
+		ReadIndexInt(f,version) && (version == theIndexVersion) &&
+		ReadIndexInt(f,fileCount) && (fileCount >= 0);
+
+	for(int i=0; ok && i<fileCount; i++)
+	{
+		std::string filename;
+		IndexedFile file;
+		int size, modified, chunkCount;
+		ok = ReadIndexString(f,filename) &&
+			ReadIndexInt(f,size) && ReadIndexInt(f,modified) &&
+			ReadIndexInt(f,chunkCount) && (chunkCount >= 0);
+		file.size = size;
+		file.modified = modified;
+		file.seen = false;
+		for(int c=0; ok && c<chunkCount; c++)
 		{
-			fclose(f);
-			return;
+			IndexedChunk chunk;
+			ok = ReadIndexString(f,chunk.name) && ReadIndexString(f,chunk.type) &&
+				ReadIndexInt(f,chunk.offset) && ReadIndexInt(f,chunk.flags) &&
+				ReadIndexInt(f,chunk.size) && ReadIndexInt(f,chunk.usize);
+			if (ok)
+				file.chunks.push_back(chunk);
 		}
+		if (ok)
+			myFileIndex[filename] = file;
 	}
 	fclose(f);
 
-	// Okay - promote the localmap to the supermap :)
+	// A damaged index just means everything gets read again
+	if (!ok)
+		myFileIndex.clear();
+}
+
+void PrayManager::SaveIndex()
+{
+	if (myIndexFilename.empty())
+		return;
 
-	std::map<std::string,FileOffset>::iterator it;
-	for(it = localmap.begin(); it != localmap.end(); it++)
-		myFileToChunkMap[(*it).first] = (*it).second;
-	std::map<std::string,FlagsType>::iterator fit;
-	for(fit = localflags.begin(); fit != localflags.end(); fit++)
-		myChunkFlags[(*fit).first] = (*fit).second;
+	FILE* f;
+	if ((f = fopen(myIndexFilename.c_str(),"wb")) == NULL)
+		return;
+
+	bool ok = (fwrite(theIndexMagic,sizeof(theIndexMagic),1,f) == 1) &&
+		WriteIndexInt(f,theIndexVersion) &&
+		WriteIndexInt(f,myFileIndex.size());
 
+	std::map<std::string, IndexedFile>::const_iterator it;
+	for(it = myFileIndex.begin(); ok && it != myFileIndex.end(); it++)
+	{
+		const IndexedFile& file = (*it).second;
+		ok = WriteIndexString(f,(*it).first) &&
+			WriteIndexInt(f,file.size) && WriteIndexInt(f,file.modified) &&
+			WriteIndexInt(f,file.chunks.size());
+		std::vector<IndexedChunk>::const_iterator cit;
+		for(cit = file.chunks.begin(); ok && cit != file.chunks.end(); cit++)
+		{
+			ok = WriteIndexString(f,(*cit).name) && WriteIndexString(f,(*cit).type) &&
+				WriteIndexInt(f,(*cit).offset) && WriteIndexInt(f,(*cit).flags) &&
+				WriteIndexInt(f,(*cit).size) && WriteIndexInt(f,(*cit).usize);
+		}
+	}
+	fclose(f);
+
+	// Don't leave half an index lying around
+	if (!ok)
+		remove(myIndexFilename.c_str());
 }
 
 int PrayManager::CheckChunk(std::string thisChunk)
@@ -191,37 +386,8 @@ int PrayManager::GetChunkSize(std::string name)
 		return (*it).second->GetSize();
 	}
 
-	// Hmm, not in memory, let's get its headers from disk...
-
-	FileOffset locationOfChunk = myFileToChunkMap[name];
-
-	FILE* f;
-	if ((f = fopen(locationOfChunk.first.c_str(),"rb")) == NULL)
-	{
-		// Boohoo, the file got pulled out from under us :(
-		throw PrayException("Error Opening file in PrayManager::GetChunk - "+name+" @ "+locationOfChunk.first,
-			PrayException::eidFilePulledOut);
-	}
-	if (fseek(f,locationOfChunk.second,SEEK_CUR))
-	{
-		// Aww, we can't seek to that chunk :(
-		fclose(f);
-		throw PrayException("File seek failed in PrayManager::GetChunk - "+name+" @ "+locationOfChunk.first,
-			PrayException::eidFileTooShortInSeek);
-	}
-	PrayChunkHeader ch;
-	if (fread(&ch,1,sizeof(ch),f) != sizeof(ch))
-	{
-		fclose(f);
-		// Aww, we couldn't read the header :(
-		fclose(f);
-		throw PrayException("File too short in PrayManager::GetChunk (Reading Chunk Header) - "+name + " @ " + locationOfChunk.first,
-			PrayException::eidFileTooShortForHeader);
-	}
-	// We now know the size of the Chunk's data and its compressed data.
-	fclose(f);
-	// And now we know the size of the chunk (usize);
-	return ch.usize;
+	// Not in memory, but we remembered its size when we scanned the file
+	return myChunkSizes[name].second;
 }
 
 PrayChunkPtr PrayManager::GetChunk(std::string thisChunk)
@@ -243,66 +409,71 @@ PrayChunkPtr PrayManager::GetChunk(std::string thisChunk)
 
 	FileOffset locationOfChunk = myFileToChunkMap[thisChunk];
 
-	FILE* f;
-	if ((f = fopen(locationOfChunk.first.c_str(),"rb")) == NULL)
+	// The file is only mapped while the chunk is copied out of it, as
+	// it could be rewritten or truncated (and touching a mapping past
+	// its end is fatal) once we're done
+	MemoryMappedFile mappedFile;
+	try
+	{
+		mappedFile.Open(locationOfChunk.first,GENERIC_READ,FILE_SHARE_READ);
+	}
+	catch (MemoryMappedFile::MemoryMappedFileException&)
 	{
 		// Boohoo, the file got pulled out from under us :(
 		throw PrayException("Error Opening file in PrayManager::GetChunk - "+thisChunk+" @ "+locationOfChunk.first,
 			PrayException::eidFilePulledOut);
 	}
-	if (fseek(f,locationOfChunk.second,SEEK_CUR))
+	const uint8* data = mappedFile.GetFileStart();
+	uint32 length = mappedFile.GetLength();
+	uint32 ofs = locationOfChunk.second;
+	if (ofs > length)
 	{
 		// Aww, we can't seek to that chunk :(
-		fclose(f);
 		throw PrayException("File seek failed in PrayManager::GetChunk - "+thisChunk+" @ "+locationOfChunk.first,
 			PrayException::eidFileTooShortInSeek);
 	}
 	PrayChunkHeader ch;
-	if (fread(&ch,1,sizeof(ch),f) != sizeof(ch))
+	if (length - ofs < sizeof(ch))
 	{
 		// Aww, we couldn't read the header :(
-		fclose(f);
 		throw PrayException("File too short in PrayManager::GetChunk (Reading Chunk Header) - "+thisChunk + " @ " + locationOfChunk.first,
 			PrayException::eidFileTooShortForHeader);
 	}
+	memcpy(&ch,data + ofs,sizeof(ch));
+	data += ofs + sizeof(ch);
+	uint32 available = length - ofs - sizeof(ch);
+
 	// We now know the size of the Chunk's data and its compressed data.
 	if ((ch.flags & 1) == 0)
 	{
-		// We can simply instantiate a pointer, and put our data in :)
-		PrayChunkPtr retVal(ch.usize,this);
-		if (fread(retVal->myPtr,1,ch.size,f) != ch.size)
+		if ((ch.size < 0) || ((uint32)ch.size > available))
 		{
 			// Aww the file didn't have enough data in it :(
-			fclose(f);
 			throw PrayException("File to short in PrayManager::GetChunk (Reading uncompressed Data) - "+thisChunk + " @ " + locationOfChunk.first,
 				PrayException::eidFileTooShortForUData);
 		}
-		// Hurrah - we had enough data - let's return :)
+		// We can simply instantiate a pointer, and put our data in :)
+		PrayChunkPtr retVal(ch.usize,this);
+		memcpy(retVal->myPtr,data,ch.size < ch.usize ? ch.size : ch.usize);
 		// After making an entry into our nice cachemap
 		myChunkList[thisChunk] = retVal;
-		fclose(f);
 		return retVal;
 	}
 	// Hmm, we have found the chunk, but we have to uncompress it :(
-	uint8* compressedData = new uint8[ ch.size ];
-	if (fread(compressedData,1,ch.size,f) != ch.size)
+	if ((ch.size < 0) || ((uint32)ch.size > available))
 	{
-		fclose(f);
-		delete [] compressedData;
 		// Aww, we pooped on the load compressed data :(
 		throw PrayException("File to short in PrayManager::GetChunk (Reading compressed Data) - "+thisChunk + " @ " + locationOfChunk.first,
 				PrayException::eidFileTooShortForCData);
 	}
-	fclose(f);
 	PrayChunkPtr returnVal(ch.usize,this);
-	//Let's decompress the data straight into the chunk :)
+	//Let's decompress the data straight from the file into the chunk :)
 
 	unsigned long s,us;
 	s = ch.size; us = ch.usize;
 
-	uncompress(returnVal->myPtr,&us,compressedData,s);
-
-	delete [] compressedData;
+	uncompress(returnVal->myPtr,&us,data,s);
+	mappedFile.Close();
 
 	if (us != ch.usize)
 	{
@@ -24,6 +24,7 @@
 
 typedef std::pair<std::string,int> FileOffset;
 typedef std::pair<int,std::string> FlagsType;
+typedef std::pair<int,int> ChunkSizes;	// size on disk, uncompressed size
 
 class PrayManager
 {
@@ -49,6 +50,18 @@ public:
 	// ----------------------------------------------------------------------------------
 	void RescanFolders();
 
+	// ----------------------------------------------------------------------------------
+	// Method:		SetIndexFile
+	// Arguments:	filename - std::string - Where to keep the chunk index between runs
+	// Returns:		(None)
+	// Description:	RescanFolders remembers the chunks in every file it scans, along
+	//				with the file's size and modification time, and saves it all here.
+	//				Next time (even in a later run) files which haven't changed aren't
+	//				read at all. An empty filename (the default) means no index file.
+	// Costs:		Immediate: Light, Later: Light
+	// ----------------------------------------------------------------------------------
+	void SetIndexFile(std::string filename) { myIndexFilename = filename; myIndexLoaded = false; }
+
 	// ----------------------------------------------------------------------------------
 	// Constructor
 	// Arguments:	thisLang - std::string - the Language ID we are working with
@@ -56,7 +69,7 @@ public:
 	// Description: This constructs a manager, with the given language ID - PrayFiles
 	//				loaded by this manager will first be localised with the filelocaliser
 	// ----------------------------------------------------------------------------------
-	PrayManager(std::string thisLang) { langid = thisLang; }
+	PrayManager(std::string thisLang) { langid = thisLang; myIndexLoaded = false; }
 
 	// ----------------------------------------------------------------------------------
 	// Method:		CheckChunk
@@ -150,10 +163,36 @@ public:
 	// Clears extension list
 	void ClearChunkFileExtensionList() { myChunkFileExtensions.clear(); }
 
-	~PrayManager() { dirnames.clear(); myChunkList.clear(); myFileToChunkMap.clear(); myChunkFlags.clear(); }
+	~PrayManager();
 private:
 
-	void AddFile(std::string filename);
+	// Indexes the chunks in the file, returning true if the file had
+	// to be read (i.e. it wasn't in the index or has changed since)
+	bool AddFile(std::string filename);
+
+	// One chunk as remembered in the index
+	struct IndexedChunk
+	{
+		std::string name;
+		std::string type;
+		int offset;
+		int flags;
+		int size;
+		int usize;
+	};
+
+	// The chunks in one file, and what the file looked like when we read them
+	struct IndexedFile
+	{
+		uint32 size;
+		uint32 modified;
+		bool seen;		// found by the current rescan
+		std::vector<IndexedChunk> chunks;
+	};
+
+	static bool ReadChunkHeaders(std::string filename, IndexedFile& file);
+	void LoadIndex();
+	void SaveIndex();
 
 	std::string langid;
 	std::vector<std::string> dirnames;
@@ -165,9 +204,15 @@ private:
 	
 	std::map<std::string, FileOffset> myFileToChunkMap;
 	std::map<std::string, FlagsType> myChunkFlags;
+	std::map<std::string, ChunkSizes> myChunkSizes;
 
 	std::list<std::string> myChunkFileExtensions;
 
+	// filename -> chunk index for every pray file we've scanned
+	std::map<std::string, IndexedFile> myFileIndex;
+	std::string myIndexFilename;
+	bool myIndexLoaded;
+
 };
 
 #endif //PRAYMANAGER_H
@@ -22,7 +22,9 @@ SRC += common/BasicException.cpp \
 	common/Position.cpp \
 	common/SimpleLexer.cpp \
 	common/Vector2D.cpp \
-	common/Configurator.cpp
+	common/Configurator.cpp \
+	common/unix/SocketServer.cpp \
+	common/unix/SocketClient.cpp
 
 include common/PRAYFiles/module.mk
 
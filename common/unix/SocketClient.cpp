@@ -0,0 +1,147 @@
+// --------------------------------------------------------------------------
+// Filename:	SocketClient.cpp
+// Class:		SocketClient
+//
+// Purpose:		Client side of the unix domain socket external interface
+//
+// Description:	See SocketClient.h
+//
+// History:
+// --------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "SocketClient.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+
+SocketClient::SocketClient()
+{
+	mySocket = -1;
+	myReturnCode = 0;
+}
+
+
+
+bool SocketClient::Open( const char* path )
+{
+	Close();
+
+	sockaddr_un address;
+	memset( &address, 0, sizeof(address) );
+	address.sun_family = AF_UNIX;
+	if( strlen( path ) >= sizeof(address.sun_path) )
+		return false;
+	strcpy( address.sun_path, path );
+
+	mySocket = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( mySocket < 0 )
+		return false;
+
+	if( connect( mySocket, (sockaddr*)&address, sizeof(address) ) != 0 )
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+
+
+void SocketClient::Close()
+{
+	if( mySocket >= 0 )
+	{
+		close( mySocket );
+		mySocket = -1;
+	}
+}
+
+
+
+bool SocketClient::SendRequest( const unsigned char* data, unsigned int size )
+{
+	RequestHeader header;
+	memcpy( header.MagicCookie, "c2e!", 4 );
+	header.DataSize = size;
+
+	return SendAll( &header, sizeof(header) ) && SendAll( data, size );
+}
+
+
+
+bool SocketClient::ReceiveResult()
+{
+	ResultHeader header;
+	if( !ReceiveAll( &header, sizeof(header) ) )
+		return false;
+	if( memcmp( header.MagicCookie, "c2e!", 4 ) != 0 )
+	{
+		Close();
+		return false;
+	}
+
+	myReturnCode = header.ReturnCode;
+	myResult.resize( header.DataSize );
+	return header.DataSize == 0 || ReceiveAll( &myResult[0], header.DataSize );
+}
+
+
+
+bool SocketClient::SendAll( const void* data, unsigned int size )
+{
+	if( mySocket < 0 )
+		return false;
+
+	const char* p = (const char*)data;
+	while( size > 0 )
+	{
+		int sent = send( mySocket, p, size, MSG_NOSIGNAL );
+		if( sent < 0 && errno == EINTR )
+			continue;
+		if( sent <= 0 )
+		{
+			Close();
+			return false;
+		}
+		p += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+
+
+bool SocketClient::ReceiveAll( void* data, unsigned int size )
+{
+	if( mySocket < 0 )
+		return false;
+
+	char* p = (char*)data;
+	while( size > 0 )
+	{
+		int got = recv( mySocket, p, size, 0 );
+		if( got < 0 && errno == EINTR )
+			continue;
+		if( got <= 0 )
+		{
+			Close();
+			return false;
+		}
+		p += got;
+		size -= got;
+	}
+	return true;
+}
@@ -0,0 +1,122 @@
+// --------------------------------------------------------------------------
+// Filename:	SocketClient.h
+// Class:		SocketClient
+//
+// Purpose:		Client side of the unix domain socket external interface
+//				(see SocketServer.h)
+//
+// Description:	Requests can be sent one at a time with StartTransaction(),
+//				as with the win32 ClientSide, or pipelined by calling
+//				SendRequest() several times and then ReceiveResult() once
+//				for each.  Results always come back in the order the
+//				requests were sent.
+//
+//				The game answers requests once a tick, so pipelining is
+//				much faster when there are a lot of them.
+//
+// Usage:
+//
+// void servertest()
+// {
+//   SocketClient c;
+//   c.Open( "/tmp/Creatures 3.caos" );
+//   if( c.StartTransaction( (const unsigned char*)"execute\nouts \"hello\"", 21 ) )
+//     printf("Result: %s\n", c.GetResultBuffer() );
+//   c.Close();
+// }
+//
+// History:
+// --------------------------------------------------------------------------
+
+#ifndef SOCKETCLIENT_H
+#define SOCKETCLIENT_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include <vector>
+#include <stddef.h>
+
+class SocketClient
+{
+public:
+	// ----------------------------------------------------------------------
+	// Method:		Open
+	// Arguments:	path - filename of the server's socket
+	// Returns:		Success
+	// Description:	Connects to a running server
+	// ----------------------------------------------------------------------
+	bool Open( const char* path );
+
+	// ----------------------------------------------------------------------
+	// Method:		Close
+	// Arguments:	None
+	// Returns:		None
+	// Description:	Disconnects.  Requests already sent are still run.
+	// ----------------------------------------------------------------------
+	void Close();
+
+	// ----------------------------------------------------------------------
+	// Method:		SendRequest
+	// Arguments:	data - the request to send (need allow for '\0'
+	//				       char if sending text!)
+	//				size - size of request in bytes
+	// Returns:		false if the communication failed
+	// Description:	Sends a request without waiting for its result.
+	// ----------------------------------------------------------------------
+	bool SendRequest( const unsigned char* data, unsigned int size );
+
+	// ----------------------------------------------------------------------
+	// Method:		ReceiveResult
+	// Arguments:	None
+	// Returns:		false if the communication failed
+	// Description:	Blocks until the result of the oldest outstanding
+	//				request arrives.  Use the accessors below to read it.
+	// ----------------------------------------------------------------------
+	bool ReceiveResult();
+
+	// ----------------------------------------------------------------------
+	// Method:		StartTransaction
+	// Arguments:	data, size - as SendRequest
+	// Returns:		false if the communication failed
+	// Description:	Sends a request and waits for its result.  There
+	//				must be no other requests outstanding.
+	// ----------------------------------------------------------------------
+	bool StartTransaction( const unsigned char* data, unsigned int size )
+		{ return SendRequest( data, size ) && ReceiveResult(); }
+
+	int GetReturnCode() const { return myReturnCode; }
+
+	unsigned int GetResultSize() const { return myResult.size(); }
+
+	const unsigned char* GetResultBuffer() const
+		{ return myResult.empty() ? NULL : &myResult[0]; }
+
+	SocketClient();
+	~SocketClient() { Close(); }
+
+private:
+	// !!! Need to keep these structs in sync with SocketServer version !!!
+	struct RequestHeader
+	{
+		char			MagicCookie[4];		// "c2e!"
+		unsigned int	DataSize;	// size of request following
+	};
+
+	struct ResultHeader
+	{
+		char			MagicCookie[4];		// "c2e!"
+		int				ReturnCode;	// result code returned from server
+		unsigned int	DataSize;	// size of result following
+	};
+
+	bool SendAll( const void* data, unsigned int size );
+	bool ReceiveAll( void* data, unsigned int size );
+
+	int mySocket;
+	int myReturnCode;
+	std::vector< unsigned char > myResult;
+};
+
+#endif // SOCKETCLIENT_H
@@ -0,0 +1,348 @@
+// --------------------------------------------------------------------------
+// Filename:	SocketServer.cpp
+// Class:		SocketServer
+//
+// Purpose:		External interface server for platforms without the win32
+//				shared memory version
+//
+// Description:	See SocketServer.h
+//
+// History:
+// --------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "SocketServer.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+// don't let a client hanging up on us kill the game with SIGPIPE
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static bool SetNonBlocking( int s )
+{
+	int flags = fcntl( s, F_GETFL, 0 );
+	return flags != -1 && fcntl( s, F_SETFL, flags | O_NONBLOCK ) != -1;
+}
+
+
+
+SocketServer::SocketServer()
+{
+	myListener = -1;
+	myMaxSize = 0;
+	myNextClientId = 1;
+}
+
+
+
+bool SocketServer::Create( const char* path, unsigned int maxsize )
+{
+	Close();
+
+	sockaddr_un address;
+	memset( &address, 0, sizeof(address) );
+	address.sun_family = AF_UNIX;
+	if( strlen( path ) >= sizeof(address.sun_path) )
+		return false;
+	strcpy( address.sun_path, path );
+
+	// If something answers on the path then another game is
+	// using it, otherwise it's a leftover from a crash
+	int probe = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( probe < 0 )
+		return false;
+	bool inUse = connect( probe, (sockaddr*)&address, sizeof(address) ) == 0;
+	close( probe );
+	if( inUse )
+		return false;
+	unlink( path );
+
+	myListener = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( myListener < 0 )
+		return false;
+
+	if( bind( myListener, (sockaddr*)&address, sizeof(address) ) != 0 ||
+		listen( myListener, SOMAXCONN ) != 0 ||
+		!SetNonBlocking( myListener ) )
+	{
+		close( myListener );
+		myListener = -1;
+		unlink( path );
+		return false;
+	}
+
+	myPath = path;
+	myMaxSize = maxsize;
+	return true;
+}
+
+
+
+void SocketServer::Close()
+{
+	while( !myClients.empty() )
+		Disconnect( myClients.begin()->first );
+	myRequests.clear();
+
+	if( myListener >= 0 )
+	{
+		close( myListener );
+		myListener = -1;
+		unlink( myPath.c_str() );
+	}
+}
+
+
+
+void SocketServer::Poll()
+{
+	if( myListener < 0 )
+		return;
+
+	std::vector< pollfd > fds( myClients.size() + 1 );
+	std::vector< int > ids;
+	fds[0].fd = myListener;
+	fds[0].events = POLLIN;
+	fds[0].revents = 0;
+
+	std::map< int, Client >::iterator it;
+	int i = 1;
+	for( it = myClients.begin(); it != myClients.end(); ++it, ++i )
+	{
+		fds[i].fd = it->second.socket;
+		fds[i].events = 0;
+		if( WantsInput( it->second ) )
+			fds[i].events |= POLLIN;
+		if( it->second.outSent < it->second.out.size() )
+			fds[i].events |= POLLOUT;
+		fds[i].revents = 0;
+		ids.push_back( it->first );
+	}
+
+	if( poll( &fds[0], fds.size(), 0 ) <= 0 )
+		return;
+
+	for( i = 1; i < fds.size(); ++i )
+	{
+		if( !fds[i].revents )
+			continue;
+
+		int id = ids[i-1];
+		Client& client = myClients[id];
+
+		bool ok = true;
+		if( fds[i].revents & POLLIN )
+			ok = Read( id, client );
+		else if( fds[i].revents & (POLLERR | POLLHUP | POLLNVAL) )
+			ok = false;
+		if( ok && (fds[i].revents & POLLOUT) )
+			ok = Write( client );
+
+		if( !ok || IsDone( client ) )
+			Disconnect( id );
+	}
+
+	// new clients last, so they're not in the arrays above
+	if( fds[0].revents & POLLIN )
+		Accept();
+}
+
+
+
+bool SocketServer::GetRequest( Request& request )
+{
+	if( myRequests.empty() )
+		return false;
+
+	request.client = myRequests.front().client;
+	request.data.swap( myRequests.front().data );
+	myRequests.pop_front();
+	return true;
+}
+
+
+
+void SocketServer::Respond( int client, const char* data, unsigned int size,
+	int returncode )
+{
+	std::map< int, Client >::iterator it = myClients.find( client );
+	if( it == myClients.end() )
+		return;
+	if( it->second.unanswered > 0 )
+		--it->second.unanswered;
+
+	ResultHeader header;
+	memcpy( header.MagicCookie, "c2e!", 4 );
+	header.ReturnCode = returncode;
+	header.DataSize = size;
+
+	std::string& out = it->second.out;
+	out.append( (const char*)&header, sizeof(header) );
+	out.append( data, size );
+
+	if( !Write( it->second ) || IsDone( it->second ) )
+		Disconnect( client );
+}
+
+
+
+void SocketServer::Accept()
+{
+	while( true )
+	{
+		int s = accept( myListener, NULL, NULL );
+		if( s < 0 )
+			return;
+
+		if( !SetNonBlocking( s ) )
+		{
+			close( s );
+			continue;
+		}
+
+		Client& client = myClients[ myNextClientId++ ];
+		client.socket = s;
+		client.outSent = 0;
+		client.unanswered = 0;
+		client.finished = false;
+	}
+}
+
+
+
+// Reads what's waiting, up to one largest request, and queues the
+// complete requests.  Returns false if the client has gone or sent
+// rubbish.
+bool SocketServer::Read( int id, Client& client )
+{
+	bool open = true;
+	char buffer[ 65536 ];
+	unsigned int limit = sizeof(RequestHeader) + myMaxSize;
+
+	while( client.in.size() < limit )
+	{
+		unsigned int room = limit - client.in.size();
+		int got = recv( client.socket, buffer,
+			room < sizeof(buffer) ? room : sizeof(buffer), 0 );
+		if( got > 0 )
+		{
+			client.in.insert( client.in.end(), buffer, buffer + got );
+			continue;
+		}
+		if( got < 0 && errno == EINTR )
+			continue;
+		if( got == 0 )
+			// no more requests, but it still wants the results
+			client.finished = true;
+		else if( errno != EAGAIN && errno != EWOULDBLOCK )
+			open = false;
+		break;
+	}
+
+	// split off complete requests
+	unsigned int used = 0;
+	while( client.in.size() - used >= sizeof(RequestHeader) )
+	{
+		RequestHeader header;
+		memcpy( &header, &client.in[used], sizeof(header) );
+		if( memcmp( header.MagicCookie, "c2e!", 4 ) != 0 ||
+			header.DataSize > myMaxSize )
+		{
+			return false;
+		}
+
+		if( client.in.size() - used - sizeof(header) < header.DataSize )
+			break;
+
+		std::vector<char>::iterator start = client.in.begin() + used + sizeof(header);
+		myRequests.push_back( Request() );
+		Request& request = myRequests.back();
+		request.client = id;
+		request.data.assign( start, start + header.DataSize );
+		if( request.data.empty() || request.data.back() != '\0' )
+			request.data.push_back( '\0' );
+		++client.unanswered;
+
+		used += sizeof(header) + header.DataSize;
+	}
+	if( used > 0 )
+		client.in.erase( client.in.begin(), client.in.begin() + used );
+
+	return open;
+}
+
+
+
+// Writes as much of the pending results as the socket will take.
+// Returns false if the client has gone.
+bool SocketServer::Write( Client& client )
+{
+	while( client.outSent < client.out.size() )
+	{
+		int sent = send( client.socket, client.out.data() + client.outSent,
+			client.out.size() - client.outSent, MSG_NOSIGNAL );
+		if( sent > 0 )
+		{
+			client.outSent += sent;
+			continue;
+		}
+		if( sent < 0 && errno == EINTR )
+			continue;
+		if( sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) )
+			break;
+		return false;
+	}
+
+	if( client.outSent == client.out.size() )
+	{
+		client.out.erase();
+		client.outSent = 0;
+	}
+	else if( client.outSent > 65536 )
+	{
+		client.out.erase( 0, client.outSent );
+		client.outSent = 0;
+	}
+	return true;
+}
+
+
+
+// Whether to read any more from the client this time round
+bool SocketServer::WantsInput( const Client& client ) const
+{
+	return !client.finished && client.out.size() - client.outSent <= myMaxSize;
+}
+
+
+
+// Whether a client that has finished sending has had all its results
+bool SocketServer::IsDone( const Client& client ) const
+{
+	return client.finished && client.unanswered == 0 &&
+		client.outSent == client.out.size();
+}
+
+
+
+void SocketServer::Disconnect( int id )
+{
+	std::map< int, Client >::iterator it = myClients.find( id );
+	if( it == myClients.end() )
+		return;
+
+	close( it->second.socket );
+	myClients.erase( it );
+}
@@ -0,0 +1,153 @@
+// --------------------------------------------------------------------------
+// Filename:	SocketServer.h
+// Class:		SocketServer
+//
+// Purpose:		External interface server for platforms without the win32
+//				shared memory version (see ServerSide.h)
+//
+// Description:	Listens on a unix domain socket.  Any number of clients
+//				can connect, and each can send as many requests as it
+//				likes without waiting for the results (they come back in
+//				the order the requests were sent).
+//
+//				Nothing here blocks or uses threads.  The game calls
+//				Poll() once a tick to pick up whatever has arrived,
+//				answers the requests with Respond(), and the results
+//				are written out as the clients read them.
+//
+//				Each message on the socket is a header followed by the
+//				data.  Requests are text, including the '\0'.
+//
+//				A client can shut down its side once it has sent its
+//				requests; it is only disconnected after their results
+//				have all been written.  A client isn't read from while
+//				it has a whole request's worth of data waiting, or more
+//				than that in results it hasn't read yet, so a client
+//				can't make the game buffer without limit.
+//
+// Usage:
+//
+//   server.Poll();
+//   while( server.GetRequest( request ) )
+//     server.Respond( request.client, result, resultsize, errorcode );
+//
+// History:
+// --------------------------------------------------------------------------
+
+#ifndef SOCKETSERVER_H
+#define SOCKETSERVER_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+
+class SocketServer
+{
+public:
+	struct Request
+	{
+		int client;					// who to send the result to
+		std::vector<char> data;		// always '\0' terminated
+	};
+
+	// ----------------------------------------------------------------------
+	// Method:		Create
+	// Arguments:	path - filename of the socket
+	//				maxsize - largest request that will be accepted
+	// Returns:		Success
+	// Description:	Starts listening.  Fails if another server is already
+	//				answering on that path, otherwise any stale socket
+	//				file left behind is replaced.
+	// ----------------------------------------------------------------------
+	bool Create( const char* path, unsigned int maxsize );
+
+	// ----------------------------------------------------------------------
+	// Method:		Close
+	// Arguments:	None
+	// Returns:		None
+	// Description:	Disconnects all the clients and removes the socket.
+	// ----------------------------------------------------------------------
+	void Close();
+
+	// ----------------------------------------------------------------------
+	// Method:		Poll
+	// Arguments:	None
+	// Returns:		None
+	// Description:	Accepts new clients, reads any requests that have
+	//				arrived and writes out pending results.  Never blocks.
+	// ----------------------------------------------------------------------
+	void Poll();
+
+	// ----------------------------------------------------------------------
+	// Method:		GetRequest
+	// Arguments:	request - receives the oldest unanswered request
+	// Returns:		false if there are no more
+	// ----------------------------------------------------------------------
+	bool GetRequest( Request& request );
+
+	// ----------------------------------------------------------------------
+	// Method:		Respond
+	// Arguments:	client - from the request being answered
+	//				data, size - the result (include the '\0' for text)
+	//				returncode - error code for the client (0=no error)
+	// Returns:		None
+	// Description:	Results must be given in the same order as the
+	//				requests were taken.  Results for clients that have
+	//				since gone away are thrown away.
+	// ----------------------------------------------------------------------
+	void Respond( int client, const char* data, unsigned int size,
+		int returncode=0 );
+
+	bool IsOpen() const { return myListener >= 0; }
+
+	unsigned int GetMaxBufferSize() const { return myMaxSize; }
+
+	SocketServer();
+	~SocketServer() { Close(); }
+
+private:
+	// !!! Need to keep these structs in sync with SocketClient version !!!
+	struct RequestHeader
+	{
+		char			MagicCookie[4];		// "c2e!"
+		unsigned int	DataSize;	// size of request following
+	};
+
+	struct ResultHeader
+	{
+		char			MagicCookie[4];		// "c2e!"
+		int				ReturnCode;	// result code returned from server
+		unsigned int	DataSize;	// size of result following
+	};
+
+	struct Client
+	{
+		int socket;
+		std::vector<char> in;		// partly received requests
+		std::string out;			// results not yet written
+		unsigned int outSent;		// how much of out has gone
+		int unanswered;				// requests queued but not responded to
+		bool finished;				// has shut down its side
+	};
+
+	void Accept();
+	bool Read( int id, Client& client );
+	bool Write( Client& client );
+	bool WantsInput( const Client& client ) const;
+	bool IsDone( const Client& client ) const;
+	void Disconnect( int id );
+
+	int myListener;
+	std::string myPath;
+	unsigned int myMaxSize;
+	int myNextClientId;
+	std::map< int, Client > myClients;
+	std::deque< Request > myRequests;
+};
+
+#endif // SOCKETSERVER_H
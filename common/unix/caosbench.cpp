@@ -0,0 +1,109 @@
+// --------------------------------------------------------------------------
+// Filename:	caosbench.cpp
+//
+// Purpose:		Measures how fast a running game answers CAOS requests
+//				over the unix domain socket external interface.
+//
+// Usage:		caosbench [socket] [requests] [connections] [depth]
+//
+//				Sends <requests> small "execute" requests spread over
+//				<connections> clients, keeping up to <depth> requests in
+//				flight on each (depth 1 = one transaction at a time), and
+//				prints the requests answered per second.
+//
+//				Build with "make caosbench".
+//
+// History:
+// --------------------------------------------------------------------------
+
+#include "SocketClient.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+static double Now()
+{
+	timeval tv;
+	gettimeofday( &tv, NULL );
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+
+int main( int argc, char* argv[] )
+{
+	const char* path = argc > 1 ? argv[1] : "/tmp/Creatures 3.caos";
+	int requests = argc > 2 ? atoi( argv[2] ) : 10000;
+	int connections = argc > 3 ? atoi( argv[3] ) : 4;
+	int depth = argc > 4 ? atoi( argv[4] ) : 64;
+	if( requests < 1 || connections < 1 || depth < 1 )
+	{
+		fprintf( stderr, "usage: caosbench [socket] [requests] [connections] [depth]\n" );
+		return 1;
+	}
+
+	std::vector< SocketClient > clients( connections );
+	int i;
+	for( i = 0; i < connections; ++i )
+	{
+		if( !clients[i].Open( path ) )
+		{
+			fprintf( stderr, "caosbench: can't connect to '%s'\n", path );
+			return 1;
+		}
+	}
+
+	static const char request[] = "execute\nouts \"ok\"";
+	std::vector< int > toSend( connections, requests / connections );
+	toSend[0] += requests % connections;
+	std::vector< int > inFlight( connections, 0 );
+
+	int answered = 0;
+	int failed = 0;
+	double start = Now();
+
+	// keep every connection's pipeline topped up, then collect one
+	// result from each in turn
+	while( answered < requests )
+	{
+		for( i = 0; i < connections; ++i )
+		{
+			while( toSend[i] > 0 && inFlight[i] < depth )
+			{
+				if( !clients[i].SendRequest( (const unsigned char*)request,
+					sizeof(request) ) )
+				{
+					fprintf( stderr, "caosbench: send failed\n" );
+					return 1;
+				}
+				--toSend[i];
+				++inFlight[i];
+			}
+		}
+
+		for( i = 0; i < connections; ++i )
+		{
+			if( inFlight[i] == 0 )
+				continue;
+			if( !clients[i].ReceiveResult() )
+			{
+				fprintf( stderr, "caosbench: receive failed\n" );
+				return 1;
+			}
+			if( clients[i].GetReturnCode() != 0 )
+				++failed;
+			--inFlight[i];
+			++answered;
+		}
+	}
+
+	double elapsed = Now() - start;
+	printf( "%d requests (%d failed) over %d connections, depth %d\n",
+		requests, failed, connections, depth );
+	printf( "%.3f seconds, %.0f requests/sec\n", elapsed,
+		elapsed > 0.0 ? requests / elapsed : 0.0 );
+	return failed ? 2 : 0;
+}
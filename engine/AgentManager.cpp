@@ -55,6 +55,7 @@
 #endif
 
 #include "Map/Map.h" // FastFloatToInteger
+#include <math.h>
 
 ////////////////////////////////////////////////////////////////////////////
 // static member variables
@@ -68,6 +69,12 @@ TaxonomicalAgentMap AgentManager::ourFGSMap;
 TaxonomicalHelperMap AgentManager::ourFGSHelperMap;
 CreatureCollection AgentManager::ourCreatureCollection;
 int AgentManager::ourCategoryIdsForSmellIds[CA_PROPERTY_COUNT];
+SpatialGrid AgentManager::ourSpatialGrid;
+SpatialCell AgentManager::ourOversizedAgents;
+uint32 AgentManager::ourNextAgentListOrder = 0;
+WorkerPool AgentManager::ourFacultyWorkers;
+bool AgentManager::ourFacultyUpdatesCanBeDeferred = false;
+CreatureCollection AgentManager::ourDeferredFacultyUpdates;
 
 ////////////////////////////////////////////////////////////////////////////
 // Constructors
@@ -168,6 +175,7 @@ AgentHandle AgentManager::CreateSimpleAgent
 			ourAgentList.push_front(agent);
 			ourAgentMap[id] = ourAgentList.begin();
 			ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(agent.GetAgentReference().GetClassifier(),agent));
+			AddToSpatialIndex(agent);
 		}
 		else
 		{
@@ -216,6 +224,7 @@ AgentHandle AgentManager::CreateCompoundAgent
 			ourAgentList.push_front(agent);
 			ourAgentMap[id] = ourAgentList.begin();
 			ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(agent.GetAgentReference().GetClassifier(),agent));
+			AddToSpatialIndex(agent);
 		}
 		else
 		{
@@ -265,6 +274,7 @@ AgentHandle AgentManager::CreateVehicle
 			ourAgentList.push_front(agent);
 			ourAgentMap[id] = ourAgentList.begin();
 			ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(agent.GetAgentReference().GetClassifier(),agent));
+			AddToSpatialIndex(agent);
 		}
 		else
 		{	
@@ -330,6 +340,7 @@ AgentHandle AgentManager::CreatePointer()
 			ourAgentList.push_front(agent);
 			ourAgentMap[id] = ourAgentList.begin();
 			ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(agent.GetAgentReference().GetClassifier(),agent));
+			AddToSpatialIndex(agent);
 			theMainView.KeepUpWithMouse(agent.GetAgentReference().GetEntityImage());
 		}
 		else
@@ -374,6 +385,10 @@ void AgentManager::UpdateAllAgents()
 	// call.
 	AgentHandle agent;
 
+	// (even with no worker threads, so that faculties are updated in
+	// the same order either way)
+	ourFacultyUpdatesCanBeDeferred = true;
+
 	for (it=ourAgentList.begin(); it!=ourAgentList.end(); ++it)
 	{
 		agent = (*it);
@@ -411,6 +426,9 @@ void AgentManager::UpdateAllAgents()
 	Agent::ourAgentProfilerPaceTotal += (double)theApp.GetTickRateFactor();
 #endif
 
+	ourFacultyUpdatesCanBeDeferred = false;
+	UpdateDeferredFaculties();
+
 	// Now we clean the map.
 	for (kit = ourKillList.begin(); kit != ourKillList.end(); ++kit)
 	{
@@ -421,6 +439,85 @@ void AgentManager::UpdateAllAgents()
 }
 
 
+bool AgentManager::StartFacultyWorkers(int threadCount)
+{
+	return ourFacultyWorkers.Start(threadCount);
+}
+
+
+void AgentManager::StopFacultyWorkers()
+{
+	ourFacultyWorkers.Stop();
+}
+
+
+bool AgentManager::DeferFacultyUpdate(AgentHandle const& creature)
+{
+	if (!ourFacultyUpdatesCanBeDeferred)
+		return false;
+
+	ourDeferredFacultyUpdates.push_back(creature);
+	return true;
+}
+
+
+void AgentManager::UpdateSelfContainedFaculty(void* creature)
+{
+	((Creature*)creature)->UpdateSelfContainedFaculty();
+}
+
+
+// Runs the deferred creature updates in rounds: the self-contained
+// faculty each creature is waiting on goes out to the worker threads,
+// then each creature carries on serially up to its next one.
+void AgentManager::UpdateDeferredFaculties()
+{
+	std::vector<void*> batch;
+	CreatureCollection stillWaiting;
+
+	while (!ourDeferredFacultyUpdates.empty())
+	{
+		// Anything killed since it was deferred is dropped
+		stillWaiting.clear();
+		batch.clear();
+		CreatureCollectionIterator c;
+		for (c=ourDeferredFacultyUpdates.begin(); c!=ourDeferredFacultyUpdates.end(); ++c)
+		{
+			if ((*c).IsValid() && !(*c).GetAgentReference().AreYouDoomed())
+			{
+				stillWaiting.push_back(*c);
+				batch.push_back(&(*c).GetCreatureReference());
+			}
+		}
+		ourDeferredFacultyUpdates.swap(stillWaiting);
+
+		if (batch.empty())
+			break;
+
+		if (!ourFacultyWorkers.Run(UpdateSelfContainedFaculty, &batch[0], batch.size()))
+			theFlightRecorder.Log(1, "Exception in parallel faculty update\n");
+
+		stillWaiting.clear();
+		for (c=ourDeferredFacultyUpdates.begin(); c!=ourDeferredFacultyUpdates.end(); ++c)
+		{
+			AgentHandle creature = *c;
+			if (!creature.IsValid())
+				continue;
+
+			Creature& creatureref = creature.GetCreatureReference();
+			if (creatureref.AreYouDoomed())
+				continue;
+			if (creatureref.ContinueFacultyUpdate())
+				stillWaiting.push_back(creature);
+			if (creatureref.AreYouDoomed())
+				KillAgent(creature);
+		}
+		ourDeferredFacultyUpdates.swap(stillWaiting);
+	}
+	ourDeferredFacultyUpdates.clear();
+}
+
+
 void AgentManager::ExecuteScriptOnAllAgents
 	(int event, AgentHandle& from, 
 	 const CAOSVar& p1, const CAOSVar& p2)
@@ -889,6 +986,8 @@ void AgentManager::KillAgent(const AgentHandle& agent)
 	ourFGSHelperMap.erase(thit);
 	ourFGSMap.erase(tait);
 
+	RemoveFromSpatialIndex(agent2);
+
 	ourKillList.push_back(it);
 	
 	agent.GetAgentReference().Trash();
@@ -969,11 +1068,8 @@ int AgentManager::GetSmellIdFromCategoryId(int categoryId) {
 
 
 
-// NOTE - THESE FUNCTIONS CURRENTLY DO BRUTE-FORCE SEARCHES.
-// THIS IS A BAD THING(tm).
-//
-// SHOULD BE REIMPLEMENTED USING A CLASSIFICATION TREE AND/OR SPATIAL
-// PARTITIONING.
+// NOTE - FindByFGS() USES THE TAXONOMICAL MAP. THE AREA AND SIGHT
+// SEARCHES GO THROUGH THE SPATIAL GRID (SEE FindCandidatesByArea()).
 
 
 void AgentManager::FindByFGS( AgentList& agents, const Classifier& c )
@@ -1025,7 +1121,7 @@ void AgentManager::FindByFGS( AgentList& agents, const Classifier& c )
 
 void AgentManager::FindByArea( AgentList& agents, const Box& r )
 {
-	FindByArea( ourAgentList, agents, r );
+	FindCandidatesByArea( agents, r );
 }
 void AgentManager::FindByArea( AgentList& input, AgentList& agents, const Box& r )
 {
@@ -1045,38 +1141,23 @@ void AgentManager::FindByArea( AgentList& input, AgentList& agents, const Box& r
 void AgentManager::FindByAreaAndFGS( AgentList& agents,
 	const Classifier& c, const Box& r )
 {
-	AgentListIterator it;
-	AgentListIterator itnext;
+	// The spatial grid narrows things down to the agents near the
+	// box, so it is always cheaper to go by area first and then
+	// filter out the non-matching classifiers.  The results are put
+	// in ourFGSMap's order, as when this went by FGS first.
 	AgentList temp;
-	// EITHER:
-	// 1) FindByArea( agents, r );
-	// 2) filter out all agents with non-matching classifiers
-	//
-	// OR:
-	// 1) FindByFGS( agents, c );
-	// 2) filter out all agents outside rect
-	//
-	// WHICHEVER IS FASTER!
-
-	FindByFGS( temp, c );
-	FindByArea( temp,agents, r );
-
-	/*
-	// cull out ones with wrong fgs
-	it = agents.begin();
-	while(  it != agents.end() )
-	{
-		itnext = it;
-		++itnext;
+	FindCandidatesByArea( temp, r );
+	SortAgents( temp, IsEarlierInFGSMap );
 
-		if( !(*it).GetAgentReference().GetClassifier().GenericMatchForWildCard( c, TRUE, TRUE,
-			TRUE, FALSE ) )
+	AgentListIterator it;
+	for( it = temp.begin(); it != temp.end(); ++it )
+	{
+		if( (*it).GetAgentReference().GetClassifier().GenericMatchForWildCard( c,
+			TRUE, TRUE, TRUE, FALSE ) )
 		{
-			agents.erase( it );
+			agents.push_back( (*it) );
 		}
-		it = itnext;
-	}*/
-
+	}
 }
 
 
@@ -1088,7 +1169,18 @@ void AgentManager::FindBySightAndFGS( AgentHandle const& viewer,
 	AgentListIterator it;
 	AgentListIterator itnext;
 
-	FindByFGS( agents, c );
+	// Anything the viewer can see has its centre within visual range,
+	// so its extent must overlap this box.
+	Agent& viewerref = viewer.GetAgentReference();
+	Vector2D centre = viewerref.GetCentre();
+	float range = viewerref.GetVisualRange();
+	Box r;
+	r.left = centre.x - range;
+	r.right = centre.x + range;
+	r.top = centre.y - range;
+	r.bottom = centre.y + range;
+
+	FindByAreaAndFGS( agents, c, r );
 
 	// cull out ones which can't be seen
 	it = agents.begin();
@@ -1105,6 +1197,236 @@ void AgentManager::FindBySightAndFGS( AgentHandle const& viewer,
 	}
 }
 
+
+
+////////////////////////////////////////////////////////////////////////////
+// Spatial index
+////////////////////////////////////////////////////////////////////////////
+
+int AgentManager::SpatialCellOf(float coordinate)
+{
+	// keep silly coordinates (eg huge visual ranges) from overflowing
+	const float limit = 1.0e9f;
+	if (coordinate < -limit)
+		coordinate = -limit;
+	else if (coordinate > limit)
+		coordinate = limit;
+
+	return ((int)floor(coordinate)) >> SPATIAL_CELL_SHIFT;
+}
+
+uint32 AgentManager::SpatialCellKey(int x, int y)
+{
+	return (((uint32)x & 0xffff) << 16) | ((uint32)y & 0xffff);
+}
+
+void AgentManager::AddToSpatialCells(Agent& agentref)
+{
+	Box extent;
+	agentref.GetAgentExtent(extent);
+
+	int left = SpatialCellOf(extent.left);
+	int top = SpatialCellOf(extent.top);
+	int right = SpatialCellOf(extent.right);
+	int bottom = SpatialCellOf(extent.bottom);
+
+	agentref.mySpatialCellLeft = left;
+	agentref.mySpatialCellTop = top;
+	agentref.mySpatialCellRight = right;
+	agentref.mySpatialCellBottom = bottom;
+
+	if ((right - left) >= SPATIAL_MAX_CELLS_PER_AGENT ||
+		(bottom - top) >= SPATIAL_MAX_CELLS_PER_AGENT ||
+		(right - left + 1) * (bottom - top + 1) > SPATIAL_MAX_CELLS_PER_AGENT)
+	{
+		// Too big to be worth filing cell by cell - every search
+		// checks these
+		agentref.mySpatiallyOversized = true;
+		ourOversizedAgents.push_back(agentref.mySelf);
+		return;
+	}
+
+	agentref.mySpatiallyOversized = false;
+	for (int x = left; x <= right; ++x)
+	{
+		for (int y = top; y <= bottom; ++y)
+			ourSpatialGrid[SpatialCellKey(x, y)].push_back(agentref.mySelf);
+	}
+}
+
+void AgentManager::RemoveFromSpatialCells(Agent& agentref)
+{
+	SpatialCell::iterator found;
+
+	if (agentref.mySpatiallyOversized)
+	{
+		found = std::find(ourOversizedAgents.begin(), ourOversizedAgents.end(),
+			agentref.mySelf);
+		_ASSERT(found != ourOversizedAgents.end());
+		if (found != ourOversizedAgents.end())
+		{
+			*found = ourOversizedAgents.back();
+			ourOversizedAgents.pop_back();
+		}
+		agentref.mySpatiallyOversized = false;
+		return;
+	}
+
+	for (int x = agentref.mySpatialCellLeft; x <= agentref.mySpatialCellRight; ++x)
+	{
+		for (int y = agentref.mySpatialCellTop; y <= agentref.mySpatialCellBottom; ++y)
+		{
+			SpatialGridIterator cellit = ourSpatialGrid.find(SpatialCellKey(x, y));
+			_ASSERT(cellit != ourSpatialGrid.end());
+			if (cellit == ourSpatialGrid.end())
+				continue;
+
+			SpatialCell& cell = (*cellit).second;
+			found = std::find(cell.begin(), cell.end(), agentref.mySelf);
+			_ASSERT(found != cell.end());
+			if (found != cell.end())
+			{
+				// order within a cell doesn't matter
+				*found = cell.back();
+				cell.pop_back();
+			}
+			if (cell.empty())
+				ourSpatialGrid.erase(cellit);
+		}
+	}
+}
+
+void AgentManager::AddToSpatialIndex(AgentHandle const& agent)
+{
+	Agent& agentref = agent.GetAgentReference();
+	if (agentref.mySpatiallyIndexed)
+		return;
+
+	agentref.mySpatiallyIndexed = true;
+	// (this is called wherever an agent goes into ourAgentList and
+	// ourFGSMap)
+	agentref.myAgentListOrder = ourNextAgentListOrder++;
+	AddToSpatialCells(agentref);
+}
+
+void AgentManager::RemoveFromSpatialIndex(AgentHandle const& agent)
+{
+	Agent& agentref = agent.GetAgentReference();
+	if (!agentref.mySpatiallyIndexed)
+		return;
+
+	RemoveFromSpatialCells(agentref);
+	agentref.mySpatiallyIndexed = false;
+}
+
+// Called by agents whenever their position or size changes.  Most
+// moves stay within the same cells, so check that first.
+void AgentManager::UpdateSpatialIndex(Agent& agentref)
+{
+	_ASSERT(agentref.mySpatiallyIndexed);
+
+	Box extent;
+	agentref.GetAgentExtent(extent);
+
+	if (!agentref.mySpatiallyOversized &&
+		SpatialCellOf(extent.left) == agentref.mySpatialCellLeft &&
+		SpatialCellOf(extent.top) == agentref.mySpatialCellTop &&
+		SpatialCellOf(extent.right) == agentref.mySpatialCellRight &&
+		SpatialCellOf(extent.bottom) == agentref.mySpatialCellBottom)
+		return;
+
+	RemoveFromSpatialCells(agentref);
+	AddToSpatialCells(agentref);
+}
+
+// All valid agents whose bounds intersect r, in ourAgentList's order
+void AgentManager::FindCandidatesByArea(AgentList& agents, const Box& r)
+{
+	int left = SpatialCellOf(r.left);
+	int top = SpatialCellOf(r.top);
+	int right = SpatialCellOf(r.right);
+	int bottom = SpatialCellOf(r.bottom);
+
+	// If the box covers more cells than are occupied, it's quicker to
+	// just check every agent
+	double cellCount = ((double)(right - left) + 1.0) * ((double)(bottom - top) + 1.0);
+	if (cellCount > (double)ourSpatialGrid.size())
+	{
+		FindByArea( ourAgentList, agents, r );
+		return;
+	}
+
+	SpatialCell::iterator it;
+	for (int x = left; x <= right; ++x)
+	{
+		for (int y = top; y <= bottom; ++y)
+		{
+			SpatialGridIterator cellit = ourSpatialGrid.find(SpatialCellKey(x, y));
+			if (cellit == ourSpatialGrid.end())
+				continue;
+
+			SpatialCell& cell = (*cellit).second;
+			for (it = cell.begin(); it != cell.end(); ++it)
+			{
+				if ((*it).IsInvalid())
+					continue;
+
+				Agent& agentref = (*it).GetAgentReference();
+
+				// An agent filed under several cells is only reported
+				// from the first of them which lies inside the search
+				if (x != (agentref.mySpatialCellLeft > left ? agentref.mySpatialCellLeft : left) ||
+					y != (agentref.mySpatialCellTop > top ? agentref.mySpatialCellTop : top))
+					continue;
+
+				if (agentref.DoBoundsIntersect(r))
+					agents.push_back(*it);
+			}
+		}
+	}
+
+	for (it = ourOversizedAgents.begin(); it != ourOversizedAgents.end(); ++it)
+	{
+		if ((*it).IsValid() && (*it).GetAgentReference().DoBoundsIntersect(r))
+			agents.push_back(*it);
+	}
+
+	// The cells give them in an order that depends on how agents have
+	// moved about, so go back to the order searching the list gave
+	SortAgents(agents, IsNewerInAgentList);
+}
+
+// ourAgentList has the newest agents at the front
+bool AgentManager::IsNewerInAgentList(AgentHandle const& a, AgentHandle const& b)
+{
+	return a.GetAgentReference().myAgentListOrder >
+		b.GetAgentReference().myAgentListOrder;
+}
+
+// ourFGSMap sorts by classifier, and agents with the same one are
+// in the order they were added
+bool AgentManager::IsEarlierInFGSMap(AgentHandle const& a, AgentHandle const& b)
+{
+	Agent& aref = a.GetAgentReference();
+	Agent& bref = b.GetAgentReference();
+	if (aref.GetClassifier() < bref.GetClassifier())
+		return true;
+	if (bref.GetClassifier() < aref.GetClassifier())
+		return false;
+	return aref.myAgentListOrder < bref.myAgentListOrder;
+}
+
+void AgentManager::SortAgents(AgentList& agents,
+	bool (*isBefore)(AgentHandle const&, AgentHandle const&))
+{
+	if (agents.size() < 2)
+		return;
+
+	std::vector<AgentHandle> sorted(agents.begin(), agents.end());
+	std::sort(sorted.begin(), sorted.end(), isBefore);
+	std::copy(sorted.begin(), sorted.end(), agents.begin());
+}
+
 AgentHandle AgentManager::FindNextAgent(AgentHandle& was, const Classifier& c)
 {
 	AgentList agents;
@@ -1198,6 +1520,7 @@ bool AgentManager::Read(CreaturesArchive &ar)
 					ourAgentList.push_front(agent);
 					ourAgentMap[id] = ourAgentList.begin();
 					ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(agent.GetAgentReference().GetClassifier(),agent));
+					AddToSpatialIndex(agent);
 				}
 				if (agent.IsPointerAgent())
 					thePointer = agent;
@@ -1238,6 +1561,7 @@ void AgentManager::RegisterClone(AgentHandle& clone)
 	Agent& cloneref = clone.GetAgentReference();
 	cloneref.SetUniqueID(id);
 	ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(clone.GetAgentReference().GetClassifier(),clone));
+	AddToSpatialIndex(clone);
 	if (clone.IsCreature())
 		ourCreatureCollection.push_back(clone);
 }
@@ -1294,6 +1618,7 @@ void AgentManager::AddCreatureToUpdateList(AgentHandle const & creature)
 	ourAgentList.push_front(creature);
 	ourAgentMap[id] = ourAgentList.begin();
 	ourFGSHelperMap[id] = ourFGSMap.insert(std::make_pair(creature.GetAgentReference().GetClassifier(),creature));
+	AddToSpatialIndex(creature);
 }
 
 
@@ -38,6 +38,7 @@
 
 #include "Caos/CAOSVar.h"
 #include "Classifier.h"
+#include "WorkerPool.h"
 
 ////////////////////////////////////////////////////////////////////////////
 // Foward Declarations all types of agent we can create
@@ -72,6 +73,12 @@ typedef TaxonomicalAgentMap::iterator TaxonomicalAgentIterator;
 typedef std::map<uint32, TaxonomicalAgentIterator> TaxonomicalHelperMap;
 typedef TaxonomicalHelperMap::iterator TaxonomicalHelperIterator;
 
+// Uniform grid of agents keyed on packed cell coordinates
+// (see AgentManager::SpatialCellKey)
+typedef std::vector<AgentHandle> SpatialCell;
+typedef std::map<uint32, SpatialCell> SpatialGrid;
+typedef SpatialGrid::iterator SpatialGridIterator;
+
 // so that calls to the agent manager are tidy
 #define theAgentManager AgentManager::GetAgentManager()
 
@@ -206,6 +213,15 @@ AgentHandle CreatePointer();
 		AgentList& agents,
 		const Classifier& c );
 
+	// ----------------------------------------------------------------------
+	// Spatial index maintenance.  Agents are filed under every grid cell
+	// their extent overlaps, so the area finders only have to look at
+	// agents near the search box.
+	// ----------------------------------------------------------------------
+	static void AddToSpatialIndex(AgentHandle const& agent);
+	static void RemoveFromSpatialIndex(AgentHandle const& agent);
+	static void UpdateSpatialIndex(Agent& agent);
+
 // ----------------------------------------------------------------------
 // Method:      WhoAmITouching
 // Arguments:   me - creature doing the looking		
@@ -288,6 +304,19 @@ void CalculateMoodAndThreat(uint32& iSelectableCount,
 
 	static void KillAgent(const AgentHandle& agent);
 	void UpdateAllAgents();
+
+	// ----------------------------------------------------------------------
+	// Parallel faculty updates.  While UpdateAllAgents() runs, creatures
+	// hand over their self-contained faculties (brain, biochemistry) with
+	// DeferFacultyUpdate().  Once every agent has had its turn these are
+	// run across the worker threads, and the rest of each creature's
+	// update is then finished off serially, in the original agent order.
+	// With no worker threads the same rounds are run on the main thread,
+	// so the results don't depend on the number of threads.
+	// ----------------------------------------------------------------------
+	static bool StartFacultyWorkers(int threadCount);
+	static void StopFacultyWorkers();
+	static bool DeferFacultyUpdate(AgentHandle const& creature);
 	void KillAllAgents();
 	void ExecuteScriptOnAllAgents(int event, AgentHandle& from, const CAOSVar& p1, const CAOSVar& p2);
 	void ExecuteScriptOnAllAgentsDeferred(int event, AgentHandle& from, const CAOSVar& p1, const CAOSVar& p2);
@@ -470,6 +499,34 @@ private:
 	static int ourCategoryIdsForSmellIds[CA_PROPERTY_COUNT];
 	static CreatureCollection ourCreatureCollection;
 	static uint32 ourBaseUniqueID;
+
+	// Spatial index
+	enum
+	{
+		SPATIAL_CELL_SHIFT = 8,				// 256 pixel cells
+		SPATIAL_MAX_CELLS_PER_AGENT = 64	// bigger agents go on the oversized list
+	};
+	static SpatialGrid ourSpatialGrid;
+	static SpatialCell ourOversizedAgents;
+	static uint32 ourNextAgentListOrder;
+
+	static int SpatialCellOf(float coordinate);
+	static uint32 SpatialCellKey(int x, int y);
+	static void RemoveFromSpatialCells(Agent& agentref);
+	static void AddToSpatialCells(Agent& agentref);
+	void FindCandidatesByArea(AgentList& agents, const Box& r);
+	static bool IsNewerInAgentList(AgentHandle const& a, AgentHandle const& b);
+	static bool IsEarlierInFGSMap(AgentHandle const& a, AgentHandle const& b);
+	static void SortAgents(AgentList& agents,
+		bool (*isBefore)(AgentHandle const&, AgentHandle const&));
+
+	// Parallel faculty updates
+	static WorkerPool ourFacultyWorkers;
+	static bool ourFacultyUpdatesCanBeDeferred;
+	static CreatureCollection ourDeferredFacultyUpdates;
+
+	static void UpdateDeferredFaculties();
+	static void UpdateSelfContainedFaculty(void* creature);
 	
 	typedef std::list< DeferredScript > DeferredScriptList;
 	DeferredScriptList myDeferredScripts;
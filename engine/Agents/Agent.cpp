@@ -249,6 +249,12 @@ void Agent::Init()
 	myCurrentWidth= 0.0f;
 	myCurrentHeight =0.0f;
 
+	mySpatiallyIndexed = false;
+	mySpatiallyOversized = false;
+	mySpatialCellLeft = mySpatialCellTop = 0;
+	mySpatialCellRight = mySpatialCellBottom = -1;
+	myAgentListOrder = 0;
+
 
 	for (i = 0; i < NUMBER_OF_STATES_I_CAN_HANDLE_FOR_CLICKACTIONS; i++)
 	{
@@ -1379,6 +1385,13 @@ void Agent::MoveTo(float x, float y)
 	_ASSERT(!myGarbaged);
 	myPositionVector.x = x;
 	myPositionVector.y = y;
+	UpdateSpatialIndex();
+}
+
+void Agent::UpdateSpatialIndex()
+{
+	if (mySpatiallyIndexed)
+		theAgentManager.UpdateSpatialIndex(*this);
 }
 
 void Agent::MoveBy(float xd, float yd)
@@ -51,6 +51,10 @@ class Agent : public PersistentObject
 {
 	CREATURES_DECLARE_SERIAL( Agent )
 
+	// the agent manager files agents in its spatial index using
+	// the cell range members below
+	friend class AgentManager;
+
 public:
 
 	// Constants for Execute...() calls
@@ -429,6 +433,8 @@ public:
 	virtual bool MoveToSafePlace(const Vector2D& positionPreferred);
 	virtual bool MoveToSafePlaceGivenCurrentLocation();
 
+	// call whenever myPositionVector or the current width/height change
+	void UpdateSpatialIndex();
 	
 	void FloatTo(const Vector2D& position);
 
@@ -1008,6 +1014,18 @@ protected:
 	float myCurrentHeight;
 	bool myResetLines;
 
+	// Spatial index cells this agent is currently filed under
+	// (see AgentManager::UpdateSpatialIndex)
+	bool mySpatiallyIndexed;
+	bool mySpatiallyOversized;
+	int mySpatialCellLeft;
+	int mySpatialCellTop;
+	int mySpatialCellRight;
+	int mySpatialCellBottom;
+	// when the agent was added to the agent lists, to put search
+	// results from the grid back in the order the lists would give
+	uint32 myAgentListOrder;
+
 	bool myDrawMirroredFlag;
 	
 	// Reference counting done through the smart pointer
@@ -57,6 +57,10 @@ public:
 	// Inequality
 	bool operator!=(const AgentHandle& handle) const; 
 
+	// Ordering (by agent address, so handles can be used as map keys)
+	bool operator<(const AgentHandle& handle) const
+		{ return myAgentPointer < handle.myAgentPointer; }
+
 private:
 	// These functions are declared but not defined so that the
 	// compiler can catch comparisons and assignments to a raw
@@ -226,6 +226,7 @@ void CompoundAgent::Update()
 
 	myCurrentWidth = (*myParts.begin())->GetEntity()->GetWidth();
 	myCurrentHeight = (*myParts.begin())->GetEntity()->GetHeight();
+	UpdateSpatialIndex();
 
 }
 
@@ -521,6 +522,7 @@ bool CompoundAgent::ShowPose( int pose, int partid )
 	{
 		myCurrentWidth = myParts[partid]->GetEntity()->GetWidth();
 		myCurrentHeight = myParts[partid]->GetEntity()->GetHeight();
+		UpdateSpatialIndex();
 	}
 
 	return true;
@@ -8,6 +8,16 @@
 #include "../World.h"
 #include <algorithm>
 
+MessageQueue::MessageQueue()
+{
+	for( int i = 0; i < LIST_COUNT; ++i )
+		myLists[i].head = myLists[i].tail = NO_NODE;
+	myFreeNodes = NO_NODE;
+	myNextSequence = 0;
+	myWheelTick = 0;
+	myDelayedCount = 0;
+}
+
 void MessageQueue::WriteMessage(	AgentHandle const & from,
 					AgentHandle const& to,
 					int msg,
@@ -15,60 +25,380 @@ void MessageQueue::WriteMessage(	AgentHandle const & from,
 					unsigned delay )
 {
 	if( delay )
-		myDelayedQueue.insert( Message( from, to, msg, p1, p2, theApp.GetWorld().GetWorldTick() + delay ) );
+	{
+		uint32 now = theApp.GetWorld().GetWorldTick();
+
+		// the wheel can only take messages from its current tick on
+		if( myDelayedCount == 0 )
+			myWheelTick = now + 1;
+		else if( now + 1 < myWheelTick )
+			Rebuild( now + 1 );
+
+		// A negative delay from CAOS wraps round to before now, and
+		// is due straight away
+		uint32 time = now + delay;
+		int node = NewNode( Message( from, to, msg, p1, p2, time ) );
+		if( time < myWheelTick )
+			InsertDue( node );
+		else
+		{
+			Schedule( node );
+			++myDelayedCount;
+		}
+	}
 	else
-		myImmediateQueue.push_back( Message( from, to, msg, p1, p2, delay ) );
+		Append( LIST_IMMEDIATE, NewNode( Message( from, to, msg, p1, p2, delay ) ) );
 }
 
-//Utilities for removing messages refering to particular AgentHandles
-struct RefersToAgent
+void MessageQueue::RemoveMessagesAbout( AgentHandle& o )
 {
-	RefersToAgent( AgentHandle& agentHandle ) : myAgentHandle( agentHandle ) {}
+	AgentLists::iterator it = myAgentLists.find( o );
+	if( it == myAgentLists.end() )
+		return;
 
-	bool operator()( Message const &message )
+	// Collect them first, as freeing the nodes changes the list.
+	// A message from the agent to itself is on the list twice.
+	std::vector<int> nodes;
+	for( AgentLink link = it->second; link != NO_NODE;
+		link = myNodes[ link >> 1 ].agentNext[ link & 1 ] )
 	{
-		return message.GetFrom() == myAgentHandle || message.GetTo() == myAgentHandle;
+		nodes.push_back( link >> 1 );
 	}
+	std::sort( nodes.begin(), nodes.end() );
+	nodes.erase( std::unique( nodes.begin(), nodes.end() ), nodes.end() );
 
-	AgentHandle myAgentHandle;
-};
+	for( int i = 0; i < nodes.size(); ++i )
+	{
+		if( myNodes[ nodes[i] ].list >= LIST_OVERFLOW )
+			--myDelayedCount;
+		FreeNode( nodes[i] );
+	}
+}
 
-void MessageQueue::RemoveMessagesAbout( AgentHandle& o )
+bool MessageQueue::ReadMessage( Message &message )
 {
-	RefersToAgent functor(o);
-	std::deque<Message> de;
-	std::multiset<Message,CompareMessageTimes> ms;
-	for(std::deque<Message>::iterator it = myImmediateQueue.begin();
-		it != myImmediateQueue.end();
-		it++)
-		if (functor(*it) == false)
-			de.push_back(*it);
-	de.swap(myImmediateQueue);
-	for(std::multiset<Message,CompareMessageTimes>::iterator it =
-		myDelayedQueue.begin();
-		it != myDelayedQueue.end();
-		it++)
-		if (functor(*it) == false)
-			ms.insert(*it);
-	ms.swap(myDelayedQueue);
+	int node = PopFront( LIST_IMMEDIATE );
+	if( node == NO_NODE )
+	{
+		AdvanceTo( theApp.GetWorld().GetWorldTick() );
+		node = PopFront( LIST_DUE );
+	}
+	if( node == NO_NODE )
+		return false;
+
+	message = myNodes[ node ].message;
+	FreeNode( node );
+	return true;
 }
 
-bool MessageQueue::ReadMessage( Message &message )
+
+
+int MessageQueue::NewNode( Message const& message )
 {
-	if( myImmediateQueue.size() )
+	int node = myFreeNodes;
+	if( node != NO_NODE )
+		myFreeNodes = myNodes[ node ].next;
+	else
 	{
-		message = myImmediateQueue.front();
-		myImmediateQueue.pop_front();
-		return true;
+		node = myNodes.size();
+		myNodes.push_back( Node() );
 	}
-	else if( myDelayedQueue.size() && 
-		myDelayedQueue.begin()->GetTime() <= theApp.GetWorld().GetWorldTick() )
+
+	Node& n = myNodes[ node ];
+	n.message = message;
+	n.sequence = myNextSequence++;
+	n.list = NO_NODE;
+	n.next = n.prev = NO_NODE;
+	AddToAgentList( node, 0, n.message.GetFrom() );
+	AddToAgentList( node, 1, n.message.GetTo() );
+	return node;
+}
+
+void MessageQueue::FreeNode( int node )
+{
+	Node& n = myNodes[ node ];
+	Unlink( node );
+	RemoveFromAgentList( node, 0 );
+	RemoveFromAgentList( node, 1 );
+
+	// let go of the agents and parameters
+	n.message = Message();
+
+	n.next = myFreeNodes;
+	myFreeNodes = node;
+}
+
+void MessageQueue::Append( int list, int node )
+{
+	Node& n = myNodes[ node ];
+	List& l = myLists[ list ];
+	n.list = list;
+	n.next = NO_NODE;
+	n.prev = l.tail;
+	if( l.tail != NO_NODE )
+		myNodes[ l.tail ].next = node;
+	else
+		l.head = node;
+	l.tail = node;
+}
+
+void MessageQueue::Unlink( int node )
+{
+	Node& n = myNodes[ node ];
+	if( n.list == NO_NODE )
+		return;
+
+	List& l = myLists[ n.list ];
+	if( n.prev != NO_NODE )
+		myNodes[ n.prev ].next = n.next;
+	else
+		l.head = n.next;
+	if( n.next != NO_NODE )
+		myNodes[ n.next ].prev = n.prev;
+	else
+		l.tail = n.prev;
+	n.list = NO_NODE;
+	n.next = n.prev = NO_NODE;
+}
+
+int MessageQueue::PopFront( int list )
+{
+	int node = myLists[ list ].head;
+	if( node != NO_NODE )
+		Unlink( node );
+	return node;
+}
+
+void MessageQueue::AddToAgentList( int node, int side, AgentHandle const& agent )
+{
+	Node& n = myNodes[ node ];
+	AgentLink link = node * 2 + side;
+
+	AgentLists::iterator it = myAgentLists.find( agent );
+	if( it == myAgentLists.end() )
+		it = myAgentLists.insert( AgentLists::value_type( agent, NO_NODE ) ).first;
+
+	n.agentList[ side ] = it;
+	n.agentPrev[ side ] = NO_NODE;
+	n.agentNext[ side ] = it->second;
+	if( it->second != NO_NODE )
+		myNodes[ it->second >> 1 ].agentPrev[ it->second & 1 ] = link;
+	it->second = link;
+}
+
+void MessageQueue::RemoveFromAgentList( int node, int side )
+{
+	Node& n = myNodes[ node ];
+	AgentLink next = n.agentNext[ side ];
+	AgentLink prev = n.agentPrev[ side ];
+
+	if( next != NO_NODE )
+		myNodes[ next >> 1 ].agentPrev[ next & 1 ] = prev;
+	if( prev != NO_NODE )
+		myNodes[ prev >> 1 ].agentNext[ prev & 1 ] = next;
+	else if( next != NO_NODE )
+		n.agentList[ side ]->second = next;
+	else
+		myAgentLists.erase( n.agentList[ side ] );
+}
+
+
+
+// Puts a delayed message on the right wheel slot for how far ahead
+// of the wheel it is due (or the overflow list, if it's too far).
+void MessageQueue::Schedule( int node )
+{
+	uint32 time = myNodes[ node ].message.GetTime();
+	_ASSERT( time >= myWheelTick );
+	uint32 ahead = time - myWheelTick;
+
+	int list = LIST_OVERFLOW;
+	for( int level = 0; level < WHEEL_LEVELS; ++level )
 	{
-		message = *myDelayedQueue.begin();
-		myDelayedQueue.erase( myDelayedQueue.begin() );
-		return true;
+		if( ahead < ( 1u << ( WHEEL_BITS * ( level + 1 ) ) ) )
+		{
+			list = LIST_WHEEL + level * WHEEL_SIZE +
+				( ( time >> ( WHEEL_BITS * level ) ) & WHEEL_MASK );
+			break;
+		}
 	}
-	return false;
+	Append( list, node );
+}
+
+// Spreads the messages on a slot out over the levels below.  The
+// slot is emptied first, as messages from the overflow list that are
+// still too far ahead go straight back onto it.
+void MessageQueue::Cascade( int list )
+{
+	List& l = myLists[ list ];
+	int node = l.head;
+	l.head = l.tail = NO_NODE;
+
+	while( node != NO_NODE )
+	{
+		Node& n = myNodes[ node ];
+		int next = n.next;
+		n.list = NO_NODE;
+		n.next = n.prev = NO_NODE;
+		Schedule( node );
+		node = next;
+	}
+}
+
+// Moves everything due up to and including the tick to the due list
+void MessageQueue::AdvanceTo( uint32 tick )
+{
+	// the world tick has gone backwards, or we're very behind
+	// (e.g. just after loading) - easier to start again
+	if( tick + 1 < myWheelTick ||
+		( tick >= myWheelTick && tick - myWheelTick > ( 1u << 16 ) ) )
+	{
+		Rebuild( tick + 1 );
+		return;
+	}
+
+	while( myWheelTick <= tick )
+	{
+		if( myDelayedCount == 0 )
+		{
+			myWheelTick = tick + 1;
+			break;
+		}
+
+		int slot = myWheelTick & WHEEL_MASK;
+		if( slot == 0 )
+		{
+			// start of a new level 0 turn, so bring down the
+			// messages for it from the levels above
+			int level;
+			for( level = 1; level < WHEEL_LEVELS; ++level )
+			{
+				int index = ( myWheelTick >> ( WHEEL_BITS * level ) ) & WHEEL_MASK;
+				Cascade( LIST_WHEEL + level * WHEEL_SIZE + index );
+				if( index != 0 )
+					break;
+			}
+			if( level == WHEEL_LEVELS )
+				Cascade( LIST_OVERFLOW );
+		}
+
+		MoveSlotToDue( LIST_WHEEL + slot );
+		++myWheelTick;
+	}
+}
+
+// Moves a level 0 slot (all due on the same tick) to the due list, in the
+// order they were sent. They can arrive on the slot out of order when
+// cascaded from different levels.
+void MessageQueue::MoveSlotToDue( int list )
+{
+	List& l = myLists[ list ];
+	if( l.head == NO_NODE )
+		return;
+
+	if( l.head == l.tail )
+	{
+		int node = PopFront( list );
+		Append( LIST_DUE, node );
+		--myDelayedCount;
+		return;
+	}
+
+	std::vector< std::pair< uint32, int > > nodes;
+	int node;
+	while( ( node = PopFront( list ) ) != NO_NODE )
+	{
+		_ASSERT( myNodes[ node ].message.GetTime() == myWheelTick );
+		nodes.push_back( std::make_pair( SendOrder( myNodes[ node ] ), node ) );
+	}
+	std::sort( nodes.begin(), nodes.end() );
+	for( int i = 0; i < nodes.size(); ++i )
+		Append( LIST_DUE, nodes[i].second );
+	myDelayedCount -= nodes.size();
+}
+
+// Puts a message that is already due on the due list, after any
+// due at the same time or earlier, as the multiset this used to be
+// would have delivered it.
+void MessageQueue::InsertDue( int node )
+{
+	uint32 time = myNodes[ node ].message.GetTime();
+	List& l = myLists[ LIST_DUE ];
+
+	int after = l.tail;
+	while( after != NO_NODE && myNodes[ after ].message.GetTime() > time )
+		after = myNodes[ after ].prev;
+
+	Node& n = myNodes[ node ];
+	n.list = LIST_DUE;
+	n.prev = after;
+	n.next = after != NO_NODE ? myNodes[ after ].next : l.head;
+	if( n.next != NO_NODE )
+		myNodes[ n.next ].prev = node;
+	else
+		l.tail = node;
+	if( after != NO_NODE )
+		myNodes[ after ].next = node;
+	else
+		l.head = node;
+}
+
+// Starts the wheel again from the given tick. Anything due before it
+// goes on the due list.
+void MessageQueue::Rebuild( uint32 tick )
+{
+	std::vector<int> nodes;
+	GetDelayedInOrder( nodes );
+
+	for( int i = 0; i < nodes.size(); ++i )
+		Unlink( nodes[i] );
+
+	myWheelTick = tick;
+	myDelayedCount = 0;
+	for( int i = 0; i < nodes.size(); ++i )
+	{
+		if( myNodes[ nodes[i] ].message.GetTime() < tick )
+			Append( LIST_DUE, nodes[i] );
+		else
+		{
+			Schedule( nodes[i] );
+			++myDelayedCount;
+		}
+	}
+}
+
+void MessageQueue::Clear()
+{
+	myNodes.clear();
+	myAgentLists.clear();
+	for( int i = 0; i < LIST_COUNT; ++i )
+		myLists[i].head = myLists[i].tail = NO_NODE;
+	myFreeNodes = NO_NODE;
+	myNextSequence = 0;
+	myWheelTick = 0;
+	myDelayedCount = 0;
+}
+
+// All the delayed messages (including those due but not yet read),
+// in the order they'll be delivered
+void MessageQueue::GetDelayedInOrder( std::vector<int>& nodes ) const
+{
+	// by time, then by when they were sent
+	std::vector< std::pair< std::pair< uint32, uint32 >, int > > sorted;
+	for( int list = LIST_DUE; list < LIST_COUNT; ++list )
+	{
+		for( int node = myLists[ list ].head; node != NO_NODE; node = myNodes[ node ].next )
+		{
+			Node const& n = myNodes[ node ];
+			sorted.push_back( std::make_pair( std::make_pair( n.message.GetTime(),
+				SendOrder( n ) ), node ) );
+		}
+	}
+	std::sort( sorted.begin(), sorted.end() );
+
+	nodes.clear();
+	for( int i = 0; i < sorted.size(); ++i )
+		nodes.push_back( sorted[i].second );
 }
 
 CreaturesArchive &operator<<( CreaturesArchive &ar, Message const &message )
@@ -83,14 +413,59 @@ CreaturesArchive &operator>>( CreaturesArchive &ar, Message &message )
 	return ar;
 }
 
+// Written in the same format as the std::multiset of delayed messages
+// and std::deque of immediate ones that this used to be
 CreaturesArchive &operator<<( CreaturesArchive &ar, MessageQueue const &messageQueue )
 {
-	ar << messageQueue.myDelayedQueue << messageQueue.myImmediateQueue;
+	std::vector<int> nodes;
+	messageQueue.GetDelayedInOrder( nodes );
+	ar << (uint32)nodes.size();
+	for( int i = 0; i < nodes.size(); ++i )
+		ar << messageQueue.myNodes[ nodes[i] ].message;
+
+	uint32 count = 0;
+	int node;
+	for( node = messageQueue.myLists[ MessageQueue::LIST_IMMEDIATE ].head;
+		node != MessageQueue::NO_NODE; node = messageQueue.myNodes[ node ].next )
+	{
+		++count;
+	}
+	ar << count;
+	for( node = messageQueue.myLists[ MessageQueue::LIST_IMMEDIATE ].head;
+		node != MessageQueue::NO_NODE; node = messageQueue.myNodes[ node ].next )
+	{
+		ar << messageQueue.myNodes[ node ].message;
+	}
 	return ar;
 }
 
 CreaturesArchive &operator>>( CreaturesArchive &ar, MessageQueue &messageQueue )
 {
-	ar >> messageQueue.myDelayedQueue >> messageQueue.myImmediateQueue;
+	messageQueue.Clear();
+
+	uint32 count;
+	ar >> count;
+	while( count-- )
+	{
+		Message message;
+		ar >> message;
+		int node = messageQueue.NewNode( message );
+
+		// they come in time order, so start the wheel at the first
+		if( messageQueue.myDelayedCount == 0 )
+			messageQueue.myWheelTick = message.GetTime();
+		else if( message.GetTime() < messageQueue.myWheelTick )
+			messageQueue.Rebuild( message.GetTime() );
+		messageQueue.Schedule( node );
+		++messageQueue.myDelayedCount;
+	}
+
+	ar >> count;
+	while( count-- )
+	{
+		Message message;
+		ar >> message;
+		messageQueue.Append( MessageQueue::LIST_IMMEDIATE, messageQueue.NewNode( message ) );
+	}
 	return ar;
 }
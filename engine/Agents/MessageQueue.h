@@ -8,22 +8,28 @@
 #include "../Message.h"
 
 #include <deque>
-#include <set>
+#include <vector>
+#include <map>
 
 class CreaturesArchive;
 
 
-struct CompareMessageTimes
-{
-	bool operator()( Message const & msg1, Message const & msg2 )
-	{
-		return msg1.GetTime() < msg2.GetTime();
-	}
-};
-
+// Messages waiting to be delivered.
+//
+// Immediate messages are delivered first, in the order they were sent.
+// Delayed messages are kept in a hierarchical timing wheel keyed by the
+// world tick they're due on, so sending one and delivering it are O(1)
+// however many are waiting. Messages due on the same tick come out in
+// the order they were sent.
+//
+// Every message is also on an intrusive list for the agents it is from
+// and to, so RemoveMessagesAbout (called for every agent that dies)
+// only touches that agent's messages.
 class MessageQueue
 {
 public:
+	MessageQueue();
+
 	void WriteMessage(	AgentHandle const& from,
 						AgentHandle const& to,
 						int msg,
@@ -38,8 +44,84 @@ public:
 	friend CreaturesArchive &operator>>( CreaturesArchive &ar, MessageQueue &message );
 
 private:
-	std::deque< Message > myImmediateQueue;
-	std::multiset< Message, CompareMessageTimes > myDelayedQueue;
+	enum
+	{
+		WHEEL_BITS = 6,
+		WHEEL_SIZE = 1 << WHEEL_BITS,	// slots per level
+		WHEEL_MASK = WHEEL_SIZE - 1,
+		WHEEL_LEVELS = 4,				// covers 2^24 ticks, the rest overflow
+
+		LIST_IMMEDIATE = 0,
+		LIST_DUE,						// delayed, and due now
+		LIST_OVERFLOW,					// too far ahead for the wheel
+		LIST_WHEEL,						// first wheel slot (level 0 slot 0)
+		LIST_COUNT = LIST_WHEEL + WHEEL_LEVELS * WHEEL_SIZE,
+
+		NO_NODE = -1
+	};
+
+	// A link to a node on one of the agent lists. A message from an
+	// agent to itself is on that agent's list twice, so the link says
+	// which of the node's two agent links (0 = from, 1 = to) it means.
+	typedef int AgentLink;
+
+	// head link of each agent's list
+	typedef std::map< AgentHandle, AgentLink > AgentLists;
+
+	struct Node
+	{
+		Message message;
+		uint32 sequence;		// for keeping send order within a tick
+		int list;				// which list it's on (LIST_...)
+		int next;				// neighbours on that list
+		int prev;
+		AgentLink agentNext[2];	// neighbours on the from/to agents' lists
+		AgentLink agentPrev[2];
+		AgentLists::iterator agentList[2];
+	};
+
+	struct List
+	{
+		int head;
+		int tail;
+	};
+
+	int NewNode( Message const& message );
+	void FreeNode( int node );
+
+	void Append( int list, int node );
+	void Unlink( int node );
+	int PopFront( int list );
+
+	void AddToAgentList( int node, int side, AgentHandle const& agent );
+	void RemoveFromAgentList( int node, int side );
+
+	void Schedule( int node );
+	void InsertDue( int node );
+	void Cascade( int list );
+	void AdvanceTo( uint32 tick );
+	void MoveSlotToDue( int list );
+	void Rebuild( uint32 tick );
+
+	// Sequence numbers relative to the next one, so they still sort
+	// in send order when they wrap round
+	uint32 SendOrder( Node const& node ) const
+		{ return node.sequence - myNextSequence; }
+
+	void Clear();
+	void GetDelayedInOrder( std::vector<int>& nodes ) const;
+
+	std::deque< Node > myNodes;		// (a deque so they never move)
+	int myFreeNodes;
+	uint32 myNextSequence;
+
+	List myLists[ LIST_COUNT ];
+
+	// The next tick the wheel hasn't yet moved to the due list
+	uint32 myWheelTick;
+	int myDelayedCount;				// on the wheel or overflow list
+
+	AgentLists myAgentLists;
 };
 CreaturesArchive &operator<<( CreaturesArchive &ar, MessageQueue const &message );
 CreaturesArchive &operator>>( CreaturesArchive &ar, MessageQueue &message );
@@ -150,6 +150,7 @@ void SimpleAgent::Update()
 
 	myCurrentWidth = myEntityImage->GetWidth();
 	myCurrentHeight = myEntityImage->GetHeight();
+	UpdateSpatialIndex();
 
 }
 
@@ -212,6 +213,7 @@ bool SimpleAgent::ShowPose(int pose,int part)
 
 	myCurrentWidth = myEntityImage->GetWidth();
 	myCurrentHeight = myEntityImage->GetHeight();
+	UpdateSpatialIndex();
 	return true;
 }
 
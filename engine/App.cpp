@@ -24,6 +24,8 @@
 #include "C2eServices.h"
 #include "Sound/Soundlib.h"
 #include "Display/SharedGallery.h"
+#include "Display/CreatureGalleryBuilder.h"
+#include "DirectoryIndex.h"
 
 #include "Sound/MusicTimer.h"
 #include "Sound/MusicManager.h"
@@ -32,6 +34,7 @@
 #include "AgentManager.h"
 
 #include "Creature/SensoryFaculty.h"
+#include "Creature/Biochemistry/Biochemistry.h"
 
 #include "../common/PRAYFiles/PrayManager.h"
 #include "Creature/Brain/BrainScriptFunctions.h"
@@ -148,6 +151,7 @@ bool App::Init()
 #endif
 
 	SharedGallery::theSharedGallery().CleanCreatureGalleryFolder();
+	DirectoryIndex::theDirectoryIndex().Build();
 
 #ifdef _WIN32
     // Prevent multiple copies of game from running.
@@ -231,9 +235,42 @@ bool App::Init()
 #endif
 	theFlightRecorder.SetCategories( mask );
 
+	// worker threads for creature faculty updates
+	// (-1 = one per extra processor, 0 = update everything on the
+	// main thread)
+	int32 workers = -1;
+#ifdef _WIN32
+	theRegistry.GetValue(theRegistry.DefaultKey(),
+						"FacultyWorkerThreads",
+						workers,
+						HKEY_CURRENT_USER);
+#else
+	UserSettings().Get( "FacultyWorkerThreads", (int&)workers );
+#endif
+	if (workers < 0)
+		workers = WorkerPool::GetProcessorCount() - 1;
+	Biochemistry::ChooseVectorRoutines();
+	theAgentManager.StartFacultyWorkers( workers );
+
+	// creature body parts are put together in the background
+	CreatureGalleryBuilder::theBuilder().Start();
+
+#ifndef _WIN32
+	// start up the external interface so other programs can talk to us
+	std::string socketPath = "/tmp/" + GetGameName() + ".caos";
+	MachineSettings().Get( "RequestSocket", socketPath );
+	// (the game runs on without it)
+	if( !myRequestSocket.Create( socketPath.c_str(), 1024*1024 ) )
+		theFlightRecorder.Log( 16, "Couldn't open request socket '%s' (is the game already running?)",
+			socketPath.c_str() );
+#endif
+
 	myPrayManager = new PrayManager(langid);
 	myPrayManager->AddDir( GetDirectory( PRAYFILE_DIR ) );
 	myPrayManager->AddDir( GetDirectory( CREATURES_DIR ) );
+	// remember what's in the pray files so unchanged ones aren't
+	// reread every time the folders are rescanned
+	myPrayManager->SetIndexFile( std::string(GetDirectory( MAIN_DIR )) + "pray.index" );
 
     // Seed random number generators
 	srand(GetTimeStamp() + GetRealWorldTime() + 1);
@@ -311,6 +348,14 @@ void App::UpdateApp()
 		myWorld->Save();
 		mySaveNextTick = false;
 	}
+	if (myWorld)
+		myWorld->UpdateBackgroundSave();
+
+#ifndef _WIN32
+	// answer everything the external interface has received
+	// since last tick in one go
+	myRequestManager.HandleQueued( myRequestSocket );
+#endif
 	if (myQuitNextTick)
 	{
 		theFlightRecorder.Log(16, "Signalling termination...\n");
@@ -486,6 +531,20 @@ void App::ShutDown()
 	// (before world object disappears!)
 	theMainView.ShutDown();
 
+	theAgentManager.StopFacultyWorkers();
+	CreatureGalleryBuilder::theBuilder().Stop();
+
+	DirectoryIndex& index = DirectoryIndex::theDirectoryIndex();
+	theFlightRecorder.Log(16, "File checks: %d answered from the index, %d from disk, %d directories listed\n",
+		index.GetStatsAvoided(), index.GetStatsMade(), index.GetDirectoriesListed());
+	theFlightRecorder.Log(16, "Request scripts: %d not in the cache, %d from the cache, %d bytes cached\n",
+		myRequestManager.GetScriptCacheMisses(), myRequestManager.GetScriptCacheHits(),
+		myRequestManager.GetScriptCacheBytes());
+
+#ifndef _WIN32
+	myRequestSocket.Close();
+#endif
+
 
 	if ( myPrayManager )
 	{
@@ -891,8 +950,9 @@ bool App::GetWorldDirectoryVersion(int dir, std::string& path,bool createFilePle
 	GetDirectory(dir,buf);
 	path = buf;
 	// get the words between the last two backslashes
-	size_t end  = path.find_last_of("\\");
-	size_t start = 	path.find_last_of("\\",end-1);
+	// (or forward slashes, on unix)
+	size_t end  = path.find_last_of("/\\");
+	size_t start = 	path.find_last_of("/\\",end-1);
 	if(end == -1 || start == -1)
 	{
 		// no main directory version!
@@ -915,24 +975,27 @@ bool App::GetWorldDirectoryVersion(const std::string& name, std::string& path,bo
 	char buf[MAX_PATH];
 	theApp.GetDirectory(WORLDS_DIR,buf);
 	path = buf;
+#ifdef _WIN32
 	path+=  myWorld->GetWorldName() + "\\"+ name + "\\";
+#else
+	path+=  myWorld->GetWorldName() + "/"+ name + "/";
+#endif
 
-#ifdef _WIN32
-	if(GetFileAttributes(path.data())== -1)
+	if(!DirectoryIndex::theDirectoryIndex().DirectoryExists(path))
 	{
 		if(createFilePlease)
 		{
+#ifdef _WIN32
 			return CreateDirectory( path.data(),NULL ) ? true : false;
+#else
+			return mkdir( path.data(), 0777 ) == 0;
+#endif
 		}
 		else // just report that there was no directory at all
 		{
 			return false;
 		}
 	}
-#else
-	// TODO: non-win32 version
-	ASSERT(false);
-#endif
 
 
 	return true;
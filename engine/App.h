@@ -321,6 +321,10 @@ private:
 	World*		 myWorld;
 	PrayManager* myPrayManager;
 	RequestManager		myRequestManager;
+#ifndef _WIN32
+	// external interface (win32 uses shared memory, see Window.cpp)
+	SocketServer		myRequestSocket;
+#endif
 
 	// The system framework will keep the InputManager fed (see window.cpp)
 	InputManager		myInputManager;
@@ -0,0 +1,196 @@
+// -------------------------------------------------------------------------
+// Filename:    ArchiveWriter.cpp
+// Class:       ArchiveWriter
+// Purpose:     Compresses and writes out an archive on a background thread
+// Description:	See ArchiveWriter.h
+//
+// Usage:
+//
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "ArchiveWriter.h"
+#include "CreaturesArchive.h"
+#ifndef _WIN32
+#include "unix/FileFuncs.h"	// for MoveFile etc...
+#endif
+#include "TimeFuncs.h"
+
+#include <fstream>
+
+
+ArchiveWriter::ArchiveWriter()
+{
+	myLevel = 6;
+	myDataSize = 0;
+	myWriteTime = 0;
+	myThreadRunning = false;
+	myResultPending = false;
+	mySucceeded = false;
+#ifdef _WIN32
+	myThread = NULL;
+#else
+	myFinished = false;
+	pthread_mutex_init( &myLock, NULL );
+#endif
+}
+
+
+
+bool ArchiveWriter::Start( std::string& data, const std::string& fullPath,
+	const std::string& tempPath, const std::string& backPath, int level )
+{
+	Wait();
+
+	myData.swap( data );
+	data.erase();
+	myFullPath = fullPath;
+	myTempPath = tempPath;
+	myBackPath = backPath;
+	myLevel = level;
+	myDataSize = myData.size();
+	myWriteTime = 0;
+	mySucceeded = false;
+	myErrorText.erase();
+
+#ifdef _WIN32
+	DWORD id;
+	myThread = CreateThread( NULL, 0, ThreadStart, this, 0, &id );
+	myThreadRunning = ( myThread != NULL );
+#else
+	myFinished = false;
+	myThreadRunning =
+		( pthread_create( &myThread, NULL, ThreadStart, this ) == 0 );
+#endif
+
+	if( !myThreadRunning )
+	{
+		// do it the slow way
+		WriteArchive();
+		myResultPending = true;
+		return false;
+	}
+	return true;
+}
+
+
+
+bool ArchiveWriter::Poll( bool& succeeded )
+{
+	if( myThreadRunning )
+	{
+		if( !IsFinished() )
+			return false;
+		Wait();
+	}
+
+	if( !myResultPending )
+		return false;
+
+	myResultPending = false;
+	succeeded = mySucceeded;
+	return true;
+}
+
+
+
+void ArchiveWriter::Wait()
+{
+	if( !myThreadRunning )
+		return;
+
+#ifdef _WIN32
+	WaitForSingleObject( myThread, INFINITE );
+	CloseHandle( myThread );
+	myThread = NULL;
+#else
+	pthread_join( myThread, NULL );
+#endif
+
+	myThreadRunning = false;
+	myResultPending = true;
+}
+
+
+
+bool ArchiveWriter::IsFinished()
+{
+#ifdef _WIN32
+	return WaitForSingleObject( myThread, 0 ) == WAIT_OBJECT_0;
+#else
+	pthread_mutex_lock( &myLock );
+	bool finished = myFinished;
+	pthread_mutex_unlock( &myLock );
+	return finished;
+#endif
+}
+
+
+
+// static entry point for the thread - just passes control on
+// to the non-static WriteArchive().
+#ifdef _WIN32
+DWORD WINAPI ArchiveWriter::ThreadStart( LPVOID writer )
+{
+	((ArchiveWriter*)writer)->WriteArchive();
+	return 0;
+}
+#else
+void* ArchiveWriter::ThreadStart( void* writer )
+{
+	ArchiveWriter* w = (ArchiveWriter*)writer;
+	w->WriteArchive();
+
+	pthread_mutex_lock( &w->myLock );
+	w->myFinished = true;
+	pthread_mutex_unlock( &w->myLock );
+	return NULL;
+}
+#endif
+
+
+
+// Runs on the writer thread, so mustn't touch anything outside
+// this object.
+void ArchiveWriter::WriteArchive()
+{
+	int64 start = GetHighPerformanceTimeStamp();
+
+	// Keep the old file as a backup before it gets replaced
+	if( !myBackPath.empty() )
+	{
+		DeleteFile( myBackPath.c_str() );
+		MoveFile( myFullPath.c_str(), myBackPath.c_str() );
+	}
+
+	try
+	{
+		std::fstream file( myTempPath.c_str(), std::ios::out | std::ios::binary );
+		CreaturesArchive::WriteCompressed( file, myData.data(), myData.size(), myLevel );
+		file.close();
+		mySucceeded = true;
+	}
+	catch( BasicException& e )
+	{
+		myErrorText = e.what();
+	}
+	catch( ... )
+	{
+	}
+
+	// don't need the data any more
+	std::string().swap( myData );
+
+	if( mySucceeded )
+	{
+		DeleteFile( myFullPath.c_str() );
+		MoveFile( myTempPath.c_str(), myFullPath.c_str() );
+	}
+
+	myWriteTime = GetHighPerformanceTimeStamp() - start;
+}
@@ -0,0 +1,119 @@
+// -------------------------------------------------------------------------
+// Filename:    ArchiveWriter.h
+// Class:       ArchiveWriter
+// Purpose:     Compresses and writes out an archive on a background thread
+// Description:	The main thread serialises into a SaveUncompressed
+//				CreaturesArchive held in memory, then hands the data over
+//				with Start().  The writer thread compresses it into the
+//				temporary file, and then moves it over the real one
+//				(keeping a backup first if asked to).
+//
+//				Only one archive can be in flight at a time - Start()
+//				waits for the previous one to finish.
+//
+// Usage:		writer.Start( data, fullPath, tempPath, backPath, level );
+//				...
+//				if( writer.Poll( ok ) )
+//					// finished
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifndef ARCHIVEWRITER_H
+#define ARCHIVEWRITER_H
+
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <string>
+#include "../common/C2eTypes.h"
+
+class ArchiveWriter
+{
+public:
+	ArchiveWriter();
+	~ArchiveWriter() { Wait(); }
+
+	// ---------------------------------------------------------------------
+	// Method:      Start
+	// Arguments:   data - uncompressed archive (swapped out, so left empty)
+	//				fullPath - file to end up with
+	//				tempPath - file to write to first
+	//				backPath - where to move the old file to, or "" to
+	//					just replace it
+	//				level - zlib compression level
+	// Returns:     false if the thread couldn't be started, in which case
+	//				the archive has been written before returning
+	// Description:	Starts writing the archive in the background.
+	// ---------------------------------------------------------------------
+	bool Start( std::string& data, const std::string& fullPath,
+		const std::string& tempPath, const std::string& backPath,
+		int level );
+
+	// ---------------------------------------------------------------------
+	// Method:      Poll
+	// Arguments:   succeeded - set to whether the archive was written
+	// Returns:     true once for each archive when it has finished
+	// Description:	Call regularly from the main thread to find out when
+	//				a background write has completed.
+	// ---------------------------------------------------------------------
+	bool Poll( bool& succeeded );
+
+	// ---------------------------------------------------------------------
+	// Method:      Wait
+	// Arguments:   None
+	// Returns:     None
+	// Description:	Blocks until any write in progress has finished.  The
+	//				result is still reported by the next Poll().
+	// ---------------------------------------------------------------------
+	void Wait();
+
+	bool IsBusy() const { return myThreadRunning; }
+
+	const std::string& GetErrorText() const { return myErrorText; }
+
+	// size of the last archive, and how long it took to write out
+	// (in GetHighPerformanceTimeStamp() units)
+	unsigned int GetDataSize() const { return myDataSize; }
+	int64 GetWriteTime() const { return myWriteTime; }
+
+private:
+#ifdef _WIN32
+	static DWORD WINAPI ThreadStart( LPVOID writer );
+#else
+	static void* ThreadStart( void* writer );
+#endif
+	void WriteArchive();
+	bool IsFinished();
+
+	std::string myData;
+	std::string myFullPath;
+	std::string myTempPath;
+	std::string myBackPath;
+	int myLevel;
+	unsigned int myDataSize;
+	int64 myWriteTime;
+
+	bool myThreadRunning;	// a thread has been started and not joined
+	bool myResultPending;	// there is a result for Poll() to hand out
+	bool mySucceeded;
+	std::string myErrorText;
+
+#ifdef _WIN32
+	HANDLE myThread;
+#else
+	pthread_t myThread;
+	pthread_mutex_t myLock;
+	bool myFinished;		// set by the thread, under myLock
+#endif
+};
+
+#endif // ARCHIVEWRITER_H
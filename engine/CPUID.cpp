@@ -10,18 +10,14 @@
 *
 *********************************************************************/
 
-#ifndef _WIN32
-#error not ported
-#endif
-
-#ifdef _MSC_VER
-
 #ifdef _MSC_VER
 #pragma warning(disable:4786 4503)
 #endif
 
 
-#include "../common/C2eTypes.h"
+#include "CPUID.h"
+
+#ifdef _MSC_VER
 
 
 // Globals:
@@ -130,13 +126,135 @@ void EnumerateProcessorType(void)
 
 }
 
+/*********************************************************************
+* Global: CheckSSE2Technology.
+*********************************************************************/
+bool CheckSSE2Technology(void)
+{
+	DWORD RegEDX;
+
+	__try {
+		_asm {
+            push ebx
+			mov eax, 1	// version and features
+		    __asm _emit 0x0f    // CPUID
+		    __asm _emit 0xa2
+			mov RegEDX, edx	// features returned in edx
+            pop ebx
+	   	}
+   	} __except(EXCEPTION_EXECUTE_HANDLER) { return false; }
+
+	return (RegEDX & 0x4000000) != 0;	// bit 26 is set for SSE2
+}
+
+
+/*********************************************************************
+* Global: CheckAVX2Technology.
+*********************************************************************/
+bool CheckAVX2Technology(void)
+{
+	DWORD RegEAX;
+	DWORD RegEBX;
+	DWORD RegECX;
+
+	__try {
+		_asm {
+            push ebx
+			xor eax, eax	// highest function supported
+		    __asm _emit 0x0f    // CPUID
+		    __asm _emit 0xa2
+			mov RegEAX, eax
+            pop ebx
+	   	}
+   	} __except(EXCEPTION_EXECUTE_HANDLER) { return false; }
+
+	if (RegEAX < 7)
+		return false;
+
+	_asm {
+        push ebx
+		mov eax, 1	// version and features
+	    __asm _emit 0x0f    // CPUID
+	    __asm _emit 0xa2
+		mov RegECX, ecx
+        pop ebx
+	}
+
+	// bit 27 is set if the OS uses XSAVE, bit 28 for AVX
+	if ((RegECX & 0x18000000) != 0x18000000)
+		return false;
+
+	_asm {
+		xor ecx, ecx
+	    __asm _emit 0x0f    // XGETBV
+	    __asm _emit 0x01
+	    __asm _emit 0xd0
+		mov RegEAX, eax
+	}
+
+	// the OS must save the XMM and YMM registers
+	if ((RegEAX & 6) != 6)
+		return false;
+
+	_asm {
+        push ebx
+		mov eax, 7	// extended features
+		xor ecx, ecx
+	    __asm _emit 0x0f    // CPUID
+	    __asm _emit 0xa2
+		mov RegEBX, ebx
+        pop ebx
+	}
+
+	return (RegEBX & 0x20) != 0;	// bit 5 is set for AVX2
+}
+
 #else
 // non visual-c version
 
-#warning CPUID functions not implemented
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
 
+bool CheckSSE2Technology(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+	return (edx & bit_SSE2) != 0;
+}
+
+bool CheckAVX2Technology(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__cpuid(1, eax, ebx, ecx, edx);
+	// the OS must use XSAVE and the cpu must have AVX
+	if ((ecx & (bit_OSXSAVE | bit_AVX)) != (bit_OSXSAVE | bit_AVX))
+		return false;
+
+	// and the OS must save the XMM and YMM registers
+	unsigned int xcr0, xcr0High;
+	__asm__ (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0), "=d" (xcr0High) : "c" (0));
+	if ((xcr0 & 6) != 6)
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_AVX2) != 0;
+}
+
+#else
+
+bool CheckSSE2Technology(void) { return false; }
+bool CheckAVX2Technology(void) { return false; }
+
+#endif
+
+#ifdef _WIN32
 DWORD GetProcessorType(void) { return 0; }
 BOOL CheckMMXTechnology(void) { return FALSE; }
+#endif
 
 #endif // MSC_VER
 
@@ -8,21 +8,28 @@
 *	gProcessorType = GetProcessorType();
 *	gHasMMXTechnology = CheckMMXTechnology();
 *
+*	CheckSSE2Technology() and CheckAVX2Technology() are available
+*	on all x86 builds, and just return false elsewhere.
+*
 *********************************************************************/
 
-#ifndef _WIN32
-#error non-win32 version needs work...
-#endif
-
 #ifndef CPUID_H
 #define CPUID_H
 
+#include "../common/C2eTypes.h"
+
 const DWORD CPU_TYPE =      0x00003000;
 const DWORD CPU_FAMILY =    0x00000f00;
 const DWORD CPU_MODEL =     0x000000f0;
 const DWORD CPU_STEPPING =  0x0000000f;
 
+#ifdef _WIN32
 extern DWORD GetProcessorType(void);
 extern BOOL CheckMMXTechnology(void);
+#endif
+
+// these also check that the OS saves the extra registers
+extern bool CheckSSE2Technology(void);
+extern bool CheckAVX2Technology(void);
 
 #endif // CPUID_H
@@ -176,8 +176,11 @@ void AgentHandlers::SubCommand_NEW_CREA( CAOSMachine& vm )
 
 	vm.SetTarg( agent );
 
+	// NEW: CREA can't wait a tick, so don't spin while the gallery builder
+	// puts the body parts together
 	while (!vm.GetTarg().GetCreatureReference().AreYourBodyPartsFullyFormed())
 	{
+		vm.GetTarg().GetCreatureReference().WaitForBodyParts();
 		if(!vm.GetTarg().GetCreatureReference().FormBodyParts())
 			vm.ThrowRunError( CAOSMachine::sidFailedToCreateCreature );
 	}
@@ -111,6 +111,108 @@ void CAOSMachine::InitialiseHandlerTables()
 }
 
 
+void CAOSMachine::DecodeSite( const MacroScript& m, int kind, int addr,
+	DecodedOp& decoded )
+{
+	decoded.kind = DecodedOp::none;
+
+	int ip = addr;
+	OpType op = m.FetchOp( ip );
+
+	switch( kind )
+	{
+	case MacroScript::siteCommand:
+		if( op < ourCommandHandlers.size() )
+		{
+			decoded.kind = DecodedOp::command;
+			decoded.op = op;
+			decoded.commandHandler = ourCommandHandlers[op];
+		}
+		break;
+	case MacroScript::siteVariable:
+		DecodeVariable( op, decoded );
+		break;
+	case MacroScript::siteArgument:
+		switch( op )
+		{
+		case CAOSDescription::argIntegerConstant:
+			decoded.kind = DecodedOp::integerConstant;
+			decoded.integerValue = m.FetchInteger( ip );
+			break;
+		case CAOSDescription::argFloatConstant:
+			decoded.kind = DecodedOp::floatConstant;
+			decoded.floatValue = m.FetchFloat( ip );
+			break;
+		case CAOSDescription::argIntegerRV:
+			op = m.FetchOp( ip );
+			if( op < ourIntegerRVHandlers.size() )
+			{
+				decoded.kind = DecodedOp::integerRV;
+				decoded.op = op;
+				decoded.integerRVHandler = ourIntegerRVHandlers[op];
+			}
+			break;
+		case CAOSDescription::argFloatRV:
+			op = m.FetchOp( ip );
+			if( op < ourFloatRVHandlers.size() )
+			{
+				decoded.kind = DecodedOp::floatRV;
+				decoded.op = op;
+				decoded.floatRVHandler = ourFloatRVHandlers[op];
+			}
+			break;
+		case CAOSDescription::argStringRV:
+			op = m.FetchOp( ip );
+			if( op < ourStringRVHandlers.size() )
+			{
+				decoded.kind = DecodedOp::stringRV;
+				decoded.op = op;
+				decoded.stringRVHandler = ourStringRVHandlers[op];
+			}
+			break;
+		case CAOSDescription::argAgentRV:
+			op = m.FetchOp( ip );
+			if( op < ourAgentRVHandlers.size() )
+			{
+				decoded.kind = DecodedOp::agentRV;
+				decoded.op = op;
+				decoded.agentRVHandler = ourAgentRVHandlers[op];
+			}
+			break;
+		case CAOSDescription::argVariable:
+			DecodeVariable( m.FetchOp( ip ), decoded );
+			break;
+		// string constants are left to the normal path
+		}
+		break;
+	}
+
+	// where execution carries on after the fetch
+	decoded.next = ip;
+}
+
+
+void CAOSMachine::DecodeVariable( OpType op, DecodedOp& decoded )
+{
+	if( op >= ourVariableHandlers.size() )
+		return;
+
+	decoded.op = op;
+	if( ourVariableHandlers[op] == Variable_VAnn &&
+		op >= CAOSDescription::varVA00 &&
+		op < CAOSDescription::varVA00 + LOCAL_VARIABLE_COUNT )
+	{
+		// local variables don't need a handler call at all
+		decoded.kind = DecodedOp::localVariable;
+	}
+	else
+	{
+		decoded.kind = DecodedOp::variable;
+		decoded.variableHandler = ourVariableHandlers[op];
+	}
+}
+
+
 CAOSMachine::CAOSMachine()
 {
 	myState = stateFinished;
@@ -288,10 +390,26 @@ bool CAOSMachine::UpdateVM( int quanta )
 		{
 			myCommandIP = myIP;
 			if( myState == stateFetch )
-				myCurrentCmd = FetchOp();
-			// if in stateBlocking, just keep executing the same op over and over...
-
-			(ourCommandHandlers[myCurrentCmd])( *this );
+			{
+				// use the pre-decoded command if the script has one
+				const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+				if( d && d->kind == DecodedOp::command )
+				{
+					myCurrentCmd = d->op;
+					myIP = d->next;
+					(d->commandHandler)( *this );
+				}
+				else
+				{
+					myCurrentCmd = FetchOp();
+					(ourCommandHandlers[myCurrentCmd])( *this );
+				}
+			}
+			else
+			{
+				// if in stateBlocking, just keep executing the same op over and over...
+				(ourCommandHandlers[myCurrentCmd])( *this );
+			}
 #ifdef C2E_COMPATIBLE_SINGLESTEP
 			if (CheckSingleStepAgent(GetOwner()))
 				WaitForSingleStepCommand();
@@ -651,6 +769,29 @@ float CAOSMachine::FetchFloatRV()
 
 void CAOSMachine::FetchStringRV(std::string& str)
 {
+	const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+	if( d )
+	{
+		switch( d->kind )
+		{
+		case DecodedOp::stringRV:
+			myIP = d->next;
+			mySecondaryOp = d->op;
+			(d->stringRVHandler)( *this, str );
+			return;
+		case DecodedOp::variable:
+		case DecodedOp::localVariable:
+			{
+				myIP = d->next;
+				CAOSVar& var = FetchDecodedVariable( *d );
+				if( var.GetType() != CAOSVar::typeString )
+					ThrowRunError( sidNotAString );
+				var.GetString( str );
+			}
+			return;
+		}
+	}
+
 	// String RVs are preceeded by a 'argtype' opcode.
 	switch( FetchOp() )
 	{
@@ -677,6 +818,27 @@ void CAOSMachine::FetchStringRV(std::string& str)
 
 AgentHandle CAOSMachine::FetchAgentRV()
 {
+	const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+	if( d )
+	{
+		switch( d->kind )
+		{
+		case DecodedOp::agentRV:
+			myIP = d->next;
+			mySecondaryOp = d->op;
+			return (d->agentRVHandler)( *this );
+		case DecodedOp::variable:
+		case DecodedOp::localVariable:
+			{
+				myIP = d->next;
+				CAOSVar& var = FetchDecodedVariable( *d );
+				if( var.GetType() != CAOSVar::typeAgent )
+					ThrowRunError( sidNotAnAgent );
+				return var.GetAgent();
+			}
+		}
+	}
+
 	// IntegerRValues are preceeded by a 'argtype' opcode.
 	switch( FetchOp() )
 	{
@@ -701,6 +863,14 @@ AgentHandle CAOSMachine::FetchAgentRV()
 
 CAOSVar& CAOSMachine::FetchVariable()
 {
+	const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+	if( d && ( d->kind == DecodedOp::variable ||
+		d->kind == DecodedOp::localVariable ) )
+	{
+		myIP = d->next;
+		return FetchDecodedVariable( *d );
+	}
+
 	// ugh - store the op so the
 	// handlers can get access to it...
 	mySecondaryOp = FetchOp();
@@ -723,6 +893,41 @@ const void* CAOSMachine::FetchRawData( int numelements, int elementsize )
 
 void CAOSMachine::FetchNumericRV(int& i, float& f, bool& intnotfloat)
 {
+	const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+	if( d )
+	{
+		switch( d->kind )
+		{
+		case DecodedOp::integerConstant:
+			myIP = d->next;
+			intnotfloat = true;
+			i = d->integerValue;
+			return;
+		case DecodedOp::floatConstant:
+			myIP = d->next;
+			intnotfloat = false;
+			f = d->floatValue;
+			return;
+		case DecodedOp::integerRV:
+			myIP = d->next;
+			intnotfloat = true;
+			mySecondaryOp = d->op;
+			i = (d->integerRVHandler)( *this );
+			return;
+		case DecodedOp::floatRV:
+			myIP = d->next;
+			intnotfloat = false;
+			mySecondaryOp = d->op;
+			f = (d->floatRVHandler)( *this );
+			return;
+		case DecodedOp::variable:
+		case DecodedOp::localVariable:
+			myIP = d->next;
+			NumericFromVariable( FetchDecodedVariable( *d ), i, f, intnotfloat );
+			return;
+		}
+	}
+
 	switch( FetchOp() )
 	{
 	case( CAOSDescription::argIntegerConstant ):
@@ -744,20 +949,7 @@ void CAOSMachine::FetchNumericRV(int& i, float& f, bool& intnotfloat)
 		f = (ourFloatRVHandlers[mySecondaryOp])( *this );
 		break;
 	case( CAOSDescription::argVariable ):
-		{
-			CAOSVar& var = FetchVariable();
-			if( var.GetType() == CAOSVar::typeInteger ) {
-				intnotfloat = true;
-				i = var.GetInteger();
-			}
-			else if( var.GetType() == CAOSVar::typeFloat ) {
-				intnotfloat = false;
-				f = var.GetFloat();
-			}
-			else {
-				ThrowRunError( sidNotADecimal );
-			}
-		}
+		NumericFromVariable( FetchVariable(), i, f, intnotfloat );
 		break;
 	default:
 		ThrowRunError( sidNotADecimal );
@@ -766,10 +958,74 @@ void CAOSMachine::FetchNumericRV(int& i, float& f, bool& intnotfloat)
 }
 
 
+void CAOSMachine::NumericFromVariable(CAOSVar& var, int& i, float& f, bool& intnotfloat)
+{
+	if( var.GetType() == CAOSVar::typeInteger ) {
+		intnotfloat = true;
+		i = var.GetInteger();
+	}
+	else if( var.GetType() == CAOSVar::typeFloat ) {
+		intnotfloat = false;
+		f = var.GetFloat();
+	}
+	else {
+		ThrowRunError( sidNotADecimal );
+	}
+}
+
+
 CAOSVar CAOSMachine::FetchGenericRV()
 {
 	CAOSVar var;
 
+	const DecodedOp* d = myMacro->GetDecodedOp( myIP );
+	if( d )
+	{
+		switch( d->kind )
+		{
+		case DecodedOp::integerConstant:
+			myIP = d->next;
+			var.SetInteger( d->integerValue );
+			return var;
+		case DecodedOp::floatConstant:
+			myIP = d->next;
+			var.SetFloat( d->floatValue );
+			return var;
+		case DecodedOp::integerRV:
+			myIP = d->next;
+			mySecondaryOp = d->op;
+			var.SetInteger( (d->integerRVHandler)( *this ) );
+			return var;
+		case DecodedOp::floatRV:
+			myIP = d->next;
+			mySecondaryOp = d->op;
+			var.SetFloat( (d->floatRVHandler)( *this ) );
+			return var;
+		case DecodedOp::stringRV:
+			{
+				std::string s;
+				myIP = d->next;
+				mySecondaryOp = d->op;
+				(d->stringRVHandler)( *this, s );
+				var.SetString( s );
+			}
+			return var;
+		case DecodedOp::agentRV:
+			{
+				myIP = d->next;
+				mySecondaryOp = d->op;
+				AgentHandle temp = (d->agentRVHandler)( *this );
+				var.SetAgent( temp );
+			}
+			return var;
+		case DecodedOp::variable:
+		case DecodedOp::localVariable:
+			myIP = d->next;
+			var = FetchDecodedVariable( *d );
+			return var;
+		}
+	}
+
 	switch( FetchOp() )
 	{
 	case( CAOSDescription::argIntegerConstant ):
@@ -556,6 +556,21 @@ public:
 
 	static void InitialiseHandlerTables();
 
+	// ---------------------------------------------------------------------
+	// Method:      DecodeSite
+	// Arguments:   m - script being decoded
+	//				kind - MacroScript::siteCommand etc...
+	//				addr - address of the site within the script
+	//				decoded - record to fill in
+	// Returns:     None
+	// Description:	Looks up the handler (or reads the constant) for a
+	//				command or argument so UpdateVM and the Fetch*RV
+	//				functions can skip the table lookups. Used by
+	//				MacroScript::Decode().
+	// ---------------------------------------------------------------------
+	static void DecodeSite( const MacroScript& m, int kind, int addr,
+		DecodedOp& decoded );
+
 	// serialization stuff
 	virtual bool Write(CreaturesArchive &ar) const;
 	virtual bool Read(CreaturesArchive &ar);
@@ -606,6 +621,16 @@ private:
 	bool EvalVarSingle();
 	bool EvaluateSingle();
 	void DeleteOutputStreamIfResponsible();
+	void NumericFromVariable(CAOSVar& var, int& i, float& f, bool& intnotfloat);
+	static void DecodeVariable( OpType op, DecodedOp& decoded );
+
+	CAOSVar& FetchDecodedVariable( const DecodedOp& d )
+	{
+		mySecondaryOp = d.op;
+		if( d.kind == DecodedOp::localVariable )
+			return myLocalVariables[ d.op - CAOSDescription::varVA00 ];
+		return (d.variableHandler)( *this );
+	}
 	
 	static std::vector<CommandHandler> ourCommandHandlers;
 	static std::vector<std::string> ourCommandNames;
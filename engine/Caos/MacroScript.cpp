@@ -6,20 +6,26 @@
 #include "DebugInfo.h"
 #include "../C2eServices.h"	// for logging
 #include "Orderiser.h"
+#include "CAOSMachine.h"
 
 #include <stdlib.h>
 #include <memory.h>	// for memcpy()
+#include <map>
 
 
 CREATURES_IMPLEMENT_SERIAL( MacroScript )
 
 
+bool MacroScript::ourUseDecodedOps = true;
+
+
 MacroScript::MacroScript( unsigned char* code, int size, DebugInfo* dbinfo )
 {
 	myCode = new unsigned char[ size ];
 	mySize = size;
 	myDebugInfo = dbinfo;
 	myReferenceCount = 0;
+	myDecoded = false;
 
 	memcpy( myCode, code ,size );
 }
@@ -31,6 +37,7 @@ MacroScript::MacroScript()
 	myCode = NULL;
 	myDebugInfo = NULL;
 	myReferenceCount = 0;
+	myDecoded = false;
 }
 
 
@@ -52,7 +59,7 @@ MacroScript::~MacroScript()
 		delete myDebugInfo;
 		myDebugInfo = NULL;
 	}
-	
+
 	myReferenceCount = 0;
 
 }
@@ -81,6 +88,61 @@ bool MacroScript::IsLocked()
 }
 
 
+void MacroScript::AddDecodeSite( int kind, int addr )
+{
+	DecodeSite site;
+	site.kind = kind;
+	site.addr = addr;
+	myDecodeSites.push_back( site );
+}
+
+
+void MacroScript::Decode()
+{
+	if( myDecoded || mySize <= 0 )
+		return;
+	myDecoded = true;
+
+	// the map sorts the sites and keeps the last decode of any address
+	std::map<int, DecodedOp> decoded;
+	DecodedOp op;
+
+	std::vector<DecodeSite>::const_iterator it;
+	for( it = myDecodeSites.begin(); it != myDecodeSites.end(); ++it )
+	{
+		// everything in the code is on an even address
+		if( (it->addr & 1) || it->addr < 0 || it->addr >= mySize )
+			continue;
+		CAOSMachine::DecodeSite( *this, it->kind, it->addr, op );
+		if( op.kind != DecodedOp::none )
+			decoded[ it->addr ] = op;
+
+		// a variable argument also decodes the variable op after it,
+		// which EvalVarSingle() fetches on its own
+		if( it->kind == siteArgument &&
+			PeekOp( it->addr ) == CAOSDescription::argVariable &&
+			it->addr + 2 < mySize )
+		{
+			CAOSMachine::DecodeSite( *this, siteVariable, it->addr + 2, op );
+			if( op.kind != DecodedOp::none )
+				decoded[ it->addr + 2 ] = op;
+		}
+	}
+
+	myDecodedAddrs.reserve( decoded.size() );
+	myDecodedOps.reserve( decoded.size() );
+	std::map<int, DecodedOp>::const_iterator d;
+	for( d = decoded.begin(); d != decoded.end(); ++d )
+	{
+		myDecodedAddrs.push_back( d->first );
+		myDecodedOps.push_back( d->second );
+	}
+
+	// don't need the sites any more
+	std::vector<DecodeSite>().swap( myDecodeSites );
+}
+
+
 
 
 
@@ -145,6 +207,7 @@ bool MacroScript::Read(CreaturesArchive &archive)
 		myCode = newCAOS->myCode;
 		mySize = newCAOS->mySize;
 		myDebugInfo = newCAOS->myDebugInfo;
+		myDecodeSites.swap( newCAOS->myDecodeSites );
 		newCAOS->myCode = NULL;
 		newCAOS->myDebugInfo = NULL;
 		newCAOS->mySize = 0;		
@@ -26,12 +26,51 @@
 #endif
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "../Classifier.h"
 #include "../PersistentObject.h"
+#include "OpSpec.h"
 
 class DebugInfo;
 
 
+// A command or argument from a MacroScript with its opcode already
+// looked up, so the CAOSMachine can run it without going back through
+// the handler tables. See MacroScript::Decode().
+struct DecodedOp
+{
+	enum
+	{
+		none=0,				// not decoded - read the code as normal
+		command,
+		integerConstant,
+		floatConstant,
+		integerRV,
+		floatRV,
+		stringRV,
+		agentRV,
+		variable,
+		localVariable,		// VA00..VA99 - no handler call needed
+	};
+
+	unsigned short kind;
+	unsigned short op;		// command, rvalue or variable opcode
+	int next;				// address following the decoded item
+	union
+	{
+		CommandHandler commandHandler;
+		IntegerRVHandler integerRVHandler;
+		FloatRVHandler floatRVHandler;
+		StringRVHandler stringRVHandler;
+		AgentRVHandler agentRVHandler;
+		VariableHandler variableHandler;
+		int integerValue;
+		float floatValue;
+	};
+};
+
+
 class MacroScript : public PersistentObject
 {
 	CREATURES_DECLARE_SERIAL( MacroScript )
@@ -114,6 +153,9 @@ public:
 	// ---------------------------------------------------------------------
 	const void* RawData( int addr ) const { return (const void*)(&myCode[ addr ]); }
 
+	// size of the orderised code, in bytes
+	int GetCodeSize() const { return mySize; }
+
 	// ---------------------------------------------------------------------
 	// Method:      GetClassifier
 	// Arguments:   c - Classifier reference to store result
@@ -148,6 +190,57 @@ public:
 	void Unlock();
 	bool IsLocked();
 
+	// ---------------------------------------------------------------------
+	// Method:      AddDecodeSite
+	// Arguments:   kind - siteCommand, siteArgument (an argument type op
+	//				followed by its value) or siteVariable (a bare
+	//				variable op)
+	//				addr - address of the site
+	// Returns:     None
+	// Description: Called by the Orderiser as it writes the code, so that
+	//				Decode() knows where the commands and arguments are.
+	// ---------------------------------------------------------------------
+	enum { siteCommand, siteArgument, siteVariable };
+	void AddDecodeSite( int kind, int addr );
+
+	// ---------------------------------------------------------------------
+	// Method:      Decode
+	// Arguments:   None
+	// Returns:     None
+	// Description: Builds the table of DecodedOps for the sites recorded
+	//				by the Orderiser. Called when the script is installed
+	//				into the Scriptorium. Only sites that could be decoded
+	//				are kept, sorted by address.
+	// ---------------------------------------------------------------------
+	void Decode();
+
+	// ---------------------------------------------------------------------
+	// Method:      GetDecodedOp
+	// Arguments:   addr - address of a command or argument
+	// Returns:     The decoded item at that address, or NULL if there
+	//				isn't one (or decoded ops are turned off).
+	// Description: 
+	// ---------------------------------------------------------------------
+	const DecodedOp* GetDecodedOp( int addr ) const;
+
+	// ---------------------------------------------------------------------
+	// Method:      GetDecodedSize
+	// Arguments:   None
+	// Returns:     Bytes used by the decoded ops table
+	// ---------------------------------------------------------------------
+	int GetDecodedSize() const
+		{ return myDecodedAddrs.size() * ( sizeof(int) + sizeof(DecodedOp) ); }
+
+	// ---------------------------------------------------------------------
+	// Method:      UseDecodedOps
+	// Arguments:   use - false to make every script read its code as
+	//				normal, decoded or not
+	// Returns:     None
+	// Description: For checking the decoded ops run the same as the code.
+	// ---------------------------------------------------------------------
+	static void UseDecodedOps( bool use )
+		{ ourUseDecodedOps = use; }
+
 
 
 	// serialization
@@ -161,9 +254,35 @@ private:
 	int32				mySize;
 	DebugInfo*		myDebugInfo;
 	int32				myReferenceCount;
+
+	// not serialised - rebuilt by the Orderiser when the script is read
+	struct DecodeSite
+	{
+		int kind;
+		int addr;
+	};
+	std::vector<DecodeSite> myDecodeSites;
+	bool			myDecoded;
+	std::vector<int>		myDecodedAddrs;		// sorted
+	std::vector<DecodedOp>	myDecodedOps;		// one per address above
+
+	static bool		ourUseDecodedOps;
 };
 
 
+inline const DecodedOp* MacroScript::GetDecodedOp( int addr ) const
+{
+	if( !ourUseDecodedOps || myDecodedAddrs.empty() )
+		return NULL;
+
+	std::vector<int>::const_iterator it =
+		std::lower_bound( myDecodedAddrs.begin(), myDecodedAddrs.end(), addr );
+	if( it == myDecodedAddrs.end() || *it != addr )
+		return NULL;
+	return &myDecodedOps[ it - myDecodedAddrs.begin() ];
+}
+
+
 inline int MacroScript::FetchInteger( int& addr )  const
 {
 	_ASSERT((addr >= 0) && (addr < mySize));
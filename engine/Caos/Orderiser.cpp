@@ -67,6 +67,7 @@ MacroScript* Orderiser::OrderFromCAOS( const char* srctext )
 		myContextStack.pop();
 	myIP = 0;
 	myUniqueLabelID = 0;
+	myDecodeSites.clear();
 
 	// this debuginfo object will be passed on to the output
 	// macroscript if all goes well:
@@ -80,6 +81,7 @@ MacroScript* Orderiser::OrderFromCAOS( const char* srctext )
 		{
 			// plonk a STOP at the end for all us stupid people who
 			// keep forgetting it.
+			AddDecodeSite( MacroScript::siteCommand );
 			EncodeOpID( CAOSDescription::cmdSTOP );
 			done = true;
 		}
@@ -99,7 +101,7 @@ MacroScript* Orderiser::OrderFromCAOS( const char* srctext )
 			else
 			{
 				myDebugInfo->AddAddressToPositionMapping( myIP, myLexer.GetPos() );
-				allok = EncodeOp( op );
+				allok = EncodeOp( op, true );
 			}
 		}
 	}
@@ -129,7 +131,10 @@ MacroScript* Orderiser::OrderFromCAOS( const char* srctext )
 
 		// Put the compiled code into a MacroScript object
 		// (ownership of debuginfo is passed to the macroscript)
-		return new MacroScript( myOutputBuffer, myIP, myDebugInfo );
+		MacroScript* m = new MacroScript( myOutputBuffer, myIP, myDebugInfo );
+		for( int i=0; i<myDecodeSites.size(); ++i )
+			m->AddDecodeSite( myDecodeSites[i].Kind, myDecodeSites[i].Addr );
+		return m;
 	}
 	else
 	{
@@ -147,7 +152,7 @@ MacroScript* Orderiser::OrderFromCAOS( const char* srctext )
 
 //////////////////////////////////////////////////////////////////
 
-bool Orderiser::EncodeOp( const OpSpec* op )
+bool Orderiser::EncodeOp( const OpSpec* op, bool command )
 {
 	int arg;
 	bool allok = true;
@@ -155,7 +160,12 @@ bool Orderiser::EncodeOp( const OpSpec* op )
 	allok = SpecialPreProcessing( op );
 
 	if( allok )
+	{
+		// (SpecialPreProcessing might have added code before the op)
+		if( command )
+			AddDecodeSite( MacroScript::siteCommand );
 		EncodeOpID( op->GetOpcode() );
+	}
 
 	// encode params
 	for( arg=0; arg < op->GetParameterCount() && allok; ++arg )
@@ -229,14 +239,14 @@ bool Orderiser::ExpectStringRV()
 		op = theCAOSDescription.FindStringRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argStringRV );
+			EncodeArgType( CAOSDescription::argStringRV );
 			return EncodeOp( op );
 		}
 
 		op = theCAOSDescription.FindVariable( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argVariable );
+			EncodeArgType( CAOSDescription::argVariable );
 			return EncodeOp( op );
 		}
 
@@ -245,7 +255,7 @@ bool Orderiser::ExpectStringRV()
 	// String constant?
 	if( lextype == Lexer::itemString )
 	{
-		EncodeOpID( CAOSDescription::argStringConstant );
+		EncodeArgType( CAOSDescription::argStringConstant );
 		EncodeString( myLexer.GetAsText() );
 		return true;
 	}
@@ -274,7 +284,7 @@ bool Orderiser::ExpectAgentRV()
 		op = theCAOSDescription.FindAgentRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argAgentRV );
+			EncodeArgType( CAOSDescription::argAgentRV );
 			return EncodeOp( op );
 		}
 
@@ -282,7 +292,7 @@ bool Orderiser::ExpectAgentRV()
 		op = theCAOSDescription.FindVariable( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argVariable );
+			EncodeArgType( CAOSDescription::argVariable );
 			return EncodeOp( op );
 		}
 
@@ -312,7 +322,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 		if( op )
 		{
 			argType = CAOSDescription::argIntegerRV;
-			EncodeOpID( argType );
+			EncodeArgType( argType );
 			return EncodeOp( op );
 		}
 
@@ -321,7 +331,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 		if( op )
 		{
 			argType = CAOSDescription::argFloatRV;
-			EncodeOpID( argType );
+			EncodeArgType( argType );
 			return EncodeOp( op );
 		}
 
@@ -330,7 +340,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 		if( op )
 		{
 			argType = CAOSDescription::argStringRV;
-			EncodeOpID( argType );
+			EncodeArgType( argType );
 			return EncodeOp( op );
 		}
 
@@ -339,7 +349,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 		if( op )
 		{
 			argType = CAOSDescription::argAgentRV;
-			EncodeOpID( argType );
+			EncodeArgType( argType );
 			return EncodeOp( op );
 		}
 
@@ -348,7 +358,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 		if( op )
 		{
 			argType = CAOSDescription::argVariable;
-			EncodeOpID( argType );
+			EncodeArgType( argType );
 			return EncodeOp( op );
 		}	
 	}
@@ -358,7 +368,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 	{
 		// encode the integer
 		argType = CAOSDescription::argIntegerConstant;
-		EncodeOpID( argType );
+		EncodeArgType( argType );
 		EncodeInt( myLexer.GetIntegerValue() );
 		return true;
 	}
@@ -368,7 +378,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 	{
 		// encode the float
 		argType = CAOSDescription::argFloatConstant;
-		EncodeOpID( argType );
+		EncodeArgType( argType );
 		EncodeFloat( myLexer.GetFloatValue() );
 		return true;
 	}
@@ -377,7 +387,7 @@ bool Orderiser::ExpectAnyRV(int& argType)
 	if( lextype == Lexer::itemString )
 	{
 		argType = CAOSDescription::argStringConstant;
-		EncodeOpID( argType );
+		EncodeArgType( argType );
 		EncodeString( myLexer.GetAsText() );
 		return true;
 	}
@@ -427,6 +437,7 @@ bool Orderiser::ExpectVariable()
 		{
 			// encode the var
 			// (don't need to code an arg type)
+			AddDecodeSite( MacroScript::siteVariable );
 			return EncodeOp( op );
 		}
 	}
@@ -448,7 +459,7 @@ bool Orderiser::ExpectNumericRV()
 		op = theCAOSDescription.FindFloatRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argFloatRV );
+			EncodeArgType( CAOSDescription::argFloatRV );
 			return EncodeOp( op );
 		}
 
@@ -456,7 +467,7 @@ bool Orderiser::ExpectNumericRV()
 		op = theCAOSDescription.FindIntegerRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argIntegerRV );
+			EncodeArgType( CAOSDescription::argIntegerRV );
 			return EncodeOp( op );
 		}
 
@@ -464,7 +475,7 @@ bool Orderiser::ExpectNumericRV()
 		op = theCAOSDescription.FindVariable( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argVariable );
+			EncodeArgType( CAOSDescription::argVariable );
 			return EncodeOp( op );
 		}
 
@@ -473,7 +484,7 @@ bool Orderiser::ExpectNumericRV()
 	if( lextype == Lexer::itemFloat )
 	{
 		// encode the float
-		EncodeOpID( CAOSDescription::argFloatConstant );
+		EncodeArgType( CAOSDescription::argFloatConstant );
 		float f = myLexer.GetFloatValue();
 		EncodeFloat( f );
 		return true;
@@ -482,7 +493,7 @@ bool Orderiser::ExpectNumericRV()
 	if( lextype == Lexer::itemInteger )
 	{
 		// encode the integer
-		EncodeOpID( CAOSDescription::argIntegerConstant );
+		EncodeArgType( CAOSDescription::argIntegerConstant );
 		int i = myLexer.GetIntegerValue();
 		EncodeInt( i );
 		return true;
@@ -506,7 +517,7 @@ bool Orderiser::ExpectGenericRV()
 		op = theCAOSDescription.FindFloatRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argFloatRV );
+			EncodeArgType( CAOSDescription::argFloatRV );
 			return EncodeOp( op );
 		}
 
@@ -514,7 +525,7 @@ bool Orderiser::ExpectGenericRV()
 		op = theCAOSDescription.FindIntegerRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argIntegerRV );
+			EncodeArgType( CAOSDescription::argIntegerRV );
 			return EncodeOp( op );
 		}
 
@@ -522,7 +533,7 @@ bool Orderiser::ExpectGenericRV()
 		op = theCAOSDescription.FindStringRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argStringRV );
+			EncodeArgType( CAOSDescription::argStringRV );
 			return EncodeOp( op );
 		}
 
@@ -530,7 +541,7 @@ bool Orderiser::ExpectGenericRV()
 		op = theCAOSDescription.FindAgentRV( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argAgentRV );
+			EncodeArgType( CAOSDescription::argAgentRV );
 			return EncodeOp( op );
 		}
 
@@ -538,7 +549,7 @@ bool Orderiser::ExpectGenericRV()
 		op = theCAOSDescription.FindVariable( myLexer.GetAsText() );
 		if( op )
 		{
-			EncodeOpID( CAOSDescription::argVariable );
+			EncodeArgType( CAOSDescription::argVariable );
 			return EncodeOp( op );
 		}
 
@@ -547,7 +558,7 @@ bool Orderiser::ExpectGenericRV()
 	if( lextype == Lexer::itemFloat )
 	{
 		// encode the float
-		EncodeOpID( CAOSDescription::argFloatConstant );
+		EncodeArgType( CAOSDescription::argFloatConstant );
 		float f = myLexer.GetFloatValue();
 		EncodeFloat( f );
 		return true;
@@ -556,7 +567,7 @@ bool Orderiser::ExpectGenericRV()
 	if( lextype == Lexer::itemInteger )
 	{
 		// encode the integer
-		EncodeOpID( CAOSDescription::argIntegerConstant );
+		EncodeArgType( CAOSDescription::argIntegerConstant );
 		int i = myLexer.GetIntegerValue();
 		EncodeInt( i );
 		return true;
@@ -565,7 +576,7 @@ bool Orderiser::ExpectGenericRV()
 	// String constant?
 	if( lextype == Lexer::itemString )
 	{
-		EncodeOpID( CAOSDescription::argStringConstant );
+		EncodeArgType( CAOSDescription::argStringConstant );
 		EncodeString( myLexer.GetAsText() );
 		return true;
 	}
@@ -778,6 +789,14 @@ void Orderiser::EncodeOpID( OpType op )
 }
 
 
+// an argument type, which is where an argument starts
+void Orderiser::EncodeArgType( OpType argType )
+{
+	AddDecodeSite( MacroScript::siteArgument );
+	EncodeOpID( argType );
+}
+
+
 void Orderiser::EncodeString( const char* str )
 {
 	int count;
@@ -866,6 +885,7 @@ bool Orderiser::SpecialPreProcessing( const OpSpec* op )
 
 		// insert a goto at the end of the block to jump to
 		//the next matching ENDI
+		AddDecodeSite( MacroScript::siteCommand );
 		EncodeOpID( CAOSDescription::cmdGOTO );
 
 		myLabelRefs.push_back( LabelRef(
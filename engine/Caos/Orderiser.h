@@ -32,6 +32,7 @@
 #include <stack>
 #include <map>
 #include <list>
+#include <vector>
 
 
 // GLOBAL
@@ -110,7 +111,7 @@ private:
 	Lexer myLexer;
 	DebugInfo*	myDebugInfo;	// debug information
 
-	bool EncodeOp( const OpSpec* op );
+	bool EncodeOp( const OpSpec* op, bool command=false );
 	bool ExpectSubCommand( const OpSpec* parentop );
 
 	bool ExpectNumericRV();
@@ -162,6 +163,17 @@ private:
 	std::map<std::string, int> myLabels;	// defined labels
 	std::list<LabelRef> myLabelRefs;		// references to labels
 
+	// struct to keep track of where commands and arguments start, so
+	// the MacroScript can decode them ahead of time.
+	struct DecodeSite
+	{
+		DecodeSite( int kind, int ip )
+			{ Kind=kind; Addr=ip; }
+		int Kind;			// MacroScript::siteCommand etc...
+		int Addr;
+	};
+	std::vector<DecodeSite> myDecodeSites;
+
 	void PlonkInt( int addr, int i );		// directly store an int
 	void PlonkFloat( int addr, float f);	
 	void PlonkByte( int addr, unsigned char b );
@@ -171,6 +183,9 @@ private:
 	void EncodeFloat( float f );
 	void EncodeByte( unsigned char b );
 	void EncodeOpID( OpType op );
+	void EncodeArgType( OpType argType );
+	void AddDecodeSite( int kind )
+		{ myDecodeSites.push_back( DecodeSite( kind, myIP ) ); }
 	void EncodeString( const char* str );
 
 	// should sort out a better error system...
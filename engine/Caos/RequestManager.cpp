@@ -6,11 +6,33 @@
 
 #include "Orderiser.h"
 #include "CAOSMachine.h"
+#include "MacroScript.h"
+#include "../md5.h"
 
 #include "../App.h"
 #include "../World.h"
 #include "../Display/ErrorMessageHandler.h"
 #include <strstream>
+#include <string.h>
+
+// limits for the compiled script cache
+static const int theScriptCacheMaxEntries = 64;
+static const uint32 theScriptCacheMaxBytes = 1024*1024;
+
+
+RequestManager::RequestManager()
+{
+	myScriptCacheHits = 0;
+	myScriptCacheMisses = 0;
+	myScriptCacheBytes = 0;
+}
+
+
+RequestManager::~RequestManager()
+{
+	FlushScriptCache();
+}
+
 
 void RequestManager::HandleIncoming( ServerSide& server )
 {
@@ -26,34 +48,6 @@ void RequestManager::HandleIncoming( ServerSide& server )
 
 	try
 	{
-		std::vector< std::string > args;
-		char* p;
-		int errorcode=0;
-
-		p = (char*)server.GetBuffer();
-
-		// chop first line up into arguments. Args are space-delimited.
-
-		// CR/LF allowed, LF only prefered.
-		// Ugh. DOS has _so_ much to answer for.
-		while( *p && *p != '\n' && *p != '\r' )
-		{
-			// new arg
-			args.push_back("");
-			while( *p && *p != '\n' && *p != '\r' && *p != ' ' && *p != '\t' )
-				args.back() += *p++;
-
-			// skip separating spaces (and/or tabs)
-			while( *p == ' ' || *p == '\t' )
-				++p;
-		}
-
-		// skip end-of-line crap
-		if( *p == '\r' )
-			++p;
-		if( *p == '\n' )
-			++p;
-
 #ifdef C2E_OLD_CPP_LIB
 		std::ostrstream out( (char*)server.GetBuffer(),
 			server.GetMaxBufferSize()-1, std::ios::out | std::ios::binary );
@@ -61,100 +55,7 @@ void RequestManager::HandleIncoming( ServerSide& server )
 		std::ostrstream out( (char*)server.GetBuffer(),
 			server.GetMaxBufferSize()-1, std::ios_base::out | std::ios_base::binary );
 #endif
-		ASSERT(args.size() > 0);
-
-		if( args[0] == "execute" || args[0] == "iscr" )
-		{
-			Orderiser o;
-			MacroScript* m;
-			CAOSMachine vm;
-
-			m = o.OrderFromCAOS( p );
-			if( m )
-			{
-				try {
-					vm.StartScriptExecuting(m, NULLHANDLE, NULLHANDLE, INTEGERZERO, INTEGERZERO);
-					vm.SetOutputStream(&out);
-					vm.UpdateVM(-1);
-				}
-				catch( CAOSMachine::RunError& e )
-				{
-					// return vm error message
-					out.seekp( 0 );
-					out << e.what();
-					vm.StreamIPLocationInSource(out);
-
-					// clean up after the error
-					vm.StopScriptExecuting();
-
-					errorcode = 1;
-				}
-
-				// finished with this script now.
-				delete m;
-			}
-			else
-			{
-				// return orderiser error message
-				std::string source(p); // copy p into sourceas out overwrites it
-				out.seekp( 0 );
-				out << o.GetLastError() << std::endl;
-				CAOSMachine::FormatErrorPos(out, o.GetLastErrorPos(), source);
-				errorcode = 1;
-			}
-		}
-
-
-		if( args[0] == "scrp" )
-		{
-			if( args.size() >= 5 )
-			{
-				int f,g,s,e;
-
-				f = atoi( args[1].c_str() );
-				g = atoi( args[2].c_str() );
-				s = atoi( args[3].c_str() );
-				e = atoi( args[4].c_str() );
-
-				Orderiser o;
-				MacroScript* m;
-
-				m = o.OrderFromCAOS( p );
-				if( m )
-				{
-					m->SetClassifier( Classifier( f, g, s, e ) );
-					if( theApp.GetWorld().GetScriptorium().InstallScript( m ) )
-						out << theCatalogue.Get("script_error", 0); // OK
-					else
-					{
-						// script probably in use
-						out << theCatalogue.Get("script_error", 1);
-						Classifier( f, g, s, e ).StreamClassifier(out);
-						out << theCatalogue.Get("script_error", 2);
-						errorcode = 1;
-					}
-
-					// Don't delete this as it is referenced by the scriptorium
-					// delete m;
-				}
-				else
-				{
-					// return orderiser error message
-					std::string source(p); // copy p into sourceas out overwrites it
-					out.seekp( 0 );
-					out << o.GetLastError() << std::endl;
-					CAOSMachine::FormatErrorPos(out, o.GetLastErrorPos(), source);
-					errorcode = 1;
-				}
-			}
-			else
-			{
-				out.seekp( 0 );
-				// "Error: Correct format is \"scrp <family> <genus> <species> <event>\""
-				out << theCatalogue.Get("script_error", 5);
-				errorcode = 1;
-			}
-		}
+		int errorcode = ExecuteRequest( (char*)server.GetBuffer(), out );
 
 		out.put( '\0' );	// terminate the string
 
@@ -193,3 +94,271 @@ void RequestManager::HandleIncoming( ServerSide& server )
 	}
 }
 
+
+
+
+#ifndef _WIN32
+void RequestManager::HandleQueued( SocketServer& server )
+{
+	SocketServer::Request request;
+
+	server.Poll();
+	while( server.GetRequest( request ) )
+	{
+		// results can be any size, so let the stream grow its own buffer
+		std::ostrstream out;
+		int errorcode = 1;
+
+		// Catch everything so one bad request can't take out the rest
+		// of the batch (or leave its client waiting forever)
+		try
+		{
+			errorcode = ExecuteRequest( &request.data[0], out );
+		}
+		catch(BasicException& e) {
+			out.seekp( 0 );
+			errorcode = 1;
+			ErrorMessageHandler::Show(e, std::string("RequestManager::HandleQueued"));
+		}
+		catch( ... ) {
+			out.seekp( 0 );
+			errorcode = 1;
+			ErrorMessageHandler::NonLocalisable("NLE0005: Unknown exception caught in request manager",
+				std::string("RequestManager::HandleQueued"));
+		}
+
+		out.put( '\0' );	// terminate the string
+		server.Respond( request.client, out.str(), out.pcount(), errorcode );
+		out.freeze( false );
+	}
+}
+#endif
+
+
+
+// Runs one request (the first line says what to do, the rest is CAOS)
+// and writes the result to out.  Returns the error code for the client.
+int RequestManager::ExecuteRequest( char* request, std::ostream& out )
+{
+	std::vector< std::string > args;
+	char* p;
+	int errorcode=0;
+
+	p = request;
+
+	// chop first line up into arguments. Args are space-delimited.
+
+	// CR/LF allowed, LF only prefered.
+	// Ugh. DOS has _so_ much to answer for.
+	while( *p && *p != '\n' && *p != '\r' )
+	{
+		// new arg
+		args.push_back("");
+		while( *p && *p != '\n' && *p != '\r' && *p != ' ' && *p != '\t' )
+			args.back() += *p++;
+
+		// skip separating spaces (and/or tabs)
+		while( *p == ' ' || *p == '\t' )
+			++p;
+	}
+
+	// skip end-of-line crap
+	if( *p == '\r' )
+		++p;
+	if( *p == '\n' )
+		++p;
+
+	if( args.empty() )
+		return 1;
+
+	if( args[0] == "execute" || args[0] == "iscr" )
+	{
+		Orderiser o;
+		MacroScript* m;
+		CAOSMachine vm;
+		bool cached = true;
+
+		std::string digest = ScriptDigest( p );
+		m = FindCachedScript( digest );
+		if( !m )
+		{
+			m = o.OrderFromCAOS( p );
+			if( m )
+				cached = CacheScript( digest, m, strlen( p ) );
+		}
+
+		if( m )
+		{
+			try {
+				vm.StartScriptExecuting(m, NULLHANDLE, NULLHANDLE, INTEGERZERO, INTEGERZERO);
+				vm.SetOutputStream(&out);
+				vm.UpdateVM(-1);
+			}
+			catch( CAOSMachine::RunError& e )
+			{
+				// return vm error message
+				out.seekp( 0 );
+				out << e.what();
+				vm.StreamIPLocationInSource(out);
+
+				// clean up after the error
+				vm.StopScriptExecuting();
+
+				errorcode = 1;
+			}
+
+			// finished with this script now (unless the cache has it)
+			vm.StopScriptExecuting();
+			if( !cached )
+				delete m;
+		}
+		else
+		{
+			// return orderiser error message
+			std::string source(p); // copy p into sourceas out overwrites it
+			out.seekp( 0 );
+			out << o.GetLastError() << std::endl;
+			CAOSMachine::FormatErrorPos(out, o.GetLastErrorPos(), source);
+			errorcode = 1;
+		}
+	}
+
+
+	if( args[0] == "scrp" )
+	{
+		if( args.size() >= 5 )
+		{
+			int f,g,s,e;
+
+			f = atoi( args[1].c_str() );
+			g = atoi( args[2].c_str() );
+			s = atoi( args[3].c_str() );
+			e = atoi( args[4].c_str() );
+
+			Orderiser o;
+			MacroScript* m;
+
+			m = o.OrderFromCAOS( p );
+			if( m )
+			{
+				m->SetClassifier( Classifier( f, g, s, e ) );
+				if( theApp.GetWorld().GetScriptorium().InstallScript( m ) )
+					out << theCatalogue.Get("script_error", 0); // OK
+				else
+				{
+					// script probably in use
+					out << theCatalogue.Get("script_error", 1);
+					Classifier( f, g, s, e ).StreamClassifier(out);
+					out << theCatalogue.Get("script_error", 2);
+					errorcode = 1;
+				}
+
+				// Don't delete this as it is referenced by the scriptorium
+				// delete m;
+			}
+			else
+			{
+				// return orderiser error message
+				std::string source(p); // copy p into sourceas out overwrites it
+				out.seekp( 0 );
+				out << o.GetLastError() << std::endl;
+				CAOSMachine::FormatErrorPos(out, o.GetLastErrorPos(), source);
+				errorcode = 1;
+			}
+		}
+		else
+		{
+			out.seekp( 0 );
+			// "Error: Correct format is \"scrp <family> <genus> <species> <event>\""
+			out << theCatalogue.Get("script_error", 5);
+			errorcode = 1;
+		}
+	}
+
+	return errorcode;
+}
+
+
+
+// Returns the md5 of the script source, as a 16 byte string
+std::string RequestManager::ScriptDigest( const char* source )
+{
+	md5_state_t state;
+	md5_byte_t digest[16];
+
+	md5_init( &state );
+	md5_append( &state, (const md5_byte_t*)source, strlen( source ) );
+	md5_finish( &state, digest );
+
+	return std::string( (const char*)digest, sizeof(digest) );
+}
+
+
+
+// Returns the cached script for the digest (moving it to the front
+// of the list) or NULL if there isn't one
+MacroScript* RequestManager::FindCachedScript( const std::string& digest )
+{
+	std::map< std::string, ScriptCacheList::iterator >::iterator it =
+		myScriptCacheIndex.find( digest );
+	if( it == myScriptCacheIndex.end() )
+	{
+		++myScriptCacheMisses;
+		return NULL;
+	}
+
+	++myScriptCacheHits;
+	myScriptCache.splice( myScriptCache.begin(), myScriptCache, it->second );
+	return it->second->script;
+}
+
+
+
+// Takes ownership of a newly orderised script, evicting the least
+// recently used ones to make room.  Returns false (and leaves the
+// script with the caller) if it's too big to be worth keeping.
+bool RequestManager::CacheScript( const std::string& digest, MacroScript* m,
+	uint32 sourceBytes )
+{
+	// it'll be run again, so decode it like an installed script
+	m->Decode();
+
+	// the code, its decoded ops and the DebugInfo copy of the source
+	uint32 bytes = m->GetCodeSize() + m->GetDecodedSize() + sourceBytes;
+	if( bytes > theScriptCacheMaxBytes )
+		return false;
+
+	while( !myScriptCache.empty() &&
+		( myScriptCache.size() >= theScriptCacheMaxEntries ||
+		  myScriptCacheBytes + bytes > theScriptCacheMaxBytes ) )
+	{
+		CachedScript& oldest = myScriptCache.back();
+		ASSERT( !oldest.script->IsLocked() );
+		delete oldest.script;
+		myScriptCacheBytes -= oldest.bytes;
+		myScriptCacheIndex.erase( oldest.digest );
+		myScriptCache.pop_back();
+	}
+
+	CachedScript entry;
+	entry.digest = digest;
+	entry.script = m;
+	entry.bytes = bytes;
+	myScriptCache.push_front( entry );
+	myScriptCacheIndex[ digest ] = myScriptCache.begin();
+	myScriptCacheBytes += bytes;
+	return true;
+}
+
+
+
+void RequestManager::FlushScriptCache()
+{
+	ScriptCacheList::iterator it;
+	for( it = myScriptCache.begin(); it != myScriptCache.end(); ++it )
+		delete it->script;
+
+	myScriptCache.clear();
+	myScriptCacheIndex.clear();
+	myScriptCacheBytes = 0;
+}
@@ -8,11 +8,61 @@
 #include "../../common/C2eTypes.h"
 // TODO: ServerSide should be fwd declaration
 #include "../../common/ServerSide.h"
+#ifndef _WIN32
+#include "../../common/unix/SocketServer.h"
+#endif
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+
+class MacroScript;
 
 class RequestManager
 {
 public:
+	RequestManager();
+	~RequestManager();
+
 	void HandleIncoming( ServerSide& server );
+
+#ifndef _WIN32
+	// Answers every request the socket server has received since
+	// the last call.  Called once per tick.
+	void HandleQueued( SocketServer& server );
+#endif
+
+	// Compiled script cache statistics
+	uint32 GetScriptCacheHits() const { return myScriptCacheHits; }
+	uint32 GetScriptCacheMisses() const { return myScriptCacheMisses; }
+	uint32 GetScriptCacheBytes() const { return myScriptCacheBytes; }
+	void FlushScriptCache();
+
+private:
+	int ExecuteRequest( char* request, std::ostream& out );
+
+	// Tools tend to inject the same few scripts over and over (e.g.
+	// a monitor polling once a second), so "execute" requests keep
+	// their orderised scripts, keyed by an md5 of the source, and
+	// throw away the least recently used when the cache is full.
+	static std::string ScriptDigest( const char* source );
+	MacroScript* FindCachedScript( const std::string& digest );
+	bool CacheScript( const std::string& digest, MacroScript* m,
+		uint32 sourceBytes );
+
+	struct CachedScript
+	{
+		std::string digest;
+		MacroScript* script;
+		uint32 bytes;
+	};
+	typedef std::list< CachedScript > ScriptCacheList;
+
+	ScriptCacheList myScriptCache;		// most recently used first
+	std::map< std::string, ScriptCacheList::iterator > myScriptCacheIndex;
+	uint32 myScriptCacheHits;
+	uint32 myScriptCacheMisses;
+	uint32 myScriptCacheBytes;
 };
 
 #endif // REQUEST_MANAGER_H
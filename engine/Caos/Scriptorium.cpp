@@ -65,6 +65,11 @@ bool Scriptorium::InstallScript( MacroScript* script)
 	// There is a script, and it is locked, so we fail :)
 	if (fail)
 		return false;
+
+	// Installed scripts get run over and over, so it's worth
+	// looking up their handlers once now
+	script->Decode();
+
 	if (m == NULL)
 	{
 		// We have to ensure that the vectors are okay :)
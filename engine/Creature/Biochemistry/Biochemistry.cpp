@@ -16,31 +16,28 @@
 #include "../Creature.h"
 #include "../LifeFaculty.h"
 
+#include "../../CPUID.h"
+
+// work out whether we can build the vector versions of the decay
+// and receptor passes (which ones are used is decided at run time)
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#define CHEMICALS_SIMD
+	#define CHEMICALS_SSE2 __attribute__((target("sse2")))
+	#define CHEMICALS_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800 && (defined(_M_IX86) || defined(_M_X64))
+	#define CHEMICALS_SIMD
+	#define CHEMICALS_SSE2
+	#define CHEMICALS_AVX2
+#endif
 
-CREATURES_IMPLEMENT_SERIAL(Biochemistry)
-
-
-
+#ifdef CHEMICALS_SIMD
+#include <immintrin.h>
+#endif
 
-float Biochemistry::GetChemical(int chem)					// return current concentration of a chemical
-{	return myChemicalConcs[chem];}
 
-void Biochemistry::SetChemical(int chem, float amount)	// set abs concentration of a chemical
-{
-	myChemicalConcs[chem] = BoundIntoZeroOne(amount);
-}
+CREATURES_IMPLEMENT_SERIAL(Biochemistry)
 
-void Biochemistry::AddChemical(int chem,float amount)		// add to the concentration of given chemical
-{											// UNLESS chem=0 ("none")
-	if (chem) 
-		myChemicalConcs[chem] = BoundIntoZeroOne(myChemicalConcs[chem]+amount); 
-} 
 
-void Biochemistry::SubChemical(int chem,float amount)		// reduce the concentration of given chemical
-{											// UNLESS chem=0 ("none")
-	if (chem) 
-		myChemicalConcs[chem] = BoundIntoZeroOne(myChemicalConcs[chem]-amount);
-} 
 
 
 /*********************************************************************
@@ -53,6 +50,11 @@ Biochemistry::Biochemistry()
 	for (int i=0; i<MAXORGANS; i++)
 		myOrgans[i] = NULL;
 	myNoOfNeuroEmitters = 0;
+
+	myChemicalDecayRates = (float*)
+		(((size_t)myChemicalStorage + chemicalAlignment-1) & ~(size_t)(chemicalAlignment-1));
+	myChemicalConcs = myChemicalDecayRates + NUMCHEM;
+
 	for (int k=0; k<NUMCHEM; k++) {
 		myChemicalConcs[k] = 0.0f;
 		myChemicalDecayRates[k] = 0.0f;
@@ -347,8 +349,153 @@ void Biochemistry::Update() {
 	}
 
 	// Reduce chemical concentrations according to half-lives
-	for (i=0; i<NUMCHEM; i++)
-		myChemicalConcs[i] *= myChemicalDecayRates[i];
+	DecayChemicals();
+}
+
+
+/*********************************************************************
+* Private: DecayChemicals.
+* Multiplies every concentration by its decay rate.  Each lane of the
+* vector versions does the same single multiply as the scalar loop,
+* so results match.
+*********************************************************************/
+void Biochemistry::DecayChemicals()
+{
+	ourDecayChemicals(myChemicalConcs, myChemicalDecayRates);
+}
+
+static void DecayChemicalsScalar(float* concs, const float* rates)
+{
+	for (int i=0; i<NUMCHEM; i++)
+		concs[i] *= rates[i];
+}
+
+#ifdef CHEMICALS_SIMD
+
+CHEMICALS_SSE2 static void DecayChemicalsSSE2(float* concs, const float* rates)
+{
+	for (int i=0; i<NUMCHEM; i+=4)
+		_mm_store_ps(concs+i, _mm_mul_ps(_mm_load_ps(concs+i), _mm_load_ps(rates+i)));
+}
+
+CHEMICALS_AVX2 static void DecayChemicalsAVX2(float* concs, const float* rates)
+{
+	for (int i=0; i<NUMCHEM; i+=8)
+		_mm256_store_ps(concs+i, _mm256_mul_ps(_mm256_load_ps(concs+i), _mm256_load_ps(rates+i)));
+	_mm256_zeroupper();
+}
+
+#endif // CHEMICALS_SIMD
+
+
+/*********************************************************************
+* SampleReceptors.
+* Works out each receptor's signal from the chemical it samples: the
+* excess over its threshold, then either its gain (digital receptors)
+* or the excess times its gain.  No chemicals change while an organ's
+* receptors are processed, so they can all be sampled up front.  The
+* vector versions make the same choices lane by lane (including for
+* -0 and NaN) and do the same single subtract and multiply, so
+* results match the plain loop.
+*********************************************************************/
+static void SampleReceptorsScalar(const float* concs, const int* chems,
+	const float* thresholds, const float* gains, const int* digital,
+	float* signals, int first, int last)
+{
+	for (int i=first; i<last; i++) {
+		float inputSignal = concs[chems[i]] - thresholds[i];
+		if (inputSignal<0.0f) inputSignal=0.0f;
+		if (inputSignal) {
+			if (digital[i])
+				inputSignal = gains[i];
+			else
+				inputSignal *= gains[i];
+		}
+		signals[i] = inputSignal;
+	}
+}
+
+#ifdef CHEMICALS_SIMD
+
+CHEMICALS_SSE2 static void SampleReceptorsSSE2(const float* concs, const int* chems,
+	const float* thresholds, const float* gains, const int* digital,
+	float* signals, int first, int last)
+{
+	const __m128 zero = _mm_setzero_ps();
+	int i = first;
+	for (; i+4<=last; i+=4) {
+		__m128 conc = _mm_set_ps(concs[chems[i+3]], concs[chems[i+2]],
+			concs[chems[i+1]], concs[chems[i]]);
+		// (max keeps the second operand unless the first is bigger,
+		// as the scalar test does)
+		__m128 excess = _mm_max_ps(zero, _mm_sub_ps(conc, _mm_loadu_ps(thresholds+i)));
+		__m128 gain = _mm_loadu_ps(gains+i);
+		__m128 isDigital = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(digital+i)));
+		__m128 response = _mm_or_ps(_mm_and_ps(isDigital, gain),
+			_mm_andnot_ps(isDigital, _mm_mul_ps(excess, gain)));
+		__m128 any = _mm_cmpneq_ps(excess, zero);
+		_mm_storeu_ps(signals+i, _mm_or_ps(_mm_and_ps(any, response),
+			_mm_andnot_ps(any, excess)));
+	}
+	SampleReceptorsScalar(concs, chems, thresholds, gains, digital, signals, i, last);
+}
+
+CHEMICALS_AVX2 static void SampleReceptorsAVX2(const float* concs, const int* chems,
+	const float* thresholds, const float* gains, const int* digital,
+	float* signals, int first, int last)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	int i = first;
+	for (; i+8<=last; i+=8) {
+		__m256 conc = _mm256_i32gather_ps(concs,
+			_mm256_loadu_si256((const __m256i*)(chems+i)), sizeof(float));
+		__m256 excess = _mm256_max_ps(zero, _mm256_sub_ps(conc, _mm256_loadu_ps(thresholds+i)));
+		__m256 gain = _mm256_loadu_ps(gains+i);
+		__m256 isDigital = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(digital+i)));
+		__m256 response = _mm256_blendv_ps(_mm256_mul_ps(excess, gain), gain, isDigital);
+		__m256 any = _mm256_cmp_ps(excess, zero, _CMP_NEQ_UQ);
+		_mm256_storeu_ps(signals+i, _mm256_blendv_ps(excess, response, any));
+	}
+	_mm256_zeroupper();
+	SampleReceptorsScalar(concs, chems, thresholds, gains, digital, signals, i, last);
+}
+
+#endif // CHEMICALS_SIMD
+
+Biochemistry::DecayFunction Biochemistry::ourDecayChemicals = DecayChemicalsScalar;
+Biochemistry::SampleFunction Biochemistry::ourSampleReceptors = SampleReceptorsScalar;
+const char* Biochemistry::ourVectorName = "C++";
+
+
+/*********************************************************************
+* Public: ChooseVectorRoutines.
+* Picks the fastest decay and receptor passes the processor has (AVX2,
+* SSE2 or the plain loops), using the CPUID functions.  Call before any
+* creatures are updated.  useVectors=false forces the plain loops, for
+* comparing.
+*********************************************************************/
+void Biochemistry::ChooseVectorRoutines(bool useVectors)
+{
+	ourDecayChemicals = DecayChemicalsScalar;
+	ourSampleReceptors = SampleReceptorsScalar;
+	ourVectorName = "C++";
+
+#ifdef CHEMICALS_SIMD
+	if (!useVectors)
+		return;
+	if (CheckAVX2Technology())
+	{
+		ourDecayChemicals = DecayChemicalsAVX2;
+		ourSampleReceptors = SampleReceptorsAVX2;
+		ourVectorName = "AVX2";
+	}
+	else if (CheckSSE2Technology())
+	{
+		ourDecayChemicals = DecayChemicalsSSE2;
+		ourSampleReceptors = SampleReceptorsSSE2;
+		ourVectorName = "SSE2";
+	}
+#endif
 }
 
 
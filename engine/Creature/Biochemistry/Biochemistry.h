@@ -17,6 +17,7 @@
 #include "BiochemistryConstants.h"
 #include "NeuroEmitter.h"
 #include "../Faculty.h"
+#include "../../Maths.h"
 
 class Creature;
 class Organ;
@@ -38,11 +39,40 @@ public:
 	virtual void ReadFromGenome(Genome& genome);	// Define whole biochemistry from DNA
 	virtual void Update();				// call this every tick to update chemicals,
 								// receptors & emitters
+	virtual bool IsSelfContained() {return true;}	// only touches our own loci
+
+	// pick the decay and receptor passes for this processor
+	// (see Biochemistry.cpp)
+	static void ChooseVectorRoutines(bool useVectors = true);
+	static const char* GetVectorRoutineName() {return ourVectorName;}
+
+	// work out the signals receptors first..last-1 get from the
+	// chemicals, for Organ::ProcessReceptors
+	static inline void SampleReceptors(const float* concs, const int* chems,
+		const float* thresholds, const float* gains, const int* digital,
+		float* signals, int first, int last) {
+		ourSampleReceptors(concs, chems, thresholds, gains, digital,
+			signals, first, last);
+	}
 
-	float GetChemical(int chem);				// return current concentration of a chemical
-	void SetChemical(int chem, float amount);	// set abs concentration of a chemical
-	void AddChemical(int chem,float amount);	// add to the concentration of given chemical
-	void SubChemical(int chem,float amount);	// reduce the concentration of given chemical UNLESS chem=0 ("none")
+	// return current concentration of a chemical
+	inline float GetChemical(int chem) {
+		return myChemicalConcs[chem];
+	}
+	// set abs concentration of a chemical
+	inline void SetChemical(int chem, float amount) {
+		myChemicalConcs[chem] = BoundIntoZeroOne(amount);
+	}
+	// add to the concentration of given chemical UNLESS chem=0 ("none")
+	inline void AddChemical(int chem,float amount) {
+		if (chem)
+			myChemicalConcs[chem] = BoundIntoZeroOne(myChemicalConcs[chem]+amount);
+	}
+	// reduce the concentration of given chemical UNLESS chem=0 ("none")
+	inline void SubChemical(int chem,float amount) {
+		if (chem)
+			myChemicalConcs[chem] = BoundIntoZeroOne(myChemicalConcs[chem]-amount);
+	}
 
 
 	virtual bool Write(CreaturesArchive &archive) const;
@@ -60,8 +90,23 @@ public:
 	Organ* GetOrgan(int organNumber) const;
 
 private:
-	float myChemicalDecayRates[NUMCHEM];		
-	float myChemicalConcs[NUMCHEM];				// array of chemical concentrations
+	// The concentrations and decay rates are carved out of
+	// myChemicalStorage on a 32 byte boundary, so the decay pass
+	// can work on them a whole vector at a time.
+	enum {chemicalAlignment = 32};
+	float myChemicalStorage[NUMCHEM*2 + chemicalAlignment/sizeof(float)];
+	float* myChemicalDecayRates;
+	float* myChemicalConcs;						// array of chemical concentrations
+
+	void DecayChemicals();
+
+	typedef void (*DecayFunction)(float* concs, const float* rates);
+	static DecayFunction ourDecayChemicals;
+	typedef void (*SampleFunction)(const float* concs, const int* chems,
+		const float* thresholds, const float* gains, const int* digital,
+		float* signals, int first, int last);
+	static SampleFunction ourSampleReceptors;
+	static const char* ourVectorName;
 
 	NeuroEmitter myNeuroEmitters[MAX_NEUROEMITTERS];
 	int myNoOfNeuroEmitters;
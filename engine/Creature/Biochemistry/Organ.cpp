@@ -57,6 +57,7 @@ Organ::Organ()
 	myNoOfEmitters = 0;
 	myNoOfReactions = 0;
 	myNoOfReceptorGroups = 0;
+	BuildProcessTables();
 }
 
 
@@ -109,6 +110,86 @@ void Organ::BindToLoci()
 	for	(i=0, e=myEmitters; i<myNoOfEmitters; i++, e++) {
 		e->Source = GetLocusAddress(EMITTER, e->IDOrgan, e->IDTissue, e->IDLocus);
 	}
+	BuildProcessTables();
+}
+
+
+/*********************************************************************
+* Protected: BuildProcessTables.
+* Copies the receptors, emitters and reactions into the flat arrays
+* used by ProcessAll() and ProcessReceptors().  Must be called again
+* whenever any of them (or their loci) change.
+*********************************************************************/
+void Organ::BuildProcessTables()
+{
+	int i, g;
+
+	// Receptors without a chemical take no part in the sums, so only
+	// the used ones go in the table.  Each group still writes its locus.
+	int n = 0;
+	for (g = 0; g < myNoOfReceptorGroups; g++)
+	{
+		Receptors& rGroup = myReceptorGroups[g];
+		myReceptorGroupStart[g] = n;
+		myReceptorGroupDest[g] = NULL;
+		myReceptorGroupIsClockRate[g] = false;
+		myReceptorGroupIsDeathLocus[g] = false;
+		if (rGroup.empty())
+			continue;
+
+		// All receptors in a group share the same locus
+		Receptor* r = rGroup.back();
+		myReceptorGroupDest[g] = r->Dest;
+		myReceptorGroupIsClockRate[g] = r->isClockRateReceptor;
+		myReceptorGroupIsDeathLocus[g] = r->IDOrgan==ORGAN_CREATURE &&
+			r->IDTissue==TISSUE_IMMUNE && r->IDLocus==LOC_DIE;
+
+		for (int j = 0; j < rGroup.size(); j++)
+		{
+			r = rGroup[j];
+			if (!r->Chem)
+				continue;
+			ASSERT(n < MAXRECEPTORS);
+			if (n == MAXRECEPTORS)
+				break;
+			myTableReceptorChem[n] = r->Chem;
+			myTableReceptorThreshold[n] = r->Threshold;
+			myTableReceptorNominal[n] = r->Nominal;
+			myTableReceptorGain[n] = r->Gain;
+			myTableReceptorEffect[n] = r->Effect;
+			myTableReceptorDigital[n] = (r->Effect & RE_DIGITAL) ? -1 : 0;
+			n++;
+		}
+	}
+	myReceptorGroupStart[myNoOfReceptorGroups] = n;
+
+	Emitter* e;
+	for (i = 0, e = myEmitters; i < myNoOfEmitters; i++, e++)
+	{
+		myTableEmitterChem[i] = e->Chem;
+		myTableEmitterThreshold[i] = e->Threshold;
+		myTableEmitterGain[i] = e->Gain;
+		myTableEmitterTickRate[i] = e->bioTickRate;
+		myTableEmitterEffect[i] = e->Effect;
+		myTableEmitterSource[i] = e->Source;
+	}
+
+	Reaction* rn;
+	for (i = 0, rn = myReactions; i < myNoOfReactions; i++, rn++)
+	{
+		int* chem = &myTableReactionChem[i*4];
+		float* prop = &myTableReactionProp[i*4];
+		chem[0] = rn->R1;	prop[0] = rn->propR1;
+		chem[1] = rn->R2;	prop[1] = rn->propR2;
+		chem[2] = rn->P1;	prop[2] = rn->propP1;
+		chem[3] = rn->P2;	prop[3] = rn->propP2;
+
+		// rn->Rate is 0 for slow, 1 for fast (reverse from when loaded in from the genome!)
+		float inputFloat = (1.0f-rn->Rate)*32.0f;
+		float halfLifeInTicks = powf(2.2f, inputFloat);
+		myTableReactionLastRate[i] = rn->Rate;
+		myTableReactionFactor[i] = 1.0f - powf(0.5f, 1.0f/halfLifeInTicks);
+	}
 }
 
 /*********************************************************************
@@ -249,6 +330,7 @@ bool Organ::Read(CreaturesArchive &archive)
 			archive.ReadFloatRef( e->Source );
 		}
 		archive >> myBiochemistryOwner;
+		BuildProcessTables();
 	}
 	else
 	{
@@ -622,29 +704,32 @@ bool Organ::ProcessAll() {
 
 	int i;
 	float conc, sig;
-	Emitter* e;
 
 	try {
 		// First, update all emitters from their source loci
-		for	(i = 0, e = myEmitters; i < myNoOfEmitters; i++, e++) {
+		for	(i = 0; i < myNoOfEmitters; i++) {
+			float* source = myTableEmitterSource[i];
+			int effect = myTableEmitterEffect[i];
+
 			// Invert signal if required.
-			sig = (e->Effect & EM_INVERT) ? 1.0f-*e->Source : *e->Source; 
+			sig = (effect & EM_INVERT) ? 1.0f-*source : *source; 
 
 			// If there's any signal at locus, and it's time to emit...
-			e->bioTick += e->bioTickRate;
-			if (e->bioTick > 1.0f) {
-				e->bioTick -= 1.0f;
+			float& tick = myEmitters[i].bioTick;
+			tick += myTableEmitterTickRate[i];
+			if (tick > 1.0f) {
+				tick -= 1.0f;
 				if (sig) {
-					if ((conc = sig - e->Threshold) > 0) {			// no o/p if sig<threshold
+					if ((conc = sig - myTableEmitterThreshold[i]) > 0) {	// no o/p if sig<threshold
 						// If response is digital then o/p = gain regardless of signal.
 						// If response is analogue then o/p is proportional to signal.
-						if (e->Effect & EM_DIGITAL)					
-							myBiochemistryOwner->AddChemical(e->Chem,e->Gain);
+						if (effect & EM_DIGITAL)					
+							myBiochemistryOwner->AddChemical(myTableEmitterChem[i],myTableEmitterGain[i]);
 						else										
-							myBiochemistryOwner->AddChemical(e->Chem,conc * e->Gain);
+							myBiochemistryOwner->AddChemical(myTableEmitterChem[i],conc * myTableEmitterGain[i]);
 
-						if (e->Effect & EM_REMOVE)					// wipe locus if reqd
-							*e->Source = 0;
+						if (effect & EM_REMOVE)					// wipe locus if reqd
+							*source = 0;
 
 						workWasDone |= true;
 					}
@@ -653,9 +738,7 @@ bool Organ::ProcessAll() {
 		}
 
 		// Next, update all reaction sites.
-		for	(i=0; i<myNoOfReactions; i++) {
-			workWasDone |= ProcessReaction(i);
-		}
+		workWasDone |= ProcessReactions();
 	}
 	catch(...) 
 	{	
@@ -668,12 +751,36 @@ bool Organ::ProcessAll() {
 // Update all receptors to modulate their loci...
 bool Organ::ProcessReceptors(bool onlyDoClockRateReceptors) {
 	bool workWasDone = false;
-	Receptor* r;
+	const float* chemicals = myBiochemistryOwner->GetChemicalConcs();
+
+	// Sample all the chemicals first (just the clock-rate groups' ones
+	// when that's all that is wanted, below)
+	float signals[MAXRECEPTORS];
+	if (!onlyDoClockRateReceptors)
+		Biochemistry::SampleReceptors(chemicals, myTableReceptorChem,
+			myTableReceptorThreshold, myTableReceptorGain, myTableReceptorDigital,
+			signals, 0, myReceptorGroupStart[myNoOfReceptorGroups]);
 
 	// Process each group of receptors (that share a locus)...
 	for	(int g = 0; g < myNoOfReceptorGroups; g++) {
-		Receptors& rGroup = myReceptorGroups[g];
-		int noOfReceptorsProcessed = 0;
+		float* dest = myReceptorGroupDest[g];
+		if (!dest)
+			continue;
+
+		if (onlyDoClockRateReceptors && !myReceptorGroupIsClockRate[g])
+			continue;		// these receptors are not clock-rate receptors
+							// so don't update them now
+
+		int first = myReceptorGroupStart[g];
+		int last = myReceptorGroupStart[g+1];
+		int noOfReceptorsProcessed = last - first;
+		if (onlyDoClockRateReceptors && noOfReceptorsProcessed==0)
+			continue;
+		if (onlyDoClockRateReceptors)
+			Biochemistry::SampleReceptors(chemicals, myTableReceptorChem,
+				myTableReceptorThreshold, myTableReceptorGain, myTableReceptorDigital,
+				signals, first, last);
+
 		float totalOfAllNominals = 0.0f;
 		int noOfTermsToAdd = 0;
 		int noOfTermsToSub = 0;
@@ -681,45 +788,21 @@ bool Organ::ProcessReceptors(bool onlyDoClockRateReceptors) {
 		float termToSubSoFar = 0.0f;
 
 		// Sum the changes the receptors make to the locus...
-		for (int rIndex=0; rIndex<rGroup.size(); rIndex++) {
-			r = rGroup[rIndex];
-			ASSERT(r->Dest);
-
-
-			if (r->isClockRateReceptor==false && onlyDoClockRateReceptors)
-				break;		// these receptors are not clock-rate receptors
-							// so don't update them now
-
-			if (r->Chem) {										 // if receptor is used...
-				workWasDone |= true;
-
-				noOfReceptorsProcessed++;
-				totalOfAllNominals += r->Nominal;
-
-				float inputSignal =
-					myBiochemistryOwner->GetChemical(r->Chem) - // get current chemical concentration
-					r->Threshold; 								// get excess of conc over threshold
-				if (inputSignal<0.0f) inputSignal=0.0f;			// ignore changes below threshold
-
-				if (inputSignal) {						
-					if (r->Effect & RE_DIGITAL)		// If response is digital
-						inputSignal = r->Gain;		// then o/p = gain regardless of signal
-					else							// If response is analogue
-						inputSignal *= r->Gain;		// then o/p is proportional to sig
-				}
-
-				if (r->Effect & RE_REDUCE) {		// add or subtract from nominal, 
-					termToSubSoFar += inputSignal;
-					noOfTermsToSub++;
-				} else {
-					termToAddSoFar += inputSignal;
-					noOfTermsToAdd++;
-				}
+		for (int i = first; i < last; i++) {
+			totalOfAllNominals += myTableReceptorNominal[i];
 
+			float inputSignal = signals[i];
+			if (myTableReceptorEffect[i] & RE_REDUCE) {		// add or subtract from nominal, 
+				termToSubSoFar += inputSignal;
+				noOfTermsToSub++;
+			} else {
+				termToAddSoFar += inputSignal;
+				noOfTermsToAdd++;
 			}
 		}
-		if (onlyDoClockRateReceptors && noOfReceptorsProcessed==0)
-			continue;
+		if (noOfReceptorsProcessed>0)
+			workWasDone |= true;
+
 		float result = 0.0f;
 		if (noOfReceptorsProcessed>0)
 			result = totalOfAllNominals/(float)noOfReceptorsProcessed;
@@ -729,56 +812,65 @@ bool Organ::ProcessReceptors(bool onlyDoClockRateReceptors) {
 			result = BoundedSub(result, termToSubSoFar/(float)noOfTermsToSub);
 
 		// for trigger death locus do an OR:
-		if (r->IDOrgan==ORGAN_CREATURE && r->IDTissue==TISSUE_IMMUNE && r->IDLocus==LOC_DIE)
+		if (myReceptorGroupIsDeathLocus[g])
 		{
 			result = (totalOfAllNominals + termToAddSoFar - termToSubSoFar)>0.0f ? 1.0f : 0.0f;
 		}
-		*r->Dest = result;
+		*dest = result;
 	}
 	return workWasDone;
 }
 
 
 /*********************************************************************
-* Protected: ProcessReaction.
+* Protected: ProcessReactions.
 *********************************************************************/
-bool Organ::ProcessReaction(int iIndex)
+bool Organ::ProcessReactions()
 {
     ASSERT(myBiochemistryOwner); 
 
-    float avail = 1.0f, avail2 = 1.0f;
-	Reaction* rn = &myReactions[iIndex];
 	bool workWasDone = false;
+	const int* chem = myTableReactionChem;
+	const float* prop = myTableReactionProp;
 
-	if (rn->R1) // amount of R or 2R or 3R in blood
-		avail = myBiochemistryOwner->GetChemical(rn->R1) / rn->propR1;
-	if (rn->R2) // (if reactant not reqd, assume 1)
-		avail2 = myBiochemistryOwner->GetChemical(rn->R2) / rn->propR2;	
-
-	if (avail2 < avail)									// amount available for reaction is
-		avail = avail2;									// the lesser of the two reactants
-
-	if (avail) {
-		// rn->Rate is 0 for slow, 1 for fast (reverse from when loaded in from the genome!)
-		float inputFloat = (1.0f-rn->Rate)*32.0f;
-		float halfLifeInTicks = powf(2.2f, inputFloat);
-		float rate = 1.0f - powf(0.5f, 1.0f/halfLifeInTicks);
+	for (int i = 0; i < myNoOfReactions; i++, chem += 4, prop += 4)
+	{
+		float avail = 1.0f, avail2 = 1.0f;
+
+		if (chem[0]) // amount of R or 2R or 3R in blood
+			avail = myBiochemistryOwner->GetChemical(chem[0]) / prop[0];
+		if (chem[1]) // (if reactant not reqd, assume 1)
+			avail2 = myBiochemistryOwner->GetChemical(chem[1]) / prop[1];	
+
+		if (avail2 < avail)									// amount available for reaction is
+			avail = avail2;									// the lesser of the two reactants
+
+		if (avail) {
+			// The rate is a receptor locus, so may have moved since last time
+			float reactionRate = myReactions[i].Rate;
+			if (reactionRate != myTableReactionLastRate[i]) {
+				// rate is 0 for slow, 1 for fast (reverse from when loaded in from the genome!)
+				float inputFloat = (1.0f-reactionRate)*32.0f;
+				float halfLifeInTicks = powf(2.2f, inputFloat);
+				myTableReactionLastRate[i] = reactionRate;
+				myTableReactionFactor[i] = 1.0f - powf(0.5f, 1.0f/halfLifeInTicks);
+			}
 
-		avail *= rate;													// see how much reacts this tick
+			avail *= myTableReactionFactor[i];					// see how much reacts this tick
 																		// rate=1 says all (i.e.fast)
 																		// rate=0 says none (i.e.slow)
 
-		myBiochemistryOwner->SubChemical(rn->R1, avail * rn->propR1);	// reduce any reactants by this much
-		myBiochemistryOwner->SubChemical(rn->R2, avail * rn->propR2);	// modulated by proportions [19/2/96]
-		
-		myBiochemistryOwner->AddChemical(rn->P1, avail * rn->propP1);	// increase any products by this much
-		myBiochemistryOwner->AddChemical(rn->P2, avail * rn->propP2);	// (in proportion as specified) 
+			myBiochemistryOwner->SubChemical(chem[0], avail * prop[0]);	// reduce any reactants by this much
+			myBiochemistryOwner->SubChemical(chem[1], avail * prop[1]);	// modulated by proportions [19/2/96]
+			
+			myBiochemistryOwner->AddChemical(chem[2], avail * prop[2]);	// increase any products by this much
+			myBiochemistryOwner->AddChemical(chem[3], avail * prop[3]);	// (in proportion as specified) 
 
-		workWasDone = true;
+			workWasDone = true;
+		}
 	}
 
 	return workWasDone;
-
 }
 
 
@@ -81,8 +81,9 @@ protected:
 	void DecayLifeForce();
 	virtual bool RepairInjury(bool bEnergyAvailable);
 	bool ProcessAll();
-	bool ProcessReaction(int iIndex);
+	bool ProcessReactions();
 	bool ProcessReceptors(bool onlyDoClockRateReceptors);
+	void BuildProcessTables();
 
 	Biochemistry* myBiochemistryOwner;
 
@@ -110,6 +111,42 @@ protected:
 	int myNoOfEmitters;							// # active emitters
 	int myNoOfReactions;						// # active reaction sites
 
+	// Flattened copies of the receptors, emitters and reactions above,
+	// rebuilt by BuildProcessTables() whenever the loci are bound, so
+	// the per-tick loops walk plain arrays instead of chasing pointers.
+	// None of this is serialised.  Anything that changes as the organ
+	// runs (like an emitter's bioTick) stays where it was, so that
+	// rebinding the loci doesn't lose it.
+
+	// Receptors with a chemical, in group order.  Group g uses entries
+	// myReceptorGroupStart[g] to myReceptorGroupStart[g+1]-1.
+	int myTableReceptorChem[MAXRECEPTORS];
+	float myTableReceptorThreshold[MAXRECEPTORS];
+	float myTableReceptorNominal[MAXRECEPTORS];
+	float myTableReceptorGain[MAXRECEPTORS];
+	int myTableReceptorEffect[MAXRECEPTORS];
+	int myTableReceptorDigital[MAXRECEPTORS];	// -1 if RE_DIGITAL, else 0
+	int myReceptorGroupStart[MAXRECEPTORGROUPS+1];
+	float* myReceptorGroupDest[MAXRECEPTORGROUPS];
+	bool myReceptorGroupIsClockRate[MAXRECEPTORGROUPS];
+	bool myReceptorGroupIsDeathLocus[MAXRECEPTORGROUPS];
+
+	int myTableEmitterChem[MAXEMITTERS];
+	float myTableEmitterThreshold[MAXEMITTERS];
+	float myTableEmitterGain[MAXEMITTERS];
+	float myTableEmitterTickRate[MAXEMITTERS];
+	int myTableEmitterEffect[MAXEMITTERS];
+	float* myTableEmitterSource[MAXEMITTERS];
+
+	// Reactant and product chemicals packed R1,R2,P1,P2 per reaction,
+	// with matching proportions.  The rate stays in myReactions as it
+	// is a receptor locus; the decay factor worked out from it is only
+	// recalculated when it changes.
+	int myTableReactionChem[MAXREACTIONS*4];
+	float myTableReactionProp[MAXREACTIONS*4];
+	float myTableReactionLastRate[MAXREACTIONS];
+	float myTableReactionFactor[MAXREACTIONS];
+
 	static const float myBaseOrganADPCost;
 	static const float myRateOfDecay;
 	static const float myBaseLifeForce;
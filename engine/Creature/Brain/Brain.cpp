@@ -21,6 +21,14 @@ CREATURES_IMPLEMENT_SERIAL(Brain)
 
 Lobe Brain::ourDummyLobe;
 
+// Tokens for each Brain::LobeHandle, in order
+const char* Brain::ourLobeHandleTokens[Brain::noOfLobeHandles] =
+{
+	"situ", "detl", "driv", "visn", "elvn", "smel",
+	"noun", "verb", "resp", "prox", "attn", "decn",
+	"forf"
+};
+
 
 
 // Offset into Brain.catalogue to access "Brain Parameters" fields
@@ -43,6 +51,12 @@ Brain::Brain()
 	myPointerToChemicals = NULL;
 	myInstinctsAreBeingProcessed = false;
 	myLastKnowledgeUpdated = 0;
+
+	// each brain has its own random stream so that it can be updated
+	// on any thread without disturbing anyone else's numbers
+	myRandomState = RandQD1::rand();
+
+	ResolveLobeHandles();
 	instinctChemicalNumber = atoi( theCatalogue.Get( "Brain Parameters", INSTINCT_CHEMICAL_NUMBER ) );
 	preInstinctChemicalNumber = atoi( theCatalogue.Get( "Brain Parameters", PREINSTINCT_CHEMICAL_NUMBER ) );
 }
@@ -110,6 +124,7 @@ void Brain::ReadFromGenome(Genome &genome)
 			break;
 		}
 	}
+	ResolveLobeHandles();
 
 	genome.Reset();
 	while (genome.GetGeneType(BRAINGENE,G_TRACT,NUMBRAINSUBTYPES))
@@ -138,6 +153,7 @@ void Brain::ReadFromGenome(Genome &genome)
 	for (int i=0; i<myBrainComponents.size(); i++)
 	{
 		myBrainComponents[i]->RegisterBiochemistry(myPointerToChemicals);
+		myBrainComponents[i]->RegisterRandomState(&myRandomState);
 		myBrainComponents[i]->Initialise();
 	}
 
@@ -158,6 +174,27 @@ void Brain::ReadFromGenome(Genome &genome)
 }
 
 
+// ------------------------------------------------------------------------
+// Function:    CheckCompiledRules
+// Class:       Brain
+// Description: Checks every lobe's and tract's SV-Rules with
+//				BrainComponent::CheckCompiledRules.
+// Arguments:   int& noOfComponents = set to the number checked
+// Returns:     int = number of components that failed
+// ------------------------------------------------------------------------
+int Brain::CheckCompiledRules(int& noOfComponents)
+{
+	noOfComponents = myBrainComponents.size();
+	int failed = 0;
+	for (int i=0; i<myBrainComponents.size(); i++)
+	{
+		if (!myBrainComponents[i]->CheckCompiledRules())
+			failed++;
+	}
+	return failed;
+}
+
+
 // ------------------------------------------------------------------------
 // Function:    GetNoOfInstinctsLeftToProcess
 // Class:       Brain
@@ -225,6 +262,7 @@ bool Brain::InitLobeFromDescription(std::istream &in)
 	}
 	if (myLobes.size()==MAX_LOBES) {
 	}
+	ResolveLobeHandles();
 
 
 	// sort brain components according to updateAtTime field:
@@ -279,7 +317,7 @@ bool Brain::InitTractFromDescription(std::istream &in)
 // Class:       Brain
 // Description: Give the brain a pointer to the biochemicals so that it can
 //				use them to signal instinct processing and reference their values in SV-Rules
-//				as need be.
+//				as need be.  Components are also pointed at the brain's random stream.
 // Arguments:   float* chemicals = an array of 256 floats (chemical concentrations).
 // ------------------------------------------------------------------------
 void Brain::RegisterBiochemistry(float* chemicals)
@@ -290,6 +328,7 @@ void Brain::RegisterBiochemistry(float* chemicals)
 	for (int i=0; i<myBrainComponents.size(); i++)
 	{
 		myBrainComponents[i]->RegisterBiochemistry(myPointerToChemicals);
+		myBrainComponents[i]->RegisterRandomState(&myRandomState);
 	}
 
 }
@@ -418,26 +457,21 @@ void Brain::Update()
 	
 
 	// next process help knowledge at same time
-	int noNeurons = GetLobeFromTokenString("driv")->GetNoOfNeurons();
+	int noNeurons = GetLobeSize(drivLobe);
 	
 	if(myLastKnowledgeUpdated>=0 && myLastKnowledgeUpdated<noNeurons)
 	{
 		ClearActivity();
 
-		int noNounNeurons = GetLobeFromTokenString("noun")->GetNoOfNeurons();
-		for(int s = 0; s != noNounNeurons; s++)
-			SetInput("noun", s, 0.5f);
+		myLobeHandles[nounLobe]->SetLobeWideInput(0.5f);
+		myLobeHandles[visnLobe]->SetLobeWideInput(0.1f);
 
-		int noVisionNeurons = GetLobeFromTokenString("visn")->GetNoOfNeurons();
-		for(int v = 0; v != noVisionNeurons; v++)
-			SetInput("visn", v, 0.1f);	
-
-		SetInput("driv", myLastKnowledgeUpdated, 1.0f);
+		SetInput(drivLobe, myLastKnowledgeUpdated, 1.0f);
 		UpdateComponents();
-		myAssistanceKnowledge[myLastKnowledgeUpdated].attentionId = GetWinningId("attn");
-		myAssistanceKnowledge[myLastKnowledgeUpdated].decisionId = GetWinningId("decn");
-		myAssistanceKnowledge[myLastKnowledgeUpdated].strength = GetLobeFromTokenString("decn")->
-			GetNeuronState(myAssistanceKnowledge[myLastKnowledgeUpdated].decisionId, STATE_VAR);
+		myAssistanceKnowledge[myLastKnowledgeUpdated].attentionId = GetWinningId(attnLobe);
+		myAssistanceKnowledge[myLastKnowledgeUpdated].decisionId = GetWinningId(decnLobe);
+		myAssistanceKnowledge[myLastKnowledgeUpdated].strength = 
+			GetNeuronState(decnLobe, myAssistanceKnowledge[myLastKnowledgeUpdated].decisionId, STATE_VAR);
 		myLastKnowledgeUpdated++;
 
 		if(myLastKnowledgeUpdated == noNeurons)
@@ -599,9 +633,10 @@ void Brain::SetNeuronState(const char* lobeTokenString, const int neuron, const
 // ------------------------------------------------------------------------
 Lobe* Brain::GetLobeFromTokenString(const char *lobeTokenString)
 {
+	TOKEN token = Tokenize(lobeTokenString);
 	for (Lobes::iterator l=myLobes.begin(); l!=myLobes.end(); l++)
 	{
-		if ((*l)->GetToken() == Tokenize(lobeTokenString))
+		if ((*l)->GetToken() == token)
 		{
 			return *l;
 		}
@@ -609,6 +644,20 @@ Lobe* Brain::GetLobeFromTokenString(const char *lobeTokenString)
 	return &ourDummyLobe;						// didn't find this lobe
 }
 
+// ------------------------------------------------------------------------
+// Function:    ResolveLobeHandles
+// Class:       Brain
+// Description: Looks up the lobe for each LobeHandle.  Call whenever
+//				lobes are added to the brain.
+// ------------------------------------------------------------------------
+void Brain::ResolveLobeHandles()
+{
+	for (int i=0; i<noOfLobeHandles; i++)
+	{
+		myLobeHandles[i] = GetLobeFromTokenString(ourLobeHandleTokens[i]);
+	}
+}
+
 // ------------------------------------------------------------------------
 // Function:    GetLobeSize
 // Class:       Brain
@@ -754,6 +803,7 @@ bool Brain::Write(CreaturesArchive &archive) const
 
 	archive << myInstinctsAreBeingProcessed;
 	archive << myInstincts;
+	archive << (uint32)myRandomState;
 
 	archive << myLastKnowledgeUpdated;
 	archive << (int)myAssistanceKnowledge.size();
@@ -785,9 +835,18 @@ bool Brain::Read(CreaturesArchive &archive)
 
 		archive >> myLobes >> myTracts;
 		archive >> myBrainComponents;
+		ResolveLobeHandles();
 
 		archive >> myInstinctsAreBeingProcessed;
 		archive >> myInstincts;
+		if(version >= 13)
+		{
+			uint32 randomState;
+			archive >> randomState;
+			myRandomState = randomState;
+		}
+		else
+			myRandomState = RandQD1::rand();
 	
 		archive >> myLastKnowledgeUpdated;
 		int size;
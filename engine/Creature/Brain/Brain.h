@@ -52,6 +52,7 @@ public:
 	// Faculty functions for creating and updating the brain:
 	virtual void ReadFromGenome(Genome& genome) ;
 	virtual void Update();
+	virtual bool IsSelfContained() {return true;}
 
 
 	// Biochemistry:
@@ -75,6 +76,29 @@ public:
 	int GetWinningId(const char* lobeTokenString);
 
 
+	// Handles for the lobes the engine itself talks to.  These are looked
+	// up whenever the brain's lobes change, so the faculties can use them
+	// every update without searching by token.  A missing lobe maps to a
+	// dummy with no neurons, as with the token string functions.
+	enum LobeHandle {
+		situLobe=0, detlLobe, drivLobe, visnLobe, elvnLobe, smelLobe,
+		nounLobe, verbLobe, respLobe, proxLobe, attnLobe, decnLobe,
+		forfLobe, noOfLobeHandles
+	};
+	inline void SetInput(LobeHandle lobe, int whichNeuron, float toWhat) {
+		myLobeHandles[lobe]->SetNeuronInput(whichNeuron, toWhat);
+	}
+	inline int GetWinningId(LobeHandle lobe) {
+		return myLobeHandles[lobe]->GetWhichNeuronWon();
+	}
+	inline float GetNeuronState(LobeHandle lobe, const int neuron, const int state) {
+		return myLobeHandles[lobe]->GetNeuronState(neuron, state);
+	}
+	inline int GetLobeSize(LobeHandle lobe) {
+		return myLobeHandles[lobe]->GetNoOfNeurons();
+	}
+
+
 	// Vat Kit init functions:
 	bool InitLobeFromDescription(std::istream &in) ;
 	bool InitTractFromDescription(std::istream &in) ;
@@ -91,6 +115,11 @@ public:
 	char* GetLobeNameFromTissueId(int tissueId);
 
 
+	// Returns how many lobes and tracts have SV-Rules whose compiled
+	// form doesn't match the interpreter, and how many there are
+	int CheckCompiledRules(int& noOfComponents);
+
+
 	// Serialisation:
 	virtual bool Write(CreaturesArchive &archive) const;
 	virtual bool Read(CreaturesArchive &archive);
@@ -112,10 +141,12 @@ public:
 protected:
 	Lobe* GetLobeFromTokenString(const char* lobeTokenString);
 	Lobe* GetLobeFromTissueId(int tissueId);
+	void ResolveLobeHandles();
 
 	bool myInstinctsAreBeingProcessed;
 	Instincts myInstincts;
 	float *myPointerToChemicals;
+	unsigned int myRandomState;		// the brain's own stream for SV-Rules
 	int instinctChemicalNumber;
 	int preInstinctChemicalNumber;
 
@@ -126,6 +157,9 @@ protected:
 	std::vector<KnowledgeAction> myAssistanceKnowledge;
 	int myLastKnowledgeUpdated;
 
+	Lobe* myLobeHandles[noOfLobeHandles];
+	static const char* ourLobeHandleTokens[noOfLobeHandles];
+
 	static Lobe ourDummyLobe;
 };
 #endif//Brain_H
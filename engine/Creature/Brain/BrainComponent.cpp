@@ -48,6 +48,37 @@ void BrainComponent::RegisterBiochemistry(float* chemicals)
 
 
 
+// ------------------------------------------------------------------------
+// Function:    RegisterRandomState
+// Class:       BrainComponent
+// Description: Makes the SV-Rules draw random numbers from the given
+//				generator state rather than the global one.
+// Arguments:   unsigned int* state = 
+// ------------------------------------------------------------------------
+void BrainComponent::RegisterRandomState(unsigned int* state)
+{
+	myInitRule.RegisterRandomState(state);
+	myUpdateRule.RegisterRandomState(state);
+}
+
+
+
+// ------------------------------------------------------------------------
+// Function:    CheckCompiledRules
+// Class:       BrainComponent
+// Description: Runs SVRule::CheckCompiledRule on both rules.  Release
+//				builds don't do this as the rules are compiled.
+// Returns:     bool = true if they agree
+// ------------------------------------------------------------------------
+bool BrainComponent::CheckCompiledRules()
+{
+	bool initAgrees = myInitRule.CheckCompiledRule();
+	bool updateAgrees = myUpdateRule.CheckCompiledRule();
+	return initAgrees && updateAgrees;
+}
+
+
+
 // ------------------------------------------------------------------------
 // Function:    xIsProcessedBeforeY
 // Class:       BrainComponent
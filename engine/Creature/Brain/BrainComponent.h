@@ -27,6 +27,7 @@ public:
 	virtual void TraceDebugInformation() {}
 	virtual void Initialise() {};
 	void RegisterBiochemistry(float* chemicals);
+	void RegisterRandomState(unsigned int* state);
 
 	virtual bool Write(CreaturesArchive &archive) const;
 	virtual bool Read(CreaturesArchive &archive);
@@ -40,6 +41,9 @@ public:
 
 	inline bool SupportsReinforcement() {	return mySupportReinforcementFlag;}
 
+	// true if both SV-Rules' compiled forms match the interpreter
+	bool CheckCompiledRules();
+
 protected:
 	int myIdInList;
 
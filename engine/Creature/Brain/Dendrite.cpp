@@ -52,9 +52,15 @@ Dendrite::Dendrite()
 // ------------------------------------------------------------------------
 void Dendrite::InitByRule(SVRule& initRule, Tract* myOwner)
 {
+	// local scratch rather than SVRule::invalidVariables, as this is also
+	// run during migration and brains may be updated on several threads
+	SVRuleVariables unused;
+	for (int i=0; i<NUM_SVRULE_VARIABLES; i++)
+		unused[i] = 0.0f;
+
 	initRule.ProcessGivenVariables(
-		SVRule::invalidVariables, weights, SVRule::invalidVariables,
-		SVRule::invalidVariables,
+		unused, weights, unused,
+		unused,
 		srcNeuron->idInList, dstNeuron->idInList, (BrainComponent*) myOwner
 	);
 }
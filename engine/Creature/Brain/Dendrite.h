@@ -24,6 +24,13 @@ struct Dendrite
 {
 	int idInList;
 
+	// These point into the lobes' neuron blocks, which are allocated
+	// once when a lobe is made or read and never moved or resized, so
+	// they stay good for the life of the brain.  They're kept as
+	// pointers rather than neuron numbers because Tract's wiring and
+	// migration code compares and passes them about throughout, and an
+	// update reaching a neuron through one costs no more than through
+	// the lobe's block plus an index would.
 	Neuron* srcNeuron;
 	Neuron* dstNeuron;
 
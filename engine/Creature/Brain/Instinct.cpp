@@ -78,8 +78,8 @@ bool Instinct::Process()
 
 		if (lobeName == std::string("noun"))
 		{
-			myBrain->SetInput("visn", myInputs[i].neuronId, 0.1f);	// make sure you can see this object
-			myBrain->SetInput("smel", myInputs[i].neuronId, 1.0f);	// and smell it too
+			myBrain->SetInput(Brain::visnLobe, myInputs[i].neuronId, 0.1f);	// make sure you can see this object
+			myBrain->SetInput(Brain::smelLobe, myInputs[i].neuronId, 1.0f);	// and smell it too
 		}
 
 		myBrain->SetInput(lobeName.c_str(), myInputs[i].neuronId, 1.0f);
@@ -87,16 +87,16 @@ bool Instinct::Process()
 
 
 	// try get the creature to do what the instinct suggests:
-	myBrain->SetInput("verb", myDecisionId, 1.0f);
+	myBrain->SetInput(Brain::verbLobe, myDecisionId, 1.0f);
 	myBrain->UpdateComponents();
 
 	// if we didn't manage to force the creature to do that assume this instinct
 	// isn't valid for this brain and don't process it:
-	if (myBrain->GetWinningId("decn")!=myDecisionId)
+	if (myBrain->GetWinningId(Brain::decnLobe)!=myDecisionId)
 		return true;
 
 	// otherwise send in the reward:
-	myBrain->SetInput("resp", myReinforcement.driveId, REINFORCEMENT_MODIFIER*myReinforcement.amount);
+	myBrain->SetInput(Brain::respLobe, myReinforcement.driveId, REINFORCEMENT_MODIFIER*myReinforcement.amount);
 	myBrain->UpdateComponents();
 
 	return true;
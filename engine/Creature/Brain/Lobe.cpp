@@ -30,6 +30,7 @@ Lobe::Lobe()
 {
 	myWinningNeuronId = 0;
 	myNeuronInput = NULL;
+	myNeuronStorage = NULL;
 }
 
 // ------------------------------------------------------------------------
@@ -42,6 +43,7 @@ Lobe::Lobe(Genome &genome)
 {
 	myWinningNeuronId = 0;
 	myNeuronInput = NULL;
+	myNeuronStorage = NULL;
 	// GENOME READING:
 
 	// update and ID:
@@ -87,13 +89,10 @@ Lobe::Lobe(Genome &genome)
 
 	// init neurons:
 	myNeuronInput = new float[noOfNeurons];
+	AllocateNeurons(noOfNeurons);
 	for (int i=0; i<noOfNeurons; i++)
 	{
 		myNeuronInput[i] = 0.0f;
-
-		Neuron* n = new Neuron();
-		n->idInList = i;
-		myNeurons.push_back(n);
 	}
 
 	// init spare neuron variables to first neuron (default)
@@ -101,6 +100,30 @@ Lobe::Lobe(Genome &genome)
 }
 
 
+// ------------------------------------------------------------------------
+// Function:    AllocateNeurons
+// Class:       Lobe
+// Description: Creates the lobe's neurons as one block and points
+//				myNeurons at them.  Neurons are numbered in order.
+// Arguments:   int noOfNeurons = 
+// ------------------------------------------------------------------------
+void Lobe::AllocateNeurons(int noOfNeurons)
+{
+	ASSERT(myNeuronStorage == NULL);
+
+	myNeuronStorage = new Neuron[noOfNeurons];
+	myNeurons.resize(noOfNeurons);
+	for (int i=0; i<noOfNeurons; i++)
+	{
+		myNeuronStorage[i].idInList = i;
+		myNeurons[i] = &myNeuronStorage[i];
+	}
+
+	for (int v=0; v<NUM_SVRULE_VARIABLES; v++)
+		myInputVariables[v] = 0.0f;
+}
+
+
 // ------------------------------------------------------------------------
 // Function:    Initialise
 // Class:       Lobe
@@ -138,6 +161,8 @@ void Lobe::Initialise()
 // Arguments:   std::istream &in = 
 // ------------------------------------------------------------------------
 Lobe::Lobe(std::istream &in) {
+	myNeuronStorage = NULL;
+
 	// DESCRIPTION READING:
 
 	// update and ID:
@@ -176,15 +201,14 @@ Lobe::Lobe(std::istream &in) {
 
 	// init neurons:
 	myNeuronInput = new float[noOfNeurons];
+	AllocateNeurons(noOfNeurons);
 	for (int i=0; i<noOfNeurons; i++) {
 		ReadDesc(&myNeuronInput[i], in);
 
-		Neuron* n = new Neuron();
+		Neuron* n = myNeurons[i];
 		ReadDesc(&n->idInList, in);
 		for(int s = 0; s != NUM_SVRULE_VARIABLES; s++)
 			ReadDesc(&n->states[s], in);
-
-		myNeurons.push_back(n);
 	}
 
 	// init spare neuron variables to first neuron (default)
@@ -199,9 +223,10 @@ Lobe::Lobe(std::istream &in) {
 // ------------------------------------------------------------------------
 Lobe::~Lobe()
 {
-	for (Neurons::iterator n=myNeurons.begin(); n!=myNeurons.end(); n++)
+	if (myNeuronStorage)
 	{
-		delete *n;
+		delete [] myNeuronStorage;
+		myNeuronStorage = NULL;
 	}
 
 	if (myNeuronInput)
@@ -227,11 +252,12 @@ void Lobe::DoUpdate()
 	
 	myWinningNeuronId = 0;
 
-	for (int i=0; i<myNeurons.size(); i++)
+	int noOfNeurons = myNeurons.size();
+	for (int i=0; i<noOfNeurons; i++)
 	{
-		Neuron& n = *(myNeurons[i]);
+		Neuron& n = myNeuronStorage[i];
 
-		SVRule::invalidVariables[0] = myNeuronInput[i];	// (for input lobes)
+		myInputVariables[0] = myNeuronInput[i];	// (for input lobes)
 		myNeuronInput[i] = 0.0f;						// reset to build up until next processed.
 
 		int returnCode;
@@ -240,7 +266,7 @@ void Lobe::DoUpdate()
 		if( myRunInitRuleAlwaysFlag )
 		{
 			returnCode = myInitRule.ProcessGivenVariables(
-				SVRule::invalidVariables, SVRule::invalidVariables, n.states,
+				myInputVariables, myInputVariables, n.states,
 				*mySpareNeuronVariables, n.idInList, n.idInList
 			);
 			if (returnCode==SVRule::setSpareNeuronToCurrent)
@@ -248,7 +274,7 @@ void Lobe::DoUpdate()
 		}
 
 		returnCode = myUpdateRule.ProcessGivenVariables(
-			SVRule::invalidVariables, SVRule::invalidVariables, n.states,
+			myInputVariables, myInputVariables, n.states,
 			*mySpareNeuronVariables, n.idInList, n.idInList
 		);
 		if (returnCode==SVRule::setSpareNeuronToCurrent)
@@ -319,16 +345,6 @@ void Lobe::DoUpdateNeuronFromDesc(int i, std::istream &in) {
 }
 
 
-// ------------------------------------------------------------------------
-// Function:    GetWhichNeuronWon
-// Class:       Lobe
-// Description: 
-// Returns:     int = 
-// ------------------------------------------------------------------------
-int Lobe::GetWhichNeuronWon() {
-	return myWinningNeuronId;
-}
-
 // ------------------------------------------------------------------------
 // Function:    GetNeuronState
 // Class:       Lobe
@@ -363,22 +379,6 @@ float* Lobe::GetNeuronStatePointer(int whichNeuron, int whichState)
 
 
 // Increase the neuron input:
-// ------------------------------------------------------------------------
-// Function:    SetNeuronInput
-// Class:       Lobe
-// Description: 
-// Arguments:   int whichNeuron = 
-//              float toWhat = 
-// ------------------------------------------------------------------------
-void Lobe::SetNeuronInput(int whichNeuron, float toWhat)
-{
-	if (whichNeuron<0 || whichNeuron>=myNeurons.size())
-		return;
-
-	myNeuronInput[whichNeuron] += toWhat;
-}
-
-
 // ------------------------------------------------------------------------
 // Function:    ClearNeuronActivity
 // Class:       Lobe
@@ -495,10 +495,9 @@ bool Lobe::Read(CreaturesArchive &archive)
 
 		uint32 n;
 		archive >> n;
-		myNeurons.resize(n);
+		AllocateNeurons(n);
 		for (int i=0; i<n; i++)
 		{
-			myNeurons[i] = new Neuron();
 			archive >> myNeurons[i]->idInList;
 			for (int j=0; j<NUM_SVRULE_VARIABLES; j++)
 			{
@@ -44,8 +44,11 @@ public:
 
 	float GetNeuronState(int whichNeuron, int whichState);
 	float* GetNeuronStatePointer(int whichNeuron, int whichState);
-	int GetWhichNeuronWon();
-	void SetNeuronInput(int whichNeuron, float toWhat);
+	inline int GetWhichNeuronWon() {	return myWinningNeuronId;}
+	inline void SetNeuronInput(int whichNeuron, float toWhat) {
+		if (whichNeuron>=0 && whichNeuron<myNeurons.size())
+			myNeuronInput[whichNeuron] += toWhat;
+	}
 	void SetLobeWideInput(float toWhat);
 	void ClearNeuronActivity(int whichNeuron);
 
@@ -72,11 +75,21 @@ protected:
 	TOKEN myToken;
 	char myName[5];
 	int myTissueId;
+
+	// All the lobe's neurons live in one contiguous block so that
+	// updates walk memory in order.  myNeurons points into it.  It is
+	// only ever allocated once, as dendrites point into it too.
+	Neuron* myNeuronStorage;
 	Neurons myNeurons;
+	void AllocateNeurons(int noOfNeurons);
 
 	int myX, myY, myWidth, myHeight;
 	int myColour[3];
 
 	float* myNeuronInput;
+
+	// Stands in for the input and dendrite variables when the neurons are
+	// updated.  Kept per lobe so brains can be updated on different threads.
+	SVRuleVariables myInputVariables;
 };
 #endif//Lobe_H
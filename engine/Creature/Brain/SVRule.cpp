@@ -123,6 +123,19 @@ int SVRule::InitVariables()
 SVRule::SVRule()
 {
 	myRule[length].opCode = stopImmediately;	// just in case
+	myPointerToChemicals = NULL;
+	myPointerToRandomState = &RandQD1::idum;
+
+	// until there is a rule to compile, do nothing
+	for (int i=0; i<length+2; i++)
+		myLineToCompiled[i] = 0;
+	SVRuleMicroOp& stop = myCompiledRule[0];
+	stop.opCode = stopImmediately;
+	stop.operandSource = fromConstant;
+	stop.arrayIndex = 0;
+	stop.constant = 0.0f;
+	stop.line = length;
+	stop.skipTo = 0;
 }
 // ------------------------------------------------------------------------
 // Function:    (destructor)
@@ -162,6 +175,7 @@ void SVRule::InitFromGenome(Genome& genome)
 		if (e.floatValue>1.0f)
 			e.floatValue = 1.0f;
 	}
+	Compile();
 }
 
 
@@ -182,6 +196,7 @@ void SVRule::InitFromDesc(std::istream &in)
 		in.get((char &)e.arrayIndex);
 		ReadDesc(&e.floatValue, in);
 	}
+	Compile();
 }
 
 
@@ -232,6 +247,7 @@ bool SVRule::Read(CreaturesArchive &archive)
 			SVRuleEntry& e = myRule[i];
 			archive >> e.opCode >> e.operandVariable >>	e.arrayIndex >> e.floatValue;
 		}
+		Compile();
 	}
 	else
 	{
@@ -308,9 +324,211 @@ bool SVRule::SetFloat(int entryNo, float value)
 		return false;
 
 	myRule[entryNo].floatValue = value;
+	Compile();
 	return true;
 }
 
+// ------------------------------------------------------------------------
+// Function:    Compile
+// Class:       SVRule
+// Description: Lowers myRule into myCompiledRule, which is what
+//				ProcessGivenVariables runs.  Operands are resolved to
+//				their source up front, constant operands are folded,
+//				and entries which can't do anything (noOperation, or
+//				writes to an operand that isn't a variable) are dropped.
+//				Must be called whenever myRule changes.
+// ------------------------------------------------------------------------
+void SVRule::Compile()
+{
+	int i;
+	int n = 0;
+
+	for (i=0; i<length; i++)
+	{
+		const SVRuleEntry& e = myRule[i];
+		myLineToCompiled[i] = n;
+
+		if (e.opCode < 0 || e.opCode >= noOfOpCodes)
+			continue;
+
+		SVRuleMicroOp& op = myCompiledRule[n];
+		op.opCode = e.opCode;
+		op.operandSource = fromConstant;
+		op.arrayIndex = e.arrayIndex;
+		op.constant = 0.0f;
+		op.line = i;
+
+		if (operationTypes[e.opCode] == operationTakesNoOperand)
+		{
+			if (e.opCode == noOperation)
+				continue;
+		}
+		else if (operationTypes[e.opCode] == operationWritesToAnOperand)
+		{
+			switch (e.operandVariable)
+			{
+				case inputNeuronCode:
+					op.operandSource = fromInputVariables;
+					break;
+				case dendriteCode:
+					op.operandSource = fromDendriteVariables;
+					break;
+				case neuronCode:
+					op.operandSource = fromNeuronVariables;
+					break;
+				case spareNeuronCode:
+					op.operandSource = fromSpareNeuronVariables;
+					break;
+				default:
+					// the interpreter ignores these
+					continue;
+			}
+		}
+		else
+		{
+			switch (e.operandVariable)
+			{
+				case accumulatorCode:
+					op.operandSource = fromAccumulator;
+					break;
+				case inputNeuronCode:
+					op.operandSource = fromInputVariables;
+					break;
+				case dendriteCode:
+					op.operandSource = fromDendriteVariables;
+					break;
+				case neuronCode:
+					op.operandSource = fromNeuronVariables;
+					break;
+				case spareNeuronCode:
+					op.operandSource = fromSpareNeuronVariables;
+					break;
+				case randomCode:
+					op.operandSource = fromRandom;
+					break;
+
+				case chemicalIndexedBySourceNeuronIdCode:
+					op.operandSource = fromChemicalIndexedBySource;
+					break;
+				case chemicalCode:
+					op.operandSource = fromChemical;
+					op.arrayIndex = e.arrayIndex%NUMCHEM;
+					break;
+				case chemicalIndexedByDestinationNeuronIdCode:
+					op.operandSource = fromChemicalIndexedByDestination;
+					break;
+
+				case zeroCode:
+					op.constant = 0.0f;
+					break;
+				case oneCode:
+					op.constant = 1.0f;
+					break;
+
+				case negativeValueCode:
+					op.constant = -e.floatValue;
+					break;
+				case valueCode:
+					op.constant = e.floatValue;
+					break;
+				case valueTenCode:
+					op.constant = e.floatValue * 10.0f;
+					break;
+				case valueTenthCode:
+					op.constant = e.floatValue / 10.0f;
+					break;
+				case valueIntCode:
+					op.constant = (float) ( Map::FastFloatToInteger ((e.floatValue * FloatDivisor)) );
+					break;
+				default:
+					op.constant = 0.0f;
+					break;
+			}
+		}
+		n++;
+	}
+
+	// Running off the end is the same as stopping
+	myLineToCompiled[length] = n;
+	myLineToCompiled[length+1] = n;
+
+	SVRuleMicroOp& stop = myCompiledRule[n];
+	stop.opCode = stopImmediately;
+	stop.operandSource = fromConstant;
+	stop.arrayIndex = 0;
+	stop.constant = 0.0f;
+	stop.line = length;
+	stop.skipTo = n;
+
+	// A failed "if" skips the next entry, whether or not it survived
+	for (i=0; i<n; i++)
+		myCompiledRule[i].skipTo = myLineToCompiled[myCompiledRule[i].line+2];
+
+#ifdef _DEBUG
+	ASSERT(CheckCompiledRule());
+#endif
+}
+
+
+// ------------------------------------------------------------------------
+// Function:    CheckCompiledRule
+// Class:       SVRule
+// Description: Runs the compiled rule and the interpreter side by side
+//				over a spread of variable values and checks they leave
+//				exactly the same bits behind.  Both are run from the
+//				same random number state, which is put back afterwards.
+// Returns:     bool = true if they agree
+// ------------------------------------------------------------------------
+bool SVRule::CheckCompiledRule()
+{
+	static const float testValues[] =
+	{
+		0.0f, 1.0f, -1.0f, 0.5f, -0.25f, 0.125f, 0.75f, -0.875f, 0.003f
+	};
+	const int noOfTestValues = sizeof(testValues)/sizeof(testValues[0]);
+
+	float chemicals[NUMCHEM];
+	int i, j;
+	for (i=0; i<NUMCHEM; i++)
+		chemicals[i] = testValues[i%noOfTestValues];
+
+	float* realChemicals = myPointerToChemicals;
+	myPointerToChemicals = chemicals;
+	unsigned int realSeed = *myPointerToRandomState;
+
+	bool same = true;
+	for (int pass=0; pass<noOfTestValues && same; pass++)
+	{
+		SVRuleVariables compiledVars[4];
+		SVRuleVariables interpretedVars[4];
+		for (j=0; j<4; j++)
+		{
+			for (i=0; i<NUM_SVRULE_VARIABLES; i++)
+			{
+				compiledVars[j][i] = interpretedVars[j][i] =
+					testValues[(pass+i*3+j*5)%noOfTestValues];
+			}
+		}
+
+		*myPointerToRandomState = realSeed + pass;
+		ProcessReturnCode compiledCode = ProcessGivenVariables(
+			compiledVars[0], compiledVars[1], compiledVars[2], compiledVars[3],
+			pass, pass*7);
+		*myPointerToRandomState = realSeed + pass;
+		ProcessReturnCode interpretedCode = InterpretGivenVariables(
+			interpretedVars[0], interpretedVars[1], interpretedVars[2], interpretedVars[3],
+			pass, pass*7);
+
+		same = compiledCode == interpretedCode &&
+			memcmp(compiledVars, interpretedVars, sizeof(compiledVars)) == 0;
+	}
+
+	myPointerToChemicals = realChemicals;
+	*myPointerToRandomState = realSeed;
+	return same;
+}
+
+
 // SVRules for reward and punishment have to be outside the inline function because they
 // access BrainComponent member functions and BrainComponents need to have SVRule defined
 // before they are.
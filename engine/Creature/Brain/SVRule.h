@@ -45,6 +45,18 @@ struct SVRuleEntry {
 	float floatValue;
 };
 
+// An SVRuleEntry lowered by SVRule::Compile(): the operand is resolved
+// to where it comes from (constants are folded), dead entries are gone
+// and skips/jumps are translated into indices of the compiled rule.
+struct SVRuleMicroOp {
+	int opCode;
+	int operandSource;
+	int arrayIndex;
+	float constant;
+	int line;			// index in myRule of the entry this came from
+	int skipTo;			// where to carry on when an "if" fails
+};
+
 // used to divide an operand to get a float
 const int FloatDivisor = 248;
 
@@ -154,10 +166,28 @@ public:
 		setSpareNeuronToCurrent
 	};
 
+	// Where a compiled entry gets its operand from
+	enum CompiledOperandSources {
+		fromConstant,
+		fromAccumulator,
+		fromInputVariables,
+		fromDendriteVariables,
+		fromNeuronVariables,
+		fromSpareNeuronVariables,
+		fromRandom,
+		fromChemical,
+		fromChemicalIndexedBySource,
+		fromChemicalIndexedByDestination
+	};
+
 	SVRule();
 	virtual ~SVRule();
 
+	// Runs the compiled form of the rule
 	inline ProcessReturnCode ProcessGivenVariables(SVRuleVariables& inputVariables, SVRuleVariables& dendriteVariables, SVRuleVariables& neuronVariables, SVRuleVariables& spareNeuronVariables, int srcNeuronId, int dstNeuronId, BrainComponent* myOwner = NULL);
+	// Runs the rule entries directly - the reference the compiled
+	// form must match bit for bit
+	inline ProcessReturnCode InterpretGivenVariables(SVRuleVariables& inputVariables, SVRuleVariables& dendriteVariables, SVRuleVariables& neuronVariables, SVRuleVariables& spareNeuronVariables, int srcNeuronId, int dstNeuronId, BrainComponent* myOwner = NULL);
 	void InitFromGenome(Genome& genome);
 	void InitFromDesc(std::istream &in);
 
@@ -172,10 +202,23 @@ public:
 	inline void RegisterBiochemistry(float* chemicals) {
 		myPointerToChemicals = chemicals;
 	}
+	inline void RegisterRandomState(unsigned int* state) {
+		myPointerToRandomState = state;
+	}
+
+	void Compile();
+	bool CheckCompiledRule();
 
 protected:
 	SVRuleEntry myRule[length+1];
 	float *myPointerToChemicals;
+	unsigned int *myPointerToRandomState;	// defaults to the global RandQD1 stream
+
+	// Compiled form of myRule, always terminated by a stopImmediately.
+	// myLineToCompiled maps an entry index (up to length+1) to the
+	// first compiled op at or after it.
+	SVRuleMicroOp myCompiledRule[length+1];
+	int myLineToCompiled[length+2];
 
 	static int InitVariables();
 	static int dummyVariableToGetInitVariablesCalled;
@@ -199,7 +242,7 @@ __forceinline
 inline 
 #endif
 
-SVRule::ProcessReturnCode SVRule::ProcessGivenVariables(SVRuleVariables& inputVariables, 
+SVRule::ProcessReturnCode SVRule::InterpretGivenVariables(SVRuleVariables& inputVariables, 
 														SVRuleVariables& dendriteVariables, 
 														SVRuleVariables& neuronVariables, 
 														SVRuleVariables& spareNeuronVariables, 
@@ -315,7 +358,7 @@ SVRule::ProcessReturnCode SVRule::ProcessGivenVariables(SVRuleVariables& inputVa
 						operand = spareNeuronVariables[svRuleEntry.arrayIndex];
 						break;
 					case randomCode:
-						operand = RndFloat();
+						operand = RndFloat(*myPointerToRandomState);
 						break;
 
 					case chemicalIndexedBySourceNeuronIdCode:
@@ -641,7 +684,7 @@ SVRule::ProcessReturnCode SVRule::ProcessGivenVariables(SVRuleVariables& inputVa
 						break;
 					case doSignalNoise:
 						neuronVariables[STATE_VAR] +=
-							operand * RndFloat();
+							operand * RndFloat(*myPointerToRandomState);
 						break;
 
 					case doSetSTtoLTRate:
@@ -664,5 +707,362 @@ SVRule::ProcessReturnCode SVRule::ProcessGivenVariables(SVRuleVariables& inputVa
 	return returnCode;
 }
 
+
+
+#ifdef _MSC_VER
+__forceinline
+#else
+inline 
+#endif
+
+SVRule::ProcessReturnCode SVRule::ProcessGivenVariables(SVRuleVariables& inputVariables, 
+														SVRuleVariables& dendriteVariables, 
+														SVRuleVariables& neuronVariables, 
+														SVRuleVariables& spareNeuronVariables, 
+														int srcNeuronId, 
+														int dstNeuronId, 
+														BrainComponent* myOwner) 
+{
+	// See InterpretGivenVariables for what each op does - this must
+	// behave identically, down to the order of the float arithmetic
+	// and the number of random numbers drawn.
+	float accumulator;
+	float operand;
+	float* pointerOperand;
+	float tendRate = 0.0f;
+
+	ProcessReturnCode returnCode = doNothing;
+
+	accumulator = inputVariables[0];
+	int i = 0;
+	for (;;) {
+		const SVRuleMicroOp& op = myCompiledRule[i++];
+
+		switch (op.operandSource)
+		{
+			case fromConstant:
+				operand = op.constant;
+				pointerOperand = NULL;
+				break;
+			case fromAccumulator:
+				operand = accumulator;
+				pointerOperand = NULL;
+				break;
+			case fromInputVariables:
+				pointerOperand = &inputVariables[op.arrayIndex];
+				operand = *pointerOperand;
+				break;
+			case fromDendriteVariables:
+				pointerOperand = &dendriteVariables[op.arrayIndex];
+				operand = *pointerOperand;
+				break;
+			case fromNeuronVariables:
+				pointerOperand = &neuronVariables[op.arrayIndex];
+				operand = *pointerOperand;
+				break;
+			case fromSpareNeuronVariables:
+				pointerOperand = &spareNeuronVariables[op.arrayIndex];
+				operand = *pointerOperand;
+				break;
+			case fromRandom:
+				operand = RndFloat(*myPointerToRandomState);
+				pointerOperand = NULL;
+				break;
+			case fromChemical:
+				operand = myPointerToChemicals[op.arrayIndex];
+				pointerOperand = NULL;
+				break;
+			case fromChemicalIndexedBySource:
+				operand = myPointerToChemicals[(op.arrayIndex+srcNeuronId)%NUMCHEM];
+				pointerOperand = NULL;
+				break;
+			case fromChemicalIndexedByDestination:
+				operand = myPointerToChemicals[(op.arrayIndex+dstNeuronId)%NUMCHEM];
+				pointerOperand = NULL;
+				break;
+		}
+
+		switch (op.opCode)
+		{
+			// takes no operand:
+			case stopImmediately:
+				return returnCode;
+			case setToSpareNeuron:
+				returnCode = setSpareNeuronToCurrent;
+				break;
+			case doWinnerTakesAll:
+				if (neuronVariables[STATE_VAR] >= spareNeuronVariables[STATE_VAR])
+				{
+					spareNeuronVariables[OUTPUT_VAR] = 0.0f;
+					neuronVariables[OUTPUT_VAR] = neuronVariables[STATE_VAR];
+					returnCode = setSpareNeuronToCurrent;
+				}
+				break;
+
+			// writes to an operand (always a variable by now):
+			case storeAccumulatorInto:
+				*pointerOperand = BoundIntoMinusOnePlusOne(accumulator);
+				break;
+			case addAndStoreIn:
+				*pointerOperand = BoundIntoMinusOnePlusOne(accumulator+operand);
+				break;
+			case blankOperand:
+				*pointerOperand = 0.0f;
+				break;
+			case tendToAndStoreIn:
+				*pointerOperand = BoundIntoMinusOnePlusOne(
+					accumulator*(1.0f-tendRate) +
+					operand*tendRate
+				);
+				break;
+			case storeAbsInto:
+				{
+					float tmpF = accumulator<0 ? -accumulator : accumulator;
+					*pointerOperand = BoundIntoZeroOne( tmpF );
+					break;
+				}
+
+			// reads from an operand:
+			case loadAccumulatorFrom:
+				accumulator = operand;
+				break;
+
+			case ifNotEqualTo:
+				if (accumulator==operand) i = op.skipTo;
+				break;
+			case ifEqualTo:
+				if (accumulator!=operand) i = op.skipTo;
+				break;
+			case ifGreaterThanOrEqualTo:
+				if (accumulator<operand) i = op.skipTo;
+				break;
+			case ifLessThanOrEqualTo:
+				if (accumulator>operand) i = op.skipTo;
+				break;
+			case ifGreaterThan:
+				if (accumulator<=operand) i = op.skipTo;
+				break;
+			case ifLessThan:
+				if (accumulator>=operand) i = op.skipTo;
+				break;
+
+			case ifNonZero:
+				if (operand==0.0f) i = op.skipTo;
+				break;
+			case ifZero:
+				if (operand!=0.0f) i = op.skipTo;
+				break;
+			case ifNonNegative:
+				if (operand<0.0f) i = op.skipTo;
+				break;
+			case ifNonPositive:
+				if (operand>0.0f) i = op.skipTo;
+				break;
+			case ifPositive:
+				if (operand<=0.0f) i = op.skipTo;
+				break;
+			case ifNegative:
+				if (operand>=0.0f) i = op.skipTo;
+				break;
+
+			case ifZeroStop:
+				if (operand==0)	return returnCode;
+				break;
+			case ifNZeroStop:
+				if (operand!=0)	return returnCode;
+				break;
+
+			case ifLessThanStop:
+				if (accumulator<operand)	return returnCode;
+				break;
+			case ifGreaterThanStop:
+				if (accumulator>operand)	return returnCode;
+				break;
+			case ifLessThanOrEqualStop:
+				if (accumulator<=operand)	return returnCode;
+				break;
+			case ifGreaterThanOrEqualStop:
+				if (accumulator>=operand)	return returnCode;
+				break;
+
+			case ifZeroGoto:
+			case ifNZeroGoto:
+			case ifNegativeGoto:
+			case ifPositiveGoto:
+			case gotoLine:
+				if ((op.opCode == ifZeroGoto && accumulator!=0) ||
+					(op.opCode == ifNZeroGoto && accumulator==0) ||
+					(op.opCode == ifNegativeGoto && !(accumulator<0)) ||
+					(op.opCode == ifPositiveGoto && !(accumulator>0)))
+					break;
+				{
+					int newLoc = Map::FastFloatToInteger(operand) - 1;
+
+					// Do not over-run the end of the SVRule
+					if (newLoc > length)
+						return returnCode;
+
+					// Or undershoot (only jump when line is later than current)
+					if (newLoc > op.line)
+						i = myLineToCompiled[newLoc];
+				}
+				break;
+			case divideAndAddToNeuronInput:
+				if (operand!=0)
+				{
+					accumulator /= operand;
+					pointerOperand = &neuronVariables[INPUT_VAR];
+					*pointerOperand = BoundIntoMinusOnePlusOne(accumulator+*pointerOperand);
+				}
+				break;
+			case mulitplyAndAddToNeuronInput:
+				accumulator *= operand;
+				pointerOperand = &neuronVariables[INPUT_VAR];
+				*pointerOperand = BoundIntoMinusOnePlusOne(accumulator+*pointerOperand);
+				break;
+
+			case setRewardThreshold:
+				HandleSetRewardThreshold( myOwner, operand );
+				break;
+			case setRewardRate:
+				HandleSetRewardRate( myOwner, operand );
+				break;
+			case setRewardChemicalIndex:
+				HandleSetRewardChemicalIndex( myOwner, operand );
+				break;
+			case setPunishmentThreshold:
+				HandleSetPunishmentThreshold( myOwner, operand );
+				break;
+			case setPunishmentRate:
+				HandleSetPunishmentRate( myOwner, operand );
+				break;
+			case setPunishmentChemicalIndex:
+				HandleSetPunishmentChemicalIndex( myOwner, operand );
+				break;
+
+			case add:
+				accumulator += operand;
+				break;
+			case subtract:
+				accumulator -= operand;
+				break;
+			case subtractFrom:
+				accumulator = operand - accumulator;
+				break;
+			case multiplyBy:
+				accumulator *= operand;
+				break;
+			case divideBy:
+				if (operand!=0)
+					accumulator /= operand;
+				break;
+			case divideInto:
+				if (accumulator!=0)
+					accumulator = operand/accumulator;
+				break;
+			case maxIntoAccumulator:
+				if (operand>accumulator) accumulator=operand;
+				break;
+			case minIntoAccumulator:
+				if (operand<accumulator) accumulator=operand;
+				break;
+
+			case tendAccumulatorToOperandAtTendRate:
+				accumulator =
+					accumulator*(1.0f-tendRate) +
+					operand*tendRate;
+				break;
+			case setTendRate:
+				tendRate = fabs(operand);
+				break;
+
+			case negateOperandIntoAccumulator:
+				accumulator = -operand;
+				break;
+			case loadAbsoluteValueOfOperandIntoAccumulator:
+				accumulator = operand<0 ? -operand : operand;
+				break;
+			case getDistanceTo:
+				accumulator = accumulator>operand ?
+					accumulator-operand :
+					operand-accumulator;
+				break;
+			case flipAccumulatorAround:
+				accumulator = operand - accumulator;
+				break;
+
+			case boundInZeroOne:
+				accumulator = BoundIntoZeroOne(operand);
+				break;
+			case boundInMinusOnePlusOne:
+				accumulator = BoundIntoMinusOnePlusOne(operand);
+				break;
+
+			case preserveVariable:
+				{
+					int varIdx = Map::FastFloatToInteger(operand) % NUM_SVRULE_VARIABLES;
+					neuronVariables[FOURTH_VAR] = neuronVariables[varIdx];
+					break;
+				}
+			case restoreVariable:
+				{
+					int varIdx = Map::FastFloatToInteger(operand) % NUM_SVRULE_VARIABLES;
+					neuronVariables[varIdx] = neuronVariables[FOURTH_VAR];
+					break;
+				}
+			case preserveSpareVariable:
+				{
+					int varIdx = Map::FastFloatToInteger(operand) % NUM_SVRULE_VARIABLES;
+					spareNeuronVariables[FOURTH_VAR] = spareNeuronVariables[varIdx];
+					break;
+				}
+			case restoreSpareVariable:
+				{
+					int varIdx = Map::FastFloatToInteger(operand) % NUM_SVRULE_VARIABLES;
+					spareNeuronVariables[varIdx] = spareNeuronVariables[FOURTH_VAR];
+					break;
+				}
+
+			// C2-style sliders:
+			case doNominalThreshold:
+				if (neuronVariables[INPUT_VAR] < operand)
+					neuronVariables[INPUT_VAR] = 0.0f;
+				break;
+			case doLeakageRate:
+				tendRate = operand;
+				break;
+			case doRestState:
+				neuronVariables[INPUT_VAR] =
+					neuronVariables[INPUT_VAR]*(1.0f-tendRate) + 
+					operand*tendRate;
+				break;
+			case doInputGainLoHi:
+				neuronVariables[INPUT_VAR] *= operand;
+				break;
+
+			case doPersistence:
+				neuronVariables[STATE_VAR] =
+					neuronVariables[INPUT_VAR]*(1.0f-operand) + 
+					neuronVariables[STATE_VAR]*operand;
+				break;
+			case doSignalNoise:
+				neuronVariables[STATE_VAR] +=
+					operand * RndFloat(*myPointerToRandomState);
+				break;
+
+			case doSetSTtoLTRate:
+				HandleSetSTtoLTRate( myOwner, operand );
+				break;
+			case doSetLTtoSTRateAndDoWeightSTLTWeightConvergence:
+				HandleSetLTtoSTRateAndDoCalc( myOwner, operand, dendriteVariables );
+				break;
+
+			default:
+				ASSERT(FALSE);
+				break;
+		}
+	}
+}
+
 #endif//SVRule_H
 
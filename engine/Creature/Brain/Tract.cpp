@@ -34,6 +34,7 @@ Tract::Tract()
 	// INITIALIZATION:
 	myMaxMigrations = atoi( theCatalogue.Get( "Migration Parameters", MAX_MIGRATIONS_PER_TRACT ) );
 	myDendriteStrengthSVIndex = atoi( theCatalogue.Get( "Migration Parameters", DENDRITE_STRENGTH_VAR ) );
+	myDendriteStorage = NULL;
 }
 
 // ------------------------------------------------------------------------
@@ -48,6 +49,7 @@ Tract::Tract(Genome &genome, Lobes& lobes)
 	// INITIALIZATION:
 	myMaxMigrations = atoi( theCatalogue.Get( "Migration Parameters", MAX_MIGRATIONS_PER_TRACT ) );
 	myDendriteStrengthSVIndex = atoi( theCatalogue.Get( "Migration Parameters", DENDRITE_STRENGTH_VAR ) );
+	myDendriteStorage = NULL;
 
 	myUpdateAtTime = genome.GetInt();
 
@@ -217,6 +219,7 @@ Tract::Tract(Genome &genome, Lobes& lobes)
 	{
 	//	OutputFormattedDebugString("Reached maximum no of dendrites in tract %s.\n",(const char*)*this);
 	}
+	PackDendrites();
 
 	// This brain component supports the SV Opcodes relating to reward and punishment
 	mySupportReinforcementFlag = true;
@@ -237,6 +240,7 @@ Tract::Tract(std::istream &in, Lobes& lobes)
 	// INITIALIZATION FROM DESCRIPTION:
 	myMaxMigrations = atoi( theCatalogue.Get( "Migration Parameters", MAX_MIGRATIONS_PER_TRACT ) );
 	myDendriteStrengthSVIndex = atoi( theCatalogue.Get( "Migration Parameters", DENDRITE_STRENGTH_VAR ) );
+	myDendriteStorage = NULL;
 
 	ReadDesc(&myIdInList, in);
 
@@ -297,6 +301,7 @@ Tract::Tract(std::istream &in, Lobes& lobes)
 
 		myDendrites.push_back(dendrite);
 	}
+	PackDendrites();
 }
 
 // ------------------------------------------------------------------------
@@ -306,9 +311,51 @@ Tract::Tract(std::istream &in, Lobes& lobes)
 // ------------------------------------------------------------------------
 Tract::~Tract()
 {
-	for (Dendrites::iterator d=myDendrites.begin(); d!=myDendrites.end(); d++)
+	if (myDendriteStorage)
+	{
+		delete [] myDendriteStorage;
+		myDendriteStorage = NULL;
+	}
+	else
 	{
-		delete *d;
+		for (Dendrites::iterator d=myDendrites.begin(); d!=myDendrites.end(); d++)
+		{
+			delete *d;
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------
+// Function:    PackDendrites
+// Class:       Tract
+// Description: Moves the individually created dendrites into a single
+//				block, keeping their order, and repoints myDendrites and
+//				myWeakDendrites at the new copies.  Call once the tract
+//				is fully wired; migration only rewires existing dendrites
+//				so the block never needs to grow.
+// ------------------------------------------------------------------------
+void Tract::PackDendrites()
+{
+	ASSERT(myDendriteStorage == NULL);
+
+	int noOfDendrites = myDendrites.size();
+	if (noOfDendrites==0)
+		return;
+
+	myDendriteStorage = new Dendrite[noOfDendrites];
+	for (int i=0; i<noOfDendrites; i++)
+	{
+		Dendrite* old = myDendrites[i];
+		myDendriteStorage[i] = *old;
+		myDendrites[i] = &myDendriteStorage[i];
+
+		for (DendritesIterator w=myWeakDendrites.begin(); w!=myWeakDendrites.end(); w++)
+		{
+			if (*w==old)
+				*w = myDendrites[i];
+		}
+		delete old;
 	}
 }
 
@@ -413,9 +460,10 @@ void Tract::DoUpdate()
 	}
 	
 	// Firing Rules:
-	for (int k=0; k<myDendrites.size(); k++)
+	int noOfDendrites = myDendrites.size();
+	for (int k=0; k<noOfDendrites; k++)
 	{
-		Dendrite& d = *(myDendrites[k]);
+		Dendrite& d = myDendriteStorage[k];
 
 		if( myRunInitRuleAlwaysFlag )
 		{
@@ -903,10 +951,12 @@ bool Tract::Read(CreaturesArchive &archive)
 		uint32 n;
 		archive >> n;
 		myDendrites.resize(n);
+		if (n>0)
+			myDendriteStorage = new Dendrite[n];
 		int i;
 		for ( i=0; i<n; i++)
 		{
-			myDendrites[i] = new Dendrite();
+			myDendrites[i] = &myDendriteStorage[i];
 			for (int j=0; j<NUM_SVRULE_VARIABLES; j++)
 			{
 				archive >> myDendrites[i]->weights[j];
@@ -52,7 +52,13 @@ public:
 
 protected:
 	std::string myName;
+
+	// Dendrites are packed into one contiguous block once the tract
+	// is wired so that updates walk memory in order.  myDendrites
+	// points into it.
+	Dendrite* myDendriteStorage;
 	Dendrites myDendrites;
+	void PackDendrites();
 
 	struct TractAttachmentDetails {
 		Lobe* lobe;
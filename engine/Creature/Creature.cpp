@@ -18,6 +18,7 @@
 #include "LifeFaculty.h"
 #include "MusicFaculty.h"
 #include "../Display/MainCamera.h"
+#include "../AgentManager.h"
 
 #ifndef _WIN32
 // VK_* defs
@@ -218,36 +219,111 @@ void Creature::Update()
 	}
 
 	if (!Life()->GetWhetherDead()) {
-		for (int i=0; i<noOfFaculties; i++) 
+		myNextFacultyToUpdate = 0;
+		while (UpdateFacultiesUntilSelfContained())
 		{
-			myFaculties[i]->Update();
-		}
-		base::SetPregnancyStage(Reproductive()->GetProgesteroneLevel());
-		
-		if (myIsHoldingHandsWithThePointer) 
-		{
-			HoldHandsWithThePointer();
+			// hand the rest over to the agent manager if it is
+			// updating all the agents (outside that, do it here)
+			if (theAgentManager.DeferFacultyUpdate(mySelf))
+				return;
+			UpdateSelfContainedFaculty();
 		}
+		FinishFacultyUpdate();
+	}
+}
+
+
+// ------------------------------------------------------------------------
+// Function:    UpdateFacultiesUntilSelfContained
+// Class:       Creature
+// Description: Updates faculties in order from myNextFacultyToUpdate,
+//				stopping short of the next self-contained one.
+// Returns:     bool = true if stopped at a self-contained faculty
+// ------------------------------------------------------------------------
+bool Creature::UpdateFacultiesUntilSelfContained()
+{
+	while (myNextFacultyToUpdate<noOfFaculties)
+	{
+		Faculty* faculty = myFaculties[myNextFacultyToUpdate];
+		if (faculty->IsSelfContained())
+			return true;
+		faculty->Update();
+		myNextFacultyToUpdate++;
+	}
+	return false;
+}
+
+
+// ------------------------------------------------------------------------
+// Function:    UpdateSelfContainedFaculty
+// Class:       Creature
+// Description: Updates the self-contained faculty we stopped at.  This
+//				may be called on a worker thread, so must not touch the
+//				world or any other agent.
+// ------------------------------------------------------------------------
+void Creature::UpdateSelfContainedFaculty()
+{
+	_ASSERT(myNextFacultyToUpdate<noOfFaculties);
+	_ASSERT(myFaculties[myNextFacultyToUpdate]->IsSelfContained());
+
+	myFaculties[myNextFacultyToUpdate]->Update();
+	myNextFacultyToUpdate++;
+}
+
 
+// ------------------------------------------------------------------------
+// Function:    ContinueFacultyUpdate
+// Class:       Creature
+// Description: Carries on a deferred update after its self-contained
+//				faculty has been run.
+// Returns:     bool = true if it has stopped at another self-contained
+//				faculty, false if the update is complete
+// ------------------------------------------------------------------------
+bool Creature::ContinueFacultyUpdate()
+{
+	_ASSERT(!myGarbaged);
+
+	if (UpdateFacultiesUntilSelfContained())
+		return true;
+	FinishFacultyUpdate();
+	return false;
+}
+
+
+// ------------------------------------------------------------------------
+// Function:    FinishFacultyUpdate
+// Class:       Creature
+// Description: Work done once all the faculties have been updated.
+// ------------------------------------------------------------------------
+void Creature::FinishFacultyUpdate()
+{
+	_ASSERT(!myGarbaged);
+
+	base::SetPregnancyStage(Reproductive()->GetProgesteroneLevel());
 	
-		myAirQualityLocus = 1.0f;
-		int roomId;
-		if (theApp.GetWorld().GetMap().GetRoomIDForPoint(myLimbs[BODY_LIMB_HEAD]->CentrePoint(), roomId))
+	if (myIsHoldingHandsWithThePointer) 
+	{
+		HoldHandsWithThePointer();
+	}
+
+
+	myAirQualityLocus = 1.0f;
+	int roomId;
+	if (theApp.GetWorld().GetMap().GetRoomIDForPoint(myLimbs[BODY_LIMB_HEAD]->CentrePoint(), roomId))
+	{
+		int roomType;
+		if (theApp.GetWorld().GetMap().GetRoomType(roomId, roomType))
 		{
-			int roomType;
-			if (theApp.GetWorld().GetMap().GetRoomType(roomId, roomType))
-			{
-				if (roomType==WATER_ROOM_TYPE_1 || roomType==WATER_ROOM_TYPE_2)
-					myAirQualityLocus = 0.0f;
-			}
+			if (roomType==WATER_ROOM_TYPE_1 || roomType==WATER_ROOM_TYPE_2)
+				myAirQualityLocus = 0.0f;
 		}
-
-		// update crowdedness:
-		myCrowdedLocus = 0.0f;
-		float value;
-		if (theApp.GetWorld().GetMap().GetRoomPropertyMinusMyContribution(AgentHandle(*this), value))
-			myCrowdedLocus = value;
 	}
+
+	// update crowdedness:
+	myCrowdedLocus = 0.0f;
+	float value;
+	if (theApp.GetWorld().GetMap().GetRoomPropertyMinusMyContribution(AgentHandle(*this), value))
+		myCrowdedLocus = value;
 }
 
 
@@ -393,6 +469,7 @@ void Creature::Init()
 	myBeingTrackedFlag = false;
 	myUpdateTickOffset = ourNextUpdateTickOffsetToUse;
 	ourNextUpdateTickOffsetToUse = (ourNextUpdateTickOffsetToUse+1)%4;
+	myNextFacultyToUpdate = 0;
 }
 
 
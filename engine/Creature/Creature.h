@@ -62,6 +62,13 @@ public:
 	virtual void Update();
    	virtual void Trash();
 
+	// Self-contained faculties can be run on worker threads by the agent
+	// manager.  Update() then stops at the first one and the manager calls
+	// UpdateSelfContainedFaculty() and ContinueFacultyUpdate() in turn
+	// until ContinueFacultyUpdate() returns false.
+	void UpdateSelfContainedFaculty();
+	bool ContinueFacultyUpdate();
+
 	virtual bool Write(CreaturesArchive &archive) const;
 	virtual bool Read(CreaturesArchive &archive);
 
@@ -175,8 +182,12 @@ protected:
 	float myCrowdedLocus;
 	float myInvalidLocus;
 
-	// these two don't need to be serialised:
+	// these don't need to be serialised:
 	int myUpdateTickOffset;
 	static int ourNextUpdateTickOffsetToUse;
+	int myNextFacultyToUpdate;
+
+	bool UpdateFacultiesUntilSelfContained();
+	void FinishFacultyUpdate();
 };
 #endif //Creature_H
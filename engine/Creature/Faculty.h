@@ -27,6 +27,10 @@ public:
 	virtual void Init(AgentHandle c);
 	virtual void Update();
 	virtual void ReadFromGenome(Genome& g);
+
+	// true if Update() only touches the creature's own state, so that
+	// it can be run on a worker thread alongside other creatures
+	virtual bool IsSelfContained() {return false;}
 	virtual float* GetLocusAddress(int type, int organ, int tissue, int locus);
 
 	virtual bool Write(CreaturesArchive &archive) const;
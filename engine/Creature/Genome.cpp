@@ -10,6 +10,7 @@
 
 #include <math.h>
 #include <string.h>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <io.h>
@@ -64,6 +65,8 @@ void Genome::Init()
 	myCrossoverMutationCount = 0;
 	myCrossoverCrossCount = 0;
 	myCrossMaxLength = 0;
+	myIndexBuilt = false;
+	myIndexEnd = 0;
 }
 
 
@@ -149,6 +152,7 @@ Genome::Genome(char filename[],
 		throw GenomeException(str,__LINE__);
 	}
 	_lclose(hFile);
+	BuildIndex();
 	Reset();									// reset pointers
 }
 
@@ -193,6 +197,7 @@ void Genome::ReadFromFile(std::string filename,
 	fread( myGenes, myLength, 1, fp );
 	fclose( fp );
 
+	BuildIndex();
 	Reset();		// reset pointers
 
 #ifdef _DEBUG
@@ -427,6 +432,7 @@ void Genome::Terminate()
 	TokenAt(myGenePointer) = ENDGENOMETOKEN;				// add the end-of-genome marker
 	myGenePointer += 4;									// tally it
 	myLength = myGenePointer - myGenes;						// store length of genome in member
+	BuildIndex();
 }
 
 // Find the NEXT gene start marker. Set myGenePointer to point to it
@@ -458,6 +464,17 @@ int Genome::GeneID()
 bool Genome::FindGene(int id)
 {
 	Reset();												// start at the beginning
+	if (myIndexBuilt && id != GeneID())
+	{
+		std::map<int, int>::const_iterator it = myFirstGeneWithID.find(id);
+		if (it == myFirstGeneWithID.end())
+		{
+			myGenePointer = myGenes + myIndexEnd + 1;		// (where the search would stop)
+			return false;
+		}
+		myGenePointer = myGenes + it->second;
+		return true;
+	}
 	while (id != GeneID()) {								// search till found
 		if	(!NextMarker())									// or false if end-of-genome
 			return false;
@@ -679,38 +696,40 @@ bool Genome::GetGeneType(
 					  int otherEndType) /*= INVALIDGENE*/	// another TYPE of gene to stop at.
 
 {
+	// With nothing to stop at, only genes of this type & subtype matter,
+	// so go straight to them
+	if (myIndexBuilt && endType == INVALIDGENE && otherEndType == INVALIDGENE)
+	{
+		const GeneOffsets* genes = IndexedGenes(type, subtype, numsubs);
+		int from = myGenePointer - myGenes;
+		if (genes && from >= 0 && from <= myIndexEnd)
+		{
+			GeneOffsets::const_iterator it = std::lower_bound(genes->begin(), genes->end(), from);
+			for (; it != genes->end(); ++it)
+			{
+				myGenePointer = myGenes + *it + 4;			// point to TYPE codon, as GetStart() does
+				int thisGeneType, thisGeneSubType;
+				if (ReadGeneHeader(numsubs, flag, thisGeneType, thisGeneSubType))
+				{
+					myEndHasBeenReached = false;
+					return true;
+				}
+			}
+
+			// leave things as if we'd read to the end
+			myGenePointer = myGenes + myIndexEnd;
+			myEndHasBeenReached = true;
+			return false;
+		}
+	}
+
 	byte* genePointerWhenWeCameIntoThisFunction = myGenePointer;
 
 	// Parse genome until end found:
 	while (GetStart())
     {
-		int thisGeneType = GetCodon(0, NUMGENETYPES - 1);	// ***** Gene type.
-		int thisGeneSubType = GetCodon(0, numsubs-1);		// ***** Sub-type.
-		myGenePointer++;									// ***** (skip over ID#).
-		myGenePointer++;									// ***** (skip over Generation#).
-		myGeneAge = GetCodon(0, 255);
-		int sexOfThisGene = GetCodon(0, 255);				// ***** Flags.
-		myGenePointer++;									// ***** (skip over Mutability Weighting).
-		int variantOfThisGene = GetCodon(0,NUM_BEHAVIOUR_VARIANTS);	// ***** variant
-
-
-		// Check switch-on time - unless an organ:
-		if ((!(thisGeneType == 3 && thisGeneSubType == 0)) && !TimeToSwitchOn(myGeneAge, flag))				// Not the Switch-on time?
-			continue;
-
-		// Check sex:
-		if (!(sexOfThisGene & MIGNORE) &&
-          (((sexOfThisGene & (LINKMALE|LINKFEMALE)) == 0) ||
-		  ((sexOfThisGene & LINKMALE) && (mySex == MALE))||
-		  ((sexOfThisGene & LINKFEMALE) && (mySex == FEMALE)))) {
-		} else {
-			// not the right sex:
-			continue;
-		}
-
-		// Check variant:
-		if (!(variantOfThisGene==0 ||					// express always?
-			variantOfThisGene==myVariant))				// express if this variant?
+		int thisGeneType, thisGeneSubType;
+		if (!ReadGeneHeader(numsubs, flag, thisGeneType, thisGeneSubType))
 			continue;
 
 
@@ -731,6 +750,107 @@ bool Genome::GetGeneType(
 }
 
 
+// Read the header of a gene, given that myGenePointer points to its TYPE codon.
+// Leaves myGenePointer pointing to the first codon after the header.
+// Return true if the gene should be expressed now (switch-on time, sex & variant).
+bool Genome::ReadGeneHeader(int numsubs, int flag,
+							int& thisGeneType, int& thisGeneSubType)
+{
+	thisGeneType = GetCodon(0, NUMGENETYPES - 1);		// ***** Gene type.
+	thisGeneSubType = GetCodon(0, numsubs-1);			// ***** Sub-type.
+	myGenePointer++;									// ***** (skip over ID#).
+	myGenePointer++;									// ***** (skip over Generation#).
+	myGeneAge = GetCodon(0, 255);
+	int sexOfThisGene = GetCodon(0, 255);				// ***** Flags.
+	myGenePointer++;									// ***** (skip over Mutability Weighting).
+	int variantOfThisGene = GetCodon(0,NUM_BEHAVIOUR_VARIANTS);	// ***** variant
+
+
+	// Check switch-on time - unless an organ:
+	if ((!(thisGeneType == 3 && thisGeneSubType == 0)) && !TimeToSwitchOn(myGeneAge, flag))				// Not the Switch-on time?
+		return false;
+
+	// Check sex:
+	if (!(sexOfThisGene & MIGNORE) &&
+      (((sexOfThisGene & (LINKMALE|LINKFEMALE)) == 0) ||
+	  ((sexOfThisGene & LINKMALE) && (mySex == MALE))||
+	  ((sexOfThisGene & LINKFEMALE) && (mySex == FEMALE)))) {
+	} else {
+		// not the right sex:
+		return false;
+	}
+
+	// Check variant:
+	if (!(variantOfThisGene==0 ||					// express always?
+		variantOfThisGene==myVariant))				// express if this variant?
+		return false;
+
+	return true;
+}
+
+
+// Find every gene start marker, in the same byte-by-byte way as GetStart(),
+// and file it by ID and by type & subtype.
+// If there's no end-of-genome marker the genome is left unindexed.
+void Genome::BuildIndex()
+{
+	myIndexBuilt = false;
+	myFirstGeneWithID.clear();
+	myGenesOfKind.clear();
+	for (int t = 0; t < NUMGENETYPES; ++t)
+		myHighestSubType[t] = -1;
+	myGeneTypesInRange = true;
+
+	int offset;
+	for (offset = 0; offset + 4 <= myLength; ++offset)
+	{
+		int marker = TokenAt(myGenes + offset);
+		if (marker == ENDGENOMETOKEN)
+			break;
+		if (marker != GENETOKEN)
+			continue;
+
+		byte* gene = myGenes + offset;
+		int id = (gene[GH_TYPE]<<16) | (gene[GH_SUB]<<8) | gene[GH_ID];
+		myFirstGeneWithID.insert(std::make_pair(id, offset));	// (keeps the first)
+
+		int type = gene[GH_TYPE];
+		int subtype = gene[GH_SUB];
+		if (type >= NUMGENETYPES)
+		{
+			myGeneTypesInRange = false;
+			continue;
+		}
+		if (subtype > myHighestSubType[type])
+			myHighestSubType[type] = subtype;
+		myGenesOfKind[(type<<8) | subtype].push_back(offset);
+	}
+
+	if (offset + 4 > myLength)
+		return;
+
+	myIndexEnd = offset;
+	myIndexBuilt = true;
+}
+
+
+// The genes GetGeneType() would stop at for this type & subtype, or NULL
+// if some codons are out of range (and so wrap round onto others).
+const Genome::GeneOffsets* Genome::IndexedGenes(int type, int subtype, int numsubs)
+{
+	static const GeneOffsets none;
+
+	if (!myGeneTypesInRange || type < 0 || type >= NUMGENETYPES ||
+		myHighestSubType[type] >= numsubs)
+		return NULL;
+
+	std::map<int, GeneOffsets>::const_iterator it = myGenesOfKind.find((type<<8) | subtype);
+	if (it == myGenesOfKind.end())
+		return &none;
+	return &it->second;
+}
+
+
 // Return true if it is Ok for given gene to switch on at this time
 bool Genome::TimeToSwitchOn(byte switchontime,	// SwitchOnTime value from gene header
 							 int flag)			// special switch-on condition
@@ -10,6 +10,8 @@
 #include "../Token.h"
 
 #include <string>
+#include <vector>
+#include <map>
 
 typedef unsigned char byte;
 
@@ -238,6 +240,17 @@ protected:
 	bool myEndHasBeenReached;
     byte myGeneAge;
 
+	// Where the genes are, found in one pass when the genome is loaded
+	// or crossed, so FindGene() and GetGeneType() needn't scan the
+	// genome a byte at a time.
+	typedef std::vector<int> GeneOffsets;	// offsets of start markers, in order
+	bool myIndexBuilt;
+	int myIndexEnd;							// offset of end-of-genome marker
+	std::map<int, int> myFirstGeneWithID;	// GeneID() -> offset
+	std::map<int, GeneOffsets> myGenesOfKind;	// (type<<8)|subtype -> offsets
+	int myHighestSubType[NUMGENETYPES];		// -1 if none of that type
+	bool myGeneTypesInRange;				// false if any TYPE codon is too big
+
 public:
 	int myCrossoverMutationCount;
 	int myCrossoverCrossCount;
@@ -348,6 +361,10 @@ private:
 		byte DadChanceOfMutation, byte DadDegreeOfMutation);
 
 	bool GetStart();	// Find the NEXT gene start marker. Set myGenePointer to point to its TYPE codon
+	bool ReadGeneHeader(int numsubs, int flag,	// Read header from TYPE codon on, true if it expresses
+						int& thisGeneType, int& thisGeneSubType);
+	void BuildIndex();				// Find all the genes for the index
+	const GeneOffsets* IndexedGenes(int type, int subtype, int numsubs);
 	bool TimeToSwitchOn(byte switchontime,			// is it Ok for this gene to switch on now?
 						int flag);
 
@@ -1291,12 +1291,12 @@ void LinguisticFaculty::HearSentence(AgentHandle speakerAgent, std::string
 	if (nounToNudge!=NONE) 
 	{
 		amountToNudgeNoun *= myVocab[NOUN][nounToNudge].learnedStrength;
-		c.GetBrain()->SetInput("noun", nounToNudge, amountToNudgeNoun);
+		c.GetBrain()->SetInput(Brain::nounLobe, nounToNudge, amountToNudgeNoun);
 	}
 	if (verbToNudge!=NONE) 
 	{
 		amountToNudgeVerb *= myVocab[VERB][verbToNudge].learnedStrength;
-		c.GetBrain()->SetInput("verb", verbToNudge, amountToNudgeVerb);
+		c.GetBrain()->SetInput(Brain::verbLobe, verbToNudge, amountToNudgeVerb);
 	}
 	
 }
@@ -106,7 +106,7 @@ void MotorFaculty::Update() {
 
 	int winningAttentionId = (myVoluntaryScriptOverrides.attentionScriptNo>=0) ?
 		myVoluntaryScriptOverrides.attentionScriptNo :
-		c.GetBrain()->GetWinningId("attn");
+		c.GetBrain()->GetWinningId(Brain::attnLobe);
 	AgentHandle winningAgent = c.Sensory()->GetKnownAgent(winningAttentionId);
 
 	if (winningAgent!=oldIt) {			// agent who won isn't IT at the moment:
@@ -116,7 +116,7 @@ void MotorFaculty::Update() {
 		}
 
 		// check if brain still has signal set
-		if(c.GetBrain()->GetNeuronState("visn", winningAttentionId, STATE_VAR) == 0.0f)
+		if(c.GetBrain()->GetNeuronState(Brain::visnLobe, winningAttentionId, STATE_VAR) == 0.0f)
 			winningAgent = NULLHANDLE;
 
 		// in any case, set the IT object:
@@ -201,7 +201,7 @@ void MotorFaculty::Update() {
 
 	int scriptAction = (myVoluntaryScriptOverrides.decisionScriptNo>=0) ?
 		myVoluntaryScriptOverrides.decisionScriptNo :
-		GetScriptOffsetFromNeuronId(c.GetBrain()->GetWinningId("decn"));
+		GetScriptOffsetFromNeuronId(c.GetBrain()->GetWinningId(Brain::decnLobe));
 
 
 	if (scriptAction!=myCurrentAction || 
@@ -139,7 +139,7 @@ void SensoryFaculty::PostInit()
 {
 	// must be done post init cos brain will not be initialised when init is run	
 	// -1 cos you need 1 set of spare dendrites for migration to work (see genome notes)
-	int forfSize = myCreature.GetCreatureReference().GetBrain()->GetLobeSize("forf")-1;
+	int forfSize = myCreature.GetCreatureReference().GetBrain()->GetLobeSize(Brain::forfLobe)-1;
 	if (forfSize >= 1)
 	{
 		myFriendsAndFoeHandles.resize(forfSize);
@@ -196,24 +196,24 @@ void SensoryFaculty::Update()
 
 	// SITUATION LOBE:
 	//	brain->SetSituationInput(IP_NEARWALL, ((float)((127-iSig)*2)/255.0f);
-	brain->SetInput("situ", IP_IN_VEHICLE, creature.GetCarrier().IsValid() ? 1.0f : 0.0f);
+	brain->SetInput(Brain::situLobe, IP_IN_VEHICLE, creature.GetCarrier().IsValid() ? 1.0f : 0.0f);
 
 
-	brain->SetInput("situ", IP_AGE_LEVEL, ((float)creature.Life()->GetAge())/NUMAGES);
-	brain->SetInput("situ", IP_CARRYING_SOMETHING, creature.GetCarried()!=NULLHANDLE ? 1.0f : 0.0f);
-	brain->SetInput("situ", IP_BEING_CARRIED, creature.GetMovementStatus()==Agent::CARRIED ? 1.0f : 0.0f);
-	brain->SetInput("situ", IP_FALLING, !creature.IsStopped() ? 1.0f : 0.0f);// if not stopped you're falling:
+	brain->SetInput(Brain::situLobe, IP_AGE_LEVEL, ((float)creature.Life()->GetAge())/NUMAGES);
+	brain->SetInput(Brain::situLobe, IP_CARRYING_SOMETHING, creature.GetCarried()!=NULLHANDLE ? 1.0f : 0.0f);
+	brain->SetInput(Brain::situLobe, IP_BEING_CARRIED, creature.GetMovementStatus()==Agent::CARRIED ? 1.0f : 0.0f);
+	brain->SetInput(Brain::situLobe, IP_FALLING, !creature.IsStopped() ? 1.0f : 0.0f);// if not stopped you're falling:
 	// find distance to nearest creature of same genus & opposite sex
 	float f = DistanceToNearestCreature(
 		creature.Life()->GetSex() == 1 ? 2 : 1,
 		myCreature.GetAgentReference().GetClassifier().Genus());
 	float vr = myCreature.GetCreatureReference().GetVisualRange();
 	if (f<vr)	
-		brain->SetInput("situ", IP_NEAR_OPPOSITE_SEX, (vr-f)/vr);
+		brain->SetInput(Brain::situLobe, IP_NEAR_OPPOSITE_SEX, (vr-f)/vr);
 
-	brain->SetInput("situ", IP_MUSIC_MOOD, creature.Music()->Mood());
-	brain->SetInput("situ", IP_MUSIC_THREAT, creature.Music()->Threat());
-	brain->SetInput("situ", IP_SELECTED_CREATURE, myCreature==theApp.GetWorld().GetSelectedCreature() ? 1.0f : 0.0f);
+	brain->SetInput(Brain::situLobe, IP_MUSIC_MOOD, creature.Music()->Mood());
+	brain->SetInput(Brain::situLobe, IP_MUSIC_THREAT, creature.Music()->Threat());
+	brain->SetInput(Brain::situLobe, IP_SELECTED_CREATURE, myCreature==theApp.GetWorld().GetSelectedCreature() ? 1.0f : 0.0f);
 	
 
 
@@ -226,30 +226,30 @@ void SensoryFaculty::Update()
 		Agent& a = it.GetAgentReference();
 		f = fabsf( creature.GetPosition().x - a.GetPosition().x );
 		if (f<128.0f)										// starts firing @ <127 pels dist
-	        brain->SetInput("detl", IP_IT_NEARNESS, ((255.0f-f-f))/255.0f);
+	        brain->SetInput(Brain::detlLobe, IP_IT_NEARNESS, ((255.0f-f-f))/255.0f);
 
 		// is a being carried:
 		if (a.GetMovementStatus() == Agent::CARRIED)
 		{
 			if (it == creature.GetCarried())
-				brain->SetInput("detl", IP_IT_IS_BEING_CARRIED_BY_ME, 1.0f);
+				brain->SetInput(Brain::detlLobe, IP_IT_IS_BEING_CARRIED_BY_ME, 1.0f);
 			else
-				brain->SetInput("detl", IP_IT_IS_BEING_CARRIED_BY_SOMEONE_ELSE, 1.0f);
+				brain->SetInput(Brain::detlLobe, IP_IT_IS_BEING_CARRIED_BY_SOMEONE_ELSE, 1.0f);
 		}
 
 		float size = (a.GetWidth()+a.GetHeight()) / 500.0f;
-		brain->SetInput("detl", IP_IT_IS_OF_THIS_SIZE, size);
-		brain->SetInput("detl", IP_IT_IS_SMELLING_THIS_MUCH, a.GetCAIncrease());
-		brain->SetInput("detl", IP_IT_IS_FALLING, !a.IsStopped() ? 1.0f : 0.0f);
+		brain->SetInput(Brain::detlLobe, IP_IT_IS_OF_THIS_SIZE, size);
+		brain->SetInput(Brain::detlLobe, IP_IT_IS_SMELLING_THIS_MUCH, a.GetCAIncrease());
+		brain->SetInput(Brain::detlLobe, IP_IT_IS_FALLING, !a.IsStopped() ? 1.0f : 0.0f);
 
 		if (it.IsCreature())
 		{
 			Creature& c = it.GetCreatureReference();
-			brain->SetInput("detl", IP_IT_IS_CREATURE,	1.0f);  // IT is a creature
-			brain->SetInput("detl", IP_IT_IS_MYPARENT,	c.GetMoniker()==creature.GetMotherMoniker() || c.GetMoniker()==creature.GetFatherMoniker() ? 1.0f : 0.0f);
-			brain->SetInput("detl", IP_IT_IS_MYCHILD,		c.GetMotherMoniker()==creature.GetMoniker() || c.GetFatherMoniker()==creature.GetMoniker() ? 1.0f : 0.0f);
-			brain->SetInput("detl", IP_IT_IS_MYSIBLING,	c.GetMotherMoniker()==creature.GetMotherMoniker() || c.GetFatherMoniker()==creature.GetFatherMoniker() ? 1.0f : 0.0f);
-			brain->SetInput("detl", IP_IT_IS_OPPOSITESEX,	c.GetFamily()==creature.GetFamily() && c.GetGenus()==creature.GetGenus() && c.Life()->GetSex()!=creature.Life()->GetSex() ? 1.0f : 0.0f);
+			brain->SetInput(Brain::detlLobe, IP_IT_IS_CREATURE,	1.0f);  // IT is a creature
+			brain->SetInput(Brain::detlLobe, IP_IT_IS_MYPARENT,	c.GetMoniker()==creature.GetMotherMoniker() || c.GetMoniker()==creature.GetFatherMoniker() ? 1.0f : 0.0f);
+			brain->SetInput(Brain::detlLobe, IP_IT_IS_MYCHILD,		c.GetMotherMoniker()==creature.GetMoniker() || c.GetFatherMoniker()==creature.GetMoniker() ? 1.0f : 0.0f);
+			brain->SetInput(Brain::detlLobe, IP_IT_IS_MYSIBLING,	c.GetMotherMoniker()==creature.GetMotherMoniker() || c.GetFatherMoniker()==creature.GetFatherMoniker() ? 1.0f : 0.0f);
+			brain->SetInput(Brain::detlLobe, IP_IT_IS_OPPOSITESEX,	c.GetFamily()==creature.GetFamily() && c.GetGenus()==creature.GetGenus() && c.Life()->GetSex()!=creature.Life()->GetSex() ? 1.0f : 0.0f);
 		}
 	}
 
@@ -259,7 +259,7 @@ void SensoryFaculty::Update()
 	{
 		for (i=0; i<NUMDRIVES; i++)
 		{
-			brain->SetInput("driv", i, creature.GetDriveLevel(i));
+			brain->SetInput(Brain::drivLobe, i, creature.GetDriveLevel(i));
 		}
 	}
 
@@ -285,7 +285,7 @@ void SensoryFaculty::Update()
 				smellValue = theApp.GetWorld().GetMap().GetRoomPropertyMinusMyContribution(myCreature, smellValue);
 
 			// Set brain neuron:
-			brain->SetInput("smel", neuronId, smellValue);
+			brain->SetInput(Brain::smelLobe, neuronId, smellValue);
 		}
 	}
 
@@ -309,7 +309,7 @@ void SensoryFaculty::Update()
 		}
 
 		// if you can still see last known agent and have been talking about it - keep it
-		if(myKnownAgents[genusId].IsValid() && creature.CanSee(myKnownAgents[genusId]) && creature.GetBrain()->GetNeuronState("noun", genusId, STATE_VAR) > 0.20f)
+		if(myKnownAgents[genusId].IsValid() && creature.CanSee(myKnownAgents[genusId]) && creature.GetBrain()->GetNeuronState(Brain::nounLobe, genusId, STATE_VAR) > 0.20f)
 		{
 			SetSeenFriendOrFoe(myKnownAgents[genusId]);
 			continue;
@@ -497,8 +497,8 @@ void SensoryFaculty::Update()
 		{
 			if (myKnownAgents[i].IsInvalid())
 			{
-				brain->SetInput("visn", i, 0.0f);
-				brain->SetInput("elvn", i, 0.0f);
+				brain->SetInput(Brain::visnLobe, i, 0.0f);
+				brain->SetInput(Brain::elvnLobe, i, 0.0f);
 			}
 			else
 			{
@@ -539,8 +539,8 @@ void SensoryFaculty::SetVisualInput(int i)
 	float xDisplacement = BoundIntoMinusOnePlusOne((myKnownAgents[i].GetAgentReference().GetCentre().x - creature.GetCentre().x) / visualRange);
 	float yDisplacement = BoundIntoMinusOnePlusOne((myKnownAgents[i].GetAgentReference().GetCentre().y - creature.GetCentre().y) / visualRange);
 
-	brain->SetInput("visn", i, xDisplacement);
-	brain->SetInput("elvn", i, yDisplacement);
+	brain->SetInput(Brain::visnLobe, i, xDisplacement);
+	brain->SetInput(Brain::elvnLobe, i, yDisplacement);
 }
 
 
@@ -663,7 +663,7 @@ void SensoryFaculty::Stimulate(Stimulus s)			// COPY of stimulus data
 	else
 	{
 		if (s.nounStim!=0.0f)
-			c.GetBrain()->SetInput("noun", s.nounIdToStim, s.nounStim);
+			c.GetBrain()->SetInput(Brain::nounLobe, s.nounIdToStim, s.nounStim);
 	}
 	if (s.verbStim>1.0f)
 	{
@@ -672,7 +672,7 @@ void SensoryFaculty::Stimulate(Stimulus s)			// COPY of stimulus data
 	else
 	{
 		if (s.verbStim!=0.0f)
-			c.GetBrain()->SetInput("verb", GetNeuronIdFromScriptOffset(s.verbIdToStim), s.verbStim);
+			c.GetBrain()->SetInput(Brain::verbLobe, GetNeuronIdFromScriptOffset(s.verbIdToStim), s.verbStim);
 	}
 
 	// stims from the SWAY macro (or STIM #):
@@ -825,7 +825,7 @@ void SensoryFaculty::AdjustChemicalLevelWithTraining(int whichChemical, float ad
 #ifdef STIM_TEST_TRACE
 	OutputFormattedDebugString("learning\n");
 #endif
-				myCreature.GetCreatureReference().GetBrain()->SetInput("resp", drive, adjustment);
+				myCreature.GetCreatureReference().GetBrain()->SetInput(Brain::respLobe, drive, adjustment);
 			}
 #ifdef STIM_TEST_TRACE
 			else
@@ -837,7 +837,7 @@ void SensoryFaculty::AdjustChemicalLevelWithTraining(int whichChemical, float ad
 #ifdef STIM_TEST_TRACE
 	OutputFormattedDebugString("prox\n");
 #endif
-			myCreature.GetCreatureReference().GetBrain()->SetInput("prox", drive, adjustment);
+			myCreature.GetCreatureReference().GetBrain()->SetInput(Brain::proxLobe, drive, adjustment);
 		}
 	}
 #ifdef STIM_TEST_TRACE
@@ -1267,8 +1267,8 @@ int SensoryFaculty::GetOpinionOfCreature(AgentHandle& creatureOrPointer, float &
 		{
 			if(myFriendsAndFoeHandles[i] == creatureOrPointer)
 			{
-				opinion = myCreature.GetCreatureReference().GetBrain()->GetNeuronState("forf", i, STATE_VAR);
-				moodOpinion = myCreature.GetCreatureReference().GetBrain()->GetNeuronState("forf", i, OUTPUT_VAR);
+				opinion = myCreature.GetCreatureReference().GetBrain()->GetNeuronState(Brain::forfLobe, i, STATE_VAR);
+				moodOpinion = myCreature.GetCreatureReference().GetBrain()->GetNeuronState(Brain::forfLobe, i, OUTPUT_VAR);
 				return i;
 			}
 		}
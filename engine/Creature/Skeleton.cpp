@@ -15,6 +15,8 @@
 
 #include "../Agents/Vehicle.h"
 #include "../Display/SharedGallery.h"
+#include "../Display/CreatureGallery.h"
+#include "../Display/CreatureGalleryBuilder.h"
 //#include "../../common/RegistryHandler.h"
 #include "../Display/MainCamera.h" // when we update plot order we need to tell
 									// the display system
@@ -462,8 +464,8 @@ void Skeleton::Init()
 
 	myStandStill = false;
 	myIsHoldingHandsWithThePointer = false;
-	myBodyPartToBeCreated = 0;
-	myBodyPartToBeCreatedForNextAgeStage =0;
+	myGalleryJob = NULL;
+	myGalleryJobForNextAgeStage = NULL;
 	myDoubleSpeedFlag = false;
 	myIntrospectiveFlag = false;
 	myBodyPartsAreFullyFormedFlag = false;
@@ -776,6 +778,7 @@ void Skeleton::UpdatePositionsWithRespectToDownFoot()
 	myMaxX = xmax;
 	myMinY = ymin;
 	myMaxY = ymax;
+	UpdateSpatialIndex();
 }
 
 
@@ -1982,36 +1985,20 @@ bool Skeleton::ReloadSkeleton(Genome& genome,
 
 
 	bool ok = false;
-	if(myCompositeBodyPartGallery->IsComplete())
+	if(!myGalleryJob && myCompositeBodyPartGallery->IsComplete())
 	{
 		ok = true;
 	}
 	else
 	{
-
-		for(int part = 0; part < ValidParts; part++)
+		// do this in one fell swoop
+		if(myGalleryJob || StartGalleryJob(Sex, Age, myCompositeBodyPartGallery,
+			*myTintin, myGalleryJob))
 		{
-			BuildGalleries(Sex, Age,myBodyPartToBeCreated,*myTintin);
+			CreatureGalleryBuilder::theBuilder().Wait(myGalleryJob);
+			if(FinishGalleryJob(Sex, Age, myGalleryJob))
+				ok = true;
 		}
-
-	
-		if(SharedGallery::theSharedGallery().CreateGallery(galleryName,
-										   GetUniqueID(),
-										   myGenera,
-										   myVariants,
-										   ValidParts,
-										   Sex,
-										   Age,
-										   myBodySprites,
-										   myCompositeBodyPartGallery,
-										   myIndividualBodyPartGalleries,
-										   myNumSpritesInFile,
-										   true)) // do this in one fell swoop
-										   ok = true;
-		if (ok)
-			for( int i = 0; i < NUMPARTS; ++i )
-				myIndividualBodyPartGalleries[i].Trash();
-
 	}
 
 
@@ -2086,15 +2073,16 @@ void Skeleton::Trash()
 
 	myBody = NULL;
 
+	// the builder mustn't be left writing to the galleries
+	CancelGalleryJob(myGalleryJobForNextAgeStage);
+	CancelGalleryJob(myGalleryJob);
+
 	if(myCompositeBodyPartGalleryForNextAgeStage != myCompositeBodyPartGallery )
 	{
 		delete myCompositeBodyPartGalleryForNextAgeStage;
 		myCompositeBodyPartGalleryForNextAgeStage = NULL;
 	}
 
-	for( int i = 0; i < NUMPARTS; ++i )
-		myIndividualBodyPartGalleries[i].Trash();
-
 	delete myCompositeBodyPartGallery;
 	myCompositeBodyPartGallery = NULL;
 
@@ -3199,11 +3187,14 @@ void Skeleton::ReadAppearanceGenes(Genome& genome, TintManager& tinty)
 
 bool Skeleton::CreateBodyPart(int sex, int age,TintManager& tinty)
 {
-	if(myBodyPartToBeCreated < NUMPARTS)
-	{
-		return BuildGalleries(sex,age,myBodyPartToBeCreated, tinty);
-	}
-	else
+	// if you haven't already preloaded you body parts have them built
+	// in the background, and check back on later calls
+	if(!myGalleryJob && !myCompositeBodyPartGallery->IsComplete())
+		return StartGalleryJob(sex, age, myCompositeBodyPartGallery, tinty, myGalleryJob);
+
+	if(myGalleryJob && !CreatureGalleryBuilder::theBuilder().IsDone(myGalleryJob))
+		return true;
+
 	{
 		Limb* Root = NULL;
 
@@ -3212,25 +3203,12 @@ bool Skeleton::CreateBodyPart(int sex, int age,TintManager& tinty)
 		
 		Gallery* gallery = NULL;
 
-		// if you haven't already preloaded you body parts...
-		if(!myCompositeBodyPartGallery->IsComplete())
+		if(myGalleryJob)
 		{
-			char buf[5];
-			sprintf(buf,"%d",age);
-			std::string galleryName = GetMoniker() + buf;
-
-
-			gallery = SharedGallery::theSharedGallery().CreateGallery(galleryName,
-											GetUniqueID(),
-										   myGenera,
-										   myVariants,
-										   NUMPARTS,
-										   sex,
-										   age,
-										   myBodySprites,
-										   myCompositeBodyPartGallery,
-										   myIndividualBodyPartGalleries,
-										   myNumSpritesInFile);
+			bool failed = myGalleryJob->failed;
+			gallery = FinishGalleryJob(sex, age, myGalleryJob);
+			if(failed)
+				return false;
 		}
 
 
@@ -3243,9 +3221,6 @@ bool Skeleton::CreateBodyPart(int sex, int age,TintManager& tinty)
 
 			sprite.GetInteger()  == 1 ? mirror = true : mirror = false;
 
-			for( int i = 0; i < NUMPARTS; ++i )
-				myIndividualBodyPartGalleries[i].Trash();
-
 
 			char buf[5];
 			sprintf(buf,"%d",age);
@@ -3530,7 +3505,6 @@ bool Skeleton::CreateBodyPart(int sex, int age,TintManager& tinty)
 			myBodyPartsAreFullyFormedFlag = true;
 			// we have all the parts we need for now
 			// reset the counter and actually create the body
-			myBodyPartToBeCreated =0;
 			myNumSpritesInFile =0;
 
 			return true;
@@ -3544,83 +3518,122 @@ bool Skeleton::CreateBodyPart(int sex, int age,TintManager& tinty)
 		return false;
 }
 
-bool Skeleton::BuildGalleries(int sex, int age, uint32& currentPart,TintManager& tintTable)
+// Finds the C16 for one body part, falling back on the default male
+// version if there isn't one for this creature's genus and variant.
+// The path is resolved here so that the gallery builder needn't.
+bool Skeleton::FindBodyPartFile(int part, int sex, int age, FilePath& file)
 {
-	uint32 fsp =0;
-	// bypass the shared gallery for this
-	// because we will delete it ourselves in a moment
-
-	fsp = ValidFsp(currentPart,
-							myGenera[currentPart],
+	uint32 fsp = ValidFsp(part,
+							myGenera[part],
 							sex,
 							age,
-							myVariants[currentPart],
+							myVariants[part],
 							"C16",
 							IMAGES_DIR);
-	if(fsp)
-	{
-		FilePath galleryName(fsp, "C16", IMAGES_DIR);
-
-		
-		try
-		{
-			if(galleryName != myIndividualBodyPartGalleries[currentPart].GetName() )
-			{
-				myIndividualBodyPartGalleries[currentPart].LoadFromC16(galleryName);
-				myIndividualBodyPartGalleries[currentPart].Recolour(tintTable.GetMyTintTable());
-			
-			}
-		myNumSpritesInFile+= myIndividualBodyPartGalleries[currentPart].GetCount();
-		
-		}
-		catch(Gallery::GalleryException&)
-		{
-			return false;
-		}
-			
-	}
-	else
+	if(!fsp)
 	{
 		// if there was no body part use a default male
 		// version
-		fsp = ValidFsp(currentPart,
+		fsp = ValidFsp(part,
 							0,
 							sex,
 							age,
 							0,
 							"C16",
 							IMAGES_DIR);
+	}
 
-		// if you don't have basic norn body parts you are in biiiiig
-		// trouble
-		if(!fsp)
-			return false;
+	// if you don't have basic norn body parts you are in biiiiig
+	// trouble
+	if(!fsp)
+		return false;
 
-		// try again
-		FilePath galleryName(fsp, "C16", IMAGES_DIR);
+	FilePath galleryName(fsp, "C16", IMAGES_DIR);
+	file = FilePath(galleryName.GetFullPath(), -1, false);
+	return true;
+}
 
-		
-		try
-		{
-			if(galleryName != myIndividualBodyPartGalleries[currentPart].GetName() )
-			{
-				myIndividualBodyPartGalleries[currentPart].LoadFromC16(galleryName);
-				myIndividualBodyPartGalleries[currentPart].Recolour(tintTable.GetMyTintTable());
-				myNumSpritesInFile+= myIndividualBodyPartGalleries[currentPart].GetCount();
-			}
-		
-		}
-		catch(Gallery::GalleryException&)
+// Hands the building of the target gallery over to the
+// CreatureGalleryBuilder.  Returns false if any body part is missing.
+bool Skeleton::StartGalleryJob(int sex, int age, CreatureGallery* target,
+							   TintManager& tinty, CreatureGalleryJob*& job)
+{
+	_ASSERT(!job);
+
+	CreatureGalleryJob* newJob = new CreatureGalleryJob;
+	for(int part = 0; part < NUMPARTS; part++)
+	{
+		if(!FindBodyPartFile(part, sex, age, newJob->parts[part]))
 		{
+			delete newJob;
 			return false;
 		}
-
 	}
-			// next body part is....
-	currentPart++;
+	newJob->target = target;
+	newJob->uniqueID = GetUniqueID();
+	newJob->tint = tinty;
+
+	job = newJob;
+	CreatureGalleryBuilder::theBuilder().Submit(job);
 	return true;
 }
 
+// Makes the Gallery from a job that is done, and deletes the job
+Gallery* Skeleton::FinishGalleryJob(int sex, int age, CreatureGalleryJob*& job)
+{
+	_ASSERT(job);
+
+	Gallery* gallery = NULL;
+	if(job->failed)
+	{
+		theFlightRecorder.Log(16, "Couldn't build the body parts for %s: %s",
+			GetMoniker().c_str(), job->error.c_str());
+	}
+	else
+	{
+		for(int part = 0; part < NUMPARTS; part++)
+			myBodySprites[part] = job->bodySprites[part];
+		myNumSpritesInFile = job->numSpritesInFile;
+
+		char buf[5];
+		sprintf(buf,"%d",age);
+		std::string galleryName = GetMoniker() + buf;
+
+		gallery = SharedGallery::theSharedGallery().CreateGallery(galleryName,
+										GetUniqueID(),
+									   myGenera,
+									   myVariants,
+									   NUMPARTS,
+									   sex,
+									   age,
+									   myBodySprites,
+									   job->target,
+									   job->partGalleries,
+									   myNumSpritesInFile,
+									   true);
+	}
+
+	delete job;
+	job = NULL;
+	return gallery;
+}
+
+void Skeleton::CancelGalleryJob(CreatureGalleryJob*& job)
+{
+	if(!job)
+		return;
+
+	CreatureGalleryBuilder::theBuilder().Cancel(job);
+	delete job;
+	job = NULL;
+}
+
+void Skeleton::WaitForBodyParts()
+{
+	if(myGalleryJob)
+		CreatureGalleryBuilder::theBuilder().Wait(myGalleryJob);
+}
+
 
 bool Skeleton::PreloadBodyPartsForNextAgeStage(Genome& genome,int sex)
 {
@@ -3636,58 +3649,33 @@ bool Skeleton::PreloadBodyPartsForNextAgeStage(Genome& genome,int sex)
 	myPreloadLastAge = age;
 
 
-	if(myBodyPartToBeCreatedForNextAgeStage < NUMPARTS)
+	// if you haven't already preloaded your body parts...
+	if(!myGalleryJobForNextAgeStage && !myCompositeBodyPartGalleryForNextAgeStage->IsComplete())
+		return StartGalleryJob(sex, age, myCompositeBodyPartGalleryForNextAgeStage,
+							   *myTintin, myGalleryJobForNextAgeStage);
+
+	if(myGalleryJobForNextAgeStage)
 	{
-		return BuildGalleries(sex,age, myBodyPartToBeCreatedForNextAgeStage,*myTintin);
+		if(!CreatureGalleryBuilder::theBuilder().IsDone(myGalleryJobForNextAgeStage))
+			return true;
+		FinishGalleryJob(sex, age, myGalleryJobForNextAgeStage);
 	}
-	else
-	{
-		Limb* Root = NULL;
-
-		Limb* Mid = NULL;
-		Limb* Tip = NULL;
 
-	
-
-		// if you haven't already preloaded your body parts...
-		if(!myCompositeBodyPartGalleryForNextAgeStage->IsComplete())
-		{
-			char buf[5];
-			sprintf(buf,"%d",age);
-			std::string galleryName = GetMoniker() + buf;
-
-			SharedGallery::theSharedGallery().CreateGallery(galleryName,
-											GetUniqueID(),
-										   myGenera,
-										   myVariants,
-										   NUMPARTS,
-										   sex,
-										   age,
-										   myBodySprites,
-										   myCompositeBodyPartGalleryForNextAgeStage,
-										   myIndividualBodyPartGalleries,
-										   myNumSpritesInFile);
-		}
-			
+	{
 		if(myCompositeBodyPartGalleryForNextAgeStage->IsComplete())
 		{
 			// we have successfully beaten the ageing process and preloaded
 			// all our data in time
-			for( int i = 0; i < NUMPARTS; ++i )
-				myIndividualBodyPartGalleries[i].Trash();
-
 			CreatureGallery* temp = myCompositeBodyPartGallery;
 			// we delete myCompositeBodyPartGallery as temp below
+			// (once nothing is building into it)
+			CancelGalleryJob(myGalleryJob);
 		
 			myCompositeBodyPartGallery = myCompositeBodyPartGalleryForNextAgeStage;
-			myBodyPartToBeCreated = NUMPARTS;
 			myJustAgedFlag =false;
 
 			ReloadSkeleton(genome,age);
 		//	myNumSpritesInFile =0;
-				// we have all the parts we need for now
-			// reset the counter and actually create the body
-			myBodyPartToBeCreatedForNextAgeStage =0;
 
 			delete temp;
 			myCompositeBodyPartGalleryForNextAgeStage = NULL;
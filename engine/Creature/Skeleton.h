@@ -58,6 +58,7 @@ enum poses {
 
 class TintManager;
 class CreatureGallery;
+struct CreatureGalleryJob;
 
 class Skeleton : public Agent 
 {
@@ -77,7 +78,6 @@ protected:
 	CreatureGallery*	myCompositeBodyPartGalleryForNextAgeStage;
 	int32				myNumSpritesInFile;
 	int32				myNumberOfSpritesInFileforAgeing;
-	CompressedGallery	myIndividualBodyPartGalleries[NUMPARTS];
 	int32				myVariants[NUMPARTS];	// variant # to use for each part
     int32				myGenera[NUMPARTS];
 	// which sprite# in final sprite file refers to the first pose of each body part
@@ -85,8 +85,9 @@ protected:
 	int32				myBodySprites[NUMPARTS];
 	Body*				myBody;						// ptr to Body Ent
 	Limb*				myLimbs[MAX_BODY_LIMBS];		// limbs (or NULL if none)
-	uint32				myBodyPartToBeCreated;
-	uint32				myBodyPartToBeCreatedForNextAgeStage;
+	// galleries being built by the CreatureGalleryBuilder (or NULL)
+	CreatureGalleryJob*	myGalleryJob;
+	CreatureGalleryJob*	myGalleryJobForNextAgeStage;
 	bool				myBodyPartsAreFullyFormedFlag;
 	int					myBodyPartsAgeStage;
 	int					myLastAge;
@@ -199,7 +200,11 @@ protected:
 
 	bool ContinueLoadingDataForNextAgeStage();
 
-	bool BuildGalleries(int sex, int age,uint32& currentPart, TintManager& tinty);
+	bool FindBodyPartFile(int part, int sex, int age, FilePath& file);
+	bool StartGalleryJob(int sex, int age, CreatureGallery* target,
+						TintManager& tinty, CreatureGalleryJob*& job);
+	Gallery* FinishGalleryJob(int sex, int age, CreatureGalleryJob*& job);
+	void CancelGalleryJob(CreatureGalleryJob*& job);
 
 
 
@@ -239,6 +244,9 @@ public:
 	
 	bool AreYourBodyPartsFullyFormed(){return myBodyPartsAreFullyFormedFlag;}
 
+	// blocks until any body part gallery being built for us is ready
+	void WaitForBodyParts();
+
 
 
  	void Walk();						// helper fn for WALK macro
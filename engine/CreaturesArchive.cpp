@@ -34,9 +34,108 @@
 
 #include "Agents/Agent.h"
 #include "App.h"
+#include "WorkerPool.h"
 
 const int BUFFER_SIZE = 16384;
 
+static std::string GetArchiveHint()
+{
+	std::string hint = "Creatures Evolution Engine - Archived information file. zLib 1.13 compressed.";
+	hint += (char)26; // MS-DOS EOF
+	hint += (char)4;  // Linux EOF (Hopefully)
+	return hint;
+}
+
+// Same length as the normal hint, so either can be read in first
+static std::string GetBlockArchiveHint()
+{
+	std::string hint = "Creatures Evolution Engine - Archived information file. zLib 1.13 block mode.";
+	hint += (char)26; // MS-DOS EOF
+	hint += (char)4;  // Linux EOF (Hopefully)
+	return hint;
+}
+
+
+// ----------------------------------------------------------------------
+// Block format
+// After the hint, each block is written as its uncompressed size, its
+// compressed size and then a complete zlib stream of its own, so they
+// can be compressed and decompressed independently of each other.  A
+// pair of zero sizes marks the end.
+// ----------------------------------------------------------------------
+const uint32 ARCHIVE_BLOCK_SIZE = 512*1024;
+const int MAX_ARCHIVE_BLOCK_BATCH = 32;
+
+struct ArchiveBlock
+{
+	unsigned char* raw;			// uncompressed data
+	uint32 rawSize;
+	unsigned char* packed;		// compressed data
+	uint32 packedSize;
+	int level;
+	bool ok;
+};
+
+// worst case for compress2() (from the zlib docs)
+static uint32 GetPackedBlockBound( uint32 size )
+{
+	return size + size/1000 + 12;
+}
+
+static void CompressArchiveBlock( void* item )
+{
+	ArchiveBlock* block = (ArchiveBlock*)item;
+	uLongf size = GetPackedBlockBound( block->rawSize );
+	block->ok = compress2( block->packed, &size, block->raw, block->rawSize,
+		block->level ) == Z_OK;
+	block->packedSize = size;
+}
+
+static void DecompressArchiveBlock( void* item )
+{
+	ArchiveBlock* block = (ArchiveBlock*)item;
+	uLongf size = ARCHIVE_BLOCK_SIZE;
+	block->ok = uncompress( block->raw, &size, block->packed,
+		block->packedSize ) == Z_OK && size == block->rawSize;
+}
+
+// Enough blocks to keep all the workers busy
+static int StartArchiveWorkers( WorkerPool& workers )
+{
+	int threads = WorkerPool::GetProcessorCount() - 1;
+	if( threads > 0 )
+		workers.Start( threads );
+	int batch = ( workers.GetThreadCount() + 1 ) * 2;
+	return batch < MAX_ARCHIVE_BLOCK_BATCH ? batch : MAX_ARCHIVE_BLOCK_BATCH;
+}
+
+static void WriteArchiveBlocks( std::ostream& stream, ArchiveBlock* blocks,
+	int count, WorkerPool& workers )
+{
+	void* items[ MAX_ARCHIVE_BLOCK_BATCH ];
+	int i;
+	for( i=0; i<count; ++i )
+		items[i] = &blocks[i];
+	workers.Run( CompressArchiveBlock, items, count );
+
+	for( i=0; i<count; ++i )
+	{
+		if( !blocks[i].ok )
+			throw CreaturesArchive::Exception( "CRA0004: failed to compress archive block" );
+		uint32 sizes[2];
+		sizes[0] = blocks[i].rawSize;
+		sizes[1] = blocks[i].packedSize;
+		stream.write( (char*)sizes, sizeof( sizes ) );
+		stream.write( (char*)blocks[i].packed, blocks[i].packedSize );
+	}
+}
+
+static void WriteArchiveBlockEnd( std::ostream& stream )
+{
+	uint32 sizes[2] = { 0, 0 };
+	stream.write( (char*)sizes, sizeof( sizes ) );
+}
+
 // ----------------------------------------------------------------------
 // Method:		CreaturesArchive
 // Arguments:	file	 - File being written to / read from
@@ -54,6 +153,17 @@ CreaturesArchive::CreaturesArchive( std::iostream &stream, Mode mode, bool bNoVe
 
 	myCloningACreature = false;
 
+	myDataSize = 0;
+	myBlockFormat = false;
+	myBlocks = NULL;
+	myBlockCapacity = 0;
+	myBlockCount = 0;
+	myCurrentBlock = 0;
+	myBlockPos = 0;
+	myBlocksFinished = false;
+	myBlockWorkers = NULL;
+	myClosed = false;
+
 	myStreamBuffer.zalloc = (alloc_func)NULL;
 	myStreamBuffer.zfree = (free_func)NULL;
 	myStreamBuffer.opaque = (voidpf)NULL;
@@ -61,9 +171,7 @@ CreaturesArchive::CreaturesArchive( std::iostream &stream, Mode mode, bool bNoVe
 	myCompressedDataBuffer = new unsigned char[BUFFER_SIZE];
 	myUncompressedDataBuffer = new unsigned char[BUFFER_SIZE];
 
-	std::string baseHint = "Creatures Evolution Engine - Archived information file. zLib 1.13 compressed.";
-	baseHint += (char)26; // MS-DOS EOF
-	baseHint += (char)4;  // Linux EOF (Hopefully)
+	std::string baseHint = GetArchiveHint();
 	std::string readHint = baseHint;
 
 	if( mode == Load )
@@ -79,7 +187,12 @@ CreaturesArchive::CreaturesArchive( std::iostream &stream, Mode mode, bool bNoVe
 			throw Exception( "CRA0001: zlib failed to initialise" );
 		}
 		myStream.read(&(readHint.at(0)),readHint.length());
-		if (readHint != baseHint)
+		if (readHint == GetBlockArchiveHint())
+		{
+			// blocks are decompressed as they are needed
+			CreateBlocks();
+		}
+		else if (readHint != baseHint)
 		{
 			throw Exception( "CRA0002: Not a creatures archive" );
 		}
@@ -87,13 +200,31 @@ CreaturesArchive::CreaturesArchive( std::iostream &stream, Mode mode, bool bNoVe
 		Read( myVersion );
 		if (!bNoVersion)
 		{
-			if( myVersion != GetCurrentVersion() )
+			if( myVersion < GetOldestVersion() || myVersion > GetCurrentVersion() )
 			{
 				std::string str = ErrorMessageHandler::Format("archive_error", 6, "CreaturesArchive::CreaturesArchive");
 				throw Exception( str.c_str() );
 			}
 		}
 	}
+	else if( mode == SaveUncompressed )
+	{
+		// no header and no zlib - WriteCompressed() adds them later
+		myStreamBuffer.next_in = myUncompressedDataBuffer;
+		myStreamBuffer.avail_in = 0;
+
+		myVersion = GetCurrentVersion();
+		Write( myVersion );
+	}
+	else if( mode == SaveBlocks )
+	{
+		CreateBlocks();
+		std::string blockHint = GetBlockArchiveHint();
+		myStream.write(blockHint.c_str(),blockHint.length());
+
+		myVersion = GetCurrentVersion();
+		Write( myVersion );
+	}
 	else
 	{
 		myStreamBuffer.next_in = myUncompressedDataBuffer;
@@ -123,6 +254,58 @@ CreaturesArchive::~CreaturesArchive()
 	if (myMode == Load)
 		inflateEnd(&myStreamBuffer);
 	else
+	{
+		// Anyone who cares whether the save worked calls Close()
+		// themselves, as there's no way to report it from here
+		try
+		{
+			Close();
+		}
+		catch( ... )
+		{
+		}
+	}
+	delete [] myCompressedDataBuffer;
+	delete [] myUncompressedDataBuffer;
+
+	if (myBlocks)
+	{
+		for (int i=0; i<myBlockCapacity; ++i)
+		{
+			delete [] myBlocks[i].raw;
+			delete [] myBlocks[i].packed;
+		}
+		delete [] myBlocks;
+	}
+	delete myBlockWorkers;
+}
+
+// ----------------------------------------------------------------------
+// Method:		Close
+// Arguments:	None
+// Returns:		Nothing
+// Description:	Writes out whatever is still buffered, and for the block
+//				format the end marker.  Throws if compressing the last
+//				blocks fails, so check the stream afterwards as well.
+// ----------------------------------------------------------------------
+void CreaturesArchive::Close()
+{
+	if (myMode == Load || myClosed)
+		return;
+	myClosed = true;
+
+	if (myMode == SaveUncompressed)
+	{
+		if (myStreamBuffer.avail_in > 0)
+			myStream.write((char*)myUncompressedDataBuffer, myStreamBuffer.avail_in);
+		myStreamBuffer.avail_in = 0;
+	}
+	else if (myMode == SaveBlocks)
+	{
+		FlushBlocks();
+		WriteArchiveBlockEnd( myStream );
+	}
+	else
 	{
 		int zret = Z_OK;
 		while (myStreamBuffer.avail_in > 0 || zret == Z_OK)
@@ -137,8 +320,237 @@ CreaturesArchive::~CreaturesArchive()
 		}
 		deflateEnd(&myStreamBuffer);
 	}
-	delete [] myCompressedDataBuffer;
-	delete [] myUncompressedDataBuffer;
+	myStream.flush();
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		CreateBlocks
+// Arguments:	None
+// Returns:		Nothing
+// Description:	Sets up the buffers and threads for a block archive
+// ----------------------------------------------------------------------
+void CreaturesArchive::CreateBlocks()
+{
+	myBlockFormat = true;
+	myBlockWorkers = new WorkerPool;
+	myBlockCapacity = StartArchiveWorkers( *myBlockWorkers );
+
+	int level = IsSaving() ? theApp.GetZLibCompressionLevel() : 0;
+	myBlocks = new ArchiveBlock[ myBlockCapacity ];
+	for (int i=0; i<myBlockCapacity; ++i)
+	{
+		myBlocks[i].raw = new unsigned char[ ARCHIVE_BLOCK_SIZE ];
+		myBlocks[i].rawSize = 0;
+		myBlocks[i].packed = new unsigned char[ GetPackedBlockBound( ARCHIVE_BLOCK_SIZE ) ];
+		myBlocks[i].packedSize = 0;
+		myBlocks[i].level = level;
+		myBlocks[i].ok = false;
+	}
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		WriteToBlocks
+// Arguments:	data - data to write
+//				count - number of bytes
+// Returns:		Nothing
+// Description:	Fills up the current block, and compresses the batch
+//				once every block in it is full.
+// ----------------------------------------------------------------------
+void CreaturesArchive::WriteToBlocks( const void *data, size_t count )
+{
+	const unsigned char* p = (const unsigned char*)data;
+	while (count > 0)
+	{
+		ArchiveBlock& block = myBlocks[ myCurrentBlock ];
+		uint32 toAdd = ARCHIVE_BLOCK_SIZE - block.rawSize;
+		if (toAdd > count)
+			toAdd = count;
+		memcpy( block.raw + block.rawSize, p, toAdd );
+		block.rawSize += toAdd;
+		p += toAdd;
+		count -= toAdd;
+
+		if (block.rawSize == ARCHIVE_BLOCK_SIZE && ++myCurrentBlock == myBlockCapacity)
+			FlushBlocks();
+	}
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		FlushBlocks
+// Arguments:	None
+// Returns:		Nothing
+// Description:	Compresses and writes out all the blocks with data in
+// ----------------------------------------------------------------------
+void CreaturesArchive::FlushBlocks()
+{
+	int count = myCurrentBlock;
+	if (count < myBlockCapacity && myBlocks[ count ].rawSize > 0)
+		++count;
+
+	if (count > 0)
+		WriteArchiveBlocks( myStream, myBlocks, count, *myBlockWorkers );
+
+	for (int i=0; i<count; ++i)
+		myBlocks[i].rawSize = 0;
+	myCurrentBlock = 0;
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		LoadBlocks
+// Arguments:	None
+// Returns:		Nothing
+// Description:	Reads in the next batch of blocks and decompresses them
+// ----------------------------------------------------------------------
+void CreaturesArchive::LoadBlocks()
+{
+	myBlockCount = 0;
+	myCurrentBlock = 0;
+	myBlockPos = 0;
+
+	while (!myBlocksFinished && myBlockCount < myBlockCapacity)
+	{
+		uint32 sizes[2];
+		myStream.read( (char*)sizes, sizeof( sizes ) );
+		if (myStream.gcount() != sizeof( sizes ))
+			throw Exception( "CRA0005: archive is truncated" );
+		if (sizes[0] == 0)
+		{
+			myBlocksFinished = true;
+			break;
+		}
+		if (sizes[0] > ARCHIVE_BLOCK_SIZE ||
+			sizes[1] > GetPackedBlockBound( ARCHIVE_BLOCK_SIZE ))
+			throw Exception( "CRA0006: archive block is corrupt" );
+
+		ArchiveBlock& block = myBlocks[ myBlockCount++ ];
+		block.rawSize = sizes[0];
+		block.packedSize = sizes[1];
+		myStream.read( (char*)block.packed, block.packedSize );
+		if (myStream.gcount() != block.packedSize)
+			throw Exception( "CRA0005: archive is truncated" );
+	}
+
+	// reading past the end
+	if (myBlockCount == 0)
+		throw Exception( "CRA0005: archive is truncated" );
+
+	void* items[ MAX_ARCHIVE_BLOCK_BATCH ];
+	int i;
+	for (i=0; i<myBlockCount; ++i)
+		items[i] = &myBlocks[i];
+	myBlockWorkers->Run( DecompressArchiveBlock, items, myBlockCount );
+
+	for (i=0; i<myBlockCount; ++i)
+	{
+		if (!myBlocks[i].ok)
+			throw Exception( "CRA0006: archive block is corrupt" );
+	}
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		ReadFromBlocks
+// Arguments:	buffer - where to put the data
+//				count - number of bytes
+// Returns:		Nothing
+// Description:	Reads from the decompressed blocks, loading more as
+//				they run out.
+// ----------------------------------------------------------------------
+void CreaturesArchive::ReadFromBlocks( void *buffer, size_t count )
+{
+	unsigned char* p = (unsigned char*)buffer;
+	while (count > 0)
+	{
+		if (myCurrentBlock >= myBlockCount)
+			LoadBlocks();
+
+		ArchiveBlock& block = myBlocks[ myCurrentBlock ];
+		uint32 toRead = block.rawSize - myBlockPos;
+		if (toRead > count)
+			toRead = count;
+		memcpy( p, block.raw + myBlockPos, toRead );
+		myBlockPos += toRead;
+		p += toRead;
+		count -= toRead;
+
+		if (myBlockPos == block.rawSize)
+		{
+			++myCurrentBlock;
+			myBlockPos = 0;
+		}
+	}
+}
+
+
+
+// ----------------------------------------------------------------------
+// Method:		WriteCompressed
+// Arguments:	stream - stream to write the finished archive to
+//				data - contents of a SaveUncompressed archive
+//				size - number of bytes of data
+//				level - zlib compression level 0 - 9
+// Returns:		Nothing
+// Description:	Produces exactly what a SaveBlocks archive would have
+//				written for the same data.
+// ----------------------------------------------------------------------
+void CreaturesArchive::WriteCompressed( std::ostream& stream, const void* data,
+	size_t size, int level )
+{
+	std::string hint = GetBlockArchiveHint();
+	stream.write( hint.c_str(), hint.length() );
+
+	WorkerPool workers;
+	int batch = StartArchiveWorkers( workers );
+
+	// the blocks can compress straight out of the data
+	ArchiveBlock blocks[ MAX_ARCHIVE_BLOCK_BATCH ];
+	int i;
+	for( i=0; i<batch; ++i )
+	{
+		blocks[i].packed = new unsigned char[ GetPackedBlockBound( ARCHIVE_BLOCK_SIZE ) ];
+		blocks[i].level = level;
+	}
+
+	try
+	{
+		const unsigned char* p = (const unsigned char*)data;
+		while( size > 0 )
+		{
+			int count = 0;
+			while( count < batch && size > 0 )
+			{
+				uint32 n = size < ARCHIVE_BLOCK_SIZE ? size : ARCHIVE_BLOCK_SIZE;
+				blocks[count].raw = (unsigned char*)p;
+				blocks[count].rawSize = n;
+				p += n;
+				size -= n;
+				++count;
+			}
+			WriteArchiveBlocks( stream, blocks, count, workers );
+		}
+		WriteArchiveBlockEnd( stream );
+	}
+	catch( ... )
+	{
+		for( i=0; i<batch; ++i )
+			delete [] blocks[i].packed;
+		throw;
+	}
+
+	for( i=0; i<batch; ++i )
+		delete [] blocks[i].packed;
+
+	if( !stream.good() )
+		throw Exception( "CRA0004: failed to write compressed archive" );
 }
 
 
@@ -305,6 +717,13 @@ void CreaturesArchive::Write(const RECT& rect)
 
 void CreaturesArchive::Write( const void *data, size_t count )
 {
+	myDataSize += count;
+	if (myBlockFormat)
+	{
+		WriteToBlocks( data, count );
+		return;
+	}
+
 	// Do some compression, and pump the data out...
 	int written = 0;
 	while (written < count)
@@ -322,6 +741,15 @@ void CreaturesArchive::Write( const void *data, size_t count )
 		if (myStreamBuffer.avail_in < BUFFER_SIZE)
 			return; // We have not filled the buffer, so there wasn't enough data to think about
 
+		if (myMode == SaveUncompressed)
+		{
+			// just pass it straight on
+			myStream.write( (char*)myUncompressedDataBuffer, BUFFER_SIZE );
+			myStreamBuffer.avail_in = 0;
+			myStreamBuffer.next_in = myUncompressedDataBuffer;
+			continue;
+		}
+
 		// Right then, we have a full input buffer, let's compress it & dump the output
 		// to disk...
 		while (myStreamBuffer.avail_in > 0)
@@ -565,6 +993,13 @@ void CreaturesArchive::Read(RECT& rect)
 
 void CreaturesArchive::Read( void *buffer, size_t count )
 {
+	myDataSize += count;
+	if (myBlockFormat)
+	{
+		ReadFromBlocks( buffer, count );
+		return;
+	}
+
 	// Let's do it...
 	int read = 0;
 	while (read < count)
@@ -769,6 +1204,18 @@ void CreaturesArchive::SetAgentArchiveStyle(AgentArchiveStyle style)
 //				the format it is archived in.
 // ---------------------------------------------------------------------
 int32 CreaturesArchive::GetCurrentVersion()
+{
+	return 13;
+}
+
+// ---------------------------------------------------------------------
+// Method:		GetOldestVersion
+// Arguments:	None
+// Returns:		Oldest archive version number that can still be read
+// Description:	13 only added the brain's random state, which Brain::Read
+//				makes up for older archives.
+// ---------------------------------------------------------------------
+int32 CreaturesArchive::GetOldestVersion()
 {
 	return 12;
 }
@@ -68,6 +68,8 @@
 
 class PersistentObject;
 class Agent;
+class WorkerPool;
+struct ArchiveBlock;
 
 
 
@@ -99,7 +101,9 @@ class CreaturesArchive
 		enum Mode
 		{
 			Save,
-			Load
+			Load,
+			SaveUncompressed,	// raw data only, for WriteCompressed() later
+			SaveBlocks			// compressed in independent blocks, in parallel
 		};
 
 		// ----------------------------------------------------------------------
@@ -116,7 +120,8 @@ class CreaturesArchive
 		// Method:		~CreaturesArchive
 		// Arguments:	None
 		// Returns:		Nothing
-		// Description:	Destructor.  Closes the file being read/written to
+		// Description:	Destructor.  Closes the archive if Close() hasn't
+		//				been called already.
 		// ----------------------------------------------------------------------
 		~CreaturesArchive();
 
@@ -129,6 +134,30 @@ class CreaturesArchive
 		// ---------------------------------------------------------------------
 		static int32 GetCurrentVersion();
 
+		// ---------------------------------------------------------------------
+		// Method:		GetOldestVersion
+		// Arguments:	None
+		// Returns:		Oldest archive version number that can still be read
+		// Description:	Classes whose format has changed since then check
+		//				GetFileVersion when reading.
+		// ---------------------------------------------------------------------
+		static int32 GetOldestVersion();
+
+		// ---------------------------------------------------------------------
+		// Method:		WriteCompressed
+		// Arguments:	stream - stream to write the finished archive to
+		//				data - contents of a SaveUncompressed archive
+		//				size - number of bytes of data
+		//				level - zlib compression level 0 - 9
+		// Returns:		Nothing
+		// Description:	Compresses data captured by a SaveUncompressed archive
+		//				into a SaveBlocks archive which can be loaded as usual.
+		//				Doesn't touch theApp, so is safe to call from another
+		//				thread.
+		// ---------------------------------------------------------------------
+		static void WriteCompressed( std::ostream& stream, const void* data,
+			size_t size, int level );
+
 		// ---------------------------------------------------------------------
 		// Method:		GetCurrentVersion
 		// Arguments:	None
@@ -198,7 +227,9 @@ class CreaturesArchive
 		// Method:		Close
 		// Arguments:	None
 		// Returns:		Nothing
-		// Description:	Prevents further writing and disconnects from given file
+		// Description:	Prevents further writing and finishes off the file.
+		//				The destructor does this too, but swallows any
+		//				error, so call it and check the stream if it matters.
 		// ----------------------------------------------------------------------
 		void Close( );
 
@@ -214,7 +245,14 @@ class CreaturesArchive
 		// Arguments:	None
 		// Returns:		true if the archive is currently being written to
 		// ----------------------------------------------------------------------
-		bool IsSaving() {return myMode == Save;}
+		bool IsSaving() {return myMode != Load;}
+
+		// ----------------------------------------------------------------------
+		// Method:		GetDataSize
+		// Arguments:	None
+		// Returns:		number of uncompressed bytes read or written so far
+		// ----------------------------------------------------------------------
+		uint32 GetDataSize() const {return myDataSize;}
 
 
 		// ----------------------------------------------------------------------
@@ -386,6 +424,29 @@ class CreaturesArchive
 
 		unsigned char* myLastUncompressedDataRead;
 
+		uint32 myDataSize;
+
+		// ----------------------------------------------------------------------
+		// Block format (SaveBlocks, or loading one)
+		// A batch of blocks is compressed or decompressed at once,
+		// across myBlockWorkers.
+		// ----------------------------------------------------------------------
+		bool myBlockFormat;
+		ArchiveBlock* myBlocks;
+		int myBlockCapacity;		// blocks in a batch
+		int myBlockCount;			// blocks loaded in this batch
+		int myCurrentBlock;
+		uint32 myBlockPos;			// read position in the current block
+		bool myBlocksFinished;		// read the end marker
+		WorkerPool* myBlockWorkers;
+		bool myClosed;				// finished writing - see Close()
+
+		void CreateBlocks();
+		void WriteToBlocks( const void *data, size_t count );
+		void ReadFromBlocks( void *buffer, size_t count );
+		void FlushBlocks();
+		void LoadBlocks();
+
 		// ----------------------------------------------------------------------
 		// mode
 		// Reading / Writing
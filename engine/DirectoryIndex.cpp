@@ -0,0 +1,357 @@
+// -------------------------------------------------------------------------
+// Filename:    DirectoryIndex.cpp
+// Class:       DirectoryIndex
+// Purpose:     Remembers what is in the game's data directories
+// Description:	See DirectoryIndex.h
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "DirectoryIndex.h"
+#include "App.h"
+#include "AppConstants.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include "unix/FileFuncs.h"
+#endif
+
+
+// The directories worth indexing - the ones FilePath and the
+// gallery code look things up in over and over
+static const int ourIndexedDirectories[] =
+{
+	SOUNDS_DIR,
+	IMAGES_DIR,
+	GENETICS_DIR,
+	BODY_DATA_DIR,
+	OVERLAYS_DIR,
+	BACKGROUNDS_DIR,
+	CATALOGUE_DIR,
+	BOOTSTRAP_DIR,
+};
+
+
+
+DirectoryIndex& DirectoryIndex::theDirectoryIndex()
+{
+	static DirectoryIndex index;
+	return index;
+}
+
+
+
+DirectoryIndex::DirectoryIndex()
+{
+	myStatsAvoided = 0;
+	myStatsMade = 0;
+	myDirectoriesListed = 0;
+#ifdef _WIN32
+	InitializeCriticalSection( &myLock );
+#else
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init( &attributes );
+	pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( &myLock, &attributes );
+	pthread_mutexattr_destroy( &attributes );
+#endif
+}
+
+
+
+void DirectoryIndex::Build()
+{
+	Lock();
+	myDirectories.clear();
+
+	int count = sizeof( ourIndexedDirectories ) / sizeof( ourIndexedDirectories[0] );
+	for( int i = 0; i < count; ++i )
+	{
+		int directory = ourIndexedDirectories[i];
+		AddDirectory( theApp.GetDirectory( directory ) );
+
+		std::string local;
+		if( theApp.GetWorldDirectoryVersion( directory, local ) )
+			AddDirectory( local );
+	}
+	Unlock();
+}
+
+
+
+bool DirectoryIndex::FileExists( const std::string& path )
+{
+	std::string directory;
+	std::string name;
+	SplitPath( path, directory, name );
+	if( name.empty() )
+		return DirectoryExists( path );
+
+	Lock();
+	bool exists;
+	Directory* found = FindDirectory( directory );
+	if( found )
+	{
+		++myStatsAvoided;
+		exists = found->names.find( Key( name ) ) != found->names.end();
+	}
+	else
+	{
+		++myStatsMade;
+		exists = AskFileSystem( path );
+	}
+	Unlock();
+	return exists;
+}
+
+
+
+bool DirectoryIndex::DirectoryExists( const std::string& path )
+{
+	// Only trust the index when it says yes - a directory that has
+	// been made since it was listed wouldn't be in it
+	Lock();
+	bool exists = true;
+	Directory* found = FindDirectory( path );
+	if( found && found->exists )
+		++myStatsAvoided;
+	else
+	{
+		++myStatsMade;
+		exists = AskFileSystem( path );
+		if( found && exists )
+			found->listed = false;
+	}
+	Unlock();
+	return exists;
+}
+
+
+
+void DirectoryIndex::FileCreated( const std::string& path )
+{
+	std::string directory;
+	std::string name;
+	SplitPath( path, directory, name );
+
+	Lock();
+	Directory* found = FindListedDirectory( directory );
+	if( found && !name.empty() )
+		found->names.insert( Key( name ) );
+	Unlock();
+}
+
+
+
+void DirectoryIndex::FileDeleted( const std::string& path )
+{
+	std::string directory;
+	std::string name;
+	SplitPath( path, directory, name );
+
+	Lock();
+	Directory* found = FindListedDirectory( directory );
+	if( found && !name.empty() )
+		found->names.erase( Key( name ) );
+	Unlock();
+}
+
+
+
+void DirectoryIndex::FileMoved( const std::string& from, const std::string& to )
+{
+	Lock();
+	FileDeleted( from );
+	FileCreated( to );
+	Unlock();
+}
+
+
+
+void DirectoryIndex::Refresh( int directory )
+{
+	if( directory < 0 )
+		return;
+
+	Lock();
+	Directory* found = FindListedDirectory( theApp.GetDirectory( directory ) );
+	if( found )
+		found->listed = false;
+
+	std::string local;
+	if( theApp.GetWorldDirectoryVersion( directory, local ) )
+	{
+		Directories::iterator it = myDirectories.find( Key( local ) );
+		if( it != myDirectories.end() )
+			it->second.listed = false;
+		else if( !myDirectories.empty() )
+			// (made since the index was built)
+			AddDirectory( local );
+	}
+	Unlock();
+}
+
+
+
+void DirectoryIndex::AddDirectory( const std::string& path )
+{
+	Directory& directory = myDirectories[ Key( path ) ];
+	directory.listed = false;
+	directory.exists = false;
+	directory.names.clear();
+}
+
+
+
+// Lists the directory if it hasn't been yet.  Returns NULL if
+// it isn't one of ours.
+DirectoryIndex::Directory* DirectoryIndex::FindDirectory( const std::string& path )
+{
+	Directories::iterator it = myDirectories.find( Key( path ) );
+	if( it == myDirectories.end() )
+		return NULL;
+
+	Directory& directory = it->second;
+	if( !directory.listed )
+	{
+		directory.names.clear();
+		directory.exists = List( path, directory.names );
+		directory.listed = true;
+		++myDirectoriesListed;
+	}
+	return &directory;
+}
+
+
+
+// As FindDirectory, but doesn't list it - for changes, which a
+// directory that is yet to be listed will see anyway
+DirectoryIndex::Directory* DirectoryIndex::FindListedDirectory( const std::string& path )
+{
+	Directories::iterator it = myDirectories.find( Key( path ) );
+	if( it == myDirectories.end() || !it->second.listed )
+		return NULL;
+	return &it->second;
+}
+
+
+
+// The directory keeps its trailing separator, as the ones
+// from theApp.GetDirectory have one
+void DirectoryIndex::SplitPath( const std::string& path, std::string& directory,
+	std::string& name )
+{
+	int x = path.find_last_of( "/\\" );
+	if( x == -1 )
+	{
+		directory.erase();
+		name = path;
+		return;
+	}
+	directory = path.substr( 0, x + 1 );
+	name = path.substr( x + 1 );
+}
+
+
+
+// Windows file names don't care about case, or which way
+// round the slashes go
+std::string DirectoryIndex::Key( const std::string& name )
+{
+#ifdef _WIN32
+	std::string key( name );
+	for( int i = 0; i < key.size(); ++i )
+	{
+		if( key[i] == '/' )
+			key[i] = '\\';
+		else
+			key[i] = tolower( key[i] );
+	}
+	return key;
+#else
+	return name;
+#endif
+}
+
+
+
+// Fills in the names of the files and subdirectories in the
+// directory.  Returns false if it doesn't exist.
+bool DirectoryIndex::List( const std::string& path, std::set< std::string >& names )
+{
+#ifdef _WIN32
+	WIN32_FIND_DATA data;
+	HANDLE find = FindFirstFile( ( path + "*" ).c_str(), &data );
+	if( find == INVALID_HANDLE_VALUE )
+		return GetFileAttributes( path.c_str() ) != -1;
+
+	do
+	{
+		if( strcmp( data.cFileName, "." ) != 0 &&
+			strcmp( data.cFileName, ".." ) != 0 )
+			names.insert( Key( data.cFileName ) );
+	}
+	while( FindNextFile( find, &data ) );
+
+	FindClose( find );
+	return true;
+#else
+	DIR* dir = opendir( path.c_str() );
+	if( !dir )
+		return false;
+
+	struct dirent* entry;
+	while( ( entry = readdir( dir ) ) != NULL )
+	{
+		if( strcmp( entry->d_name, "." ) != 0 &&
+			strcmp( entry->d_name, ".." ) != 0 )
+			names.insert( Key( entry->d_name ) );
+	}
+
+	closedir( dir );
+	return true;
+#endif
+}
+
+
+
+bool DirectoryIndex::AskFileSystem( const std::string& path )
+{
+#ifdef _WIN32
+	return GetFileAttributes( path.c_str() ) != -1;
+#else
+	return ::FileExists( path.c_str() );
+#endif
+}
+
+
+
+void DirectoryIndex::Lock()
+{
+#ifdef _WIN32
+	EnterCriticalSection( &myLock );
+#else
+	pthread_mutex_lock( &myLock );
+#endif
+}
+
+
+
+void DirectoryIndex::Unlock()
+{
+#ifdef _WIN32
+	LeaveCriticalSection( &myLock );
+#else
+	pthread_mutex_unlock( &myLock );
+#endif
+}
@@ -0,0 +1,150 @@
+// -------------------------------------------------------------------------
+// Filename:    DirectoryIndex.h
+// Class:       DirectoryIndex
+// Purpose:     Remembers what is in the game's data directories
+// Description:	Resolving a FilePath, finding a body part with ValidFsp or
+//				looking for the C16 version of a sprite file all ask the
+//				file system whether files exist, sometimes dozens of times
+//				for one lookup.  The DirectoryIndex lists the data
+//				directories (sounds, images, genetics, body data and so
+//				on, both the main ones and the current world's) once and
+//				answers from memory after that.
+//
+//				The index is built when the game starts and again whenever
+//				a world is loaded.  The engine keeps it up to date with
+//				the files it makes, moves and deletes itself: File::Create,
+//				World::MarkFileCreated and the attic, basement and porch
+//				moves.  Anything changed behind the engine's back is seen
+//				at the next rebuild.
+//
+//				Paths outside the indexed directories are passed on to the
+//				file system as before.  Counts of both are logged at
+//				shutdown.
+//
+//				Everything is done under a lock, as files are opened
+//				(and so possibly created) on the creature gallery
+//				builder's thread too.
+//
+// Usage:		if( DirectoryIndex::theDirectoryIndex().FileExists( path ) )
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifndef DIRECTORYINDEX_H
+#define DIRECTORYINDEX_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../common/C2eTypes.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+class DirectoryIndex
+{
+public:
+	static DirectoryIndex& theDirectoryIndex();
+
+	// ---------------------------------------------------------------------
+	// Method:      Build
+	// Arguments:   None
+	// Returns:     None
+	// Description:	Forgets everything and lists the main and current
+	//				world versions of each data directory.
+	// ---------------------------------------------------------------------
+	void Build();
+
+	// ---------------------------------------------------------------------
+	// Method:      FileExists
+	// Arguments:   path - full path of a file (or directory)
+	// Returns:     true if it exists, as GetFileAttributes would say
+	// Description:	Only asks the file system if the path isn't in an
+	//				indexed directory.
+	// ---------------------------------------------------------------------
+	bool FileExists( const std::string& path );
+
+	// ---------------------------------------------------------------------
+	// Method:      DirectoryExists
+	// Arguments:   path - full path of a directory, with the trailing
+	//				separator
+	// Returns:     true if it exists
+	// ---------------------------------------------------------------------
+	bool DirectoryExists( const std::string& path );
+
+	// ---------------------------------------------------------------------
+	// Method:      FileCreated, FileDeleted, FileMoved
+	// Arguments:   full paths of the files
+	// Returns:     None
+	// Description:	Keep the index up to date with a change the engine
+	//				has just made.  FileCreated is for new files only,
+	//				not ones that were opened.  Paths outside the
+	//				indexed directories are ignored.
+	// ---------------------------------------------------------------------
+	void FileCreated( const std::string& path );
+	void FileDeleted( const std::string& path );
+	void FileMoved( const std::string& from, const std::string& to );
+
+	// ---------------------------------------------------------------------
+	// Method:      Refresh
+	// Arguments:   directory - one of the directory numbers (IMAGES_DIR
+	//				etc.)
+	// Returns:     None
+	// Description:	Lists the main and world versions of the directory
+	//				again the next time they're asked about, for when
+	//				something has been written there without File::Create.
+	// ---------------------------------------------------------------------
+	void Refresh( int directory );
+
+	uint32 GetStatsAvoided() const { return myStatsAvoided; }
+	uint32 GetStatsMade() const { return myStatsMade; }
+	uint32 GetDirectoriesListed() const { return myDirectoriesListed; }
+
+private:
+	DirectoryIndex();
+
+	struct Directory
+	{
+		bool listed;				// false until (re)listed
+		bool exists;
+		std::set< std::string > names;	// files and subdirectories
+	};
+	typedef std::map< std::string, Directory > Directories;
+
+	void AddDirectory( const std::string& path );
+	Directory* FindDirectory( const std::string& path );
+	Directory* FindListedDirectory( const std::string& path );
+
+	static void SplitPath( const std::string& path, std::string& directory,
+		std::string& name );
+	static std::string Key( const std::string& name );
+	static bool List( const std::string& path, std::set< std::string >& names );
+	static bool AskFileSystem( const std::string& path );
+
+	// (recursive, as Build and Refresh come back in through
+	// App::GetWorldDirectoryVersion)
+	void Lock();
+	void Unlock();
+
+	Directories myDirectories;		// keyed by Key() of the path
+
+	uint32 myStatsAvoided;
+	uint32 myStatsMade;
+	uint32 myDirectoriesListed;
+
+#ifdef _WIN32
+	CRITICAL_SECTION myLock;
+#else
+	pthread_mutex_t myLock;
+#endif
+};
+
+#endif // DIRECTORYINDEX_H
@@ -41,7 +41,10 @@ myHeight(0),
 myGallery(NULL),
 myPixelWidth(0),
 myPixelHeight(0),
-myOwnerCamera(NULL)
+myOwnerCamera(NULL),
+myLastDisplayWidth(0),
+myLastDisplayHeight(0),
+myLastDrawValid(false)
 {
 
 }
@@ -66,6 +69,7 @@ bool Background::Create(FilePath const& gallery_name,
 						Camera* owner)
 {
 	myOwnerCamera = owner;
+	myLastDrawValid = false;
 	myWidth=BACKGROUND_WIDTH;
 	myHeight=BACKGROUND_HEIGHT;
 
@@ -124,6 +128,7 @@ bool Background::Create(FilePath const& gallery_name,
 						Camera* owner)
 {
 	myOwnerCamera = owner;
+	myLastDrawValid = false;
 	if(!gallery_name.empty())
 	{
 		myWidth=BACKGROUND_WIDTH;
@@ -379,21 +384,21 @@ bool Background::Read( CreaturesArchive &ar )
 // ----------------------------------------------------------------------
 // Method:      Draw 
 // Arguments:   completeRedraw - whether to draw the whole screen or
-//                                  just dirty rects
-//              dirtyRects - a list of dirty rects to compare against
+//                                  just dirty tiles
+//              dirtyTiles - tiles that were under sprites last frame
 //			
-// Returns:     true if the bitmap loads OK false otherwise
+// Returns:     None
 //
-// Description: Works out which tile needs to be drawn.  If this is not
-//				a complete redraw then a tile which coincides with each
-//				rectangle in the list must be found.
+// Description: Works out which tiles need to be drawn.  If this is not
+//				a complete redraw then only the dirty tiles are drawn.
+//				If the view has moved since the last draw the surface
+//				is scrolled to match and the newly exposed strip is
+//				drawn as well.
 //				
 //			
 // ----------------------------------------------------------------------
-void Background::Draw(bool completeRedraw,std::vector<RECT>& dirtyRects,
-					  IntegerPairList& dirtyTiles)
+void Background::Draw(bool completeRedraw,DirtyTileMap& dirtyTiles)
 {
-
 	if(!(myGallery && myGallery->IsValid()))
 		return;
 
@@ -422,8 +427,36 @@ void Background::Draw(bool completeRedraw,std::vector<RECT>& dirtyRects,
 
 	
 
+	// anything other than the last thing we drew on this surface
+	// means we can't trust what is already there
+	if(!myLastDrawValid ||
+		displayWidth != myLastDisplayWidth ||
+		displayHeight != myLastDisplayHeight)
+	{
+		completeRedraw = true;
+	}
+
+	// slide what we drew last time to where it should be now
+	int32 scrollX = myLastDrawnPosition.GetX() - myWorldPosition.GetX();
+	int32 scrollY = myLastDrawnPosition.GetY() - myWorldPosition.GetY();
+	if(!completeRedraw && (scrollX != 0 || scrollY != 0))
+	{
+		RECT area;
+		area.left = 0;
+		area.top = 0;
+		area.right = displayWidth;
+		area.bottom = displayHeight;
+		if(!DisplayEngine::theRenderer().ScrollBackBuffer(area,scrollX,scrollY))
+			completeRedraw = true;
+	}
+
+	myLastDrawnPosition = myWorldPosition;
+	myLastDisplayWidth = displayWidth;
+	myLastDisplayHeight = displayHeight;
+	myLastDrawValid = true;
+
 	//draw the whole background
-    if(completeRedraw  || dirtyRects.size() > 500)
+    if(completeRedraw)
     {
 		//	the background gallery effectively only has one bitmap which
 		// points to the relevant tile
@@ -499,130 +532,69 @@ void Background::Draw(bool completeRedraw,std::vector<RECT>& dirtyRects,
         }
     else
     {
-		//    DrawDirtyRects(dirtyRects);
-		// find out which background tiles intersect 
-		//	with the rect and draw
-		// the visible parts of them
-/*		std::vector<RECT>::iterator rect;
-	
-		Bitmap* bitmap = NULL;
-		int32 imod = 0;
-		uint32 z  = dirtyRects.size();
-		int top =0;
-		int bottom =0;
-		int left =0;
-		int right =0;
-		int32 xpos =0;
-		int32 ypos =0;
-		int32 y =0;
-		int32 x =0;
-	
-		for(rect = dirtyRects.begin(); rect != dirtyRects.end(); rect++)
-		{
-
-			top = ((*rect).top - myTopLeftWorldCoordinate.GetY())>>7;
-			bottom = ((*rect).bottom - myTopLeftWorldCoordinate.GetY())>>7;
-			left = ((*rect).left-myTopLeftWorldCoordinate.GetX())>>7;
-			right = ((*rect).right-myTopLeftWorldCoordinate.GetX())>>7;
-
-				 // screen position
-			
-			xpos =((left-x_div.quot) << 7)-x_div.rem;
-			ypos =((top-y_div.quot) << 7)-y_div.rem;
-
+		// the strips uncovered by scrolling, in screen co-ordinates
+		int32 exposedLeft = scrollX > 0 ? 0 : displayWidth + scrollX;
+		int32 exposedRight = scrollX > 0 ? scrollX : displayWidth;
+		int32 exposedTop = scrollY > 0 ? 0 : displayHeight + scrollY;
+		int32 exposedBottom = scrollY > 0 ? scrollY : displayHeight;
 
-		for (y=top;y<=bottom; y++,ypos = ((y-y_div.quot) << 7) - y_div.rem)
-			{	
-
-				for (x=left;x<=right; x++,  xpos = ((x - x_div.quot) << 7) - x_div.rem)
-				{
-					
-	  				 imod=x%myWidth;
-					// get the right tile
-			
-					bitmap = myGallery->GetTile((imod*myHeight) + y);
-					 if(bitmap)
-					 {
-					
-						 Position pos(xpos,ypos);
-						bitmap->SetPosition(Position(xpos,ypos));
-					//	 bitmap->Draw();
-					//	if((pos.GetX() < 0 || pos.GetY() < 0)||
-					//		(pos.GetX() + DEFAULT_ENVIRONMENT_RESOLUTION > displayWidth ||
-					//		pos.GetY()+ DEFAULT_ENVIRONMENT_RESOLUTION > displayHeight))
-							bitmap->Draw();
-					//	else
-					//		bitmap->DrawWholeBitmapRegardless();
-
-					 }
-				}// end for x=((*rect).left...
-			xpos =((left-x_div.quot) << 7)-x_div.rem;
-			}// end for y = (*rect).top...
-		}// end for rect = dirtyRects
-*/
-
-
-			// find out which background tiles intersect 
-		//	with the rect and draw
-		// the visible parts of them
-		// std::vector<RECT>::iterator rect;
-		IntegerPairListIterator it;
-		Bitmap* bitmap = NULL;
-	//	int32 imod = 0;
-	//	uint32 z  = dirtyRects.size();
-	//	int top =0;
-	//	int bottom =0;
-	//	int left =0;
-	//	int right =0;
-		int32 xpos =0;
-		int32 ypos =0;
-		int32 y =0;
-		int32 x =0;
-
-		
+		int32 lastX = x_div.quot + (x_div.rem + displayWidth - 1)/DEFAULT_ENVIRONMENT_RESOLUTION;
+		int32 lastY = y_div.quot + (y_div.rem + displayHeight - 1)/DEFAULT_ENVIRONMENT_RESOLUTION;
 
-				 // screen position
-			
-		
-
-		//	int x = dirtyTiles.begin()).first;
-	//	int y = dirtyTiles.begin()).second;
-
-		for(it = dirtyTiles.begin(); it != dirtyTiles.end() ; it++)
+		int32 ypos = -y_div.rem;
+		for(int32 y = y_div.quot; y <= lastY; y++, ypos += DEFAULT_ENVIRONMENT_RESOLUTION)
 		{
-			x = (*it).first;
-			y = (*it).second;
-			// get the position of each tile
-			xpos =(((*it).first-x_div.quot) << 7)-x_div.rem;
-			ypos =(((*it).second-y_div.quot) << 7)-y_div.rem;
-
-					
-					// get the right tile
-			
-					bitmap = myGallery->GetTile(((x%myWidth)*myHeight) + (*it).second);
-					 if(bitmap)
-					 {
-					
-					//	 Position pos(xpos,ypos);
-						bitmap->SetPosition(Position(xpos,ypos));
-					//	 bitmap->Draw();
-						if((xpos < 0 || ypos < 0)||
-							(xpos + DEFAULT_ENVIRONMENT_RESOLUTION > displayWidth ||
-							ypos + DEFAULT_ENVIRONMENT_RESOLUTION > displayHeight))
-							bitmap->Draw();
-						else
-							bitmap->DrawWholeBitmapRegardless();
-
-					 }
-		
-		}// end for rect = dirtyRects
+			bool rowExposed = ypos < exposedBottom &&
+				ypos + DEFAULT_ENVIRONMENT_RESOLUTION > exposedTop;
 
+			int32 xpos = -x_div.rem;
+			for(int32 x = x_div.quot; x <= lastX; x++, xpos += DEFAULT_ENVIRONMENT_RESOLUTION)
+			{
+				if(rowExposed ||
+					(xpos < exposedRight && xpos + DEFAULT_ENVIRONMENT_RESOLUTION > exposedLeft) ||
+					dirtyTiles.IsDirty(x,y))
+				{
+					DrawTile(x,y,xpos,ypos,displayWidth,displayHeight);
+				}
+			}
+		}
 	}// end else not complete draw
 
 //	myGallery->EndTileCount();
 
 }
 
+// ----------------------------------------------------------------------
+// Method:      DrawTile 
+// Arguments:   x,y - tile co-ordinates within the background
+//              xpos,ypos - where the tile goes on the screen
+//              displayWidth,displayHeight - size of the area drawn on
+//			
+// Returns:     None
+//
+// Description: Draws one tile, clipping it only if it hangs off the
+//				edge of the display area.
+//			
+// ----------------------------------------------------------------------
+void Background::DrawTile(int32 x, int32 y, int32 xpos, int32 ypos,
+						  int32 displayWidth, int32 displayHeight)
+{
+	if(x < 0 || y < 0 || y >= myHeight)
+		return;
+
+	Bitmap* bitmap = myGallery->GetTile(((x%myWidth)*myHeight) + y);
+	if(bitmap)
+	{
+		bitmap->SetPosition(Position(xpos,ypos));
+		if((xpos < 0 || ypos < 0)||
+			(xpos + DEFAULT_ENVIRONMENT_RESOLUTION > displayWidth ||
+			ypos + DEFAULT_ENVIRONMENT_RESOLUTION > displayHeight))
+			bitmap->Draw();
+		else
+			bitmap->DrawWholeBitmapRegardless();
+	}
+}
+
 Position& Background::GetDisplayPosition(void)
 {
 	return myWorldPosition;
@@ -12,6 +12,7 @@
 #include	<string>
 #include    <vector>
 #include	"Bitmap.h"
+#include	"DirtyTileMap.h"
 
 #define		BACKGROUND_WIDTH			DEFAULT_ENVIRONMENT_WIDTH
 #define		BACKGROUND_HEIGHT			DEFAULT_ENVIRONMENT_HEIGHT
@@ -19,10 +20,6 @@
 #define		BACKGROUND_BITMAP_WIDTH		DEFAULT_ENVIRONMENT_RESOLUTION
 #define		BACKGROUND_BITMAP_HEIGHT	DEFAULT_ENVIRONMENT_RESOLUTION
 
-typedef std::pair<int,int> IntegerPair;
-typedef std::list<IntegerPair> IntegerPairList;
-typedef IntegerPairList::iterator IntegerPairListIterator;
-
 
 class Camera;
 
@@ -37,8 +34,11 @@ public:
 	~Background();
 
 	void Draw(bool completeRedraw,
-		std::vector<RECT>& dirtyRects,
-		IntegerPairList& dirtyTiles);
+		DirtyTileMap& dirtyTiles);
+
+	// Forget what is on the surface so that the next Draw is
+	// a complete one (e.g. the surface was lost)
+	void Invalidate(){myLastDrawValid = false;}
 
 
 	Position& GetDisplayPosition(void);
@@ -98,6 +98,9 @@ private:
 	Background (const Background&);
 	Background& operator= (const Background&);
 
+	void DrawTile(int32 x, int32 y, int32 xpos, int32 ypos,
+		int32 displayWidth, int32 displayHeight);
+
 	Position	myWorldPosition;
 	Position	myTopLeftWorldCoordinate;
 
@@ -110,6 +113,13 @@ private:
 	BackgroundGallery*	myGallery;
 	Camera*	myOwnerCamera;
 
+	// what the surface held after the last Draw, so that a pan
+	// can scroll it rather than redraw everything
+	Position	myLastDrawnPosition;
+	int32		myLastDisplayWidth;
+	int32		myLastDisplayHeight;
+	bool		myLastDrawValid;
+
 };
 
 
@@ -503,8 +503,8 @@ bool Camera::Remove(Line* const chop)
 // ----------------------------------------------------------------------
 void Camera::DoUpdateAfterAdjustments()
 {
-	// Remember we need to do a complete redraw this time
-	myCompleteRedraw = true;
+	// Nothing to force here any more - the background notices that
+	// the view has moved and scrolls the back buffer to match
 }
 
 // ----------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #include "System.h"
 #include <stdio.h>
 #include "DisplayEngine.h"
+#include "TintManager.h"
 
 CREATURES_IMPLEMENT_SERIAL( CompressedGallery )
 
@@ -230,15 +231,15 @@ bool CompressedGallery::LoadFromC16(FilePath& fileName)
 
 	myCount = myMemoryMappedFile.ReadUINT16();
 
-	ASSERT(myCount != 0);
-
+	// (thrown rather than shown, as the CreatureGalleryBuilder loads
+	// these on its own thread)
 	if(myCount == 0)
 	{
-
-		ErrorMessageHandler::Show("gallery_error",
+		throw GalleryException(ErrorMessageHandler::Format("gallery_error",
 									1,
-									std::string("CompressedGallery::CompressedGallery"),
-									myName.GetFullPath().c_str());
+									std::string("CompressedGallery::LoadFromC16"),
+									myName.GetFullPath().c_str()),
+								__LINE__);
 	}
 
 	//create the correct number of bitmaps
@@ -575,6 +576,10 @@ int32 CompressedGallery::GetBitmapHeight(uint32 index)
 
 void CompressedGallery::Recolour(const uint16 tintTable[65536])
 {
+	// nothing to do for an untinted creature
+	if (TintManager::IsIdentityTable(tintTable))
+		return;
+
 	for(int i = 0; i < myCount; i++)
 		{
 		myCompressedBitmaps[i].Recolour(tintTable);
@@ -266,6 +266,36 @@ Gallery* CreatureGallery::AddCompressedCreature(std::string moniker,
 return NULL;
 }
 
+void CreatureGallery::PackCompressedCreature(uint32 uniqueID,
+									  int32 BodySprites[NUMPARTS],
+									  CompressedGallery creatureParts[NUMPARTS],
+									  int32 numSpritesInFile,
+									  uint32 validParts)
+{
+	while(true)
+	{
+		switch(	myCreatureBuildingStage)
+		{
+		case STAGE_ONE: if(!Part1CreatureBuilder( BodySprites,
+											creatureParts,
+											numSpritesInFile,
+											uniqueID,
+											validParts))
+											myCreatureBuildingStage = STAGE_COMPLETE;
+			break;
+		case STAGE_TWO: Part2CreatureBuilder(validParts,BodySprites,creatureParts);
+			break;
+		case STAGE_THREE: Part3CreatureBuilder(creatureParts,validParts);
+			break;
+		case STAGE_FOUR: Part4CreatureBuilder(creatureParts,validParts);
+			break;
+		default:
+			// STAGE_FIVE is up to AddCompressedCreature (or we're full)
+			return;
+		}
+	}
+}
+
 bool CreatureGallery::Part1CreatureBuilder( int32 BodySprites[NUMPARTS],
 									  CompressedGallery creatureParts[NUMPARTS],
 									  int32 numSpritesInFile,
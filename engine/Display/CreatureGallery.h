@@ -18,6 +18,10 @@
 //				When a creature must be deleted all we need do is set the key
 //				to null.
 //
+//				In practice each creature has a gallery file of its own
+//				(myMaxCreatures is 1), so there is only ever one slot and
+//				FindSlot reads a single key.
+//
 //				There should only be one instance of the Creature file
 //				 		
 //
@@ -101,6 +105,23 @@ Gallery* AddCompressedCreature(std::string moniker,
 							  CompressedGallery creatureParts[NUMPARTS],
 								int32 numSpritesInFile);
 
+// ----------------------------------------------------------------------
+// Method:		PackCompressedCreature
+// Arguments:	as AddCompressedCreature
+// Returns:		None
+// Description:	Runs all the building stages that only write to this
+//				gallery's own file, leaving the last one (making the
+//				Gallery) for AddCompressedCreature.  Only uses this
+//				object and the parts given, so the CreatureGalleryBuilder
+//				calls it from its own thread.
+//				
+// ----------------------------------------------------------------------
+void PackCompressedCreature(uint32 uniqueID,
+							int32 BodySprites[NUMPARTS],
+							CompressedGallery creatureParts[NUMPARTS],
+							int32 numSpritesInFile,
+							uint32 ValidParts);
+
 // ----------------------------------------------------------------------
 // Method:		RemoveCreature
 // Arguments:	moniker - the moniker key of the slot to free
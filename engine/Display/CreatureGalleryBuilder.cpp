@@ -0,0 +1,351 @@
+// -------------------------------------------------------------------------
+// Filename:    CreatureGalleryBuilder.cpp
+// Class:       CreatureGalleryBuilder
+// Purpose:     Builds creature galleries on a background thread
+// Description:	See CreatureGalleryBuilder.h
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "CreatureGalleryBuilder.h"
+#include "CreatureGallery.h"
+
+#include <algorithm>
+
+
+CreatureGalleryJob::CreatureGalleryJob()
+{
+	target = NULL;
+	uniqueID = 0;
+	for( int i = 0; i < NUMPARTS; ++i )
+		bodySprites[i] = 0;
+	numSpritesInFile = 0;
+	failed = false;
+	state = jobIdle;
+}
+
+
+
+// (never destroyed, as skeletons can cancel jobs at exit)
+CreatureGalleryBuilder& CreatureGalleryBuilder::theBuilder()
+{
+	static CreatureGalleryBuilder* builder = new CreatureGalleryBuilder;
+	return *builder;
+}
+
+
+
+CreatureGalleryBuilder::CreatureGalleryBuilder()
+{
+	myRunning = false;
+	myStopping = false;
+#ifdef _WIN32
+	myThread = NULL;
+	myWorkSemaphore = NULL;
+	myFinishedEvent = NULL;
+	InitializeCriticalSection( &myLock );
+#else
+	pthread_mutex_init( &myLock, NULL );
+	pthread_cond_init( &myWorkCondition, NULL );
+	pthread_cond_init( &myFinishedCondition, NULL );
+#endif
+}
+
+
+
+bool CreatureGalleryBuilder::Start()
+{
+	Stop();
+
+	myStopping = false;
+
+#ifdef _WIN32
+	myWorkSemaphore = CreateSemaphore( NULL, 0, 0x7fffffff, NULL );
+	myFinishedEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+	DWORD id;
+	if( myWorkSemaphore && myFinishedEvent )
+		myThread = CreateThread( NULL, 0, ThreadStart, this, 0, &id );
+	if( !myThread )
+	{
+		if( myWorkSemaphore )
+			CloseHandle( myWorkSemaphore );
+		if( myFinishedEvent )
+			CloseHandle( myFinishedEvent );
+		myWorkSemaphore = NULL;
+		myFinishedEvent = NULL;
+		return false;
+	}
+	// pick up anything queued while we were stopped
+	if( !myQueue.empty() )
+		ReleaseSemaphore( myWorkSemaphore, myQueue.size(), NULL );
+#else
+	if( pthread_create( &myThread, NULL, ThreadStart, this ) != 0 )
+		return false;
+#endif
+
+	myRunning = true;
+	return true;
+}
+
+
+
+void CreatureGalleryBuilder::Stop()
+{
+	if( !myRunning )
+		return;
+
+	Lock();
+	myStopping = true;
+	Unlock();
+
+#ifdef _WIN32
+	ReleaseSemaphore( myWorkSemaphore, 1, NULL );
+	WaitForSingleObject( myThread, INFINITE );
+	CloseHandle( myThread );
+	CloseHandle( myWorkSemaphore );
+	CloseHandle( myFinishedEvent );
+	myThread = NULL;
+	myWorkSemaphore = NULL;
+	myFinishedEvent = NULL;
+#else
+	pthread_cond_signal( &myWorkCondition );
+	pthread_join( myThread, NULL );
+#endif
+
+	myRunning = false;
+	myStopping = false;
+}
+
+
+
+void CreatureGalleryBuilder::Submit( CreatureGalleryJob* job )
+{
+	ASSERT( job && job->target );
+	ASSERT( job->state == CreatureGalleryJob::jobIdle ||
+		job->state == CreatureGalleryJob::jobDone );
+
+	if( !myRunning )
+	{
+		Build( *job );
+		job->state = CreatureGalleryJob::jobDone;
+		return;
+	}
+
+	Lock();
+	job->state = CreatureGalleryJob::jobQueued;
+	myQueue.push_back( job );
+	Unlock();
+
+#ifdef _WIN32
+	ReleaseSemaphore( myWorkSemaphore, 1, NULL );
+#else
+	pthread_cond_signal( &myWorkCondition );
+#endif
+}
+
+
+
+bool CreatureGalleryBuilder::IsDone( CreatureGalleryJob* job )
+{
+	Lock();
+	bool done = job->state == CreatureGalleryJob::jobDone;
+	Unlock();
+	return done;
+}
+
+
+
+void CreatureGalleryBuilder::Wait( CreatureGalleryJob* job )
+{
+	if( TakeOutOfQueue( job ) )
+	{
+		Build( *job );
+		Lock();
+		job->state = CreatureGalleryJob::jobDone;
+		Unlock();
+		return;
+	}
+	WaitUntilFinished( job );
+}
+
+
+
+void CreatureGalleryBuilder::Cancel( CreatureGalleryJob* job )
+{
+	if( TakeOutOfQueue( job ) )
+	{
+		Lock();
+		job->state = CreatureGalleryJob::jobIdle;
+		Unlock();
+		return;
+	}
+	WaitUntilFinished( job );
+}
+
+
+
+// Returns true if the job was still waiting its turn
+bool CreatureGalleryBuilder::TakeOutOfQueue( CreatureGalleryJob* job )
+{
+	bool found = false;
+	Lock();
+	if( job->state == CreatureGalleryJob::jobQueued )
+	{
+		std::deque< CreatureGalleryJob* >::iterator it =
+			std::find( myQueue.begin(), myQueue.end(), job );
+		ASSERT( it != myQueue.end() );
+		myQueue.erase( it );
+		job->state = CreatureGalleryJob::jobRunning;
+		found = true;
+	}
+	Unlock();
+	return found;
+}
+
+
+
+void CreatureGalleryBuilder::WaitUntilFinished( CreatureGalleryJob* job )
+{
+	Lock();
+	while( job->state == CreatureGalleryJob::jobRunning )
+	{
+#ifdef _WIN32
+		Unlock();
+		WaitForSingleObject( myFinishedEvent, INFINITE );
+		Lock();
+#else
+		pthread_cond_wait( &myFinishedCondition, &myLock );
+#endif
+	}
+	Unlock();
+}
+
+
+
+// Everything here must only use the job - the thread shares nothing
+// else with the game.
+void CreatureGalleryBuilder::Build( CreatureGalleryJob& job )
+{
+	job.failed = false;
+	job.error.erase();
+	job.numSpritesInFile = 0;
+
+	try
+	{
+		const uint16* tintTable = job.tint.GetMyTintTable();
+		int part;
+		for( part = 0; part < NUMPARTS; ++part )
+		{
+			job.partGalleries[part].LoadFromC16( job.parts[part] );
+			job.partGalleries[part].Recolour( tintTable );
+			job.numSpritesInFile += job.partGalleries[part].GetCount();
+		}
+
+		job.target->PackCompressedCreature( job.uniqueID,
+			job.bodySprites,
+			job.partGalleries,
+			job.numSpritesInFile,
+			NUMPARTS );
+
+		// the packed copy is all that's wanted now
+		for( part = 0; part < NUMPARTS; ++part )
+			job.partGalleries[part].Trash();
+	}
+	catch( BasicException& e )
+	{
+		job.failed = true;
+		job.error = e.what();
+	}
+	catch( ... )
+	{
+		job.failed = true;
+	}
+}
+
+
+
+// static entry point for the thread - just passes control on
+// to the non-static ThreadMain().
+#ifdef _WIN32
+DWORD WINAPI CreatureGalleryBuilder::ThreadStart( LPVOID builder )
+{
+	((CreatureGalleryBuilder*)builder)->ThreadMain();
+	return 0;
+}
+#else
+void* CreatureGalleryBuilder::ThreadStart( void* builder )
+{
+	((CreatureGalleryBuilder*)builder)->ThreadMain();
+	return NULL;
+}
+#endif
+
+
+
+void CreatureGalleryBuilder::ThreadMain()
+{
+	while( true )
+	{
+#ifdef _WIN32
+		WaitForSingleObject( myWorkSemaphore, INFINITE );
+		Lock();
+#else
+		Lock();
+		while( myQueue.empty() && !myStopping )
+			pthread_cond_wait( &myWorkCondition, &myLock );
+#endif
+		if( myStopping )
+		{
+			Unlock();
+			return;
+		}
+		if( myQueue.empty() )
+		{
+			// (taken by Wait or Cancel in the meantime)
+			Unlock();
+			continue;
+		}
+
+		CreatureGalleryJob* job = myQueue.front();
+		myQueue.pop_front();
+		job->state = CreatureGalleryJob::jobRunning;
+		Unlock();
+
+		Build( *job );
+
+		Lock();
+		job->state = CreatureGalleryJob::jobDone;
+#ifdef _WIN32
+		SetEvent( myFinishedEvent );
+#else
+		pthread_cond_broadcast( &myFinishedCondition );
+#endif
+		Unlock();
+	}
+}
+
+
+
+void CreatureGalleryBuilder::Lock()
+{
+#ifdef _WIN32
+	EnterCriticalSection( &myLock );
+#else
+	pthread_mutex_lock( &myLock );
+#endif
+}
+
+
+
+void CreatureGalleryBuilder::Unlock()
+{
+#ifdef _WIN32
+	LeaveCriticalSection( &myLock );
+#else
+	pthread_mutex_unlock( &myLock );
+#endif
+}
@@ -0,0 +1,181 @@
+// -------------------------------------------------------------------------
+// Filename:    CreatureGalleryBuilder.h
+// Class:       CreatureGalleryBuilder
+// Purpose:     Builds creature galleries on a background thread
+// Description:	Making a creature's gallery means loading a C16 for each
+//				body part, recolouring it with the creature's tint and
+//				packing the lot into its CreatureGallery file.  Doing
+//				that on the main thread stalls the game whenever an egg
+//				hatches or a creature ages, so the Skeleton fills in a
+//				CreatureGalleryJob and hands it over here instead.
+//
+//				The job carries everything the thread needs (full file
+//				paths, its own copy of the tint and its own staging
+//				galleries for the parts), and while it is queued or
+//				running only the builder touches it or its target
+//				CreatureGallery.  Once it is done the main thread makes
+//				the Gallery object with SharedGallery::CreateGallery as
+//				before, which just swaps in the finished file.
+//
+//				If the thread can't be started, jobs are built on the
+//				main thread as they are submitted.
+//
+// Usage:		CreatureGalleryBuilder::theBuilder().Submit( job );
+//				...each tick...
+//				if( CreatureGalleryBuilder::theBuilder().IsDone( job ) )
+//					// finish off the gallery
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifndef CREATUREGALLERYBUILDER_H
+#define CREATUREGALLERYBUILDER_H
+
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../Creature/Definitions.h"
+#include "../FilePath.h"
+#include "CompressedGallery.h"
+#include "TintManager.h"
+
+#include <deque>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+class CreatureGallery;
+
+struct CreatureGalleryJob
+{
+	CreatureGalleryJob();
+
+	// Filled in by the main thread before submitting
+	CreatureGallery* target;
+	uint32 uniqueID;
+	FilePath parts[NUMPARTS];		// body part C16s, as full paths
+	TintManager tint;
+
+	// Filled in by the builder
+	CompressedGallery partGalleries[NUMPARTS];	// staging for the parts
+	int32 bodySprites[NUMPARTS];	// first sprite of each part
+	int32 numSpritesInFile;
+	bool failed;
+	std::string error;				// why, if it threw
+
+	enum
+	{
+		jobIdle = 0,
+		jobQueued,
+		jobRunning,
+		jobDone
+	} state;						// (only changed under the builder's lock)
+
+private:
+	CreatureGalleryJob( const CreatureGalleryJob& );
+	CreatureGalleryJob& operator=( const CreatureGalleryJob& );
+};
+
+
+class CreatureGalleryBuilder
+{
+public:
+	static CreatureGalleryBuilder& theBuilder();
+
+	// ---------------------------------------------------------------------
+	// Method:      Start
+	// Arguments:   None
+	// Returns:     true for Success
+	// Description:	Creates the builder thread.
+	// ---------------------------------------------------------------------
+	bool Start();
+
+	// ---------------------------------------------------------------------
+	// Method:      Stop
+	// Arguments:   None
+	// Returns:     None
+	// Description:	Waits for the current job and stops the thread.  Jobs
+	//				still queued stay queued; waiting for them builds
+	//				them on the calling thread.
+	// ---------------------------------------------------------------------
+	void Stop();
+
+	// ---------------------------------------------------------------------
+	// Method:      Submit
+	// Arguments:   job - the job to build.  It must stay alive until it
+	//				is done or has been cancelled.
+	// Returns:     None
+	// Description:	Queues the job for the builder thread.
+	// ---------------------------------------------------------------------
+	void Submit( CreatureGalleryJob* job );
+
+	// ---------------------------------------------------------------------
+	// Method:      IsDone
+	// Arguments:   job - a submitted job
+	// Returns:     true once the job has been built (or has failed)
+	// Description:	Doesn't wait.
+	// ---------------------------------------------------------------------
+	bool IsDone( CreatureGalleryJob* job );
+
+	// ---------------------------------------------------------------------
+	// Method:      Wait
+	// Arguments:   job - a submitted job
+	// Returns:     None
+	// Description:	Blocks until the job is done.  A job still in the
+	//				queue is taken out and built on the calling thread
+	//				rather than waiting for the ones in front of it.
+	// ---------------------------------------------------------------------
+	void Wait( CreatureGalleryJob* job );
+
+	// ---------------------------------------------------------------------
+	// Method:      Cancel
+	// Arguments:   job - a submitted job
+	// Returns:     None
+	// Description:	Takes the job out of the queue, or waits for it to
+	//				finish if it has already started, so that it and its
+	//				target gallery can be deleted.
+	// ---------------------------------------------------------------------
+	void Cancel( CreatureGalleryJob* job );
+
+private:
+	CreatureGalleryBuilder();
+
+	static void Build( CreatureGalleryJob& job );
+
+#ifdef _WIN32
+	static DWORD WINAPI ThreadStart( LPVOID builder );
+#else
+	static void* ThreadStart( void* builder );
+#endif
+	void ThreadMain();
+
+	bool TakeOutOfQueue( CreatureGalleryJob* job );
+	void WaitUntilFinished( CreatureGalleryJob* job );
+
+	void Lock();
+	void Unlock();
+
+	bool myRunning;
+	bool myStopping;
+	std::deque< CreatureGalleryJob* > myQueue;
+
+#ifdef _WIN32
+	HANDLE myThread;
+	HANDLE myWorkSemaphore;		// released once for each job queued
+	HANDLE myFinishedEvent;		// set whenever a job has been built
+	CRITICAL_SECTION myLock;
+#else
+	pthread_t myThread;
+	pthread_cond_t myWorkCondition;
+	pthread_cond_t myFinishedCondition;
+	pthread_mutex_t myLock;
+#endif
+};
+
+#endif // CREATUREGALLERYBUILDER_H
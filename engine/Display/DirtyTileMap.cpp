@@ -0,0 +1,90 @@
+// --------------------------------------------------------------------------
+// Filename:	DirtyTileMap.cpp
+// Class:		DirtyTileMap
+// Purpose:		Remembers which background tiles need redrawing.
+//
+// Description: See DirtyTileMap.h
+//
+// History:
+// --------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "DirtyTileMap.h"
+#include <string.h>
+
+DirtyTileMap::DirtyTileMap()
+:myColumns(0),
+myRows(0),
+myDirtyCount(0)
+{
+}
+
+void DirtyTileMap::MarkRange(int32 left, int32 top, int32 right, int32 bottom)
+{
+	if(left < 0)
+		left = 0;
+	if(top < 0)
+		top = 0;
+	if(right < left || bottom < top)
+		return;
+
+	if(right >= myColumns || bottom >= myRows)
+		Grow(right >= myColumns ? right + 1 : myColumns,
+			bottom >= myRows ? bottom + 1 : myRows);
+
+	for(int32 y = top; y <= bottom; y++)
+	{
+		uint8* tile = &myTiles[y * myColumns + left];
+		for(int32 x = left; x <= right; x++, tile++)
+		{
+			if(!*tile)
+			{
+				*tile = 1;
+				myDirtyCount++;
+			}
+		}
+	}
+}
+
+void DirtyTileMap::Clear()
+{
+	if(myDirtyCount)
+	{
+		memset(&myTiles[0], 0, myTiles.size());
+		myDirtyCount = 0;
+	}
+}
+
+void DirtyTileMap::Swap(DirtyTileMap& other)
+{
+	myTiles.swap(other.myTiles);
+
+	int32 temp = myColumns;
+	myColumns = other.myColumns;
+	other.myColumns = temp;
+
+	temp = myRows;
+	myRows = other.myRows;
+	other.myRows = temp;
+
+	temp = myDirtyCount;
+	myDirtyCount = other.myDirtyCount;
+	other.myDirtyCount = temp;
+}
+
+void DirtyTileMap::Grow(int32 columns, int32 rows)
+{
+	std::vector<uint8> tiles(columns * rows, 0);
+
+	for(int32 y = 0; y < myRows; y++)
+	{
+		if(myColumns)
+			memcpy(&tiles[y * columns], &myTiles[y * myColumns], myColumns);
+	}
+
+	myTiles.swap(tiles);
+	myColumns = columns;
+	myRows = rows;
+}
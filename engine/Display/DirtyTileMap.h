@@ -0,0 +1,61 @@
+// --------------------------------------------------------------------------
+// Filename:	DirtyTileMap.h
+// Class:		DirtyTileMap
+// Purpose:		Remembers which background tiles need redrawing.
+//
+// Description: One flag per 128x128 background tile, addressed in tile
+//				co-ordinates relative to the top left of the background.
+//				The map grows to fit whatever is marked so it does not
+//				need to know the size of the background in advance, and
+//				clearing it only touches memory when something was marked.
+//
+// History:
+// --------------------------------------------------------------------------
+#ifndef		DIRTY_TILE_MAP_H
+#define		DIRTY_TILE_MAP_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../../common/C2eTypes.h"
+#include <vector>
+
+class DirtyTileMap
+{
+public:
+	DirtyTileMap();
+
+	// ----------------------------------------------------------------------
+	// Method:      MarkRange
+	// Arguments:   left, top, right, bottom - inclusive tile co-ordinates
+	// Returns:     None
+	// Description: Flags every tile in the range as needing a redraw.
+	//				Negative co-ordinates are ignored.
+	// ----------------------------------------------------------------------
+	void MarkRange(int32 left, int32 top, int32 right, int32 bottom);
+
+	bool IsDirty(int32 x, int32 y) const
+	{
+		return x >= 0 && y >= 0 && x < myColumns && y < myRows &&
+			myTiles[y * myColumns + x] != 0;
+	}
+
+	bool IsEmpty() const {return myDirtyCount == 0;}
+
+	void Clear();
+
+	// Exchange contents - used to turn this frame's marks into
+	// last frame's without copying them
+	void Swap(DirtyTileMap& other);
+
+private:
+	void Grow(int32 columns, int32 rows);
+
+	std::vector<uint8> myTiles;
+	int32 myColumns;
+	int32 myRows;
+	int32 myDirtyCount;
+};
+
+#endif		// DIRTY_TILE_MAP_H
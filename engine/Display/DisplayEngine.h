@@ -361,6 +361,8 @@ public:
 	void ReleaseSurface(LPDIRECTDRAWSURFACE4& tempSurface);
 
 
+	bool ScrollBackBuffer(RECT& area, int32 dx, int32 dy);
+
 	bool FlipScreenHorizontally();
 	void FlipScreenVertically();
 	bool SlideScreen();
@@ -52,6 +52,8 @@
 DrawableObjectListMap DrawableObjectHandler::myRenderObjects;
 DrawableObjectRenderMappings DrawableObjectHandler::myRenderMappings;
 
+DrawableObjectIndex DrawableObjectHandler::ourVisibilityIndex;
+
 bool DrawableObjectHandler::ourAlreadyDoneSetCurrentBoundsThisTick = false;
 
 // ----------------------------------------------------------------------
@@ -137,6 +139,7 @@ bool DrawableObjectHandler::InsertObject( DrawableObject* const  obj, RECT* rect
 	}
 	myRenderObjects[thePlane].push_back(obj);
 	myRenderMappings.insert(std::make_pair(obj,--(myRenderObjects[thePlane].end())));
+	ourVisibilityIndex.Add(obj,thePlane);
 
 	// don't deal with lines
 	return true;
@@ -199,17 +202,13 @@ DrawableObjectHandler::~DrawableObjectHandler()
 //								 just dirty rects.
 // Returns:     None
 //
-// Description: myRenderObjects has been presorted into plane order and
-//				non visible entities have been weeded out so just draw
-//				the list.
+// Description: Asks the visibility index for the objects that touch
+//				the view area, which come back in plane order, and draws
+//				them.
 //			
 // ----------------------------------------------------------------------
 void DrawableObjectHandler::Draw(bool completeRedraw)
 {
-
-	DrawableObjectListMap::iterator it;
-	DrawableObjectList::iterator oit;
-	
 	RECT rect;
 	/* // Try this with Boxes instead
 	POINT topLeft;
@@ -225,11 +224,11 @@ void DrawableObjectHandler::Draw(bool completeRedraw)
 	Box displayBox(displayRect);
 	Box entityBox;
 	
+	ourVisibilityIndex.Find(displayRect,myVisibleObjects);
 
-	for(it = myRenderObjects.begin(); it != myRenderObjects.end(); it++)
-	for(oit = (*it).second.begin(); oit != (*it).second.end(); oit++)
+	for(int i = 0; i < myVisibleObjects.size(); i++)
 		{
-		DrawableObject* obj = (*oit);
+		DrawableObject* obj = myVisibleObjects[i];
 
 		// if remote cameras cannot be allowed to try to draw themselves
 		if (obj->AreYouALine() && myOwnerCamera->IsRemote())
@@ -255,14 +254,9 @@ void DrawableObjectHandler::Draw(bool completeRedraw)
 
 		}
 
- 	myOldDirtyTiles.clear();
-#ifdef _MSC_VER
-	// TODO: is this ANSI?
-	myOldDirtyTiles.assign(myNewDirtyTiles.begin(),myNewDirtyTiles.end());
-#else
-	myOldDirtyTiles = myNewDirtyTiles;
-#endif
-	myNewDirtyTiles.clear();
+	// the tiles under this frame's sprites must be redrawn next frame
+	myOldDirtyTiles.Swap(myNewDirtyTiles);
+	myNewDirtyTiles.Clear();
 }
 
 void DrawableObjectHandler::SetInterestLevel(bool interested)
@@ -285,23 +279,20 @@ void DrawableObjectHandler::Update(Position pos)
 	if(myShutDownFlag)
 		return ;
 	RECT rect;
-	DrawableObjectListMap::iterator it;
-	DrawableObjectList::iterator oit;
 	RECT displayRect;
 
 	myOwnerCamera->GetViewArea(displayRect);
 	myNewRects.clear();
 
-	std::map<IntegerPair,bool> ourBackgroundTilesMap;
+	// everything's bounds are brought up to date once a tick,
+	// cameras every time
+	ourVisibilityIndex.UpdateBounds(!ourAlreadyDoneSetCurrentBoundsThisTick);
+	ourVisibilityIndex.Find(displayRect,myVisibleObjects);
 
 	int top,bottom,left,right = 0;
-	for(it = myRenderObjects.begin(); it != myRenderObjects.end(); it++)
-	for(oit = (*it).second.begin(); oit != (*it).second.end(); oit++)
+	for(int i = 0; i < myVisibleObjects.size(); i++)
 	{
-
-		DrawableObject* sprite = (*oit);
-		if (!ourAlreadyDoneSetCurrentBoundsThisTick || sprite->AreYouACamera())
-			sprite->SetCurrentBound();
+		DrawableObject* sprite = myVisibleObjects[i];
 		sprite->GetBound(rect);
 
 		if(IsRectOnScreen(rect,displayRect))
@@ -319,14 +310,7 @@ void DrawableObjectHandler::Update(Position pos)
 			left = (rect.left-backgroundTopLeft.GetX())>>7;
 			right = (rect.right-backgroundTopLeft.GetX())>>7;
 
-			for(int i = left; i <= right; i++ )
-			{
-				for (int j = top; j <= bottom; j++)
-				{
-					IntegerPair tilepos(i,j);// = std::make_pair<i,j>;
-					ourBackgroundTilesMap[tilepos] = true;
-				}
-			}
+			myNewDirtyTiles.MarkRange(left,top,right,bottom);
 		}
 	}
 	// now add the fast rectangles
@@ -341,9 +325,6 @@ void DrawableObjectHandler::Update(Position pos)
 	myFastRects.clear();
 	myWorldPosition = pos;
 	ourAlreadyDoneSetCurrentBoundsThisTick = true;
-	std::map<IntegerPair,bool>::iterator mapIterator(ourBackgroundTilesMap.begin());
-	for(;mapIterator != ourBackgroundTilesMap.end();mapIterator++)
-		myNewDirtyTiles.push_back((*mapIterator).first);
 }
 
 void DrawableObjectHandler::ShutDown()
@@ -431,6 +412,7 @@ bool DrawableObjectHandler::Remove(EntityImage* const chop)
 		return false;
 	oit = (*mit).second;
 
+	ourVisibilityIndex.Remove((*mit).first);
 	myRenderObjects[(*oit)->GetPlane()].erase(oit);
 	myRenderMappings.erase(mit);
 
@@ -463,6 +445,7 @@ bool DrawableObjectHandler::Remove(Camera* const chop)
 		return false;
 	oit = (*mit).second;
 
+	ourVisibilityIndex.Remove((*mit).first);
 	myRenderObjects[(*oit)->GetPlane()].erase(oit);
 	myRenderMappings.erase(mit);
 
@@ -495,6 +478,7 @@ bool DrawableObjectHandler::Remove(Line* const chop)
 		return false;
 	oit = (*mit).second;
 
+	ourVisibilityIndex.Remove((*mit).first);
 	myRenderObjects[(*oit)->GetPlane()].erase(oit);
 	myRenderMappings.erase(mit);
 
@@ -38,6 +38,8 @@
 #include "../mfchack.h"
 
 #include	"DrawableObject.h"
+#include	"DirtyTileMap.h"
+#include	"DrawableObjectIndex.h"
 #include	<list>
 #include	<vector>
 #include    <map>
@@ -48,9 +50,6 @@
 typedef  std::list<DrawableObject*> DrawableObjectList;
 typedef  std::vector<RECT>::iterator RECT_ITERATOR;
 
-typedef std::pair<int,int> IntegerPair;
-typedef std::list<IntegerPair> IntegerPairList;
-
 typedef std::map<uint32,DrawableObjectList> DrawableObjectListMap;
 typedef std::map<DrawableObject*,std::list<DrawableObject*>::iterator> DrawableObjectRenderMappings;
 
@@ -111,9 +110,8 @@ public:
 	//								 just dirty rects.
 	// Returns:     None
 	//
-	// Description: myRenderObjects has been presorted into plane order and
-	//				non visible entities have been weeded out so just draw
-	//				the list.
+	// Description: Draws the objects the visibility index says touch
+	//				the view area, in plane order.
 	//			
 	// ----------------------------------------------------------------------
 	void Draw(bool completeRedraw);
@@ -160,7 +158,7 @@ public:
 	bool Add(EntityImage* const newEntity);
 
     std::vector<RECT>& GetUpdateList() {return myOldRects;}
-	IntegerPairList& GetDirtyTileList(){return myOldDirtyTiles;}
+	DirtyTileMap& GetDirtyTiles(){return myOldDirtyTiles;}
 
 	void GetScreenRect(RECT& rect)
 	{
@@ -222,6 +220,11 @@ private:
 	static DrawableObjectListMap myRenderObjects;
 	static DrawableObjectRenderMappings myRenderMappings;
 
+	// the same objects filed by position so each camera only
+	// looks at the ones it can see
+	static DrawableObjectIndex ourVisibilityIndex;
+	std::vector<DrawableObject*> myVisibleObjects;
+
 	// rectangles dirtied in the last draw
 	std::vector<RECT> myOldRects;
 
@@ -231,8 +234,9 @@ private:
 	// current dirty rectangles of fast objects
 	std::vector<RECT> myFastRects;
 
-	IntegerPairList myNewDirtyTiles;
-	IntegerPairList myOldDirtyTiles;
+	// background tiles under this frame's and last frame's sprites
+	DirtyTileMap myNewDirtyTiles;
+	DirtyTileMap myOldDirtyTiles;
 
 	// where are we looking in the world?
 	Position myWorldPosition;
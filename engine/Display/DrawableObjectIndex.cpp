@@ -0,0 +1,236 @@
+// --------------------------------------------------------------------------
+// Filename:	DrawableObjectIndex.cpp
+// Class:		DrawableObjectIndex
+// Purpose:		Finds the drawable objects that overlap an area of the
+//				world without looking at every object.
+//
+// Description: See DrawableObjectIndex.h
+//
+// History:
+// --------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "DrawableObjectIndex.h"
+#include "DrawableObject.h"
+#include <algorithm>
+
+DrawableObjectIndex::DrawableObjectIndex()
+:myNextOrder(0),
+myFindStamp(0)
+{
+}
+
+DrawableObjectIndex::~DrawableObjectIndex()
+{
+	std::map<DrawableObject*, Entry*>::iterator it;
+	for(it = myEntries.begin(); it != myEntries.end(); it++)
+		delete (*it).second;
+}
+
+void DrawableObjectIndex::Add(DrawableObject* object, uint32 plane)
+{
+	if(myEntries.find(object) != myEntries.end())
+		Remove(object);
+
+	Entry* entry = new Entry;
+	entry->object = object;
+	entry->plane = plane;
+	entry->order = myNextOrder++;
+	entry->findStamp = myFindStamp;
+	object->GetBound(entry->bound);
+
+	myEntries[object] = entry;
+	File(entry);
+}
+
+void DrawableObjectIndex::Remove(DrawableObject* object)
+{
+	std::map<DrawableObject*, Entry*>::iterator it = myEntries.find(object);
+	if(it == myEntries.end())
+		return;
+
+	Unfile((*it).second);
+	delete (*it).second;
+	myEntries.erase(it);
+}
+
+void DrawableObjectIndex::UpdateBounds(bool everything)
+{
+	RECT bound;
+
+	if(everything)
+	{
+		std::map<DrawableObject*, Entry*>::iterator it;
+		for(it = myEntries.begin(); it != myEntries.end(); it++)
+		{
+			Entry* entry = (*it).second;
+			entry->object->SetCurrentBound();
+			entry->object->GetBound(bound);
+			if(bound.left != entry->bound.left || bound.top != entry->bound.top ||
+				bound.right != entry->bound.right || bound.bottom != entry->bound.bottom)
+			{
+				Unfile(entry);
+				entry->bound = bound;
+				File(entry);
+			}
+		}
+	}
+	else
+	{
+		// cameras are always unfiled so their bounds can
+		// change without any refiling
+		for(int i = 0; i < myUnfiledEntries.size(); i++)
+		{
+			Entry* entry = myUnfiledEntries[i];
+			if(entry->object->AreYouACamera())
+			{
+				entry->object->SetCurrentBound();
+				entry->object->GetBound(entry->bound);
+			}
+		}
+	}
+}
+
+void DrawableObjectIndex::Find(const RECT& area, std::vector<DrawableObject*>& found)
+{
+	found.clear();
+	myFoundEntries.clear();
+	++myFindStamp;
+
+	int32 cellLeft = area.left >> CELL_SHIFT;
+	int32 cellTop = area.top >> CELL_SHIFT;
+	int32 cellRight = area.right >> CELL_SHIFT;
+	int32 cellBottom = area.bottom >> CELL_SHIFT;
+
+	int32 width = cellRight - cellLeft + 1;
+	int32 height = cellBottom - cellTop + 1;
+
+	int i;
+	if(width > BUCKET_COUNT || height > BUCKET_COUNT || width * height > BUCKET_COUNT)
+	{
+		// the area covers more cells than there are buckets so
+		// just look at every filed object once
+		cellBottom = cellTop - 1;
+		std::map<DrawableObject*, Entry*>::iterator it;
+		for(it = myEntries.begin(); it != myEntries.end(); it++)
+		{
+			Entry* entry = (*it).second;
+			if(entry->filed &&
+				entry->bound.right >= area.left && entry->bound.left <= area.right &&
+				entry->bound.bottom >= area.top && entry->bound.top <= area.bottom)
+			{
+				myFoundEntries.push_back(entry);
+			}
+		}
+	}
+
+	for(int32 cellY = cellTop; cellY <= cellBottom; cellY++)
+	{
+		for(int32 cellX = cellLeft; cellX <= cellRight; cellX++)
+		{
+			std::vector<Entry*>& bucket = Bucket(cellX,cellY);
+			for(i = 0; i < bucket.size(); i++)
+			{
+				Entry* entry = bucket[i];
+				if(entry->findStamp == myFindStamp)
+					continue;
+				entry->findStamp = myFindStamp;
+				if(entry->bound.right >= area.left && entry->bound.left <= area.right &&
+					entry->bound.bottom >= area.top && entry->bound.top <= area.bottom)
+				{
+					myFoundEntries.push_back(entry);
+				}
+			}
+		}
+	}
+
+	for(i = 0; i < myUnfiledEntries.size(); i++)
+	{
+		Entry* entry = myUnfiledEntries[i];
+		if(entry->bound.right >= area.left && entry->bound.left <= area.right &&
+			entry->bound.bottom >= area.top && entry->bound.top <= area.bottom)
+		{
+			myFoundEntries.push_back(entry);
+		}
+	}
+
+	std::sort(myFoundEntries.begin(), myFoundEntries.end(), DrawsBefore);
+
+	found.reserve(myFoundEntries.size());
+	for(i = 0; i < myFoundEntries.size(); i++)
+		found.push_back(myFoundEntries[i]->object);
+}
+
+bool DrawableObjectIndex::DrawsBefore(const Entry* a, const Entry* b)
+{
+	if(a->plane != b->plane)
+		return a->plane < b->plane;
+	return a->order < b->order;
+}
+
+void DrawableObjectIndex::File(Entry* entry)
+{
+	entry->cellLeft = entry->bound.left >> CELL_SHIFT;
+	entry->cellTop = entry->bound.top >> CELL_SHIFT;
+	entry->cellRight = entry->bound.right >> CELL_SHIFT;
+	entry->cellBottom = entry->bound.bottom >> CELL_SHIFT;
+
+	int32 width = entry->cellRight - entry->cellLeft + 1;
+	int32 height = entry->cellBottom - entry->cellTop + 1;
+
+	entry->filed = !entry->object->AreYouACamera() &&
+		width > 0 && height > 0 &&
+		width <= MAX_FILED_CELLS && height <= MAX_FILED_CELLS &&
+		width * height <= MAX_FILED_CELLS;
+
+	if(!entry->filed)
+	{
+		myUnfiledEntries.push_back(entry);
+		return;
+	}
+
+	for(int32 cellY = entry->cellTop; cellY <= entry->cellBottom; cellY++)
+	{
+		for(int32 cellX = entry->cellLeft; cellX <= entry->cellRight; cellX++)
+			Bucket(cellX,cellY).push_back(entry);
+	}
+}
+
+void DrawableObjectIndex::Unfile(Entry* entry)
+{
+	std::vector<Entry*>::iterator it;
+
+	if(!entry->filed)
+	{
+		it = std::find(myUnfiledEntries.begin(), myUnfiledEntries.end(), entry);
+		if(it != myUnfiledEntries.end())
+		{
+			*it = myUnfiledEntries.back();
+			myUnfiledEntries.pop_back();
+		}
+		return;
+	}
+
+	// take out one reference per cell - two cells may share a bucket
+	for(int32 cellY = entry->cellTop; cellY <= entry->cellBottom; cellY++)
+	{
+		for(int32 cellX = entry->cellLeft; cellX <= entry->cellRight; cellX++)
+		{
+			std::vector<Entry*>& bucket = Bucket(cellX,cellY);
+			it = std::find(bucket.begin(), bucket.end(), entry);
+			if(it != bucket.end())
+			{
+				*it = bucket.back();
+				bucket.pop_back();
+			}
+		}
+	}
+}
+
+std::vector<DrawableObjectIndex::Entry*>& DrawableObjectIndex::Bucket(int32 cellX, int32 cellY)
+{
+	uint32 hash = ((uint32)cellX * 73856093u) ^ ((uint32)cellY * 19349663u);
+	return myBuckets[hash & (BUCKET_COUNT - 1)];
+}
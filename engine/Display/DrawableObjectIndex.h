@@ -0,0 +1,110 @@
+// --------------------------------------------------------------------------
+// Filename:	DrawableObjectIndex.h
+// Class:		DrawableObjectIndex
+// Purpose:		Finds the drawable objects that overlap an area of the
+//				world without looking at every object.
+//
+// Description: Objects are filed by their current bound into a hashed
+//				grid of 512 pixel cells.  Objects that cover a great many
+//				cells, and cameras (whose bounds change every update),
+//				are kept in a separate list that every search checks.
+//
+//				Each object also remembers its plane and the order it was
+//				added in, so the results of a search come back in the
+//				same order DrawableObjectHandler would draw them.
+//
+// History:
+// --------------------------------------------------------------------------
+#ifndef		DRAWABLE_OBJECT_INDEX_H
+#define		DRAWABLE_OBJECT_INDEX_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../mfchack.h"
+#include <vector>
+#include <map>
+
+class DrawableObject;
+
+class DrawableObjectIndex
+{
+public:
+	DrawableObjectIndex();
+	~DrawableObjectIndex();
+
+	// ----------------------------------------------------------------------
+	// Method:      Add
+	// Arguments:   object - object to file under its current bound
+	//				plane - the plane it is drawn in
+	// Returns:     None
+	// Description: Objects added later are drawn after earlier objects
+	//				in the same plane.
+	// ----------------------------------------------------------------------
+	void Add(DrawableObject* object, uint32 plane);
+
+	void Remove(DrawableObject* object);
+
+	// ----------------------------------------------------------------------
+	// Method:      UpdateBounds
+	// Arguments:   everything - false to only update cameras
+	// Returns:     None
+	// Description: Calls SetCurrentBound on the objects and refiles
+	//				any whose bound has changed.
+	// ----------------------------------------------------------------------
+	void UpdateBounds(bool everything);
+
+	// ----------------------------------------------------------------------
+	// Method:      Find
+	// Arguments:   area - world rectangle to search
+	//				found - receives the objects whose bounds touch the
+	//						area, in drawing order
+	// Returns:     None
+	// Description: The edges of the area count as touching, so callers
+	//				can still apply their own exact test.
+	// ----------------------------------------------------------------------
+	void Find(const RECT& area, std::vector<DrawableObject*>& found);
+
+private:
+	// Copy constructor and assignment operator
+	// Declared but not implemented
+	DrawableObjectIndex (const DrawableObjectIndex&);
+	DrawableObjectIndex& operator= (const DrawableObjectIndex&);
+
+	struct Entry
+	{
+		DrawableObject* object;
+		uint32 plane;
+		uint32 order;
+		RECT bound;
+		int32 cellLeft;
+		int32 cellTop;
+		int32 cellRight;
+		int32 cellBottom;
+		bool filed;			// in the grid rather than the unfiled list
+		uint32 findStamp;	// stops objects in several cells being found twice
+	};
+
+	static bool DrawsBefore(const Entry* a, const Entry* b);
+
+	void File(Entry* entry);
+	void Unfile(Entry* entry);
+	std::vector<Entry*>& Bucket(int32 cellX, int32 cellY);
+
+	enum
+	{
+		CELL_SHIFT = 9,			// 512 pixel cells
+		BUCKET_COUNT = 4096,	// must be a power of two
+		MAX_FILED_CELLS = 16	// bigger than this goes in the unfiled list
+	};
+
+	std::map<DrawableObject*, Entry*> myEntries;
+	std::vector<Entry*> myBuckets[BUCKET_COUNT];
+	std::vector<Entry*> myUnfiledEntries;
+	std::vector<Entry*> myFoundEntries;
+	uint32 myNextOrder;
+	uint32 myFindStamp;
+};
+
+#endif		// DRAWABLE_OBJECT_INDEX_H
@@ -84,6 +84,9 @@ public:
 	uint32 GetPosition(){return myPosition;}
 	void Reset(){myPosition = 0;}
 
+	// size of the mapped view in bytes
+	uint32 GetLength(){return myLength;}
+
 	bool Valid(){return (myMemoryFile !=NULL);}
 
 //////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,348 @@
+// -------------------------------------------------------------------------
+// Filename:    SDL_Bench.cpp
+//
+// Purpose:     Headless throughput test for the engine.  Replaces
+//              SDL_Main.cpp: starts the game with SDL's dummy video
+//              driver, loads a world (or bootstraps the startup one),
+//              adds creatures and agents, then ticks the world as fast
+//              as it can with rendering turned off and reports the
+//              tick rate, the tick time percentiles and where the time
+//              went inside World::TaskSwitcher.
+//
+// Usage:       lc2e-bench [-ticks n] [-warmup n] [-creatures n]
+//                         [-agents n] [-world name] [-caos file]
+//
+//              -caos runs the CAOS in the file after the default
+//              population has been added, for anything more specific.
+//
+//              lc2e-bench -check name [-world name]
+//
+//              runs one of the checks in SDL_BenchChecks.cpp instead,
+//              and exits with 1 if it fails.
+//
+//              lc2e-bench -bench name [-ticks n] [-creatures n] ...
+//
+//              sets up the population as usual, then times one of the
+//              benches in SDL_BenchChecks.cpp for -ticks rounds
+//              (10000 by default) instead of ticking the world.
+//
+//              Build with "make lc2e-bench".
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "SDL_Main.h"
+#include "SDL_BenchChecks.h"
+#include "../../App.h"
+#include "../../World.h"
+#include "../../TimeFuncs.h"
+#include "../../DirectoryIndex.h"
+#include "../../Caos/Orderiser.h"
+#include "../../Caos/CAOSMachine.h"
+#include "../../Caos/MacroScript.h"
+#include "../ErrorMessageHandler.h"
+
+#include <SDL/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+static bool ourQuit;
+
+static bool InitInstance();
+static bool RunCAOS( const std::string& source );
+static double Milliseconds( int64 stamps );
+
+
+
+int main(int argc, char *argv[])
+{
+	int ticks = 0;
+	int warmup = 100;
+	int creatures = 10;
+	int agents = 1000;
+	std::string worldName;
+	std::string caosFile;
+	std::string checkName;
+	std::string benchName;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		bool hasValue = i + 1 < argc;
+		if( hasValue && strcmp( argv[i], "-ticks" ) == 0 )
+			ticks = atoi( argv[++i] );
+		else if( hasValue && strcmp( argv[i], "-warmup" ) == 0 )
+			warmup = atoi( argv[++i] );
+		else if( hasValue && strcmp( argv[i], "-creatures" ) == 0 )
+			creatures = atoi( argv[++i] );
+		else if( hasValue && strcmp( argv[i], "-agents" ) == 0 )
+			agents = atoi( argv[++i] );
+		else if( hasValue && strcmp( argv[i], "-world" ) == 0 )
+			worldName = argv[++i];
+		else if( hasValue && strcmp( argv[i], "-caos" ) == 0 )
+			caosFile = argv[++i];
+		else if( hasValue && strcmp( argv[i], "-check" ) == 0 )
+			checkName = argv[++i];
+		else if( hasValue && strcmp( argv[i], "-bench" ) == 0 )
+			benchName = argv[++i];
+		else
+		{
+			fprintf( stderr, "usage: lc2e-bench [-ticks n] [-warmup n] "
+				"[-creatures n] [-agents n] [-world name] [-caos file]\n"
+				"       lc2e-bench -check name [-world name] [-ticks n]\n"
+				"       lc2e-bench -bench name [-ticks n] ...\n" );
+			return 1;
+		}
+	}
+	if( ticks == 0 )
+		ticks = benchName.empty() ? 1000 : 10000;
+	if( ticks < 1 || warmup < 0 || creatures < 0 || agents < 0 )
+	{
+		fprintf( stderr, "lc2e-bench: counts must not be negative\n" );
+		return 1;
+	}
+
+	try
+	{
+		// no window, but the display engine still wants a surface
+		static char dummyVideo[] = "SDL_VIDEODRIVER=dummy";
+		putenv( dummyVideo );
+
+		if( !InitInstance() )
+			return 1;
+
+		if ( SDL_Init(SDL_INIT_VIDEO) < 0 )
+		{
+			fprintf( stderr, "lc2e-bench: %s\n", SDL_GetError() );
+			return 1;
+		}
+
+		// App::Init loads (and bootstraps) the startup world
+		if( !theApp.Init() )
+		{
+			SDL_Quit();
+			return 1;
+		}
+
+		// turn off rendering (the same as "wolf 1 0")
+		theApp.EorWolfValues( ~1, 0 );
+
+		// loading happens at the start of the next tick
+		if( !worldName.empty() )
+		{
+			if( !RunCAOS( "load \"" + worldName + "\"" ) )
+				ourQuit = true;
+			theApp.UpdateApp();
+		}
+
+		if( !checkName.empty() )
+		{
+			bool passed = !ourQuit && RunBenchCheck( checkName, ticks );
+			printf( "%s: %s\n", checkName.c_str(), passed ? "passed" : "FAILED" );
+			theApp.ShutDown();
+			SDL_Quit();
+			return passed ? 0 : 1;
+		}
+
+		// Put everything roughly where the camera is looking, which
+		// after the bootstrap is the world's starting metaroom.
+		// The creatures share one holder agent for their genomes.
+		std::ostringstream populate;
+		if( agents > 0 )
+		{
+			populate <<
+				"reps " << agents << " "
+					"new: simp 2 21 1000 \"blnk\" 1 0 5000 "
+					"attr 192 accg 0.3 "
+					"setv va00 cmrx addv va00 rand -400 400 "
+					"setv va01 cmry addv va01 rand -200 0 "
+					"mvsf va00 va01 "
+					"velo rand -5 5 0 "
+				"repe ";
+		}
+		if( creatures > 0 )
+		{
+			populate <<
+				"new: simp 1 1 1 \"blnk\" 1 0 0 "
+				"setv va02 targ "
+				"reps " << creatures << " "
+					"gene load va02 1 \"norn.bengal46*\" "
+					"new: crea 4 va02 1 0 0 "
+					"born "
+					"setv va00 cmrx addv va00 rand -400 400 "
+					"mvsf va00 cmry "
+				"repe "
+				"targ va02 kill targ ";
+		}
+		if( !ourQuit && !populate.str().empty() && !RunCAOS( populate.str() ) )
+			ourQuit = true;
+
+		if( !ourQuit && !caosFile.empty() )
+		{
+			std::ifstream in( caosFile.c_str() );
+			std::ostringstream source;
+			source << in.rdbuf();
+			if( !in || !RunCAOS( source.str() ) )
+			{
+				fprintf( stderr, "lc2e-bench: can't run '%s'\n", caosFile.c_str() );
+				ourQuit = true;
+			}
+		}
+
+		// let births, falling agents and so on settle down first
+		int i;
+		for( i = 0; i < warmup && !ourQuit; ++i )
+			theApp.UpdateApp();
+
+		if( !benchName.empty() )
+		{
+			bool ran = !ourQuit && RunMicroBench( benchName, ticks );
+			theApp.ShutDown();
+			SDL_Quit();
+			return ran ? 0 : 1;
+		}
+
+		theApp.GetWorld().ResetTaskTimes();
+
+		std::vector< int64 > tickTimes;
+		tickTimes.reserve( ticks );
+		int64 start = GetHighPerformanceTimeStamp();
+		for( i = 0; i < ticks && !ourQuit; ++i )
+		{
+			int64 tickStart = GetHighPerformanceTimeStamp();
+			theApp.UpdateApp();
+			tickTimes.push_back( GetHighPerformanceTimeStamp() - tickStart );
+		}
+		int64 total = GetHighPerformanceTimeStamp() - start;
+
+		if( !tickTimes.empty() )
+		{
+			World& world = theApp.GetWorld();
+			int run = tickTimes.size();
+			double seconds = Milliseconds( total ) / 1000.0;
+
+			std::vector< int64 > sorted( tickTimes );
+			std::sort( sorted.begin(), sorted.end() );
+
+			printf( "%d ticks, %d creatures, %d agents requested\n",
+				run, creatures, agents );
+			printf( "%.3f seconds, %.1f ticks/sec\n", seconds,
+				seconds > 0.0 ? run / seconds : 0.0 );
+			printf( "tick ms: p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+				Milliseconds( sorted[ (run - 1) * 50 / 100 ] ),
+				Milliseconds( sorted[ (run - 1) * 95 / 100 ] ),
+				Milliseconds( sorted[ (run - 1) * 99 / 100 ] ),
+				Milliseconds( sorted[ run - 1 ] ) );
+
+			static const char* names[ World::taskTimeCount ] =
+				{ "agents", "messages", "CA", "music/sound" };
+			int64 accounted = 0;
+			for( int task = 0; task < World::taskTimeCount; ++task )
+			{
+				int64 t = world.GetTaskTime( task );
+				accounted += t;
+				printf( "%-12s %9.3f ms/tick  %5.1f%%\n", names[task],
+					Milliseconds( t ) / run,
+					total > 0 ? 100.0 * t / total : 0.0 );
+			}
+			printf( "%-12s %9.3f ms/tick  %5.1f%%\n", "other",
+				Milliseconds( total - accounted ) / run,
+				total > 0 ? 100.0 * (total - accounted) / total : 0.0 );
+		}
+
+		// (for the whole run, including startup)
+		DirectoryIndex& index = DirectoryIndex::theDirectoryIndex();
+		printf( "file checks: %u from the index, %u from disk, %u directories listed\n",
+			index.GetStatsAvoided(), index.GetStatsMade(), index.GetDirectoriesListed() );
+
+		theApp.ShutDown();
+	}
+	catch (BasicException& e)
+	{
+		ErrorMessageHandler::Show(e, std::string("lc2e-bench"));
+	}
+	catch (...)
+	{
+		ErrorMessageHandler::NonLocalisable("NLE0004: Unknown exception caught in initialisation or main loop",
+			std::string("lc2e-bench"));
+	}
+
+	SDL_Quit();
+	return 0;
+}
+
+
+
+// The same setup SDL_Main.cpp does before SDL_Init
+static bool InitInstance()
+{
+	if( !theApp.InitConfigFiles( "user.cfg", "machine.cfg" ) )
+		return false;
+
+	if ( !theApp.GetDirectories() )
+		return false;
+
+	if( !theApp.InitLocalisation() )
+		return false;
+
+	return true;
+}
+
+
+
+// Runs a script to completion, as an "execute" request from the
+// external interface would.  Errors go to stderr.
+static bool RunCAOS( const std::string& source )
+{
+	Orderiser o;
+	MacroScript* m = o.OrderFromCAOS( source.c_str() );
+	if( !m )
+	{
+		std::ostringstream out;
+		out << o.GetLastError() << std::endl;
+		CAOSMachine::FormatErrorPos( out, o.GetLastErrorPos(), source );
+		fprintf( stderr, "lc2e-bench: %s\n", out.str().c_str() );
+		return false;
+	}
+
+	bool ok = true;
+	CAOSMachine vm;
+	std::ostringstream out;
+	try
+	{
+		vm.StartScriptExecuting( m, NULLHANDLE, NULLHANDLE, INTEGERZERO, INTEGERZERO );
+		vm.SetOutputStream( &out );
+		vm.UpdateVM( -1 );
+	}
+	catch( CAOSMachine::RunError& e )
+	{
+		out << e.what();
+		vm.StreamIPLocationInSource( out );
+		fprintf( stderr, "lc2e-bench: %s\n", out.str().c_str() );
+		ok = false;
+	}
+
+	vm.StopScriptExecuting();
+	delete m;
+	return ok;
+}
+
+
+
+static double Milliseconds( int64 stamps )
+{
+	return stamps * 1000.0 / GetHighPerformanceTimeStampFrequency();
+}
+
+
+
+void SignalTerminateApplication()
+{
+	ourQuit = true;
+}
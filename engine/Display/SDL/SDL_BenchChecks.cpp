@@ -0,0 +1,832 @@
+// -------------------------------------------------------------------------
+// Filename:    SDL_BenchChecks.cpp
+//
+// Purpose:     Checks and benches for lc2e-bench's -check and -bench
+//              options.  See
+//              SDL_BenchChecks.h
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "SDL_BenchChecks.h"
+#include "../../App.h"
+#include "../../AppConstants.h"
+#include "../../World.h"
+#include "../../TimeFuncs.h"
+#include "../../AgentManager.h"
+#include "../../CreaturesArchive.h"
+#include "../../Agents/MessageQueue.h"
+#include "../../Creature/Creature.h"
+#include "../../Creature/Biochemistry/Biochemistry.h"
+#include "../../Creature/Brain/Brain.h"
+#include "../../Creature/Genome.h"
+#include "../../Creature/CreatureConstants.h"
+#include "../../Creature/Biochemistry/BiochemistryConstants.h"
+#include "../../Caos/Orderiser.h"
+#include "../../Caos/CAOSMachine.h"
+#include "../../Caos/MacroScript.h"
+#include "../../Maths.h"
+#include "../SpriteBlitter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <set>
+#include <deque>
+#include <vector>
+#include <sstream>
+
+static bool CheckMessages();
+static bool CheckSprites();
+static bool CheckSVRules();
+static bool CheckCAOS( int ticks );
+static bool BenchBiochemistry( int ticks );
+static bool BenchLobes( int ticks );
+static bool BenchArchive( int ticks );
+static double Milliseconds( int64 stamps );
+
+
+
+bool RunBenchCheck( const std::string& name, int ticks )
+{
+	if( name == "messages" )
+		return CheckMessages();
+	if( name == "sprites" )
+		return CheckSprites();
+	if( name == "svrules" )
+		return CheckSVRules();
+	if( name == "caos" )
+		return CheckCAOS( ticks );
+
+	fprintf( stderr, "lc2e-bench: no check called '%s'\n", name.c_str() );
+	return false;
+}
+
+
+
+// The sprite blitter against the plain C++ one it replaced, over
+// every line of every C16 file in the images directories.  S16
+// files don't go through the blitter, so their lines are compressed
+// the same way C16 ones are first, for a wider set of real images.
+// Both versions have to draw the same pixels and leave the screen
+// and data pointers in the same places, drawn forwards and mirrored.
+
+struct SpriteLineTotals
+{
+	int files;
+	int lines;
+	int pixels;
+	int mismatches;
+};
+
+static bool LoadSpriteFile( const std::string& path, std::vector< uint8 >& file )
+{
+	FILE* in = fopen( path.c_str(), "rb" );
+	if( !in )
+		return false;
+	fseek( in, 0, SEEK_END );
+	long size = ftell( in );
+	fseek( in, 0, SEEK_SET );
+	file.resize( size > 0 ? size : 0 );
+	bool ok = size > 0 && fread( &file[0], 1, size, in ) == size;
+	fclose( in );
+	return ok;
+}
+
+static uint32 ReadSpriteUINT32( const std::vector< uint8 >& file, uint32 at )
+{
+	uint32 value = 0;
+	if( at + 4 <= file.size() )
+		memcpy( &value, &file[at], 4 );
+	return value;
+}
+
+static uint16 ReadSpriteUINT16( const std::vector< uint8 >& file, uint32 at )
+{
+	uint16 value = 0;
+	if( at + 2 <= file.size() )
+		memcpy( &value, &file[at], 2 );
+	return value;
+}
+
+// Copies one compressed line out of the file, and checks it fits in
+// the sprite's width so neither blitter can run off the screen.
+// Returns the number of pixels, or -1 if it's bad.
+static int CopySpriteLine( const std::vector< uint8 >& file, uint32 at,
+	int width, std::vector< uint16 >& line )
+{
+	line.clear();
+	int pixels = 0;
+	for( ;; )
+	{
+		if( at + 2 > file.size() )
+			return -1;
+		uint16 tag = ReadSpriteUINT16( file, at );
+		at += 2;
+		line.push_back( tag );
+		if( tag == 0 )
+			return pixels;
+
+		int count = tag >> 1;
+		pixels += count;
+		if( pixels > width )
+			return -1;
+		if( tag & 1 )
+		{
+			if( at + count * 2 > file.size() )
+				return -1;
+			for( int i = 0; i < count; ++i, at += 2 )
+				line.push_back( ReadSpriteUINT16( file, at ) );
+		}
+	}
+}
+
+// Compresses a line of S16 pixels as a C16 file would hold it
+static void CompressSpriteLine( const std::vector< uint8 >& file, uint32 at,
+	int width, std::vector< uint16 >& line )
+{
+	line.clear();
+	int x = 0;
+	while( x < width )
+	{
+		bool colour = ReadSpriteUINT16( file, at + x * 2 ) != 0;
+		int count = 0;
+		int tag = line.size();
+		line.push_back( 0 );
+		while( x < width && count < 0x7fff &&
+			( ReadSpriteUINT16( file, at + x * 2 ) != 0 ) == colour )
+		{
+			if( colour )
+				line.push_back( ReadSpriteUINT16( file, at + x * 2 ) );
+			++count;
+			++x;
+		}
+		line[tag] = (uint16)( ( count << 1 ) | ( colour ? 1 : 0 ) );
+	}
+	line.push_back( 0 );
+}
+
+static void CompareSpriteLine( const std::vector< uint16 >& line, int width,
+	SpriteLineFunction fast, SpriteLineFunction plain, bool mirrored,
+	const std::string& name, int image, int y, SpriteLineTotals& totals )
+{
+	// a margin either side catches anything drawn out of place
+	const int margin = 64;
+	std::vector< uint16 > screenA( width + margin * 2, 0x5555 );
+	std::vector< uint16 > screenB( width + margin * 2, 0x5555 );
+	int start = mirrored ? margin + width - 1 : margin;
+
+	uint16* screen1 = &screenA[start];
+	uint16* data1 = (uint16*)&line[0];
+	fast( screen1, data1 );
+
+	uint16* screen2 = &screenB[start];
+	uint16* data2 = (uint16*)&line[0];
+	plain( screen2, data2 );
+
+	if( screen1 - &screenA[0] != screen2 - &screenB[0] || data1 != data2 ||
+		screenA != screenB )
+	{
+		if( totals.mismatches < 10 )
+			printf( "sprites: %s image %d line %d differs%s\n", name.c_str(),
+				image, y, mirrored ? " mirrored" : "" );
+		++totals.mismatches;
+	}
+}
+
+static void CheckSpriteFile( const std::string& path, const std::string& name,
+	SpriteLineFunction fastLine, SpriteLineFunction fastMirrored,
+	SpriteLineFunction plainLine, SpriteLineFunction plainMirrored,
+	SpriteLineTotals& totals )
+{
+	std::string extension;
+	if( name.size() > 4 )
+		extension = name.substr( name.size() - 4 );
+	for( int c = 0; c < extension.size(); ++c )
+		extension[c] = tolower( extension[c] );
+	bool compressed = extension == ".c16";
+	if( !compressed && extension != ".s16" )
+		return;
+
+	std::vector< uint8 > file;
+	if( !LoadSpriteFile( path, file ) || file.size() < 6 )
+		return;
+	++totals.files;
+
+	int count = ReadSpriteUINT16( file, 4 );
+	uint32 header = 6;
+	std::vector< uint16 > line;
+	for( int image = 0; image < count; ++image )
+	{
+		uint32 offset = ReadSpriteUINT32( file, header );
+		int width = ReadSpriteUINT16( file, header + 4 );
+		int height = ReadSpriteUINT16( file, header + 6 );
+		header += 8;
+
+		for( int y = 0; y < height; ++y )
+		{
+			int pixels = width;
+			if( compressed )
+			{
+				// the first line's offset is in the header above
+				// and the rest follow it
+				uint32 at = offset;
+				if( y > 0 )
+					at = ReadSpriteUINT32( file, header + ( y - 1 ) * 4 );
+				pixels = CopySpriteLine( file, at, width, line );
+				if( pixels < 0 )
+				{
+					printf( "sprites: %s image %d line %d is bad, skipped\n",
+						name.c_str(), image, y );
+					continue;
+				}
+			}
+			else
+			{
+				uint32 at = offset + y * width * 2;
+				if( at + width * 2 > file.size() )
+					break;
+				CompressSpriteLine( file, at, width, line );
+			}
+
+			CompareSpriteLine( line, width, fastLine, plainLine, false,
+				name, image, y, totals );
+			CompareSpriteLine( line, width, fastMirrored, plainMirrored, true,
+				name, image, y, totals );
+			++totals.lines;
+			totals.pixels += pixels;
+		}
+		if( compressed && height > 0 )
+			header += ( height - 1 ) * 4;
+	}
+}
+
+static bool CheckSprites()
+{
+	SpriteBlitter::Initialise();
+	std::string fastName = SpriteBlitter::GetName();
+	SpriteLineFunction fastLine = SpriteBlitter::DrawLine;
+	SpriteLineFunction fastMirrored = SpriteBlitter::DrawMirroredLine;
+	SpriteBlitter::Initialise( false );
+	SpriteLineFunction plainLine = SpriteBlitter::DrawLine;
+	SpriteLineFunction plainMirrored = SpriteBlitter::DrawMirroredLine;
+	SpriteBlitter::Initialise();
+
+	std::vector< std::string > directories;
+	directories.push_back( theApp.GetDirectory( IMAGES_DIR ) );
+	std::string local;
+	if( theApp.GetWorldDirectoryVersion( IMAGES_DIR, local ) )
+		directories.push_back( local );
+
+	SpriteLineTotals totals = { 0, 0, 0, 0 };
+	for( int d = 0; d < directories.size(); ++d )
+	{
+		DIR* dir = opendir( directories[d].c_str() );
+		if( !dir )
+			continue;
+		struct dirent* entry;
+		while( ( entry = readdir( dir ) ) != NULL )
+		{
+			CheckSpriteFile( directories[d] + entry->d_name, entry->d_name,
+				fastLine, fastMirrored, plainLine, plainMirrored, totals );
+		}
+		closedir( dir );
+	}
+
+	printf( "sprites: %s against C++, %d files, %d lines, %d pixels, %d differ\n",
+		fastName.c_str(), totals.files, totals.lines, totals.pixels,
+		totals.mismatches );
+	return totals.files > 0 && totals.mismatches == 0;
+}
+
+
+
+// The compiled SV-Rules against the interpreter, for every rule in
+// every genome file in the genetics directories.  Each genome makes a
+// brain for each sex and age, as a creature growing up would, and
+// every lobe and tract in it is checked.
+
+static bool CheckSVRules()
+{
+	std::vector< std::string > directories;
+	directories.push_back( theApp.GetDirectory( GENETICS_DIR ) );
+	std::string local;
+	if( theApp.GetWorldDirectoryVersion( GENETICS_DIR, local ) )
+		directories.push_back( local );
+
+	static float chemicals[ NUMCHEM ];
+	int genomes = 0;
+	int brains = 0;
+	int components = 0;
+	int failed = 0;
+	for( int d = 0; d < directories.size(); ++d )
+	{
+		DIR* dir = opendir( directories[d].c_str() );
+		if( !dir )
+			continue;
+		struct dirent* entry;
+		while( ( entry = readdir( dir ) ) != NULL )
+		{
+			std::string name( entry->d_name );
+			std::string extension;
+			if( name.size() > 4 )
+				extension = name.substr( name.size() - 4 );
+			for( int c = 0; c < extension.size(); ++c )
+				extension[c] = tolower( extension[c] );
+			if( extension != ".gen" )
+				continue;
+
+			std::string path = directories[d] + name;
+			try
+			{
+				for( int sex = 1; sex <= 2; ++sex )
+				{
+					for( int age = 0; age < NUMAGES; ++age )
+					{
+						Genome genome;
+						genome.ReadFromFile( path, sex, age, 0, "" );
+
+						Brain brain;
+						brain.RegisterBiochemistry( chemicals );
+						brain.ReadFromGenome( genome );
+						int checked;
+						int wrong = brain.CheckCompiledRules( checked );
+						if( wrong && failed < 10 )
+							printf( "svrules: %s sex %d age %d: %d components differ\n",
+								name.c_str(), sex, age, wrong );
+						failed += wrong;
+						components += checked;
+						++brains;
+					}
+				}
+				++genomes;
+			}
+			catch( BasicException& e )
+			{
+				printf( "svrules: %s: %s\n", name.c_str(), e.what() );
+			}
+		}
+		closedir( dir );
+	}
+
+	printf( "svrules: %d genomes, %d brains, %d lobes and tracts, %d differ\n",
+		genomes, brains, components, failed );
+	return genomes > 0 && failed == 0;
+}
+
+
+
+// Installed scripts run with their decoded ops against the same
+// scripts reading their code as normal.  Each pass deletes and loads
+// a new world, so the bootstrap installs its scripts and runs its
+// install sections, seeds the random numbers the same way and runs
+// the world for "ticks" ticks.  The world tick, the game variables
+// and every agent's position, object variables and virtual machine
+// are written out, and the two passes have to write the same thing.
+// Anything that goes by the real time (RTIM, timers on the clock)
+// can differ on its own, so run it on a bootstrap that doesn't.
+
+static bool RunCheckCAOS( const std::string& source )
+{
+	Orderiser o;
+	MacroScript* m = o.OrderFromCAOS( source.c_str() );
+	if( !m )
+	{
+		fprintf( stderr, "lc2e-bench: %s\n", o.GetLastError() );
+		return false;
+	}
+
+	bool ok = true;
+	CAOSMachine vm;
+	std::ostringstream out;
+	try
+	{
+		vm.StartScriptExecuting( m, NULLHANDLE, NULLHANDLE, INTEGERZERO, INTEGERZERO );
+		vm.SetOutputStream( &out );
+		vm.UpdateVM( -1 );
+	}
+	catch( CAOSMachine::RunError& e )
+	{
+		fprintf( stderr, "lc2e-bench: %s\n", e.what() );
+		ok = false;
+	}
+
+	vm.StopScriptExecuting();
+	delete m;
+	return ok;
+}
+
+static void WriteCAOSState( std::vector< std::string >& lines )
+{
+	World& world = theApp.GetWorld();
+	{
+		std::ostringstream line;
+		line << "tick " << world.GetWorldTick();
+		lines.push_back( line.str() );
+	}
+
+	std::string name = world.GetNextGameVar( "" );
+	while( !name.empty() )
+	{
+		std::ostringstream line;
+		line << "game \"" << name << "\" ";
+		world.GetGameVar( name ).Write( line );
+		lines.push_back( line.str() );
+		name = world.GetNextGameVar( name );
+	}
+
+	AgentListIterator it = theAgentManager.GetAgentIteratorStart();
+	for( ; !theAgentManager.IsEnd( it ); ++it )
+	{
+		if( !it->IsValid() )
+			continue;
+		Agent& agent = it->GetAgentReference();
+		const Classifier& c = agent.GetClassifier();
+		Vector2D position = agent.GetPosition();
+
+		std::ostringstream line;
+		line << "agent " << agent.GetUniqueID() << " " <<
+			(int)c.Family() << " " << (int)c.Genus() << " " <<
+			(int)c.Species() << " at " << position.x << " " << position.y;
+		for( int v = 0; v < 100; ++v )
+		{
+			line << " ";
+			agent.GetReferenceToVariable( v ).Write( line );
+		}
+		line << " vm ";
+		agent.GetVirtualMachine().DumpState( line, ' ' );
+		lines.push_back( line.str() );
+	}
+}
+
+static bool CheckCAOS( int ticks )
+{
+	static const char* worlds[] = { "lc2e-bench caos code", "lc2e-bench caos decoded" };
+	std::string startWorld = theApp.GetWorld().GetWorldName();
+
+	std::vector< std::string > lines[2];
+	bool ok = true;
+	for( int pass = 0; pass < 2 && ok; ++pass )
+	{
+		MacroScript::UseDecodedOps( pass == 1 );
+
+		// loading happens at the start of the next tick
+		std::string world = std::string( "\"" ) + worlds[pass] + "\"";
+		ok = RunCheckCAOS( "delw " + world + " load " + world );
+		srand( 1 );
+		RandQD1::seed( 1 );
+		for( int tick = 0; ok && tick <= ticks; ++tick )
+			theApp.UpdateApp();
+		WriteCAOSState( lines[pass] );
+	}
+	MacroScript::UseDecodedOps( true );
+
+	// put the world back as it was
+	if( RunCheckCAOS( "load \"" + startWorld + "\"" ) )
+	{
+		theApp.UpdateApp();
+		RunCheckCAOS( std::string( "delw \"" ) + worlds[0] + "\" " +
+			"delw \"" + worlds[1] + "\"" );
+	}
+	if( !ok )
+		return false;
+
+	int differ = 0;
+	int count = lines[0].size() > lines[1].size() ? lines[0].size() : lines[1].size();
+	for( int i = 0; i < count; ++i )
+	{
+		const std::string& code = i < lines[0].size() ? lines[0][i] : std::string();
+		const std::string& decoded = i < lines[1].size() ? lines[1][i] : std::string();
+		if( code == decoded )
+			continue;
+		if( differ < 10 )
+			printf( "caos: code    %s\ncaos: decoded %s\n", code.c_str(), decoded.c_str() );
+		++differ;
+	}
+
+	printf( "caos: %d ticks, %d lines, %d differ\n", ticks,
+		(int)lines[1].size(), differ );
+	return lines[0].size() > 1 && differ == 0;
+}
+
+
+
+bool RunMicroBench( const std::string& name, int ticks )
+{
+	if( name == "biochemistry" )
+		return BenchBiochemistry( ticks );
+	if( name == "lobes" )
+		return BenchLobes( ticks );
+	if( name == "archive" )
+		return BenchArchive( ticks );
+
+	fprintf( stderr, "lc2e-bench: no bench called '%s'\n", name.c_str() );
+	return false;
+}
+
+
+
+// The message queue against the std::multiset and std::deque it
+// replaced.  Random messages are sent over a run of world ticks with
+// immediate, short, long, negative and overflowing delays, and each
+// read has to come out the same as the old queue would have given.
+// The runs start just short of wheel level boundaries so the overflow
+// list is cascaded.
+
+struct CompareMessageTimes
+{
+	bool operator()( Message const & msg1, Message const & msg2 ) const
+	{
+		return msg1.GetTime() < msg2.GetTime();
+	}
+};
+
+static bool CheckMessages()
+{
+	static const uint32 starts[] = { 0, (1 << 24) - 3000, (1 << 30) - 7000 };
+	const int runs = sizeof( starts ) / sizeof( starts[0] );
+	const int ticks = 20000;
+
+	World& world = theApp.GetWorld();
+	uint32 realTick = world.GetWorldTick();
+	srand( 1 );
+
+	int mismatches = 0;
+	int delivered = 0;
+	for( int run = 0; run < runs; ++run )
+	{
+		MessageQueue queue;
+		std::multiset< Message, CompareMessageTimes > oldDelayed;
+		std::deque< Message > oldImmediate;
+		int sent = 0;
+
+		for( int tick = 0; tick < ticks; ++tick )
+		{
+			uint32 now = starts[run] + tick;
+			world.SetWorldTick( now );
+
+			int count = rand() % 4;
+			for( int i = 0; i < count; ++i )
+			{
+				unsigned delay;
+				int kind = rand() % 100;
+				if( kind < 10 )
+					delay = 0;
+				else if( kind < 15 )
+					delay = (unsigned)( -( rand() % 20 + 1 ) );
+				else if( kind < 20 )
+					delay = ( 1 << 24 ) + rand() % 5000;
+				else if( kind < 22 )
+					delay = ( 1 << 25 ) + rand() % 100;
+				else if( kind < 60 )
+					delay = rand() % 10 + 1;
+				else
+					delay = rand() % 5000 + 1;
+
+				queue.WriteMessage( NULLHANDLE, NULLHANDLE, sent,
+					INTEGERZERO, INTEGERZERO, delay );
+				if( delay )
+					oldDelayed.insert( Message( NULLHANDLE, NULLHANDLE, sent,
+						INTEGERZERO, INTEGERZERO, now + delay ) );
+				else
+					oldImmediate.push_back( Message( NULLHANDLE, NULLHANDLE, sent,
+						INTEGERZERO, INTEGERZERO, 0 ) );
+				++sent;
+			}
+
+			int reads = rand() % 6;
+			for( int j = 0; j < reads; ++j )
+			{
+				Message got;
+				bool gotOne = queue.ReadMessage( got );
+
+				Message expected;
+				bool expectedOne = false;
+				if( !oldImmediate.empty() )
+				{
+					expected = oldImmediate.front();
+					oldImmediate.pop_front();
+					expectedOne = true;
+				}
+				else if( !oldDelayed.empty() && oldDelayed.begin()->GetTime() <= now )
+				{
+					expected = *oldDelayed.begin();
+					oldDelayed.erase( oldDelayed.begin() );
+					expectedOne = true;
+				}
+
+				if( gotOne != expectedOne ||
+					( gotOne && got.GetMsg() != expected.GetMsg() ) )
+				{
+					if( mismatches < 10 )
+						printf( "messages: tick %u read %d, expected %d\n", now,
+							gotOne ? got.GetMsg() : -1,
+							expectedOne ? expected.GetMsg() : -1 );
+					++mismatches;
+				}
+				if( gotOne )
+					++delivered;
+			}
+		}
+	}
+
+	world.SetWorldTick( realTick );
+	printf( "messages: %d delivered, %d out of order\n", delivered, mismatches );
+	return mismatches == 0;
+}
+
+
+
+// 1000 biochemistry updates a tick, taken in turn from the creatures
+// in the world, with the vector chemical decay and receptor sampling
+// and then the plain C++ ones.  The chemicals carry on from one run into the next, so
+// give it enough creatures (-creatures) that neither run is mostly
+// decaying zeroes.
+
+static bool BenchBiochemistry( int ticks )
+{
+	const int perTick = 1000;
+
+	std::vector< Biochemistry* > biochemistries;
+	CreatureCollection& creatures = theAgentManager.GetCreatureCollection();
+	for( int c = 0; c < creatures.size(); ++c )
+		biochemistries.push_back( creatures[c].GetCreatureReference().GetBiochemistry() );
+	if( biochemistries.empty() )
+	{
+		fprintf( stderr, "lc2e-bench: no creatures to time\n" );
+		return false;
+	}
+
+	for( int pass = 0; pass < 2; ++pass )
+	{
+		Biochemistry::ChooseVectorRoutines( pass == 0 );
+
+		int next = 0;
+		int64 start = GetHighPerformanceTimeStamp();
+		for( int tick = 0; tick < ticks; ++tick )
+		{
+			for( int i = 0; i < perTick; ++i )
+			{
+				biochemistries[next]->Update();
+				if( ++next == biochemistries.size() )
+					next = 0;
+			}
+		}
+		double ms = Milliseconds( GetHighPerformanceTimeStamp() - start );
+
+		printf( "biochemistry: %d x %d updates, %s chemicals: %.3f ms, %.3f us/update\n",
+			ticks, perTick, Biochemistry::GetVectorRoutineName(), ms,
+			ms * 1000.0 / ( (double)ticks * perTick ) );
+	}
+
+	Biochemistry::ChooseVectorRoutines();
+	return true;
+}
+
+
+
+// The brain inputs and outputs a creature's faculties use each
+// update - drive and situation inputs, the attention and decision
+// winners and the decision's strength - through the token string
+// functions and then through the LobeHandles.  The token string
+// functions only tokenize once now, so the first figure is a little
+// better than the faculties used to do.
+
+static bool BenchLobes( int ticks )
+{
+	std::vector< Brain* > brains;
+	CreatureCollection& creatures = theAgentManager.GetCreatureCollection();
+	for( int c = 0; c < creatures.size(); ++c )
+		brains.push_back( creatures[c].GetCreatureReference().GetBrain() );
+	if( brains.empty() )
+	{
+		fprintf( stderr, "lc2e-bench: no creatures to time\n" );
+		return false;
+	}
+
+	int calls = 0;
+	int winners = 0;
+	float tokenStrengths = 0.0f;
+	float handleStrengths = 0.0f;
+	int64 start = GetHighPerformanceTimeStamp();
+	for( int tick = 0; tick < ticks; ++tick )
+	{
+		for( int b = 0; b < brains.size(); ++b )
+		{
+			Brain* brain = brains[b];
+			int drives = brain->GetLobeSize( "driv" );
+			for( int i = 0; i < drives; ++i )
+				brain->SetInput( "driv", i, 0.5f );
+			int situations = brain->GetLobeSize( "situ" );
+			for( int j = 0; j < situations; ++j )
+				brain->SetInput( "situ", j, 0.25f );
+			int decision = brain->GetWinningId( "decn" );
+			winners += brain->GetWinningId( "attn" ) + decision;
+			tokenStrengths += brain->GetNeuronState( "decn", decision, 0 );
+			calls += drives + situations + 5;
+		}
+	}
+	double tokenMs = Milliseconds( GetHighPerformanceTimeStamp() - start );
+
+	start = GetHighPerformanceTimeStamp();
+	for( int tick = 0; tick < ticks; ++tick )
+	{
+		for( int b = 0; b < brains.size(); ++b )
+		{
+			Brain* brain = brains[b];
+			int drives = brain->GetLobeSize( Brain::drivLobe );
+			for( int i = 0; i < drives; ++i )
+				brain->SetInput( Brain::drivLobe, i, 0.5f );
+			int situations = brain->GetLobeSize( Brain::situLobe );
+			for( int j = 0; j < situations; ++j )
+				brain->SetInput( Brain::situLobe, j, 0.25f );
+			int decision = brain->GetWinningId( Brain::decnLobe );
+			winners -= brain->GetWinningId( Brain::attnLobe ) + decision;
+			handleStrengths += brain->GetNeuronState( Brain::decnLobe, decision, 0 );
+		}
+	}
+	double handleMs = Milliseconds( GetHighPerformanceTimeStamp() - start );
+
+	printf( "lobes: %d calls each way over %d brains\n", calls, (int)brains.size() );
+	printf( "lobes: token strings %.3f ms, handles %.3f ms\n", tokenMs, handleMs );
+	// (the brains aren't updated in between, so the winners are the
+	// same both ways)
+	return winners == 0 && tokenStrengths == handleStrengths;
+}
+
+
+
+// Saves the world's data in the old single zlib stream and in
+// blocks, then loads each back, and prints the speeds.  Saving the
+// world itself is left out, as that costs the same either way; the
+// data is taken once and each archive is just given it.  "ticks" is
+// how many times each is done, so keep it small.
+
+static bool BenchArchive( int ticks )
+{
+	std::string data;
+	{
+		std::stringstream stream( std::ios::in | std::ios::out | std::ios::binary );
+		{
+			CreaturesArchive archive( stream, CreaturesArchive::SaveUncompressed );
+			theApp.GetWorld().Write( archive );
+		}
+		data = stream.str();
+	}
+
+	static const CreaturesArchive::Mode modes[] =
+		{ CreaturesArchive::Save, CreaturesArchive::SaveBlocks };
+	static const char* names[] = { "stream", "blocks" };
+
+	bool same = true;
+	std::string loaded( data.size(), 0 );
+	for( int m = 0; m < 2; ++m )
+	{
+		int64 saveTime = 0;
+		int64 loadTime = 0;
+		uint32 packed = 0;
+		for( int tick = 0; tick < ticks; ++tick )
+		{
+			std::stringstream stream( std::ios::in | std::ios::out | std::ios::binary );
+			int64 start = GetHighPerformanceTimeStamp();
+			{
+				CreaturesArchive archive( stream, modes[m] );
+				archive.Write( data.data(), data.size() );
+			}
+			saveTime += GetHighPerformanceTimeStamp() - start;
+			packed = stream.str().size();
+
+			stream.seekg( 0 );
+			start = GetHighPerformanceTimeStamp();
+			{
+				CreaturesArchive archive( stream, CreaturesArchive::Load );
+				archive.Read( &loaded[0], loaded.size() );
+			}
+			loadTime += GetHighPerformanceTimeStamp() - start;
+			same = same && loaded == data;
+		}
+
+		double megabytes = (double)data.size() * ticks / ( 1024.0 * 1024.0 );
+		double saveMs = Milliseconds( saveTime );
+		double loadMs = Milliseconds( loadTime );
+		printf( "archive: %s, %u KB to %u KB: save %.1f MB/s, load %.1f MB/s\n",
+			names[m], (uint32)( data.size() / 1024 ), packed / 1024,
+			saveMs > 0.0 ? megabytes * 1000.0 / saveMs : 0.0,
+			loadMs > 0.0 ? megabytes * 1000.0 / loadMs : 0.0 );
+	}
+
+	if( !same )
+		printf( "archive: data loaded back differs\n" );
+	return same;
+}
+
+
+
+static double Milliseconds( int64 stamps )
+{
+	return stamps * 1000.0 / GetHighPerformanceTimeStampFrequency();
+}
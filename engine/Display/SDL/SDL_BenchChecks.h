@@ -0,0 +1,41 @@
+// -------------------------------------------------------------------------
+// Filename:    SDL_BenchChecks.h
+//
+// Purpose:     Checks for lc2e-bench's -check option and timings for
+//              its -bench option.  Each check compares a fast path in
+//              the engine with the simpler code it replaced, on a
+//              running game, and prints what differs.  Each bench times
+//              one part of the engine both ways.
+//
+// Usage:       lc2e-bench -check messages
+//              lc2e-bench -check sprites
+//              lc2e-bench -check svrules
+//              lc2e-bench -check caos -ticks 1000
+//              lc2e-bench -bench biochemistry -creatures 50
+//              lc2e-bench -bench lobes
+//              lc2e-bench -bench archive -ticks 10
+// -------------------------------------------------------------------------
+
+#ifndef SDL_BENCHCHECKS_H
+#define SDL_BENCHCHECKS_H
+
+#include <string>
+
+// ---------------------------------------------------------------------
+// Function:    RunBenchCheck
+// Arguments:   name - which check
+//              ticks - how long to run the world, for checks that do
+// Returns:     true if it passed.  An unknown name fails.
+// ---------------------------------------------------------------------
+bool RunBenchCheck( const std::string& name, int ticks );
+
+// ---------------------------------------------------------------------
+// Function:    RunMicroBench
+// Arguments:   name - which bench
+//              ticks - how many times to repeat the work timed
+// Returns:     false if there was nothing to time or the name is
+//              unknown
+// ---------------------------------------------------------------------
+bool RunMicroBench( const std::string& name, int ticks );
+
+#endif // SDL_BENCHCHECKS_H
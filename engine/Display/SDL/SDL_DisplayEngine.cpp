@@ -28,6 +28,7 @@
 #include	"../../ProgressDialog.h"
 #include	"../../C2eServices.h"
 #include	"../DrawableObjectHandler.h"
+#include	"../SpriteBlitter.h"
 #include <string>
 //#include	<dinput.h>
 #include "../EntityImage.h"
@@ -144,6 +145,9 @@ bool DisplayEngine::Start( bool fullScreen /*= false*/)
 {
 	myFullScreenFlag =fullScreen;
 
+	// pick the fastest sprite routines for this processor
+	SpriteBlitter::Initialise();
+
 //	myWindow=window;
 
 	// should query available screenmodes here.
@@ -627,7 +631,7 @@ void DisplayEngine::Update(Background* background,
 	}
 	
 	// draw the background parts
-	background->Draw(completeRedraw,entityHandler->GetUpdateList(),entityHandler->GetDirtyTileList());
+	background->Draw(completeRedraw,entityHandler->GetDirtyTiles());
 	// draw the sprites
 	entityHandler->Draw(completeRedraw);
 
@@ -659,6 +663,57 @@ void DisplayEngine::Update(Background* background,
 	}
 }
 
+// ----------------------------------------------------------------------
+// Method:      ScrollBackBuffer 
+// Arguments:   area - the part of the surface to scroll
+//				dx,dy - how far to move the contents in pixels
+// Returns:     true if the contents were moved, false if none of them
+//				would still be visible or no surface is open
+//
+// Description: Slides what is already on the surface being drawn to so
+//				that when the camera pans only the newly uncovered strip
+//				needs drawing.  The strip itself is left as it was.
+//			
+// ----------------------------------------------------------------------
+bool DisplayEngine::ScrollBackBuffer(RECT& area, int32 dx, int32 dy)
+{
+	if(!myCurrentOffScreenBufferPtr)
+		return false;
+
+	RECT clip = area;
+	if(clip.left < mySurfaceArea.left) clip.left = mySurfaceArea.left;
+	if(clip.top < mySurfaceArea.top) clip.top = mySurfaceArea.top;
+	if(clip.right > mySurfaceArea.right) clip.right = mySurfaceArea.right;
+	if(clip.bottom > mySurfaceArea.bottom) clip.bottom = mySurfaceArea.bottom;
+
+	int32 width = clip.right - clip.left - (dx < 0 ? -dx : dx);
+	int32 height = clip.bottom - clip.top - (dy < 0 ? -dy : dy);
+	if(width <= 0 || height <= 0)
+		return false;
+
+	uint16* from = myCurrentOffScreenBufferPtr + clip.left + (dx < 0 ? -dx : 0);
+	uint16* to = myCurrentOffScreenBufferPtr + clip.left + (dx > 0 ? dx : 0);
+	int32 bytes = width * sizeof(uint16);
+
+	if(dy > 0)
+	{
+		// moving down so start at the bottom to avoid
+		// overwriting lines we haven't moved yet
+		from += (clip.top + height - 1) * myPitch;
+		to += (clip.top + height - 1 + dy) * myPitch;
+		for(int32 line = 0; line < height; line++, from -= myPitch, to -= myPitch)
+			memmove(to,from,bytes);
+	}
+	else
+	{
+		from += (clip.top - dy) * myPitch;
+		to += clip.top * myPitch;
+		for(int32 line = 0; line < height; line++, from += myPitch, to += myPitch)
+			memmove(to,from,bytes);
+	}
+	return true;
+}
+
 // ----------------------------------------------------------------------
 // Method:      DrawToFrontBuffer 
 // Arguments:   None
@@ -2757,76 +2812,12 @@ void DisplayEngine::DrawCompressedSprite(Position& position,
 	// if no clipping is required
 	if(data_step == 0)
 	{
-		//	OutputDebugString("start no clip\n");
 		// draw taking account of transparent pixels
-		
-
-#ifdef C2E_NO_INLINE_ASM		
 		for (;bitmapHeight--;)
 		{
-			
-			tag = *compressedData_ptr++;
-			while(tag)
-			{
-				
-				// find the number of colours to plot
-				count = tag >>1;
-				
-				// check whether the run is transparent or colour
-				if(tag & 0x01)
-				{
-					bytes = count << 1;
-					memcpy(screen_ptr,compressedData_ptr,bytes);
-					compressedData_ptr+=count;
-					screen_ptr+=count;
-
-				}
-				else
-				{
-					screen_ptr+= count;
-				}
-				tag = *compressedData_ptr++;
-			}// end  while tag
-			
+			SpriteBlitter::DrawLine(screen_ptr,compressedData_ptr);
 			screen_ptr+=screen_step;
 		}//end for bitmap height--
-#else
-		// need a gcc-friendly or nasm version
-
-		if (bitmapHeight == 0 || bitmapWidth == 0)
-			return;	
-		_asm
-		{
-			;pusha
-
-			mov esi,dword ptr [compressedData_ptr]
-			mov edi,dword ptr [screen_ptr]
-			mov edx,dword ptr [screen_step]
-			mov ebx,dword ptr [bitmapHeight]
-
-		topOfLineLoop:
-			lodsw									;Get tag and increment ptr lodsb
-			and eax,0ffffh			;0ffh
-			test eax,eax
-			je lineLoopEpilogue
-			test ax,1
-			je skipCopy
-			mov ecx,eax
-			shr ecx,1
-			rep movsw ;dword ptr [edi],dword ptr [esi]
-			jmp topOfLineLoop
-		skipCopy:	
-			lea edi,[edi+eax]
-			jmp topOfLineLoop
-		lineLoopEpilogue:
-			lea edi,[edi+edx*2]
-			;sub ebx,1
-			dec ebx
-			;test ebx,ebx
-			jne topOfLineLoop
-			;popa
-		}
-#endif
 		return;
 	//		OutputDebugString("end no clip \n");*/
 	}// end if datastep ==0
@@ -3109,33 +3100,11 @@ void DisplayEngine::DrawMirroredCompressedSprite(Position& position,
 
 		for (;bitmapHeight--;)
 			{
-			tag = *compressedData_ptr++;
-			while(tag)
-				{
-				// find the number of colours to plot
-				count = tag >>1;
-
-				// check whether the run is transparent or colour
-				if(tag & 0x01)
-					{
-					for(;count--;)
-						{
-						// move along the screen line
-						screenLineStart++;
-						*screen_ptr-- = *compressedData_ptr;
-						compressedData_ptr++;//=sizeof(uint16);
-						}
-					}
-				else
-					{
-					// move along the screen line
-					screenLineStart+=count;
-					screen_ptr-= count;
-					}
-				tag = *compressedData_ptr++;
-				}// end  while tag
-			// move to the next screen line
-			screenLineStart+=screen_step;
+			uint16* lineEnd = screen_ptr;
+			SpriteBlitter::DrawMirroredLine(screen_ptr,compressedData_ptr);
+			// move along the screen line by however much was drawn,
+			// then on to the next screen line
+			screenLineStart+=(lineEnd - screen_ptr) + screen_step;
 			// make sure that the screen pointer draws the line backwards
 			screen_ptr= screenLineStart + bitmapWidth;
 			}//end for bitmap heigth--
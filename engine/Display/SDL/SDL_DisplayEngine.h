@@ -330,6 +330,8 @@ DisplayEngine(int do_not_call_me,int as_i_never_return) { while (true);}
 	void ReleaseSurface(SDL_Surface*& tempSurface);
 
 
+	bool ScrollBackBuffer(RECT& area, int32 dx, int32 dy);
+
 	bool FlipScreenHorizontally();
 	void FlipScreenVertically();
 	bool SlideScreen();
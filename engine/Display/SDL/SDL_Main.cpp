@@ -305,7 +305,7 @@ static bool DoStartup()
 	if( !theApp.Init() )
 		return false;
 
-	// TODO: setup external interface here please :-)
+	// (the external interface is set up by App::Init)
 
 	return true;
 }
@@ -316,7 +316,7 @@ static void DoShutdown()
 {
 	ourRunning = false;
 
-	// TODO: close down external interface here.
+	// (the external interface is closed by App::ShutDown)
 
 	theApp.ShutDown();
 }
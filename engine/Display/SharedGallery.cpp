@@ -35,6 +35,7 @@
 #include "DisplayEngine.h"		// for displaying errors
 #include "../General.h"
 #include "../App.h"
+#include "../DirectoryIndex.h"
 #include "ErrorMessageHandler.h"
 #include <algorithm>
 #include <locale.h> //need non-template tolower
@@ -133,12 +134,7 @@ Gallery* SharedGallery::CreateGallery(FilePath const &galleryIn)
 		// not compressed sprite gallery
 		std::string tempGalleryName = galleryName;
 		tempGalleryName[x+1] = 'C';
-#ifdef _WIN32
-		int32 attributes = GetFileAttributes(tempGalleryName.data());
-		if(attributes != -1)
-#else
-		if(FileExists(tempGalleryName.data()))
-#endif
+		if(DirectoryIndex::theDirectoryIndex().FileExists(tempGalleryName))
 		{
 			galleryName = tempGalleryName;
 			// get the revised extension
@@ -356,12 +352,7 @@ Gallery* SharedGallery::CreateClonedGallery(FilePath const &galleryIn,
 		// not compressed sprite gallery
 		std::string tempGalleryName = fileName;
 		tempGalleryName[x+1] = 'C';
-#ifdef _WIN32
-		int32 attributes = GetFileAttributes(tempGalleryName.data());
-		if(attributes != -1)
-#else
-		if(FileExists(tempGalleryName.data()))
-#endif
+		if(DirectoryIndex::theDirectoryIndex().FileExists(tempGalleryName))
 		{
 			fileName = tempGalleryName;
 			// get the revised extension
@@ -0,0 +1,302 @@
+// --------------------------------------------------------------------------
+// Filename:	SpriteBlitter.cpp
+// Class:		SpriteBlitter
+// Purpose:		Draws scanlines of compressed (C16) sprite data
+//
+// Description: See SpriteBlitter.h
+//
+//				The SSE2 and AVX2 versions copy colour runs a register
+//				at a time, finishing off with one overlapping copy (or
+//				pixel by pixel for mirrored runs), so short runs don't
+//				pay for a call to memcpy.
+//
+// History:
+// --------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "SpriteBlitter.h"
+#include "../CPUID.h"
+#include "../../common/C2eDebug.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+// work out whether we can build the SIMD versions
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#define BLIT_SIMD
+	#define BLIT_SSE2 __attribute__((target("sse2")))
+	#define BLIT_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800 && (defined(_M_IX86) || defined(_M_X64))
+	#define BLIT_SIMD
+	#define BLIT_SSE2
+	#define BLIT_AVX2
+#endif
+
+#ifdef BLIT_SIMD
+#include <immintrin.h>
+#endif
+
+
+// ----------------------------------------------------------------------
+// plain versions
+// ----------------------------------------------------------------------
+static void DrawLineScalar( uint16*& screen, uint16*& data )
+{
+	uint16 tag = *data++;
+	while( tag )
+	{
+		// find the number of colours to plot
+		uint16 count = tag >> 1;
+
+		// check whether the run is transparent or colour
+		if( tag & 0x01 )
+		{
+			memcpy( screen, data, count << 1 );
+			data += count;
+		}
+		screen += count;
+		tag = *data++;
+	}
+}
+
+static void DrawMirroredLineScalar( uint16*& screen, uint16*& data )
+{
+	uint16 tag = *data++;
+	while( tag )
+	{
+		uint16 count = tag >> 1;
+		if( tag & 0x01 )
+		{
+			for( ; count--; )
+				*screen-- = *data++;
+		}
+		else
+			screen -= count;
+		tag = *data++;
+	}
+}
+
+
+#ifdef BLIT_SIMD
+
+// ----------------------------------------------------------------------
+// SSE2 versions
+// ----------------------------------------------------------------------
+BLIT_SSE2 static void DrawLineSSE2( uint16*& screen, uint16*& data )
+{
+	uint16 tag = *data++;
+	while( tag )
+	{
+		int count = tag >> 1;
+		if( tag & 0x01 )
+		{
+			if( count < 8 )
+			{
+				for( int i = 0; i < count; ++i )
+					screen[i] = data[i];
+			}
+			else
+			{
+				int i = 0;
+				for( ; i + 8 <= count; i += 8 )
+					_mm_storeu_si128( (__m128i*)(screen + i),
+						_mm_loadu_si128( (const __m128i*)(data + i) ) );
+				if( i < count )
+					_mm_storeu_si128( (__m128i*)(screen + count - 8),
+						_mm_loadu_si128( (const __m128i*)(data + count - 8) ) );
+			}
+			data += count;
+		}
+		screen += count;
+		tag = *data++;
+	}
+}
+
+BLIT_SSE2 static void DrawMirroredLineSSE2( uint16*& screen, uint16*& data )
+{
+	uint16 tag = *data++;
+	while( tag )
+	{
+		int count = tag >> 1;
+		if( tag & 0x01 )
+		{
+			for( ; count >= 8; count -= 8 )
+			{
+				// reverse the eight pixels and store them so the
+				// first one ends up at screen[0]
+				__m128i pixels = _mm_loadu_si128( (const __m128i*)data );
+				pixels = _mm_shufflelo_epi16( pixels, _MM_SHUFFLE(0,1,2,3) );
+				pixels = _mm_shufflehi_epi16( pixels, _MM_SHUFFLE(0,1,2,3) );
+				pixels = _mm_shuffle_epi32( pixels, _MM_SHUFFLE(1,0,3,2) );
+				_mm_storeu_si128( (__m128i*)(screen - 7), pixels );
+				screen -= 8;
+				data += 8;
+			}
+			for( ; count--; )
+				*screen-- = *data++;
+		}
+		else
+			screen -= count;
+		tag = *data++;
+	}
+}
+
+
+// ----------------------------------------------------------------------
+// AVX2 versions
+// ----------------------------------------------------------------------
+BLIT_AVX2 static void DrawLineAVX2( uint16*& screen, uint16*& data )
+{
+	uint16 tag = *data++;
+	while( tag )
+	{
+		int count = tag >> 1;
+		if( tag & 0x01 )
+		{
+			if( count < 8 )
+			{
+				for( int i = 0; i < count; ++i )
+					screen[i] = data[i];
+			}
+			else
+			{
+				int i = 0;
+				for( ; i + 16 <= count; i += 16 )
+					_mm256_storeu_si256( (__m256i*)(screen + i),
+						_mm256_loadu_si256( (const __m256i*)(data + i) ) );
+				if( i + 8 <= count )
+				{
+					_mm_storeu_si128( (__m128i*)(screen + i),
+						_mm_loadu_si128( (const __m128i*)(data + i) ) );
+					i += 8;
+				}
+				if( i < count )
+					_mm_storeu_si128( (__m128i*)(screen + count - 8),
+						_mm_loadu_si128( (const __m128i*)(data + count - 8) ) );
+			}
+			data += count;
+		}
+		screen += count;
+		tag = *data++;
+	}
+	_mm256_zeroupper();
+}
+
+BLIT_AVX2 static void DrawMirroredLineAVX2( uint16*& screen, uint16*& data )
+{
+	// reverses the pixels within each half of a register
+	const __m256i reverse = _mm256_setr_epi8(
+		14,15, 12,13, 10,11, 8,9, 6,7, 4,5, 2,3, 0,1,
+		14,15, 12,13, 10,11, 8,9, 6,7, 4,5, 2,3, 0,1 );
+
+	uint16 tag = *data++;
+	while( tag )
+	{
+		int count = tag >> 1;
+		if( tag & 0x01 )
+		{
+			for( ; count >= 16; count -= 16 )
+			{
+				__m256i pixels = _mm256_loadu_si256( (const __m256i*)data );
+				pixels = _mm256_shuffle_epi8( pixels, reverse );
+				pixels = _mm256_permute2x128_si256( pixels, pixels, 0x01 );
+				_mm256_storeu_si256( (__m256i*)(screen - 15), pixels );
+				screen -= 16;
+				data += 16;
+			}
+			for( ; count--; )
+				*screen-- = *data++;
+		}
+		else
+			screen -= count;
+		tag = *data++;
+	}
+	_mm256_zeroupper();
+}
+
+#endif // BLIT_SIMD
+
+
+SpriteLineFunction SpriteBlitter::DrawLine = DrawLineScalar;
+SpriteLineFunction SpriteBlitter::DrawMirroredLine = DrawMirroredLineScalar;
+const char* SpriteBlitter::ourName = "C++";
+
+
+#ifdef _DEBUG
+// Draws random lines with both routines and checks that they match
+static bool TestSpriteLines( SpriteLineFunction test, SpriteLineFunction plain,
+							bool mirrored )
+{
+	const int maxPixels = 600;
+	uint16 data[ maxPixels * 2 + 2 ];
+	uint16 screenA[ maxPixels * 2 ];
+	uint16 screenB[ maxPixels * 2 ];
+
+	for( int line = 0; line < 200; ++line )
+	{
+		// make up a scanline
+		int pixels = 0;
+		int n = 0;
+		while( pixels < maxPixels - 40 && (rand() % 16) != 0 )
+		{
+			int count = 1 + rand() % 40;
+			bool colour = (rand() & 1) != 0;
+			data[n++] = (uint16)((count << 1) | (colour ? 1 : 0));
+			if( colour )
+			{
+				for( int i = 0; i < count; ++i )
+					data[n++] = (uint16)(rand() | 1);
+			}
+			pixels += count;
+		}
+		data[n++] = 0;
+
+		memset( screenA, 0, sizeof( screenA ) );
+		memset( screenB, 0, sizeof( screenB ) );
+
+		int start = mirrored ? maxPixels : 0;
+		uint16* screen1 = screenA + start;
+		uint16* data1 = data;
+		uint16* screen2 = screenB + start;
+		uint16* data2 = data;
+		test( screen1, data1 );
+		plain( screen2, data2 );
+
+		if( screen1 - screenA != screen2 - screenB ||
+			data1 != data2 ||
+			memcmp( screenA, screenB, sizeof( screenA ) ) != 0 )
+			return false;
+	}
+	return true;
+}
+#endif
+
+
+void SpriteBlitter::Initialise( bool useVectors )
+{
+	DrawLine = DrawLineScalar;
+	DrawMirroredLine = DrawMirroredLineScalar;
+	ourName = "C++";
+
+#ifdef BLIT_SIMD
+	if( useVectors && CheckAVX2Technology() )
+	{
+		DrawLine = DrawLineAVX2;
+		DrawMirroredLine = DrawMirroredLineAVX2;
+		ourName = "AVX2";
+	}
+	else if( useVectors && CheckSSE2Technology() )
+	{
+		DrawLine = DrawLineSSE2;
+		DrawMirroredLine = DrawMirroredLineSSE2;
+		ourName = "SSE2";
+	}
+
+#ifdef _DEBUG
+	ASSERT( TestSpriteLines( DrawLine, DrawLineScalar, false ) );
+	ASSERT( TestSpriteLines( DrawMirroredLine, DrawMirroredLineScalar, true ) );
+#endif
+#endif
+}
@@ -0,0 +1,70 @@
+// --------------------------------------------------------------------------
+// Filename:	SpriteBlitter.h
+// Class:		SpriteBlitter
+// Purpose:		Draws scanlines of compressed (C16) sprite data
+//
+// Description: Each scanline of a CompressedBitmap is a list of tags.
+//				The bottom bit of a tag says whether it is a run of
+//				colours (which follow the tag) or of transparent pixels,
+//				and the rest is the number of pixels.  A zero tag ends
+//				the line.
+//
+//				DrawLine and DrawMirroredLine point at the fastest
+//				version for the processor, which Initialise() picks
+//				using the CPUID functions.  Until then they point at
+//				the plain C++ versions.
+//
+// History:
+// --------------------------------------------------------------------------
+#ifndef		SPRITEBLITTER_H
+#define		SPRITEBLITTER_H
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../../common/C2eTypes.h"
+
+typedef void (*SpriteLineFunction)( uint16*& screen, uint16*& data );
+
+class SpriteBlitter
+{
+public:
+	// ----------------------------------------------------------------------
+	// Method:      Initialise
+	// Arguments:   useVectors - false for the plain versions whatever
+	//				the processor
+	// Returns:     None
+	// Description: Picks the routines for this processor.  Debug builds
+	//				check them against the plain versions first.
+	// ----------------------------------------------------------------------
+	static void Initialise( bool useVectors = true );
+
+	static const char* GetName() { return ourName; }
+
+	// ----------------------------------------------------------------------
+	// Method:      DrawLine
+	// Arguments:   screen - first pixel of the line on the screen
+	//				data - first tag of the line in the sprite
+	// Returns:     None
+	// Description: Draws one unclipped scanline left to right.  Both
+	//				pointers are left just past what was drawn and read,
+	//				exactly as the old loops left them.
+	// ----------------------------------------------------------------------
+	static SpriteLineFunction DrawLine;
+
+	// ----------------------------------------------------------------------
+	// Method:      DrawMirroredLine
+	// Arguments:   screen - where the first pixel of the line goes
+	//				data - first tag of the line in the sprite
+	// Returns:     None
+	// Description: As DrawLine, but draws right to left, moving screen
+	//				back one pixel after each one drawn.
+	// ----------------------------------------------------------------------
+	static SpriteLineFunction DrawMirroredLine;
+
+private:
+	static const char* ourName;
+};
+
+#endif		// SPRITEBLITTER_H
@@ -8,26 +8,68 @@
 #include "DisplayEngine.h"
 #include "../C2eServices.h"
 
+#include <string.h>
+
 #ifdef _WIN32
 #include "../../common/zlib113/zlib.h"
 #else
 #include <zlib.h>
 #endif
 
-#define BOUND(c) if(c<0)c=0;else if (c>255)c=255;
-
 CREATURES_IMPLEMENT_SERIAL( TintManager )
 
+// (never destroyed, as managers can outlive static data at exit)
+TintManager::SharedTables& TintManager::GetTables()
+{
+	static SharedTables* tables = new SharedTables;
+	return *tables;
+}
+
+// Every colour maps to itself.  Shared by all untinted managers,
+// whatever the pixel format, and never freed.
+static const int16 theIdentityTint[5] = { 128, 128, 128, 128, 128 };
+
+// (set once, so safe to compare against from the gallery builder)
+const uint16* TintManager::ourIdentityTable = NULL;
+
+
 TintManager::TintManager()
 {
 	myRedTint = myBlueTint = myGreenTint = mySwap = myRotation = 128;
-	for(int colour = 0;colour < 65536; colour++)
-		myTintTable[colour] = colour;
+	myTable = AcquireTable(128,128,128,128,128);
 }
 
-TintManager::~TintManager()
+TintManager::TintManager( const TintManager& other )
+	: PersistentObject( other )
+{
+	myRedTint = other.myRedTint;
+	myGreenTint = other.myGreenTint;
+	myBlueTint = other.myBlueTint;
+	myRotation = other.myRotation;
+	mySwap = other.mySwap;
+	myTable = other.myTable;
+	myTable->references++;
+}
+
+TintManager& TintManager::operator=( const TintManager& other )
 {
+	if (this != &other)
+	{
+		other.myTable->references++;
+		ReleaseTable(myTable);
+		myTable = other.myTable;
+		myRedTint = other.myRedTint;
+		myGreenTint = other.myGreenTint;
+		myBlueTint = other.myBlueTint;
+		myRotation = other.myRotation;
+		mySwap = other.mySwap;
+	}
+	return *this;
+}
 
+TintManager::~TintManager()
+{
+	ReleaseTable(myTable);
 }
 
 CreaturesArchive& operator<<( CreaturesArchive &ar, TintManager const &thisManager )
@@ -45,10 +87,20 @@ CreaturesArchive& operator>>( CreaturesArchive &ar, TintManager &thisManager )
 bool TintManager::Write( CreaturesArchive &ar ) const
 {
 	// New style...
-	uint16* myCompressedSpace = new uint16[128*1024];
-	uint32 csize = 128*1024*sizeof(uint16);
+	// (compressed once per shared table, however many use it)
+	std::vector< uint8 >& compressed = myTable->compressed;
+	if (compressed.empty())
+	{
+		uint32 csize = 128*1024*sizeof(uint16);
+		compressed.resize(csize);
+		if ( compress(&compressed[0],&csize,(uint8*)myTable->table,65536*sizeof(uint16)) != Z_OK)
+			compressed.clear();
+		else
+			compressed.resize(csize);
+	}
+
 	uint32 temp;
-	if ( compress((uint8*)myCompressedSpace,&csize,(uint8*)myTintTable,65536*sizeof(uint16)) != Z_OK)
+	if (compressed.empty())
 	{
 		temp = 1;
 		ar << temp;
@@ -58,11 +110,11 @@ bool TintManager::Write( CreaturesArchive &ar ) const
 	{
 		temp = 2;
 		ar << temp;
+		uint32 csize = compressed.size();
 		ar << csize;
-		ar.Write(myCompressedSpace,csize);
+		ar.Write(&compressed[0],csize);
 		ar << myRedTint << myGreenTint << myBlueTint << myRotation << mySwap;
 	}
-	delete [] myCompressedSpace;
 	
 	return true;
 }
@@ -77,18 +129,15 @@ bool TintManager::Read( CreaturesArchive &ar )
 		ar >> size;
 		if (size == 2)
 		{
-			uint16* myCompressedData = new uint16[128*1024];
+			// The saved table is only ever what BuildTintTable makes
+			// from the tint values, so skip it and share the cached one
 			uint32 csize;
 			ar >> csize;
-			ar.Read(myCompressedData,csize);
+			std::vector< uint8 > compressedData(csize);
+			if (csize > 0)
+				ar.Read(&compressedData[0],csize);
 			ar >> myRedTint >> myGreenTint >> myBlueTint >> myRotation >> mySwap;
-			size = 65536 * sizeof(uint16);
-			if ( uncompress((uint8*)myTintTable,&size,(uint8*)myCompressedData,csize) != Z_OK )
-			{
-				// Oh bugger - fecked tinttable on load :(:(
-				BuildTintTable(myRedTint,myGreenTint,myBlueTint,myRotation,mySwap);
-			}
-			delete [] myCompressedData;
+			BuildTintTable(myRedTint,myGreenTint,myBlueTint,myRotation,mySwap);
 		}
 		else if (size == 1)
 		{
@@ -108,104 +157,151 @@ bool TintManager::Read( CreaturesArchive &ar )
 
 void TintManager::BuildTintTable(int16 redTint, int16 greenTint, int16 blueTint, int16 rotation, int16 swap)
 {
-	// Remember to manage by 565/555
-
 	myRedTint = redTint;
 	myGreenTint = greenTint;
 	myBlueTint = blueTint;
 	myRotation = rotation;
 	mySwap = swap;
 
-	if (redTint == 128 && blueTint == 128 && greenTint == 128 && rotation == 128 && swap == 128)
+	SharedTable* table = AcquireTable(redTint,greenTint,blueTint,rotation,swap);
+	ReleaseTable(myTable);
+	myTable = table;
+}
+
+
+bool TintManager::IsIdentityTable( const uint16* tintTable )
+{
+	return tintTable == ourIdentityTable;
+}
+
+
+bool TintManager::TableKey::operator<( const TableKey& other ) const
+{
+	int cmp = memcmp(tint, other.tint, sizeof(tint));
+	if (cmp != 0)
+		return cmp < 0;
+	return is565 < other.is565;
+}
+
+
+TintManager::SharedTable* TintManager::AcquireTable( int16 redTint,
+	int16 greenTint, int16 blueTint, int16 rotation, int16 swap )
+{
+	TableKey key;
+	key.tint[0] = redTint;
+	key.tint[1] = greenTint;
+	key.tint[2] = blueTint;
+	key.tint[3] = rotation;
+	key.tint[4] = swap;
+
+	// the identity table doesn't depend on the pixel format
+	bool identity = memcmp(key.tint, theIdentityTint, sizeof(theIdentityTint)) == 0;
+	key.is565 = !identity &&
+		DisplayEngine::theRenderer().GetMyPixelFormat() == RGB_565;
+
+	SharedTables& tables = GetTables();
+	SharedTables::iterator it = tables.find(key);
+	if (it != tables.end())
 	{
-		for(int colour = 0;colour < 65536; colour++)
-			myTintTable[colour] = colour;
-		return;
+		it->second->references++;
+		return it->second;
 	}
 
+	SharedTable* table = new SharedTable;
+	table->key = key;
+	table->references = identity ? 2 : 1;	// (the cache keeps the identity)
+	FillTable(table->table,redTint,greenTint,blueTint,rotation,swap,key.is565);
+	if (identity)
+		ourIdentityTable = table->table;
+	tables[key] = table;
+	return table;
+}
 
-	// OutputFormattedDebugString("Building of Tint table of (%d,%d,%d) : %d : %d ...",redTint,greenTint,blueTint,rotation,swap);
 
-	bool is565 = DisplayEngine::theRenderer().GetMyPixelFormat() == RGB_565;
+void TintManager::ReleaseTable( SharedTable* table )
+{
+	if (--table->references > 0)
+		return;
+
+	GetTables().erase(table->key);
+	delete table;
+}
+
+
+static inline int32 Bound( int32 c )
+{
+	return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+
+void TintManager::FillTable( uint16* table, int16 redTint, int16 greenTint,
+	int16 blueTint, int16 rotation, int16 swap, bool is565 )
+{
+	int32 colour;
+
+	if (redTint == 128 && blueTint == 128 && greenTint == 128 && rotation == 128 && swap == 128)
+	{
+		for(colour = 0;colour < 65536; colour++)
+			table[colour] = colour;
+		return;
+	}
+
+	// Remember to manage by 565/555
 
 	uint16 absRot = (rotation >= 128)? rotation - 128:128 - rotation;
 	uint16 invRot = 127 - absRot;
 	uint16 absSwap = (swap >= 128)? swap - 128:128 - swap;
 	uint16 invSwap = 127 - absSwap;
 
-	uint16 destinationColour;
-	uint8 ar, ag, ab =0;
-	int32 r,g,b = 0;
-	int32 rr,rg,rb = 0;
-	int32 sr,sb = 0;
-
-	myTintTable[0] = 0;
+	// Uses C2 (fecked?) code for now :)
+	// Rotation mixes each channel with the one before it (below 128)
+	// or after it.  Sorting that out once here, rather than for every
+	// colour, leaves the loop below as plain straight line arithmetic
+	// that the compiler is free to vectorise.
+	int32 before = (rotation < 128) ? absRot : 0;
+	int32 after = (rotation < 128) ? 0 : absRot;
 
 	redTint -= 128;
 	greenTint -= 128;
 	blueTint -= 128;
 
-	for(int32 colour = 1; colour < (is565?65536:32678); colour++)
-	{
-		
-		if (is565)
-		{
-			P565_TO_RGB(colour,ar,ag,ab)
-		}
-		else
-		{
-			P555_TO_RGB(colour,ar,ag,ab)
-		}
-
-		// Now we have a colour. Let's tint it :)
-
-		r = ar + redTint;
-		g = ag + greenTint;
-		b = ab + blueTint;
+	int redShift = is565 ? 8 : 7;
+	int greenShift = is565 ? 3 : 2;
+	int32 end = is565 ? 65536 : 32678;
 
-		// Woohoo, tinted :):)
+	table[0] = 0;
+	for(colour = 1; colour < end; colour++)
+	{
+		// Now we have a colour. Let's tint it, and
+		// ceiling / floor it...
+		int32 r = Bound(((colour >> redShift) & 0xff) + redTint);
+		int32 g = Bound(((colour >> greenShift) & 0xff) + greenTint);
+		int32 b = Bound(((colour << 3) & 0xff) + blueTint);
 
-		// Ceiling / Floor it...
-		BOUND(r)
-		BOUND(g)
-		BOUND(b)
+		int32 rr = ( (before * b) + (after * g) + (invRot * r) ) >> 7;
+		int32 rg = ( (before * r) + (after * b) + (invRot * g) ) >> 7;
+		int32 rb = ( (before * g) + (after * r) + (invRot * b) ) >> 7;
 
-		// Next the task is to make them HSV? do we need this? Rot/Swap
-		// Perhaps the trick will be to make it cunningly without H,S & V.
-
-		
-		// Uses C2 (fecked?) code for now :)
-		if ( rotation < 128 )
-		{
-			rr = ( (absRot * b) + (invRot * r) ) >> 7;
-			rg = ( (absRot * r) + (invRot * g) ) >> 7;
-			rb = ( (absRot * g) + (invRot * b) ) >> 7;
-		}	
-		else
-		{
-			rr = ( (absRot * g) + (invRot * r) ) >> 7;
-			rg = ( (absRot * b) + (invRot * g) ) >> 7;
-			rb = ( (absRot * r) + (invRot * b) ) >> 7;
-		}
-		sr = ( (absSwap * rb) + (invSwap * rr) ) >> 7;
-		sb = ( (absSwap * rr) + (invSwap * rb) ) >> 7;
-
-		BOUND(sr)
-		BOUND(rg)
-		BOUND(sb)
+		int32 sr = Bound( ( (absSwap * rb) + (invSwap * rr) ) >> 7 );
+		int32 sg = Bound( rg );
+		int32 sb = Bound( ( (absSwap * rr) + (invSwap * rb) ) >> 7 );
 
+		uint16 destinationColour;
 		if (is565)
 		{
-			RGB_TO_565(sr,rg,sb,destinationColour)
+			RGB_TO_565(sr,sg,sb,destinationColour)
 		}
 		else
 		{
-			RGB_TO_555(sr,rg,sb,destinationColour)
+			RGB_TO_555(sr,sg,sb,destinationColour)
 		}
 		
-		myTintTable[colour] = (destinationColour == 0)?1:destinationColour;
+		table[colour] = (destinationColour == 0)?1:destinationColour;
 	}
-	// OutputFormattedDebugString("Done\n");	
+
+	// (555 colours past the end of the loop are left as they are)
+	for(; colour < 65536; colour++)
+		table[colour] = colour;
 }
 
 void TintManager::TintBitmap(Bitmap* thisBitmap) const
@@ -218,5 +314,5 @@ void TintManager::TintBitmap(Bitmap* thisBitmap) const
 	uint16* bitmapData = thisBitmap->GetData();
 
 	for(int i = 0; i < (w*h); i++)
-		*bitmapData++ = myTintTable[*bitmapData];	
+		*bitmapData++ = myTable->table[*bitmapData];	
 }
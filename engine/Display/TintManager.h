@@ -8,6 +8,9 @@
 #include "../PersistentObject.h"
 #include "../../common/C2eTypes.h"
 
+#include <map>
+#include <vector>
+
 class Bitmap;
 
 class TintManager : public PersistentObject
@@ -17,6 +20,8 @@ class TintManager : public PersistentObject
 public:
 
 	TintManager();
+	TintManager( const TintManager& other );
+	TintManager& operator=( const TintManager& other );
 	~TintManager();
 
 	virtual bool Write( CreaturesArchive &ar ) const;
@@ -25,12 +30,47 @@ public:
 	void BuildTintTable(int16 redTint, int16 greenTint, int16 blueTint, int16 rotation, int16 swap);
 	void TintBitmap(Bitmap* thisBitmap) const;
 
-	const uint16* GetMyTintTable() const { return myTintTable; }
+	const uint16* GetMyTintTable() const { return myTable->table; }
+
+	// True for the table that leaves every colour alone, which
+	// there's no need to apply.  Safe on any thread.
+	static bool IsIdentityTable( const uint16* tintTable );
+
 private:
 
 	// My Tint Tables
-
-	uint16 myTintTable[65536];
+	//
+	// Tables are shared between all the managers with the same tint
+	// and pixel format (all the siblings of a breed, for instance),
+	// and freed when the last of them lets go.  Only used from the
+	// main thread.
+
+	struct TableKey
+	{
+		int16 tint[5];		// red, green, blue, rotation, swap
+		bool is565;
+		bool operator<( const TableKey& other ) const;
+	};
+
+	struct SharedTable
+	{
+		TableKey key;
+		int references;
+		std::vector< uint8 > compressed;	// for Write, made when first needed
+		uint16 table[65536];
+	};
+	typedef std::map< TableKey, SharedTable* > SharedTables;
+
+	static SharedTable* AcquireTable( int16 redTint, int16 greenTint,
+		int16 blueTint, int16 rotation, int16 swap );
+	static void ReleaseTable( SharedTable* table );
+	static void FillTable( uint16* table, int16 redTint, int16 greenTint,
+		int16 blueTint, int16 rotation, int16 swap, bool is565 );
+
+	static SharedTables& GetTables();
+	static const uint16* ourIdentityTable;
+
+	SharedTable* myTable;
 
 	// Specifications for tint table for use in serialisation etc.
 
@@ -16,8 +16,11 @@ SRC += engine/Display/Background.cpp \
 	engine/Display/CompressedGallery.cpp \
 	engine/Display/CompressedSprite.cpp \
 	engine/Display/CreatureGallery.cpp \
+	engine/Display/CreatureGalleryBuilder.cpp \
+	engine/Display/DirtyTileMap.cpp \
 	engine/Display/DrawableObject.cpp \
 	engine/Display/DrawableObjectHandler.cpp \
+	engine/Display/DrawableObjectIndex.cpp \
 	engine/Display/EntityImage.cpp \
 	engine/Display/EntityImageClone.cpp \
 	engine/Display/EntityImageWithEmbeddedCamera.cpp \
@@ -30,6 +33,7 @@ SRC += engine/Display/Background.cpp \
 	engine/Display/NormalGallery.cpp \
 	engine/Display/SharedGallery.cpp \
 	engine/Display/Sprite.cpp \
+	engine/Display/SpriteBlitter.cpp \
 	engine/Display/System.cpp \
 	engine/Display/TintManager.cpp
 
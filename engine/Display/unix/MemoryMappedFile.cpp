@@ -28,13 +28,13 @@
 
 
 MemoryMappedFile::MemoryMappedFile() :
-	myFile(0),myLength(0),myBasePtr(NULL),myPosition(0)
+	myFile(-1),myLength(0),myBasePtr(NULL),myPosition(0)
 {
 }
 
 MemoryMappedFile::MemoryMappedFile( const std::string& filename,
 	uint32 desiredAccessFlags, uint32 sharemodeFlags ) :
-	myFile(0),myLength(0),myBasePtr(NULL),myPosition(0)
+	myFile(-1),myLength(0),myBasePtr(NULL),myPosition(0)
 {
 	Open( filename, desiredAccessFlags, sharemodeFlags );
 }
@@ -48,7 +48,7 @@ void MemoryMappedFile::Open( const std::string& filename,
 {
 	// open the file
 
-	ASSERT( myFile == 0 );		// don't allow reopening.
+	ASSERT( myFile == -1 );		// don't allow reopening.
 
 	int oflags = 0;
 
@@ -63,8 +63,9 @@ void MemoryMappedFile::Open( const std::string& filename,
         oflags |= O_WRONLY;
 
 	myFile = open( filename.c_str(), oflags, S_IREAD|S_IWRITE );
-	if( !myFile )
+	if( myFile < 0 )
 	{
+		myFile = -1;
 		throw MemoryMappedFileException(
 			"MemoryMappedFile::Open() - open failed", __LINE__ );
 	}
@@ -76,6 +77,7 @@ void MemoryMappedFile::Open( const std::string& filename,
 		if( fstat( myFile, &inf ) != 0 )
 		{
 			close( myFile );
+			myFile = -1;
 			throw MemoryMappedFileException(
 				"MemoryMappedFile::Open() - fstat failed", __LINE__ );
 		}
@@ -93,14 +95,20 @@ void MemoryMappedFile::Open( const std::string& filename,
 	if( desiredAccessFlags & GENERIC_READ )
 		prot |= PROT_READ;
 
-	myBasePtr = (byte*)mmap( 0, fileSize, prot, flags, myFile, 0 );
+	void* view = MAP_FAILED;
+	if( myLength > 0 )
+		view = mmap( 0, myLength, prot, flags, myFile, 0 );
 
-	if( !myBasePtr )
+	if( view == MAP_FAILED )
 	{
 		close( myFile );
+		myFile = -1;
+		myLength = 0;
 		throw MemoryMappedFileException(
 			"MemoryMappedFile::Open() - mmap failed", __LINE__ );
 	}
+	myBasePtr = (uint8*)view;
+	myPosition = 0;
 }
 
 
@@ -116,17 +124,16 @@ MemoryMappedFile::~MemoryMappedFile()
 
 void MemoryMappedFile::Close()
 {
-	if( myBasePtr && myLength > 0 );
-	{
+	if( myBasePtr && myLength > 0 )
 		munmap( myBasePtr, myLength );
-		myBasePtr = NULL;
-		myLength = 0;
-	}
+	myBasePtr = NULL;
+	myLength = 0;
+	myPosition = 0;
 
-	if( myFile )
+	if( myFile != -1 )
 	{
 		close( myFile );
-		myFile = 0;
+		myFile = -1;
 	}
 
 }
@@ -136,7 +143,7 @@ void MemoryMappedFile::Close()
 void MemoryMappedFile::Seek(int32 moveBy, File::FilePosition from)
 {
 
-	uint32 newpos;
+	uint32 newpos = myPosition;
 	switch(from)
 	{
 	case(File::Start): 
@@ -147,7 +154,7 @@ void MemoryMappedFile::Seek(int32 moveBy, File::FilePosition from)
 
 	case(File::Current):
 		{
-			newpos += moveBy;
+			newpos = myPosition + moveBy;
 			break;
 		}
 	case(File::End):
@@ -45,13 +45,16 @@ public:
 
 	void Seek( int32 moveBy, File::FilePosition from );
 
-	unsigned char* GetFileStart();
+	unsigned char* GetFileStart(){return myBasePtr;}
 //	HANDLE GetFileMapping(){return myMemoryFile;}
 
-	uint32 GetPosition();
-	void Reset();
+	uint32 GetPosition(){return myPosition;}
+	void Reset(){myPosition = 0;}
 
-	bool Valid();
+	// size of the mapped view in bytes
+	uint32 GetLength(){return myLength;}
+
+	bool Valid(){return (myBasePtr != NULL);}
 
 //////////////////////////////////////////////////////////////////////////
 // Exceptions
@@ -22,6 +22,7 @@
 
 #include "File.h"
 #include "Display/ErrorMessageHandler.h"
+#include "DirectoryIndex.h"
 
 
 
@@ -124,7 +125,11 @@ void File::Create(const std::string& name,
 
 	if (myDiskFileHandle!=INVALID_HANDLE_VALUE)
 	{
+		// (OPEN_ALWAYS, so it may well have been there already)
+		bool created = GetLastError() != ERROR_ALREADY_EXISTS;
 		myLength=GetFileSize(myDiskFileHandle,NULL);
+		if (created)
+			DirectoryIndex::theDirectoryIndex().FileCreated(name);
 	}
 	else
 	{
@@ -243,9 +248,7 @@ void File::Write(std::string string)
 
 bool File::FileExists(std::string& filename)
 {
-	uint32 attributes = GetFileAttributes(filename.c_str());
-	
-	return attributes == -1 ?  false: true;
+	return DirectoryIndex::theDirectoryIndex().FileExists(filename);
 
 }
 
@@ -6,6 +6,7 @@
 #include "App.h"
 #include "CreaturesArchive.h"
 #include "Display/ErrorMessageHandler.h"
+#include "DirectoryIndex.h"
 #include <algorithm>
 
 #ifndef _WIN32
@@ -154,12 +155,8 @@ bool FilePath::GetWorldDirectoryVersionOfTheFile(std::string& path, bool forcecr
 		std::string tempPath = path;
 		path+= myName;
 
-#ifdef _WIN32
-		if(GetFileAttributes(path.data()) != -1)
+		if(DirectoryIndex::theDirectoryIndex().FileExists(path))
 			return true;
-#else
-		ASSERT( false );	//TODO: non-win32 version
-#endif
 
 	
 		// now check for C16 version as the call would have
@@ -177,11 +174,7 @@ bool FilePath::GetWorldDirectoryVersionOfTheFile(std::string& path, bool forcecr
 
 			tempName+= "C16";
 			tempPath+= tempName;
-#ifdef _WIN32
-			if(GetFileAttributes(tempPath.data()) != -1)
-#else
-			if(FileExists(tempPath.data()))
-#endif	
+			if(DirectoryIndex::theDirectoryIndex().FileExists(tempPath))
 			{
 				path = tempPath;
 				return true;
@@ -25,6 +25,7 @@ public:
 	std::string GetFullPath() const;
 
 	std::string GetFileName() const;
+	int GetDirectory() const { return myDirectory; }
 
 	bool empty() const {return myName.empty();}
 	void SetExtension( std::string extension );
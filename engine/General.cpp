@@ -10,6 +10,7 @@
 #include "../common/Catalogue.h"
 #include "World.h"
 #include "md5.h"
+#include "DirectoryIndex.h"
 
 #ifdef _WIN32
 #include "rpcdce.h"
@@ -72,11 +73,7 @@ char* BuildFsp(DWORD fsp,char const* ext, int SubDir /* =-1 */,
 			strcat(SFPath,"over_");
 
 		strcat(SFPath,ourlocalTemplate);
-#ifdef _WIN32
-		if(GetFileAttributes(SFPath) != -1)
-#else
-		if(FileExists(SFPath))
-#endif	
+		if(DirectoryIndex::theDirectoryIndex().FileExists(SFPath))
 			return SFPath;
 		}
 
@@ -154,16 +151,10 @@ DWORD ValidFsp(int Part,			// part number
 bool FindFile(std::string& filename,
 			   bool hardDriveOnly)	
 {
-#ifdef _WIN32
-	uint32 attributes = GetFileAttributes(filename.data());
-	if (attributes == -1)
+	if (!DirectoryIndex::theDirectoryIndex().FileExists(filename))
 	{
 		return false;
 	}
-#else
-	ASSERT( false );	// TODO - non win32 version
-
-#endif
 
 
 
@@ -32,6 +32,7 @@ CREATURES_IMPLEMENT_SERIAL(MetaRoom)
 //
 Map::Map(void) 
 {
+	mySparseCAUpdate = true;
 	Initialise();
 }
 
@@ -83,8 +84,10 @@ void Map::Initialise(void)
 	{
 		myRoomCollection[i] = NULL;
 		myAlreadyProcessedList[i] = 0;
+		myCAUpdateMarks[i] = 0;
 	}
 	myAlreadyProcessedTruthValue = 0;
+	myCAUpdateStamp = 0;
 	myMetaRoomCount = 0;
 	myMetaRoomMaxID = -1;
 	myMetaRoomID = -1;
@@ -5684,6 +5687,9 @@ void Map::CalculateRoomPermiabilityAndDoorage(Room* room)
 		}
 	}
 	room->permiability = permiability;
+
+	// Doorage affects diffusion so let the CA settle again
+	WakeCA(room);
 }
 
 
@@ -5842,6 +5848,26 @@ void Map::CalculateNeighbourInformationForRoom(Room* room)
 
 	room->leftFloorRoomID = roomIDLeft;
 	room->rightFloorRoomID = roomIDRight;
+	CalculateFloorDoorsForRoom(room);
+}
+
+
+// ---------------------------------------------------------------------------
+// Function:	CalculateFloorDoorsForRoom
+// Description:	Finds the doors to a room's left and right floor neighbours,
+//					so that CA navigation can read their permiability
+//					without searching the room's doors
+// Arguments:	room - room to perform calculation on (in)
+// Returns:		None
+// ---------------------------------------------------------------------------
+void Map::CalculateFloorDoorsForRoom(Room* room)
+{
+	if (room->leftFloorRoomID == -1 ||
+		!GetDoorBetweenRooms(room->roomID, room->leftFloorRoomID, room->leftFloorDoor))
+		room->leftFloorDoor = NULL;
+	if (room->rightFloorRoomID == -1 ||
+		!GetDoorBetweenRooms(room->roomID, room->rightFloorRoomID, room->rightFloorDoor))
+		room->rightFloorDoor = NULL;
 }
 
 
@@ -5970,6 +5996,8 @@ bool Map::AddRoom
 		room->caValues[i] = 0;
 		room->caOldValues[i] = 0;
 		room->caOlderValues[i] = 0;
+		room->caSettled[i] = false;
+		room->caSettledInput[i] = 0;
 	}
 	room->caTempValue = 0;
 	room->caTotalDoorage = 0;
@@ -7737,6 +7765,8 @@ bool Room::Read(CreaturesArchive &ar)
 			if( theApp.GetWorld().GetMap().IsCANavigable( i ) ) caValues[i] = 0.0f;
 			ar >> caOldValues[i];
 			ar >> caOlderValues[i];
+			caSettled[i] = false;
+			caSettledInput[i] = 0.0f;
 		}
 
 		ar >> caTempValue;
@@ -7909,6 +7939,13 @@ bool Map::Read(CreaturesArchive &ar)
 		}	
 		ar >> myLinkCollection;
 		ar >> myNavigableDoorCollection;
+
+		IntegerIterator integerIterator;
+		for (integerIterator = myRoomIDCollection.begin();
+			integerIterator != myRoomIDCollection.end(); ++integerIterator)
+		{
+			CalculateFloorDoorsForRoom(myRoomCollection[*integerIterator]);
+		}
 	}
 	else
 	{
@@ -21,6 +21,7 @@
 #include <set>
 #include <algorithm>
 #include <list>
+#include <vector>
 #include <string>
 #include <float.h>
 #include "../PersistentObject.h"
@@ -522,6 +523,10 @@ void Map::ShiftCreatureAlongFloor
 
 	void Map::UpdateCurrentCAProperty();
 
+	void Map::SetSparseCAUpdate(bool sparse);
+
+	bool Map::GetSparseCAUpdate() const {return mySparseCAUpdate;}
+
 	int Map::GetCAIndex(void);
 
 	bool Map::GetRoomIDWithHighestCA( int roomID, int caIndex, bool includeUpDown, int &roomIDHighest );
@@ -576,6 +581,38 @@ private:
 		);
 	}
 
+	// As above, but only for doors touching the rooms being updated by
+	// UpdateSparseCAProperty().  Settled rooms on the far side of the
+	// door lend their temp value but keep their own value.
+	template<typename D>
+	void UpdateSparseDoorCABetweenRooms(const D &doorOrLink) 
+	{
+		Room *room1 = myRoomCollection[doorOrLink.parent1];
+		Room *room2 = myRoomCollection[doorOrLink.parent2];
+		float unused1 = 0.0f, unused2 = 0.0f;
+
+		UpdateDoorCA(
+			room1->caTempValue,
+			myCARates[room1->type][myNextCAProperty],
+			doorOrLink.doorage1,
+
+			room2->caTempValue,
+			myCARates[room2->type][myNextCAProperty],
+			doorOrLink.doorage2,
+
+			myCAUpdateMarks[room1->roomID] == myCAUpdateStamp ?
+				room1->caValues[myNextCAProperty] : unused1,
+			myCAUpdateMarks[room2->roomID] == myCAUpdateStamp ?
+				room2->caValues[myNextCAProperty] : unused2
+		);
+	}
+
+	void UpdateSparseCAProperty();
+	void CalculateFloorDoorsForRoom(Room* room);
+	void WakeCA(Room* room, int caIndex);
+	void WakeCA(Room* room);
+	void WakeAllCA(int caIndex);
+
 	template<typename D>
 	void CalculateDoorDoorage( D &doorOrLink ) 
 	{
@@ -1004,6 +1041,15 @@ void Map::SnapFeetToFloor
 	int mySquareCountY;
 	CARates myCARates[ROOM_TYPE_COUNT][CA_PROPERTY_COUNT];
 	int myNextCAProperty;
+	// Sparse CA update - only rooms that haven't settled (and their
+	// neighbours) are diffused.  myCAUpdateMarks holds myCAUpdateStamp
+	// for rooms being updated this time, and myCAUpdateStamp+1 for
+	// settled rooms bordering them.
+	bool mySparseCAUpdate;
+	unsigned int myCAUpdateMarks[MAX_ROOMS];
+	unsigned int myCAUpdateStamp;
+	std::vector<Room*> myCAUpdateRooms;
+	std::vector<Room*> myCABorderRooms;
 	int myMetaRoomIndexBase;
 	int myRoomIndexBase;
 	unsigned int myAlreadyProcessedList[MAX_ROOMS];
@@ -1142,12 +1188,19 @@ public:
 	float caTempValue;
 	float caInput;
 	float caTotalDoorage;
+	// Not serialised - see Map::UpdateSparseCAProperty()
+	bool caSettled[CA_PROPERTY_COUNT];
+	float caSettledInput[CA_PROPERTY_COUNT];
 	float perimeterLength;
 	std::string track;
 	int leftFloorRoomID;
 	int rightFloorRoomID;
 	Door *leftNavigableDoor;
 	Door *rightNavigableDoor;
+	// Not serialised - the doors to leftFloorRoomID and rightFloorRoomID,
+	// kept by Map::CalculateFloorDoorsForRoom() for CA navigation
+	Door *leftFloorDoor;
+	Door *rightFloorDoor;
 	std::list<Link*> linkCollection;
 
 	virtual bool Write(CreaturesArchive &ar) const;
@@ -16,6 +16,12 @@
 const float caMultiplier = 10.0f;
 const int caDistance = 30;
 
+// A room is treated as settled by the sparse update once its CA value
+// moves by less than this fraction of its slowest rate in an update.
+// A value relaxing at rate r is then within about this much of where
+// it would end up.  Inputs changing by less than it don't wake a room.
+const float caSettledTolerance = 1.0e-5f;
+
 
 CREATURES_IMPLEMENT_SERIAL( Link );
 
@@ -36,6 +42,7 @@ bool Map::SetRoomType( int roomID, int type )
 		return false;
 
 	room->type = type;
+	WakeCA(room);
 
 	// Copy any navigable (by creatures) doors into navigable door collection
 	DoorIterator doorIterator;
@@ -115,6 +122,7 @@ bool Map::SetRoomProperty( int roomID, int caIndex, float value )
 		return false;
 
 	room->caValues[ caIndex ] = value;
+	WakeCA(room, caIndex);
 	return true;
 }
 
@@ -240,6 +248,7 @@ bool Map::SetCARates( int roomType, int caIndex, CARates const &rates )
 		caIndex >= 0 && caIndex < CA_PROPERTY_COUNT )
 	{
 		myCARates[roomType][caIndex] = rates;
+		WakeAllCA(caIndex);
 		return true;
 	}
 	return false;
@@ -278,6 +287,7 @@ bool Map::IncreaseCAProperty( int roomID, int caIndex, float value )
 		return false;
 
 	room->caValues[ caIndex ] = BoundIntoZeroOne( room->caValues[ caIndex ] + value );
+	WakeCA(room, caIndex);
 
 	return true;
 }
@@ -444,7 +454,11 @@ void LogCAValue( int id, float value )
 
 void Map::UpdateCurrentCAProperty()
 {
-	if( !IsCANavigable( myNextCAProperty ) )
+	if( mySparseCAUpdate && !IsCANavigable( myNextCAProperty ) )
+	{
+		UpdateSparseCAProperty();
+	}
+	else if( !IsCANavigable( myNextCAProperty ) )
 	{
 		int idCount = myRoomCount;
 		int linkCount = myLinkCollection.size();
@@ -512,79 +526,310 @@ void Map::UpdateCurrentCAProperty()
 	myNextCAProperty = (myNextCAProperty + 1) % CA_PROPERTY_COUNT;
 }
 
+// ---------------------------------------------------------------------
+// Method:		UpdateSparseCAProperty
+// Arguments:	None
+// Returns:		None
+// Description:	Does the same job as the loops in UpdateCurrentCAProperty
+//				for the current CA, but only for rooms which haven't
+//				settled plus their immediate neighbours.  A room settles
+//				once an update moves its value by less than
+//				caSettledTolerance times the smallest of its room type's
+//				gain, loss and diffusion rates for the CA, and is woken
+//				again by a change in its input, its value, its
+//				neighbours or its doors.
+// ---------------------------------------------------------------------
+void Map::UpdateSparseCAProperty()
+{
+	int ca = myNextCAProperty;
+	IntegerIterator integerIterator;
+	DoorIterator doorIterator;
+	LinkIterator linkIterator;
+	Room* room;
+	int i, roomCount;
+
+	myCAUpdateStamp += 2;
+	if (myCAUpdateStamp < 2)
+	{
+		for (i=0; i<MAX_ROOMS; ++i)
+			myCAUpdateMarks[i] = 0;
+		myCAUpdateStamp = 2;
+	}
+	unsigned int updateMark = myCAUpdateStamp;
+	unsigned int borderMark = myCAUpdateStamp + 1;
+
+	myCAUpdateRooms.clear();
+	myCABorderRooms.clear();
+
+	// Unsettled rooms, or settled ones whose input has moved
+	for (integerIterator = myRoomIDCollection.begin();
+		integerIterator != myRoomIDCollection.end(); ++integerIterator)
+	{
+		room = myRoomCollection[*integerIterator];
+		if (room->caSettled[ca])
+		{
+			float inputChange = room->caInput - room->caSettledInput[ca];
+			if (inputChange < caSettledTolerance && inputChange > -caSettledTolerance)
+				continue;
+			room->caSettled[ca] = false;
+		}
+		myCAUpdateMarks[room->roomID] = updateMark;
+		myCAUpdateRooms.push_back(room);
+	}
+
+	if (myCAUpdateRooms.empty())
+	{
+		for (integerIterator = myRoomIDCollection.begin();
+			integerIterator != myRoomIDCollection.end(); ++integerIterator)
+			myRoomCollection[*integerIterator]->caInput = 0;
+		return;
+	}
+
+	// Their neighbours get updated too, and the settled rooms beyond
+	// those are needed for their temp values
+	int activeCount = myCAUpdateRooms.size();
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		unsigned int mark = pass == 0 ? updateMark : borderMark;
+		roomCount = pass == 0 ? activeCount : myCAUpdateRooms.size();
+		for (i=0; i<roomCount; ++i)
+		{
+			room = myCAUpdateRooms[i];
+			for (doorIterator = room->doorCollection.begin();
+				doorIterator != room->doorCollection.end(); ++doorIterator)
+			{
+				Door* door = *doorIterator;
+				if (door->parentCount != 2)
+					continue;
+				int other = door->parent1 == room->roomID ? door->parent2 : door->parent1;
+				if (myCAUpdateMarks[other] == updateMark || myCAUpdateMarks[other] == borderMark)
+					continue;
+				myCAUpdateMarks[other] = mark;
+				if (pass == 0)
+					myCAUpdateRooms.push_back(myRoomCollection[other]);
+				else
+					myCABorderRooms.push_back(myRoomCollection[other]);
+			}
+			for (linkIterator = room->linkCollection.begin();
+				linkIterator != room->linkCollection.end(); ++linkIterator)
+			{
+				Link* link = *linkIterator;
+				int other = link->parent1 == room->roomID ? link->parent2 : link->parent1;
+				if (myCAUpdateMarks[other] == updateMark || myCAUpdateMarks[other] == borderMark)
+					continue;
+				myCAUpdateMarks[other] = mark;
+				if (pass == 0)
+					myCAUpdateRooms.push_back(myRoomCollection[other]);
+				else
+					myCABorderRooms.push_back(myRoomCollection[other]);
+			}
+		}
+	}
+
+	// The neighbours woken above are updated with whatever input they
+	// have this time, so only the rooms left out lose theirs
+	for (integerIterator = myRoomIDCollection.begin();
+		integerIterator != myRoomIDCollection.end(); ++integerIterator)
+	{
+		if (myCAUpdateMarks[*integerIterator] != updateMark)
+			myRoomCollection[*integerIterator]->caInput = 0;
+	}
+
+	// Room pass, as in UpdateCurrentCAProperty
+	roomCount = myCAUpdateRooms.size();
+	for (i=0; i<roomCount; ++i)
+	{
+		room = myCAUpdateRooms[i];
+		room->caOlderValues[ca] = room->caOldValues[ca];
+		room->caOldValues[ca] = room->caValues[ca];
+		UpdateRoomCA( myCARates[room->type][ca], room->caInput,
+			room->caValues[ca], room->caTempValue );
+		room->caSettledInput[ca] = room->caInput;
+		room->caInput = 0;
+	}
+	// Border rooms are settled, so their input is unchanged and their
+	// value stays put - only the temp value is wanted
+	for (i=0; i<myCABorderRooms.size(); ++i)
+	{
+		room = myCABorderRooms[i];
+		float value = room->caValues[ca];
+		UpdateRoomCA( myCARates[room->type][ca], room->caSettledInput[ca],
+			value, room->caTempValue );
+	}
+
+	// Door pass - each door or link once, from its first updated room
+	for (i=0; i<roomCount; ++i)
+	{
+		room = myCAUpdateRooms[i];
+		for (doorIterator = room->doorCollection.begin();
+			doorIterator != room->doorCollection.end(); ++doorIterator)
+		{
+			Door* door = *doorIterator;
+			if (door->parentCount != 2)
+				continue;
+			int other = door->parent1 == room->roomID ? door->parent2 : door->parent1;
+			if (myCAUpdateMarks[other] == updateMark && other < room->roomID)
+				continue;
+			UpdateSparseDoorCABetweenRooms(*door);
+		}
+		for (linkIterator = room->linkCollection.begin();
+			linkIterator != room->linkCollection.end(); ++linkIterator)
+		{
+			Link* link = *linkIterator;
+			int other = link->parent1 == room->roomID ? link->parent2 : link->parent1;
+			if (myCAUpdateMarks[other] == updateMark && other < room->roomID)
+				continue;
+			UpdateSparseDoorCABetweenRooms(*link);
+		}
+	}
+
+	for (i=0; i<roomCount; ++i)
+	{
+		room = myCAUpdateRooms[i];
+		room->caValues[ca] +=
+				room->caTempValue * (1.0f - room->caTotalDoorage );
+
+		const CARates& rates = myCARates[room->type][ca];
+		float slowest = 1.0f;
+		if (rates.GetGain() > 0.0f && rates.GetGain() < slowest)
+			slowest = rates.GetGain();
+		if (rates.GetLoss() > 0.0f && rates.GetLoss() < slowest)
+			slowest = rates.GetLoss();
+		if (rates.GetDiffusion() > 0.0f && rates.GetDiffusion() < slowest)
+			slowest = rates.GetDiffusion();
+		float epsilon = caSettledTolerance * slowest;
+
+		float change = room->caValues[ca] - room->caOldValues[ca];
+		if (change < epsilon && change > -epsilon)
+		{
+			room->caSettled[ca] = true;
+			room->caOldValues[ca] = room->caValues[ca];
+			room->caOlderValues[ca] = room->caValues[ca];
+		}
+		else
+			room->caSettled[ca] = false;
+	}
+}
+
+// ---------------------------------------------------------------------
+// Method:		SetSparseCAUpdate
+// Arguments:	sparse - true to only update rooms which haven't settled
+// Returns:		None
+// Description:	Chooses between the sparse and the full CA update.
+// ---------------------------------------------------------------------
+void Map::SetSparseCAUpdate(bool sparse)
+{
+	if (sparse && !mySparseCAUpdate)
+	{
+		for (int ca = 0; ca < CA_PROPERTY_COUNT; ++ca)
+			WakeAllCA(ca);
+	}
+	mySparseCAUpdate = sparse;
+}
+
+// Mark a room as needing its CA updated by the sparse update
+void Map::WakeCA(Room* room, int caIndex)
+{
+	room->caSettled[caIndex] = false;
+}
+
+void Map::WakeCA(Room* room)
+{
+	for (int ca = 0; ca < CA_PROPERTY_COUNT; ++ca)
+		room->caSettled[ca] = false;
+}
+
+void Map::WakeAllCA(int caIndex)
+{
+	IntegerIterator integerIterator;
+	for (integerIterator = myRoomIDCollection.begin();
+		integerIterator != myRoomIDCollection.end(); ++integerIterator)
+	{
+		myRoomCollection[*integerIterator]->caSettled[caIndex] = false;
+	}
+}
+
 int Map::GetCAIndex(void)
 {
 	return myNextCAProperty;
 }
 
+// The value GetRoomProperty would return for a room, for the CA
+// navigation queries which already know the room and index are valid
+static inline float GetNavigationCAValue(const Room* room, int caIndex, bool navigable)
+{
+	float value = room->caValues[ caIndex ];
+	if( navigable )
+	{
+		if( value < 0 ) value = 0;
+		else value = 1 - 1 / ( value + 1 );
+	}
+	return value;
+}
+
 bool Map::WhichDirectionToFollowCA(int currentRoomID, int caIndex, int &mapDirection, bool approachNotRetreat)
 {
 	Room* currentRoom;
 	if (!GetValidRoomPointer(currentRoomID, currentRoom))
 		return false;
+	if( caIndex < 0 || caIndex >= CA_PROPERTY_COUNT )
+		return false;
+
+	bool navigable = IsCANavigable( caIndex );
 
+	// Permiability of the doors to the floor neighbours (0 if none)
+	int leftPerm = currentRoom->leftFloorDoor ? currentRoom->leftFloorDoor->permiability : 0;
+	int rightPerm = currentRoom->rightFloorDoor ? currentRoom->rightFloorDoor->permiability : 0;
 
-	// See which is the highest CA neighbour:
-	IntegerCollection neighbours;
 
-	// Add LINK collection:
-	LinkIterator i;
-	for (i = myLinkCollection.begin(); i != myLinkCollection.end(); ++i)
+	// See which is the highest CA neighbour, looking at the links
+	// first and then the left and right neighbours:
+	int roomIDHighest = currentRoomID;
+	float bestValue = GetNavigationCAValue( currentRoom, caIndex, navigable );
+
+	ConstantLinkIterator i;
+	for (i = currentRoom->linkCollection.begin(); i != currentRoom->linkCollection.end(); ++i)
 	{
-		Link& l = **i;
+		const Link& l = **i;
 
-		if (l.parent1==currentRoomID || l.parent2==currentRoomID) 		
-		{	
-			if(l.parent1==currentRoom->leftFloorRoomID 
-				|| l.parent2==currentRoom->rightFloorRoomID)
-			{
-				int perm = 0;
-				GetDoorPermiability(l.parent1 , l.parent2, perm);
-				if(perm == 0)
-				{
-					// only add if has 0 permiability else will be added 
-					// as left or right neighbour
-					neighbours.push_back(
-						l.parent2==currentRoomID ? l.parent1 :l.parent2);
-				}
-			}
-			else
-			{
-				// meta link or up/down link
-				neighbours.push_back(
-					l.parent2==currentRoomID ? l.parent1 :l.parent2);
-			}
+		if(l.parent1==currentRoom->leftFloorRoomID 
+			|| l.parent2==currentRoom->rightFloorRoomID)
+		{
+			// only add if has 0 permiability else will be added 
+			// as left or right neighbour
+			int perm = l.parent1==currentRoom->leftFloorRoomID ? leftPerm : rightPerm;
+			if(perm != 0)
+				continue;
+		}
+		// (else meta link or up/down link)
+
+		Room* neighbour = myRoomCollection[ l.parent2==currentRoomID ? l.parent1 : l.parent2 ];
+		float value = GetNavigationCAValue( neighbour, caIndex, navigable );
+		if( approachNotRetreat ? value>bestValue : value<bestValue )
+		{
+			bestValue = value;
+			roomIDHighest = neighbour->roomID;
 		}
 	}
 
 	// Add left and right neighbours if permiable 
 	// (else not traverable or door shut and will already be included in links list)
-	int leftPerm = 0;
-	int rightPerm = 0;
-	GetDoorPermiability(currentRoom->roomID , currentRoom->leftFloorRoomID, leftPerm);
-	GetDoorPermiability(currentRoom->roomID , currentRoom->rightFloorRoomID, rightPerm);
-
 	if (currentRoom->leftFloorRoomID != -1 && leftPerm != 0) 
-		neighbours.push_back(currentRoom->leftFloorRoomID);
+	{
+		float value = GetNavigationCAValue( myRoomCollection[currentRoom->leftFloorRoomID], caIndex, navigable );
+		if( approachNotRetreat ? value>bestValue : value<bestValue )
+		{
+			bestValue = value;
+			roomIDHighest = currentRoom->leftFloorRoomID;
+		}
+	}
 	if (currentRoom->rightFloorRoomID != -1 && rightPerm != 0)
-		neighbours.push_back(currentRoom->rightFloorRoomID);
-
-
-
-	// Work out highest CA room:
-	int roomIDHighest = currentRoomID;
-	float bestValue;
-	GetProjectedRoomProperty( currentRoomID, caIndex, bestValue );
-	IntegerIterator itor;
-
-	for( itor = neighbours.begin(); itor != neighbours.end(); ++itor )
 	{
-		float value;
-		GetProjectedRoomProperty( *itor, caIndex, value );
+		float value = GetNavigationCAValue( myRoomCollection[currentRoom->rightFloorRoomID], caIndex, navigable );
 		if( approachNotRetreat ? value>bestValue : value<bestValue )
 		{
 			bestValue = value;
-			roomIDHighest = *itor;
+			roomIDHighest = currentRoom->rightFloorRoomID;
 		}
 	}
 
@@ -659,32 +904,40 @@ bool Map::GetRoomIDWithHighestCA( int roomID, int caIndex, bool includeUpDown, i
 
 	if (!GetValidRoomPointer(roomID, room))
 		return false;
+	if( caIndex < 0 || caIndex >= CA_PROPERTY_COUNT )
+		return false;
+
+	bool navigable = IsCANavigable( caIndex );
+	roomIDHighest = roomID;
+	float highestValue = GetNavigationCAValue( room, caIndex, navigable );
 
-	IntegerCollection neighbours;
 	if( includeUpDown )
 	{
-		GetNeighbours( roomID, DIRECTION_ALL, neighbours );
+		IntegerCollection const &neighbours = room->neighbourIDCollection;
+		IntegerCollection::const_iterator itor;
+		for( itor = neighbours.begin(); itor != neighbours.end(); ++itor )
+		{
+			float value = GetNavigationCAValue( myRoomCollection[*itor], caIndex, navigable );
+			if( value > highestValue )
+			{
+				highestValue = value;
+				roomIDHighest = *itor;
+			}
+		}
 	}
 	else
 	{
-		if (room->leftFloorRoomID != -1) 
-			neighbours.push_back(room->leftFloorRoomID);
-		if (room->rightFloorRoomID != -1)
-			neighbours.push_back(room->rightFloorRoomID);
-	}
-	roomIDHighest = roomID;
-	float highestValue;
-	GetRoomProperty( roomID, caIndex, highestValue );
-
-	IntegerIterator itor;
-	for( itor = neighbours.begin(); itor != neighbours.end(); ++itor )
-	{
-		float value;
-		GetRoomProperty( *itor, caIndex, value );
-		if( value > highestValue )
+		int floorNeighbours[2] = { room->leftFloorRoomID, room->rightFloorRoomID };
+		for( int n = 0; n < 2; ++n )
 		{
-			highestValue = value;
-			roomIDHighest = *itor;
+			if( floorNeighbours[n] == -1 )
+				continue;
+			float value = GetNavigationCAValue( myRoomCollection[floorNeighbours[n]], caIndex, navigable );
+			if( value > highestValue )
+			{
+				highestValue = value;
+				roomIDHighest = floorNeighbours[n];
+			}
 		}
 	}
 	return true;
@@ -692,35 +945,44 @@ bool Map::GetRoomIDWithHighestCA( int roomID, int caIndex, bool includeUpDown, i
 
 bool Map::GetRoomIDWithLowestCA( int roomID, int caIndex, bool includeUpDown, int &roomIDLowest )
 {
-	Room *room;
+	Room* room;
+
 	if (!GetValidRoomPointer(roomID, room))
 		return false;
+	if( caIndex < 0 || caIndex >= CA_PROPERTY_COUNT )
+		return false;
+
+	bool navigable = IsCANavigable( caIndex );
+	roomIDLowest = roomID;
+	float lowestValue = GetNavigationCAValue( room, caIndex, navigable );
 
-	IntegerCollection neighbours;
 	if( includeUpDown )
 	{
-		GetNeighbours( roomID, DIRECTION_ALL, neighbours );
+		IntegerCollection const &neighbours = room->neighbourIDCollection;
+		IntegerCollection::const_iterator itor;
+		for( itor = neighbours.begin(); itor != neighbours.end(); ++itor )
+		{
+			float value = GetNavigationCAValue( myRoomCollection[*itor], caIndex, navigable );
+			if( value < lowestValue )
+			{
+				lowestValue = value;
+				roomIDLowest = *itor;
+			}
+		}
 	}
 	else
 	{
-		if (room->leftFloorRoomID != -1)
-			neighbours.push_back(room->leftFloorRoomID);
-		if (room->rightFloorRoomID != -1)
-			neighbours.push_back(room->rightFloorRoomID);
-	}
-	roomIDLowest = roomID;
-	float lowestValue;
-	GetRoomProperty( roomID, caIndex, lowestValue );
-
-	IntegerIterator itor;
-	for( itor = neighbours.begin(); itor != neighbours.end(); ++itor )
-	{
-		float value;
-		GetRoomProperty( *itor, caIndex, value );
-		if( value < lowestValue )
+		int floorNeighbours[2] = { room->leftFloorRoomID, room->rightFloorRoomID };
+		for( int n = 0; n < 2; ++n )
 		{
-			lowestValue = value;
-			roomIDLowest = *itor;
+			if( floorNeighbours[n] == -1 )
+				continue;
+			float value = GetNavigationCAValue( myRoomCollection[floorNeighbours[n]], caIndex, navigable );
+			if( value < lowestValue )
+			{
+				lowestValue = value;
+				roomIDLowest = floorNeighbours[n];
+			}
 		}
 	}
 	return true;
@@ -764,6 +1026,7 @@ void Map::AlterCAEmission( Room *room, int caIndex, float difference,
 
 	// Terminate the recursion
 	room->caValues[ caIndex ] += difference;
+	WakeCA(room, caIndex);
 
 	if( !distance-- )
 		return;
@@ -814,6 +1077,7 @@ void Map::AlterCAEmission( Room *room, int caIndex, float difference,
 			leftRoom = otherRoom;
 
 			leftRoom->caValues[ caIndex ] += leftDifference;
+			WakeCA(leftRoom, caIndex);
 
 			int count = leftRoom->linkCollection.size();
 			LinkIterator linkIterator = leftRoom->linkCollection.begin();
@@ -864,6 +1128,7 @@ void Map::AlterCAEmission( Room *room, int caIndex, float difference,
 			rightRoom = otherRoom;
 
 			rightRoom->caValues[ caIndex ] += rightDifference;
+			WakeCA(rightRoom, caIndex);
 
 
 			int count = rightRoom->linkCollection.size();
@@ -41,6 +41,11 @@ namespace RandQD1 {
 		//return ( (( idum = 1664525 * idum + 1013904223 )>>16) )  & (RandQD1::MAX_RAND);
 		return ( (( idum = 1664525 * idum + 1013904223 )>>17) );
 	}
+	// Same generator run on a caller-owned state, for code that has to
+	// be independent of the global sequence (e.g. on worker threads)
+	inline unsigned int rand( unsigned int& state ) {
+		return ( (( state = 1664525 * state + 1013904223 )>>17) );
+	}
 	bool PlatformTest ();
 }
 
@@ -62,6 +67,10 @@ inline int Rnd(int max)
 inline float RndFloat() {
 	return ((float)Rnd(65536)) / 65535.0f;
 }
+// as above, but drawn from the given generator state
+inline float RndFloat(unsigned int& state) {
+	return ((float)( ( ((int)RandQD1::rand(state)) * 65537 ) >> RandQD1::MAX_RAND_SHIFT )) / 65535.0f;
+}
 
 
 #endif
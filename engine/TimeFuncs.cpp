@@ -54,14 +54,18 @@ int GetTimeStamp()
 	return 0;
 }
 
+// in nanoseconds, from a clock that never goes backwards
 int64 GetHighPerformanceTimeStamp()
 {
-	return 0;
+	struct timespec now;
+	if( clock_gettime( CLOCK_MONOTONIC, &now ) != 0 )
+		return 0;
+	return (int64)now.tv_sec * 1000000000 + now.tv_nsec;
 }
 
 int64 GetHighPerformanceTimeStampFrequency()
 {
-	return 0;
+	return 1000000000;
 }
 
 // win32 replacement function
@@ -0,0 +1,290 @@
+// -------------------------------------------------------------------------
+// Filename:    WorkerPool.cpp
+// Class:       WorkerPool
+// Purpose:     Runs batches of independent work across several threads
+// Description:	See WorkerPool.h
+//
+// Usage:
+//
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "WorkerPool.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+
+WorkerPool::WorkerPool()
+{
+	myThreadCount = 0;
+	myStopping = false;
+	myFunction = NULL;
+	myItems = NULL;
+	myItemCount = 0;
+	myNextItem = 0;
+	myItemFailed = false;
+	myThreads = NULL;
+#ifdef _WIN32
+	myStartSemaphore = NULL;
+	myDoneSemaphore = NULL;
+#endif
+}
+
+
+
+bool WorkerPool::Start( int threadCount )
+{
+	Stop();
+
+	if( threadCount <= 0 )
+		return true;
+
+	myStopping = false;
+
+#ifdef _WIN32
+	InitializeCriticalSection( &myLock );
+	myStartSemaphore = CreateSemaphore( NULL, 0, threadCount, NULL );
+	myDoneSemaphore = CreateSemaphore( NULL, 0, threadCount, NULL );
+	if( !myStartSemaphore || !myDoneSemaphore )
+	{
+		if( myStartSemaphore )
+			CloseHandle( myStartSemaphore );
+		if( myDoneSemaphore )
+			CloseHandle( myDoneSemaphore );
+		myStartSemaphore = NULL;
+		myDoneSemaphore = NULL;
+		DeleteCriticalSection( &myLock );
+		return false;
+	}
+
+	myThreads = new HANDLE[ threadCount ];
+	for( int i=0; i<threadCount; ++i )
+	{
+		DWORD id;
+		myThreads[i] = CreateThread( NULL, 0, ThreadStart, this, 0, &id );
+		if( !myThreads[i] )
+			break;
+		++myThreadCount;
+	}
+#else
+	pthread_mutex_init( &myLock, NULL );
+	sem_init( &myStartSemaphore, 0, 0 );
+	sem_init( &myDoneSemaphore, 0, 0 );
+
+	myThreads = new pthread_t[ threadCount ];
+	for( int i=0; i<threadCount; ++i )
+	{
+		if( pthread_create( &myThreads[i], NULL, ThreadStart, this ) != 0 )
+			break;
+		++myThreadCount;
+	}
+#endif
+
+	// Run with however many threads we did manage to create
+	if( myThreadCount == 0 )
+	{
+		Stop();
+		return false;
+	}
+	return true;
+}
+
+
+
+void WorkerPool::Stop()
+{
+	if( !myThreads )
+		return;
+
+	myStopping = true;
+
+#ifdef _WIN32
+	if( myThreadCount > 0 )
+	{
+		ReleaseSemaphore( myStartSemaphore, myThreadCount, NULL );
+		WaitForMultipleObjects( myThreadCount, myThreads, TRUE, INFINITE );
+	}
+	for( int i=0; i<myThreadCount; ++i )
+		CloseHandle( myThreads[i] );
+	CloseHandle( myStartSemaphore );
+	CloseHandle( myDoneSemaphore );
+	myStartSemaphore = NULL;
+	myDoneSemaphore = NULL;
+	DeleteCriticalSection( &myLock );
+#else
+	int i;
+	for( i=0; i<myThreadCount; ++i )
+		sem_post( &myStartSemaphore );
+	for( i=0; i<myThreadCount; ++i )
+		pthread_join( myThreads[i], NULL );
+	sem_destroy( &myStartSemaphore );
+	sem_destroy( &myDoneSemaphore );
+	pthread_mutex_destroy( &myLock );
+#endif
+
+	delete [] myThreads;
+	myThreads = NULL;
+	myThreadCount = 0;
+	myStopping = false;
+}
+
+
+
+bool WorkerPool::Run( WorkerFunction function, void** items, int itemCount )
+{
+	if( itemCount <= 0 )
+		return true;
+
+	// No threads (and so no lock) - just do it all here
+	if( myThreadCount == 0 )
+	{
+		bool failed = false;
+		for( int item=0; item<itemCount; ++item )
+		{
+			try
+			{
+				function( items[item] );
+			}
+			catch( ... )
+			{
+				failed = true;
+			}
+		}
+		return !failed;
+	}
+
+	myFunction = function;
+	myItems = items;
+	myItemCount = itemCount;
+	myNextItem = 0;
+	myItemFailed = false;
+
+	// Don't bother waking the threads for a single item
+	int helpers = myThreadCount < itemCount-1 ? myThreadCount : itemCount-1;
+
+#ifdef _WIN32
+	if( helpers > 0 )
+		ReleaseSemaphore( myStartSemaphore, helpers, NULL );
+	WorkThroughItems();
+	for( int i=0; i<helpers; ++i )
+		WaitForSingleObject( myDoneSemaphore, INFINITE );
+#else
+	int i;
+	for( i=0; i<helpers; ++i )
+		sem_post( &myStartSemaphore );
+	WorkThroughItems();
+	for( i=0; i<helpers; ++i )
+	{
+		while( sem_wait( &myDoneSemaphore ) != 0 )
+			;	// interrupted by a signal
+	}
+#endif
+
+	myFunction = NULL;
+	myItems = NULL;
+	myItemCount = 0;
+	return !myItemFailed;
+}
+
+
+
+int WorkerPool::GetProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+
+
+// static entry point for the threads - just passes control on
+// to the non-static ThreadMain().
+#ifdef _WIN32
+DWORD WINAPI WorkerPool::ThreadStart( LPVOID pool )
+{
+	((WorkerPool*)pool)->ThreadMain();
+	return 0;
+}
+#else
+void* WorkerPool::ThreadStart( void* pool )
+{
+	((WorkerPool*)pool)->ThreadMain();
+	return NULL;
+}
+#endif
+
+
+
+void WorkerPool::ThreadMain()
+{
+	while( true )
+	{
+#ifdef _WIN32
+		WaitForSingleObject( myStartSemaphore, INFINITE );
+#else
+		if( sem_wait( &myStartSemaphore ) != 0 )
+			continue;	// interrupted by a signal
+#endif
+		if( myStopping )
+			return;
+
+		WorkThroughItems();
+
+#ifdef _WIN32
+		ReleaseSemaphore( myDoneSemaphore, 1, NULL );
+#else
+		sem_post( &myDoneSemaphore );
+#endif
+	}
+}
+
+
+
+void WorkerPool::WorkThroughItems()
+{
+	int item;
+	while( (item = TakeNextItem()) >= 0 )
+	{
+		try
+		{
+			myFunction( myItems[item] );
+		}
+		catch( ... )
+		{
+			// Let Run() report it on the calling thread
+			myItemFailed = true;
+		}
+	}
+}
+
+
+
+int WorkerPool::TakeNextItem()
+{
+	int item = -1;
+#ifdef _WIN32
+	EnterCriticalSection( &myLock );
+#else
+	pthread_mutex_lock( &myLock );
+#endif
+	if( myNextItem < myItemCount )
+		item = myNextItem++;
+#ifdef _WIN32
+	LeaveCriticalSection( &myLock );
+#else
+	pthread_mutex_unlock( &myLock );
+#endif
+	return item;
+}
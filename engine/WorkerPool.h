@@ -0,0 +1,107 @@
+// -------------------------------------------------------------------------
+// Filename:    WorkerPool.h
+// Class:       WorkerPool
+// Purpose:     Runs batches of independent work across several threads
+// Description:	A fixed set of worker threads sleeps until Run() is called
+//				with a list of items.  The items are handed out one at a
+//				time to whichever thread (including the caller) is free,
+//				and Run() returns once every item has been processed.
+//
+//				The work function must only touch state belonging to
+//				the item it is given - nothing in the world is locked.
+//
+// Usage:		pool.Start( WorkerPool::GetProcessorCount()-1 );
+//				pool.Run( MyFunction, items, itemCount );
+//
+// History:
+// -------------------------------------------------------------------------
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+typedef void (*WorkerFunction)( void* item );
+
+class WorkerPool
+{
+public:
+	WorkerPool();
+	~WorkerPool() { Stop(); }
+
+	// ---------------------------------------------------------------------
+	// Method:      Start
+	// Arguments:   threadCount - number of extra threads to create
+	// Returns:     true for Success
+	// Description:	Creates the worker threads.  With no threads Run()
+	//				simply does all the work on the calling thread.
+	// ---------------------------------------------------------------------
+	bool Start( int threadCount );
+
+	// ---------------------------------------------------------------------
+	// Method:      Stop
+	// Arguments:   None
+	// Returns:     None
+	// Description:	Waits for the worker threads to finish and cleans up.
+	// ---------------------------------------------------------------------
+	void Stop();
+
+	// ---------------------------------------------------------------------
+	// Method:      Run
+	// Arguments:   function - called once for each item
+	//				items - array of items to process
+	//				itemCount - number of items
+	// Returns:     false if any call threw an exception
+	// Description:	Processes all the items and waits for them to finish.
+	//				Must only be called from one thread at a time.
+	// ---------------------------------------------------------------------
+	bool Run( WorkerFunction function, void** items, int itemCount );
+
+	int GetThreadCount() const { return myThreadCount; }
+
+	static int GetProcessorCount();
+
+private:
+#ifdef _WIN32
+	static DWORD WINAPI ThreadStart( LPVOID pool );
+#else
+	static void* ThreadStart( void* pool );
+#endif
+	void ThreadMain();
+	void WorkThroughItems();
+	int TakeNextItem();
+
+	int myThreadCount;
+	bool myStopping;
+
+	// the batch currently being processed
+	WorkerFunction myFunction;
+	void** myItems;
+	int myItemCount;
+	int myNextItem;
+	bool myItemFailed;
+
+#ifdef _WIN32
+	HANDLE* myThreads;
+	HANDLE myStartSemaphore;	// released once per thread for each batch
+	HANDLE myDoneSemaphore;		// released by each thread when it runs dry
+	CRITICAL_SECTION myLock;
+#else
+	pthread_t* myThreads;
+	sem_t myStartSemaphore;
+	sem_t myDoneSemaphore;
+	pthread_mutex_t myLock;
+#endif
+};
+
+#endif // WORKERPOOL_H
@@ -23,6 +23,7 @@
 #include "CosInstaller.h"
 #include "Display/SharedGallery.h"
 #include "Display/ErrorMessageHandler.h"
+#include "DirectoryIndex.h"
 
 #include "Sound/MusicManager.h"
 
@@ -32,10 +33,29 @@
 
 
 #include <fstream>
+#include <sstream>
+
 #include <algorithm>
 
 AgentHandle thePointer;
 
+// Logs how quickly a world was read or written
+static void LogArchiveThroughput( const char* what, uint32 bytes, int64 ticks )
+{
+	int64 frequency = GetHighPerformanceTimeStampFrequency();
+	if( frequency <= 0 || ticks <= 0 )
+	{
+		theFlightRecorder.Log( 16, "%s: %u KB", what, bytes / 1024 );
+		return;
+	}
+
+	double seconds = (double)ticks / (double)frequency;
+	theFlightRecorder.Log( 16, "%s: %u KB in %d ms (%.1f MB/s)", what,
+		bytes / 1024, (int)(seconds * 1000.0),
+		(double)bytes / (1024.0 * 1024.0) / seconds );
+}
+
+
 TintManager& World::GetTintManager( int index )
 {
 	if (index > myTints.size()-1)
@@ -55,6 +75,7 @@ World::World()
 {
 	initialisedSanityCheck = false;
 	myCurrentlyLoadingWorld = false;
+	ResetTaskTimes();
 }
 
 void World::Init()
@@ -101,6 +122,7 @@ void World::Init()
 	GetGameVar("engine_full_screen_toggle").SetInteger(1);
 	GetGameVar("engine_dumb_creatures").SetInteger(0);
 	GetGameVar("engine_zlib_compression").SetInteger(6);
+	GetGameVar("engine_background_save").SetInteger(0);
 	
 	// twin and triplet probabilities
 	{
@@ -345,13 +367,24 @@ bool World::Read(CreaturesArchive &ar)
 void World::TaskSwitcher()
 {
 	ASSERT(initialisedSanityCheck);
+
+	int64 stamp = GetHighPerformanceTimeStamp();
+	int64 lastStamp = stamp;
 	   
 	// First, do all things that MUST happen every tick.
 	theAgentManager.UpdateAllAgents();
+
+	stamp = GetHighPerformanceTimeStamp();
+	myTaskTimes[taskAgents] += stamp - lastStamp;
+	lastStamp = stamp;
 			
 	// Handle messages 
 	TaskHandleMessages();
 
+	stamp = GetHighPerformanceTimeStamp();
+	myTaskTimes[taskMessages] += stamp - lastStamp;
+	lastStamp = stamp;
+
 	// to do look at this for timing music issues
 	// use system tick, as music carries on even when game paused
 	if (theApp.GetSystemTick() % 20 == 19)							
@@ -362,8 +395,18 @@ void World::TaskSwitcher()
 	{
 		myWorldTick++;
 		if ((myWorldTick % 2) == 0)
+		{
+			stamp = GetHighPerformanceTimeStamp();
+			myTaskTimes[taskSound] += stamp - lastStamp;
+			lastStamp = stamp;
+
 			myMap.UpdateCurrentCAProperty();
 
+			stamp = GetHighPerformanceTimeStamp();
+			myTaskTimes[taskCA] += stamp - lastStamp;
+			lastStamp = stamp;
+		}
+
 		 // Update any active sounds
 		if( theSoundManager )
 			theSoundManager -> Update();
@@ -385,6 +428,14 @@ void World::TaskSwitcher()
 		theMusicManager->Update();
 	}
 
+	myTaskTimes[taskSound] += GetHighPerformanceTimeStamp() - lastStamp;
+}
+
+
+void World::ResetTaskTimes()
+{
+	for (int i = 0; i < taskTimeCount; ++i)
+		myTaskTimes[i] = 0;
 }
 
 // Handle any pending messages & stimuli
@@ -1146,6 +1197,7 @@ bool World::Load( std::string const &worldName, bool loadBackup )
 
 	myNeedToBackUp = false;
 	myName = worldName;
+	DirectoryIndex::theDirectoryIndex().Build();
 
 	bool worldHasLoaded = false;
 
@@ -1203,10 +1255,13 @@ bool World::Load( std::string const &worldName, bool loadBackup )
 	{
 		try
 		{	
+			int64 start = GetHighPerformanceTimeStamp();
 			std::fstream file( fullPath.c_str(), std::ios::in | std::ios::binary);
 			CreaturesArchive archive( file, CreaturesArchive::Load );
 
 			Read( archive );
+			LogArchiveThroughput( "World load", archive.GetDataSize(),
+				GetHighPerformanceTimeStamp() - start );
 		
 			// We've loaded in a good archive, so signal to back it up on the next save
 			if (!loadBackup)
@@ -1431,6 +1486,9 @@ bool World::Save()
 		return false;
 	}
 
+	// only one save at a time
+	myArchiveWriter.Wait();
+
 	// get the approximate shutdown time
 	GetLocalTime(&myGameEndTime);
 
@@ -1443,6 +1501,9 @@ bool World::Save()
 	std::string backPath = path.GetFullPath() + "\\" + DefaultWorldName() + ".bak";
 	std::string tempPath = path.GetFullPath() + "\\" + DefaultWorldName() + ".tmp";
 
+	if( GetGameVar("engine_background_save").GetInteger() != 0 )
+		return SaveInBackground( fullPath, tempPath, backPath );
+
 	// myNeedToBackUp is true if we have successfully loaded an archive, so we
 	// know we have a safe version to backup.  This way, the .bak file is 
 	// guaranteed to always be a file which can be loaded in.
@@ -1453,11 +1514,18 @@ bool World::Save()
 		myNeedToBackUp = false;
 	}
 
+	int64 start = GetHighPerformanceTimeStamp();
+	uint32 bytes = 0;
+	bool written = false;
 	try
 	{
 		std::fstream file( tempPath.c_str(), std::ios::out | std::ios::binary);
-		CreaturesArchive archive( file, CreaturesArchive::Save );
+		CreaturesArchive archive( file, CreaturesArchive::SaveBlocks );
 		Write( archive );
+		archive.Close();
+		bytes = archive.GetDataSize();
+		file.close();
+		written = !file.fail();
 	}
 	catch( BasicException &e )
 	{
@@ -1470,11 +1538,92 @@ bool World::Save()
 		return false;
 	}
 
+	// Don't replace the last good save with a short one
+	if( !written )
+	{
+		DeleteFile( tempPath.c_str() );
+		ErrorMessageHandler::Show("archive_error", 3, "World::Save");
+		return false;
+	}
+
+	LogArchiveThroughput( "World save", bytes,
+		GetHighPerformanceTimeStamp() - start );
+
 	DeleteFile( fullPath.c_str() );
 	MoveFile( tempPath.c_str(), fullPath.c_str() );
 	return true;
 }
 
+// ---------------------------------------------------------------------
+// Method:		SaveInBackground
+// Arguments:	fullPath, tempPath, backPath - as for Save()
+// Returns:		true if the world was captured successfully
+// Description:	Serialises the world into memory without compressing it,
+//				and hands it to myArchiveWriter to do the rest.
+// ---------------------------------------------------------------------
+bool World::SaveInBackground( const std::string& fullPath,
+	const std::string& tempPath, const std::string& backPath )
+{
+	int64 start = GetHighPerformanceTimeStamp();
+	std::string data;
+	try
+	{
+		std::stringstream stream( std::ios::in | std::ios::out | std::ios::binary );
+		{
+			CreaturesArchive archive( stream, CreaturesArchive::SaveUncompressed );
+			Write( archive );
+		}
+		data = stream.str();
+	}
+	catch( BasicException &e )
+	{
+		ErrorMessageHandler::Show(e, "World::Save");
+		return false;
+	}
+	catch(...)
+	{
+		ErrorMessageHandler::Show("archive_error", 3, "World::Save");
+		return false;
+	}
+
+	LogArchiveThroughput( "World snapshot", data.size(),
+		GetHighPerformanceTimeStamp() - start );
+
+	// see Save() for why we only back up sometimes
+	myArchiveWriter.Start( data, fullPath, tempPath,
+		myNeedToBackUp ? backPath : std::string(),
+		theApp.GetZLibCompressionLevel() );
+	myNeedToBackUp = false;
+
+	GetGameVar("engine_save_in_progress").SetInteger(1);
+	return true;
+}
+
+void World::UpdateBackgroundSave()
+{
+	bool succeeded;
+	if( !myArchiveWriter.Poll( succeeded ) )
+		return;
+
+	GetGameVar("engine_save_in_progress").SetInteger(0);
+	GetGameVar("engine_last_save_succeeded").SetInteger(succeeded ? 1 : 0);
+
+	if( succeeded )
+		LogArchiveThroughput( "World background save",
+			myArchiveWriter.GetDataSize(), myArchiveWriter.GetWriteTime() );
+
+	if( !succeeded )
+	{
+		if( myArchiveWriter.GetErrorText().empty() )
+			ErrorMessageHandler::Show("archive_error", 3, "World::Save");
+		else
+		{
+			BasicException e( myArchiveWriter.GetErrorText().c_str() );
+			ErrorMessageHandler::Show(e, "World::Save");
+		}
+	}
+}
+
 bool World::CopyWorldDirectory( std::string const &source, std::string const &destination )
 {
 	return CopyDirectory( FilePath( source, WORLDS_DIR ).GetFullPath(),
@@ -1658,6 +1807,9 @@ void World::MarkFileCreated(const FilePath& fileJustCreated)
 {
 	bool wasOnDeleteList = false;
 
+	// it was written behind the directory index's back
+	DirectoryIndex::theDirectoryIndex().Refresh(fileJustCreated.GetDirectory());
+
 	// Make sure it is not on the delayed delete list
 	if (DeleteFromFilePathList(myFilesForAtticDelayed, fileJustCreated))
 		wasOnDeleteList = true;
@@ -1713,7 +1865,8 @@ void World::MoveFilesToAttic()
 
 		// Move file to the attic directory
 		DeleteFile(atticFilename.c_str());
-		MoveFile(fullFilename.c_str(), atticFilename.c_str());
+		if (MoveFile(fullFilename.c_str(), atticFilename.c_str()))
+			DirectoryIndex::theDirectoryIndex().FileMoved(fullFilename, atticFilename);
 		// If the move fails, don't worry about it
 		// (the worst that can happen is we have unused files about the place)
 	}
@@ -1754,7 +1907,8 @@ void World::MoveFilesToBasement()
 			std::string basementFilename = GetBasementPath() + tryingToClimbTheStairs[i].GetFileName();
 
 			DeleteFile(basementFilename.c_str());
-			MoveFile(fullFilename.c_str(), basementFilename.c_str());
+			if (MoveFile(fullFilename.c_str(), basementFilename.c_str()))
+				DirectoryIndex::theDirectoryIndex().FileMoved(fullFilename, basementFilename);
 			// If the move fails, don't worry about it
 			// (worse that can happen is we have unused files about)
 		}
@@ -1777,7 +1931,8 @@ void World::MoveFileToPorch(std::string creatureFile)
 	std::string porchFilename = GetPorchPath() + justFileName;
 
 	DeleteFile(porchFilename.c_str());
-	MoveFile(creatureFile.c_str(), porchFilename.c_str());
+	if (MoveFile(creatureFile.c_str(), porchFilename.c_str()))
+		DirectoryIndex::theDirectoryIndex().FileMoved(creatureFile, porchFilename);
 
 	myFilesInThePorch.push_back(justFileName);
 }
@@ -15,6 +15,7 @@
 #include "Creature/History/HistoryStore.h"
 
 #include "Display/TintManager.h"
+#include "ArchiveWriter.h"
 
 class Creature;
 
@@ -35,6 +36,20 @@ public:
 	void TaskMusic( bool forceUpdate = false );
 	void TaskHandleMessages();
 
+	// Time TaskSwitcher has spent on each of its jobs since the last
+	// ResetTaskTimes(), in GetHighPerformanceTimeStamp() units
+	enum TaskTime
+	{
+		taskAgents = 0,
+		taskMessages,
+		taskCA,
+		taskSound,			// music and sound effects
+		taskTimeCount
+	};
+	int64 GetTaskTime( int task ) const
+		{ return myTaskTimes[ task ]; }
+	void ResetTaskTimes();
+
 	Scriptorium& GetScriptorium()
 		{ return myScriptorium; }
 
@@ -203,10 +218,24 @@ public:
 	// Method:		Save
 	// Arguments:	None
 	// Returns:		true if successful
-	// Description:	Saves the current world. 
+	// Description:	Saves the current world.  If the game variable
+	//				engine_background_save is set, this only takes a copy
+	//				of the world in memory, and it is compressed and
+	//				written out on another thread.  The game variable
+	//				engine_save_in_progress is 1 until that has finished,
+	//				and engine_last_save_succeeded then says how it went.
 	// ---------------------------------------------------------------------
 	bool Save();
 
+	// ---------------------------------------------------------------------
+	// Method:		UpdateBackgroundSave
+	// Arguments:	None
+	// Returns:		None
+	// Description:	Called every tick to pick up the result of a
+	//				background save.
+	// ---------------------------------------------------------------------
+	void UpdateBackgroundSave();
+
 	// ---------------------------------------------------------------------
 	// Method:		Copy
 	// Arguments:	source - name of world to copy
@@ -247,6 +276,8 @@ protected:
 	std::string GetBasementPath();
 	std::string GetPorchPath();
 	static bool DeleteFromFilePathList(std::vector<FilePath>& list, const FilePath& item);
+	bool SaveInBackground( const std::string& fullPath,
+		const std::string& tempPath, const std::string& backPath );
 
 private:
     // Music timer to prevent replacement of CAOS invoked music
@@ -269,6 +300,8 @@ private:
 
 	bool myPausedWorldTick;
 
+	int64 myTaskTimes[ taskTimeCount ];
+
 	AgentHandle mySelectedCreature;
 	AgentHandle myBirthdayAgent;
 	AgentHandle myCountDownClock;
@@ -297,6 +330,9 @@ private:
 	HistoryStore myHistoryStore;
 
 	bool myCurrentlyLoadingWorld;
+
+	// compresses and writes out background saves
+	ArchiveWriter myArchiveWriter;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -708,6 +708,22 @@ SOURCE=.\Display\CreatureGallery.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Display\CreatureGalleryBuilder.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Display\CreatureGalleryBuilder.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\Display\DirtyTileMap.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Display\DirtyTileMap.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Display\DisplayEngine.cpp
 # End Source File
 # Begin Source File
@@ -736,6 +752,14 @@ SOURCE=.\Display\DrawableObjectHandler.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Display\DrawableObjectIndex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Display\DrawableObjectIndex.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Display\EntityImage.cpp
 # End Source File
 # Begin Source File
@@ -856,6 +880,14 @@ SOURCE=.\Display\Sprite.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Display\SpriteBlitter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\Display\SpriteBlitter.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Display\System.cpp
 # End Source File
 # Begin Source File
@@ -1216,6 +1248,14 @@ SOURCE=.\Caos\VelocityVariable.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\WorkerPool.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\WorkerPool.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\World.cpp
 
 !IF  "$(CFG)" == "engine - Win32 Release"
@@ -1489,6 +1529,14 @@ SOURCE=..\common\SimpleLexer.h
 # PROP Default_Filter ""
 # Begin Source File
 
+SOURCE=.\ArchiveWriter.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\ArchiveWriter.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\CreaturesArchive.cpp
 # End Source File
 # Begin Source File
@@ -1497,6 +1545,14 @@ SOURCE=.\CreaturesArchive.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\DirectoryIndex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\DirectoryIndex.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\File.cpp
 # End Source File
 # Begin Source File
@@ -2,7 +2,6 @@
 
 # some files in this dir are win32 only:
 #
-# CPUID.cpp
 # File.cpp (use unix/File.cpp instead)
 # ProgressDialog.cpp (TODO: find alternative)
 # ServerThread.cpp (TODO: find alternative)
@@ -23,11 +22,14 @@ include engine/Sound/module.mk
 
 SRC += engine/AgentManager.cpp \
 	engine/App.cpp \
+	engine/ArchiveWriter.cpp \
 	engine/C2eServices.cpp \
 	engine/Classifier.cpp \
 	engine/CosInstaller.cpp \
+	engine/CPUID.cpp \
 	engine/CreaturesArchive.cpp \
 	engine/CustomHeap.cpp \
+	engine/DirectoryIndex.cpp \
 	engine/Entity.cpp \
 	engine/unix/File.cpp \
 	engine/unix/FileFuncs.cpp \
@@ -40,6 +42,7 @@ SRC += engine/AgentManager.cpp \
 	engine/PersistentObject.cpp \
 	engine/Scramble.cpp \
 	engine/Stimulus.cpp \
+	engine/WorkerPool.cpp \
 	engine/World.cpp \
 	engine/md5.cpp \
 	engine/mfchack.cpp \
@@ -11,6 +11,7 @@
 // --------------------------------------------------------------------------
 
 #include "../File.h"	// platform independent header.
+#include "../DirectoryIndex.h"
 //#include "Display/ErrorMessageHandler.h"
 
 #include <sys/types.h>
@@ -76,10 +77,17 @@ void File::Create( const std::string& name,
 		oflags |= O_WRONLY;
 
 
+	// (O_CREAT, so it may well have been there already)
+	struct stat s;
+	bool created = stat( name.c_str(), &s ) == -1;
+
 	myDiskFileHandle = open( name.c_str(), oflags, S_IREAD|S_IWRITE );
 
 	if( myDiskFileHandle==INVALID_HANDLE_VALUE)
 		throw FileException( "File::Open", __LINE__);
+
+	if( created )
+		DirectoryIndex::theDirectoryIndex().FileCreated( name );
 }
 
 
@@ -146,10 +154,7 @@ void File::Write(std::string string)
 
 bool File::FileExists(std::string& filename)
 {
-	struct stat s;
-	if( stat( filename.c_str(), &s) == -1)
-		return false;
-	return true;
+	return DirectoryIndex::theDirectoryIndex().FileExists( filename );
 }
 
 void File::Close()